@@ -0,0 +1,301 @@
+#include "DspBench.hxx"
+
+#include "DspCore/Biquad.hxx"
+#include "DspCore/BiquadBank.hxx"
+#include "DspCore/Denormals.hxx"
+#include "DspCore/LowPassTable.hxx"
+#include "DspCore/ParameterMapping.hxx"
+#include "DspCore/Silence.hxx"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// The filter loop of MyVstPlugIn-ex3 before Biquad (without the gain ramp):
+struct LegacyBiquad
+{
+	double b_[3], a_[3], xN_[3], yN_[3];
+
+	LegacyBiquad(double freq, double q, double sampleRate)
+	{
+		float w0 = 2 * 3.14159265358979323f * (float)freq / (float)sampleRate;
+		float alpha = std::sin(w0) / (2.0f * (float)q);
+		b_[0] = (1.0f - std::cos(w0)) / 2.0f;
+		b_[1] = 1.0f - std::cos(w0);
+		b_[2] = b_[0];
+		a_[0] = 1.0f + alpha;
+		a_[1] = -2.0f * std::cos(w0);
+		a_[2] = 1.0f - alpha;
+		for (int i = 0; i < 3; i++)
+		{
+			xN_[i] = yN_[i] = 0.0;
+		}
+	}
+
+	void process(const float *in, float *out, int numSamples)
+	{
+		for (int j = 0; j < numSamples; ++j)
+		{
+			xN_[2] = xN_[1];
+			xN_[1] = xN_[0];
+			xN_[0] = in[j];
+			yN_[2] = yN_[1];
+			yN_[1] = yN_[0];
+			yN_[0] = (b_[0]/a_[0]) * xN_[0] + (b_[1]/a_[0]) * xN_[1] + (b_[2]/a_[0]) * xN_[2] -
+			         (a_[1]/a_[0]) * yN_[1] - (a_[2]/a_[0]) * yN_[2];
+			out[j] = (float)yN_[0];
+		}
+	}
+};
+
+template <typename Sample, typename Coeff>
+static double benchBiquad(const char *group, const char *variant, const std::vector<float> &input,
+                          const std::vector<float> &reference, double legacy)
+{
+	const int n = (int)input.size();
+	std::vector<Sample> in(input.begin(), input.end()), out(n);
+	Biquad<Sample, Coeff> filter;
+	filter.setLowPass(1000.0, 0.707, 48000.0);
+
+	filter.process(&in[0], &out[0], n);
+	double maxError = 0.0;
+	for (int j = 0; j < n; ++j)
+	{
+		maxError = std::fmax(maxError, std::fabs((double)out[j] - (double)reference[j]));
+	}
+
+	double ns = benchTime([&]() { filter.process(&in[0], &out[0], n); benchKeep(out[0]); });
+	char name[64];
+	std::snprintf(name, sizeof(name), "%s (err %.0e)", variant, maxError);
+	benchReport(group, name, ns/n, "ns/sample", legacy/ns);
+	return ns;
+}
+
+// TDF-II Biquad templates against the legacy ex3 loop, 1 kHz low-pass at 48 kHz:
+DSPBENCH(biquad)
+{
+	const int n = 1024;
+	std::vector<float> in(n), reference(n), out(n);
+	for (int j = 0; j < n; ++j)
+	{
+		in[j] = std::sin(0.05f*j) + 0.3f*std::sin(1.3f*j);
+	}
+
+	LegacyBiquad legacyFilter(1000.0, 0.707, 48000.0);
+	legacyFilter.process(&in[0], &reference[0], n);
+	legacyFilter = LegacyBiquad(1000.0, 0.707, 48000.0);
+	double legacy = benchTime([&]() { legacyFilter.process(&in[0], &out[0], n); benchKeep(out[0]); });
+	benchReport("biquad/1024", "legacy ex3 loop", legacy/n, "ns/sample");
+
+	benchBiquad<float, double>("biquad/1024", "Biquad<float, double>", in, reference, legacy);
+	benchBiquad<float, float>("biquad/1024", "Biquad<float, float>", in, reference, legacy);
+	benchBiquad<double, double>("biquad/1024", "Biquad<double, double>", in, reference, legacy);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// The legacy ex3 loop fed silence, with its double state restarted every block just inside
+// the subnormal range (the end of a decaying tail), against normal numbers, against FTZ/DAZ,
+// and against skipping the block altogether once silence is detected:
+DSPBENCH(denormals)
+{
+	const int n = 1024;
+	std::vector<float> in(n, 0.0f), out(n);
+	LegacyBiquad filter(100.0, 0.707, 48000.0);
+	const double tiny = 1e-309; // below DBL_MIN = 2.2e-308
+
+	double normal = benchTime([&]() {
+		filter.yN_[0] = 1e-3;
+		filter.yN_[1] = 0.99e-3;
+		filter.process(&in[0], &out[0], n);
+		benchKeep(out[0]);
+	});
+	benchReport("denormals/1024", "legacy ex3 loop, normal", normal/n, "ns/sample");
+
+	double subnormal = benchTime([&]() {
+		filter.yN_[0] = tiny;
+		filter.yN_[1] = 0.99*tiny;
+		filter.process(&in[0], &out[0], n);
+		benchKeep(out[0]);
+	});
+	benchReport("denormals/1024", "legacy ex3 loop, subnormal", subnormal/n, "ns/sample", normal/subnormal);
+
+	double flushed = benchTime([&]() {
+		ScopedFlushDenormals flushDenormals;
+		filter.yN_[0] = tiny;
+		filter.yN_[1] = 0.99*tiny;
+		filter.process(&in[0], &out[0], n);
+		benchKeep(out[0]);
+	});
+	benchReport("denormals/1024", "subnormal, FTZ/DAZ", flushed/n, "ns/sample", subnormal/flushed);
+
+	const float *channels[1] = { &in[0] };
+	float *outputs[1] = { &out[0] };
+	double skipped = benchTime([&]() {
+		if (!isSilent(channels, 1, n))
+		{
+			filter.process(&in[0], &out[0], n);
+		}
+		else
+		{
+			clearChannels(outputs, 1, n);
+		}
+		benchKeep(out[0]);
+	});
+	benchReport("denormals/1024", "isSilent + clearChannels", skipped/n, "ns/sample", subnormal/skipped);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+template <typename T, int Lanes>
+static void benchBiquadBank(const char *group, const char *variant, std::vector<float *> &in,
+                            std::vector<float *> &out, int n, double scalar)
+{
+	const int numChannels = (int)in.size();
+	const int numBanks = (numChannels + Lanes - 1)/Lanes;
+	std::vector<BiquadBank<T, Lanes> > banks(numBanks);
+	for (int c = 0; c < numChannels; ++c)
+	{
+		banks[c/Lanes].setLowPass(c % Lanes, 200.0 + 100.0*c, 0.707, 48000.0);
+	}
+
+	double ns = benchTime([&]() {
+		for (int b = 0; b < numBanks; ++b)
+		{
+			const int channels = numChannels - b*Lanes < Lanes ? numChannels - b*Lanes : Lanes;
+			banks[b].process(&in[b*Lanes], &out[b*Lanes], channels, n);
+		}
+		benchKeep(out[0][0]);
+	});
+	benchReport(group, variant, ns/((double)n*numChannels), "ns/sample", scalar/ns);
+}
+
+// 32 channels with per-channel cutoffs: one scalar Biquad per channel against SoA banks:
+DSPBENCH(biquadbank)
+{
+	const int n = 1024, numChannels = 32;
+	std::vector<float> data(2*(size_t)n*numChannels);
+	for (size_t i = 0; i < data.size(); ++i)
+	{
+		data[i] = std::sin(0.05f*i) + 0.3f*std::sin(1.3f*i);
+	}
+	std::vector<float *> in(numChannels), out(numChannels);
+	for (int c = 0; c < numChannels; ++c)
+	{
+		in[c] = &data[(size_t)c*n];
+		out[c] = &data[(size_t)(numChannels + c)*n];
+	}
+
+	std::vector<Biquad<float, double> > filters(numChannels);
+	for (int c = 0; c < numChannels; ++c)
+	{
+		filters[c].setLowPass(200.0 + 100.0*c, 0.707, 48000.0);
+	}
+	double scalar = benchTime([&]() {
+		for (int c = 0; c < numChannels; ++c)
+		{
+			filters[c].process(in[c], out[c], n);
+		}
+		benchKeep(out[0][0]);
+	});
+	benchReport("biquadbank/32x1024", "32 x Biquad<float, double>", scalar/((double)n*numChannels), "ns/sample");
+
+	benchBiquadBank<float, 4>("biquadbank/32x1024", "BiquadBank<float, 4>", in, out, n, scalar);
+	benchBiquadBank<float, 8>("biquadbank/32x1024", "BiquadBank<float, 8>", in, out, n, scalar);
+	benchBiquadBank<float, 16>("biquadbank/32x1024", "BiquadBank<float, 16>", in, out, n, scalar);
+	benchBiquadBank<double, 4>("biquadbank/32x1024", "BiquadBank<double, 4>", in, out, n, scalar);
+	benchBiquadBank<double, 8>("biquadbank/32x1024", "BiquadBank<double, 8>", in, out, n, scalar);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Magnitude response in dB at frequency w (radians/sample):
+static double magnitudeDb(const BiquadCoeffs<float> &c, double w)
+{
+	const double cw = std::cos(w), sw = std::sin(w), c2w = std::cos(2.0*w), s2w = std::sin(2.0*w);
+	const double nr = c.b0 + c.b1*cw + c.b2*c2w, ni = -(c.b1*sw + c.b2*s2w);
+	const double dr = 1.0 + c.a1*cw + c.a2*c2w, di = -(c.a1*sw + c.a2*s2w);
+	return 10.0*std::log10((nr*nr + ni*ni)/(dr*dr + di*di));
+}
+
+// LowPassTable (ex3 ranges: 20 Hz..10 kHz, Q 0.01..10) against computing the coefficients:
+DSPBENCH(lowpasstable)
+{
+	const double sampleRate = 48000.0;
+	LowPassTable table;
+	table.build(sampleRate, 20.0, 10000.0, 0.01, 10.0);
+
+	// Worst magnitude response difference above -40 dB, off grid, at 64 frequencies up to 20 kHz:
+	double maxErrorDb = 0.0;
+	for (int i = 0; i < 1000; ++i)
+	{
+		const float cutoff = (i + 0.37f)/1000.0f;
+		for (int k = 0; k < 40; ++k)
+		{
+			const float q = (k + 0.5f)/40.0f;
+			const BiquadCoeffs<float> approx = table.lookup(cutoff, q), exact = table.exact(cutoff, q);
+			for (int f = 1; f <= 64; ++f)
+			{
+				const double w = 2.0*3.14159265358979323846*20000.0*f/(64.0*sampleRate);
+				const double reference = magnitudeDb(exact, w);
+				if (reference < -40.0)
+				{
+					continue; // stop band
+				}
+				const double error = std::fabs(magnitudeDb(approx, w) - reference);
+				maxErrorDb = std::fmax(maxErrorDb, error);
+			}
+		}
+	}
+	benchReport("lowpasstable/error", "max |dB| difference", maxErrorDb, "dB");
+
+	float cutoff = 0.0f;
+	double exact = benchTime([&]() {
+		cutoff = cutoff < 1.0f ? cutoff + 0.0013f : 0.0f;
+		BiquadCoeffs<double> c = BiquadCoeffs<double>::lowPass(norm2exp((double)cutoff, 20.0, 10000.0), 0.707, sampleRate);
+		benchKeep(c);
+	});
+	benchReport("lowpasstable/update", "norm2exp + BiquadCoeffs::lowPass", exact, "ns/update");
+	double lookup = benchTime([&]() {
+		cutoff = cutoff < 1.0f ? cutoff + 0.0013f : 0.0f;
+		BiquadCoeffs<float> c = table.lookup(cutoff, 0.07f);
+		benchKeep(c);
+	});
+	benchReport("lowpasstable/update", "LowPassTable::lookup", lookup, "ns/update", exact/lookup);
+
+	// Cost of per-sample coefficient interpolation in a bank:
+	const int n = 1024;
+	std::vector<float> data(2*n*16);
+	for (size_t i = 0; i < data.size(); ++i)
+	{
+		data[i] = std::sin(0.05f*i);
+	}
+	std::vector<float *> in(16), out(16);
+	for (int c = 0; c < 16; ++c)
+	{
+		in[c] = &data[(size_t)c*n];
+		out[c] = &data[(size_t)(16 + c)*n];
+	}
+	BiquadBank<float, 16> bank;
+	bank.setCoefficients(table.lookup(0.5f, 0.07f));
+	double fixed = benchTime([&]() { bank.process(&in[0], &out[0], 16, n); benchKeep(out[0][0]); });
+	benchReport("lowpasstable/bank16", "fixed coefficients", fixed/(16.0*n), "ns/sample");
+	double ramped = benchTime([&]() {
+		for (int j = 0; j < n; j += 32)
+		{
+			cutoff = cutoff < 1.0f ? cutoff + 0.0013f : 0.0f;
+			bank.setTarget(table.lookup(cutoff, 0.07f));
+			bank.rampToTarget(32);
+			const float *x[16];
+			float *y[16];
+			for (int c = 0; c < 16; ++c)
+			{
+				x[c] = in[c] + j;
+				y[c] = out[c] + j;
+			}
+			bank.process(x, y, 16, 32);
+		}
+		benchKeep(out[0][0]);
+	});
+	benchReport("lowpasstable/bank16", "lookup every 32 + per-sample ramp", ramped/(16.0*n), "ns/sample", fixed/ramped);
+}
@@ -0,0 +1,31 @@
+#include "DspBench.hxx"
+
+#include "DspCore/BlockProfiler.hxx"
+
+// Per-block cost of the instrumentation every plug-in carries (see BlockProfiler.hxx): the
+// scope with the counters only, as in a process without DSPCORE_PROFILE, and the two parts
+// added while a drain thread listens, a timestamp read and a record through the ring.
+DSPBENCH(blockProfiler)
+{
+	static BlockProfiler profiler; // not set up: counters only
+	const double scope = benchTime([&]() {
+		BlockProfiler::Scope profile(profiler, 64);
+		profiler.mark(BlockProfiler::kRamping);
+	});
+	benchReport("profiler/scope", "counters only", scope, "ns/block");
+	benchKeep(profiler.blocks());
+
+	uint64_t ticks = 0;
+	const double timestamp = benchTime([&]() { ticks += profilerTicks(); benchKeep(ticks); });
+	benchReport("profiler/timestamp", "profilerTicks()", timestamp, "ns/call");
+
+	static SpscRing<BlockRecord, 1024> ring;
+	BlockRecord record = { 1000u, 64, 0u };
+	const double pushPop = benchTime([&]() {
+		ring.push(record);
+		ring.pop(record);
+		benchKeep(record);
+	});
+	benchReport("profiler/ring", "push + pop", pushPop, "ns/record");
+	benchReport("profiler/scope", "drained (estimate)", scope + 2.0*timestamp + pushPop, "ns/block");
+}
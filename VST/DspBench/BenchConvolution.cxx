@@ -0,0 +1,165 @@
+#include "DspBench.hxx"
+
+#include "DspCore/PartitionedConvolver.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// Deterministic decaying noise, a stand-in for a reverb impulse response:
+static std::vector<float> makeImpulseResponse(int length, float decaySamples)
+{
+	std::vector<float> ir(length);
+	unsigned int seed = 12345u;
+	for (int j = 0; j < length; ++j)
+	{
+		seed = seed*1664525u + 1013904223u;
+		const float noise = (float)(seed >> 9)*(2.0f/8388608.0f) - 1.0f;
+		ir[j] = noise*std::exp(-(float)j/decaySamples);
+	}
+	return ir;
+}
+
+// Direct form, in double, the reference for the error:
+static void directConvolution(const std::vector<float> &x, const std::vector<float> &ir, std::vector<double> &y)
+{
+	y.assign(x.size(), 0.0);
+	for (size_t n = 0; n < x.size(); ++n)
+	{
+		const size_t taps = std::min(ir.size(), n + 1);
+		double sum = 0.0;
+		for (size_t k = 0; k < taps; ++k)
+		{
+			sum += (double)ir[k]*x[n - k];
+		}
+		y[n] = sum;
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Uniform and non-uniform partitioning against the direct convolution, in host blocks that
+// do not line up with the partitions:
+DSPBENCH(convolutionError)
+{
+	const std::vector<float> ir = makeImpulseResponse(12000, 3000.0f);
+	std::vector<float> x(24000), y(24000);
+	for (size_t j = 0; j < x.size(); ++j)
+	{
+		x[j] = std::sin(0.01f*j) + 0.5f*(float)((j*7919) % 101 - 50)/50.0f;
+	}
+	std::vector<double> reference;
+	directConvolution(x, ir, reference);
+	double peak = 0.0;
+	for (size_t j = 0; j < reference.size(); ++j)
+	{
+		peak = std::fmax(peak, std::fabs(reference[j]));
+	}
+
+	const int maxPartitionSizes[] = { 64, 4096 };
+	const int hostBlocks[] = { 64, 37, 1000 };
+	for (int m = 0; m < 2; ++m)
+	{
+		PartitionedConvolver convolver;
+		convolver.setup(&ir[0], (int)ir.size(), 64, maxPartitionSizes[m]);
+		char group[48];
+		std::snprintf(group, sizeof(group), "convolution/%s", maxPartitionSizes[m] == 64 ? "uniform" : "non-uniform");
+		benchReport(group, "stages", convolver.numStages(), "");
+		benchReport(group, "latency", convolver.latency(), "samples");
+		for (int b = 0; b < 3; ++b)
+		{
+			convolver.reset();
+			for (size_t j = 0; j < x.size(); j += hostBlocks[b])
+			{
+				const int n = (int)std::min((size_t)hostBlocks[b], x.size() - j);
+				convolver.process(&x[j], &y[j], n);
+			}
+			double error = 0.0;
+			for (size_t j = convolver.latency(); j < y.size(); ++j)
+			{
+				error = std::fmax(error, std::fabs(y[j] - reference[j - convolver.latency()]));
+			}
+			char variant[64];
+			std::snprintf(variant, sizeof(variant), "error / peak, host block %d", hostBlocks[b]);
+			benchReport(group, variant, error/peak, "");
+		}
+	}
+}
+
+// A 3 s response at 44.1 kHz in 64 sample blocks: mean cost per sample and the slowest block,
+// against the block period at 96 kHz, the shortest ex6 runs at. Non-uniform partitioning up
+// to 4096 (ex6's default) must keep the slowest block within 15% of the period; uniform
+// partitioning is too slow on average for such a response, and with 16384 a single 32768
+// point transform takes longer, so those are only reported:
+DSPBENCH(convolution)
+{
+	const int blockSize = 64;
+	const double periodMicroseconds = 1e6*blockSize/96000.0;
+	const double maxWorstShare = 0.15;
+	const std::vector<float> ir = makeImpulseResponse(3*44100, 0.5f*44100);
+	std::vector<float> x(blockSize), y(blockSize);
+	for (int j = 0; j < blockSize; ++j)
+	{
+		x[j] = std::sin(0.05f*j);
+	}
+	const char *group = "convolution/3s";
+
+	// Direct form, as a scale:
+	std::vector<float> history(ir.size() + blockSize, 0.0f);
+	double direct = benchTime([&]() {
+		std::copy(history.begin() + blockSize, history.end(), history.begin());
+		std::copy(x.begin(), x.end(), history.end() - blockSize);
+		for (int j = 0; j < blockSize; ++j)
+		{
+			const float *newest = &history[ir.size() + j];
+			float sum = 0.0f;
+			for (size_t k = 0; k < ir.size(); ++k)
+			{
+				sum += ir[k]*newest[-(long)k];
+			}
+			y[j] = sum;
+		}
+		benchKeep(y[0]);
+	}, 0.05);
+	benchReport(group, "direct form", direct/blockSize, "ns/sample");
+
+	const int maxPartitionSizes[] = { 64, 1024, 4096, 16384 };
+	for (int m = 0; m < 4; ++m)
+	{
+		PartitionedConvolver convolver;
+		convolver.setup(&ir[0], (int)ir.size(), blockSize, maxPartitionSizes[m]);
+		double ns = benchTime([&]() { convolver.process(&x[0], &y[0], blockSize); benchKeep(y[0]); });
+		char variant[64];
+		std::snprintf(variant, sizeof(variant), "partitions 64..%d, %d stages", maxPartitionSizes[m], convolver.numStages());
+		benchReport(group, variant, ns/blockSize, "ns/sample", direct/ns);
+
+		// Worst block over a few cycles of the largest partition; the lowest of 3 runs, as a
+		// single run also catches the interrupts of the machine:
+		typedef std::chrono::steady_clock Clock;
+		double worst = 0.0;
+		for (int run = 0; run < 3; ++run)
+		{
+			double runWorst = 0.0;
+			for (int i = 0; i < 4*maxPartitionSizes[m]/blockSize + 16; ++i)
+			{
+				const Clock::time_point start = Clock::now();
+				convolver.process(&x[0], &y[0], blockSize);
+				runWorst = std::fmax(runWorst, std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+			}
+			worst = run == 0 ? runWorst : std::fmin(worst, runWorst);
+		}
+		std::snprintf(variant, sizeof(variant), "partitions 64..%d, worst block", maxPartitionSizes[m]);
+		benchReport(group, variant, worst, "us");
+		std::snprintf(variant, sizeof(variant), "partitions 64..%d, of period", maxPartitionSizes[m]);
+		benchReport(group, variant, 100.0*worst/periodMicroseconds, "%");
+		if (maxPartitionSizes[m] > blockSize && maxPartitionSizes[m] <= 4096)
+		{
+			char requirement[96];
+			std::snprintf(requirement, sizeof(requirement), "worst block %.0f us, above %.0f%% of the %.0f us period",
+			              worst, 100.0*maxWorstShare, periodMicroseconds);
+			benchCheck(worst <= maxWorstShare*periodMicroseconds, group, variant, requirement);
+		}
+	}
+}
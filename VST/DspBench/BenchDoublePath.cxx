@@ -0,0 +1,147 @@
+#include "DspBench.hxx"
+
+#include "DspCore/BiquadBank.hxx"
+#include "DspCore/GainRamp.hxx"
+#include "DspCore/PanLaw.hxx"
+#include "DspCore/WavetableSynth.hxx"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// The processDoubleReplacing() kernels against what a 64 bit host does for a plug-in without
+// one: convert the double buffers to float, run processReplacing(), convert back.
+
+// Non-interleaved channels of one sample type, plus the pointer array:
+template <typename Sample>
+struct BenchChannels
+{
+	std::vector<Sample> data;
+	std::vector<Sample *> pointers;
+
+	BenchChannels(int numChannels, int numSamples) : data((size_t)numChannels*numSamples), pointers(numChannels)
+	{
+		for (int c = 0; c < numChannels; ++c)
+		{
+			pointers[c] = &data[(size_t)c*numSamples];
+		}
+		for (size_t i = 0; i < data.size(); ++i)
+		{
+			data[i] = (Sample)(0.5*std::sin(0.05*(double)i) + 0.2*std::sin(1.3*(double)i));
+		}
+	}
+
+	Sample **channels() { return &pointers[0]; }
+};
+
+template <typename From, typename To>
+static void convertChannels(const BenchChannels<From> &from, BenchChannels<To> &to)
+{
+	for (size_t i = 0; i < from.data.size(); ++i)
+	{
+		to.data[i] = (To)from.data[i];
+	}
+}
+
+// Reports the three ways for one kernel; process(float/double inputs, outputs) runs it once.
+template <typename Process>
+static void benchPrecisions(const char *group, int numChannels, int numInputs, int n, Process process)
+{
+	BenchChannels<float> floatIn(numInputs, n), floatOut(numChannels, n);
+	BenchChannels<double> doubleIn(numInputs, n), doubleOut(numChannels, n);
+	convertChannels(floatIn, doubleIn);
+
+	const double samples = (double)n*numChannels;
+	double single = benchTime([&]() { process(floatIn.channels(), floatOut.channels(), n); benchKeep(floatOut.data[0]); });
+	benchReport(group, "float", single/samples, "ns/sample");
+	double converted = benchTime([&]() {
+		convertChannels(doubleIn, floatIn);
+		process(floatIn.channels(), floatOut.channels(), n);
+		convertChannels(floatOut, doubleOut);
+		benchKeep(doubleOut.data[0]);
+	});
+	benchReport(group, "double via float", converted/samples, "ns/sample", single/converted);
+	double native = benchTime([&]() { process(doubleIn.channels(), doubleOut.channels(), n); benchKeep(doubleOut.data[0]); });
+	benchReport(group, "double", native/samples, "ns/sample", single/native);
+
+	// The two paths share their code, so they differ by float rounding only:
+	convertChannels(doubleIn, floatIn);
+	process(floatIn.channels(), floatOut.channels(), n);
+	process(doubleIn.channels(), doubleOut.channels(), n);
+	double maxError = 0.0;
+	for (size_t i = 0; i < doubleOut.data.size(); ++i)
+	{
+		maxError = std::fmax(maxError, std::fabs(doubleOut.data[i] - (double)floatOut.data[i]));
+	}
+	benchReport(group, "max |double - float|", maxError, "");
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+DSPBENCH(doublePath)
+{
+	const int blockSizes[] = { 64, 1024 };
+	for (int b = 0; b < 2; ++b)
+	{
+		const int n = blockSizes[b];
+		char group[32];
+
+		// MyVstPlugIn-ex1: a ramping gain per channel (each block restarts the same ramp):
+		std::snprintf(group, sizeof(group), "double/gain/%d", n);
+		LinearSmoother gainL, gainR;
+		gainL.setRampTime(20.0f, 48000.0f);
+		gainR.setRampTime(20.0f, 48000.0f);
+		benchPrecisions(group, 2, 2, n, [&](auto **in, auto **out, int numSamples) {
+			gainL.reset(0.2f);
+			gainL.setTarget(0.9f);
+			gainR.reset(0.8f);
+			gainR.setTarget(0.1f);
+			applySmoothedGain(gainL, in[0], out[0], numSamples);
+			applySmoothedGain(gainR, in[1], out[1], numSamples);
+		});
+
+		// MyVstPlugIn-ex2: gain and balance ramping together:
+		std::snprintf(group, sizeof(group), "double/pan/%d", n);
+		LinearSmoother gain, balance;
+		gain.setRampTime(20.0f, 48000.0f);
+		balance.setRampTime(20.0f, 48000.0f);
+		benchPrecisions(group, 2, 2, n, [&](auto **in, auto **out, int numSamples) {
+			gain.reset(0.3f);
+			gain.setTarget(0.9f);
+			balance.reset(0.1f);
+			balance.setTarget(0.8f);
+			applySmoothedPan(kPanLaw3dB, gain, balance, in, out, numSamples);
+		});
+
+		// MyVstPlugIn-ex3 built with 8 channels: one float bank, double audio converted in the
+		// transposes:
+		std::snprintf(group, sizeof(group), "double/bank8/%d", n);
+		BiquadBank<float, 8> bank;
+		for (int l = 0; l < 8; ++l)
+		{
+			bank.setLowPass(l, 200.0 + 300.0*l, 0.707, 48000.0);
+		}
+		benchPrecisions(group, 8, 8, n, [&](auto **in, auto **out, int numSamples) {
+			bank.reset();
+			bank.process(in, out, 8, numSamples);
+		});
+
+		// MyVstPlugIn-ex4: 16 voices (restarted every block) summed into the output:
+		std::snprintf(group, sizeof(group), "double/synth16/%d", n);
+		const ClippedSineWavetables &tables = clippedSineWavetables();
+		WavetableSynth synth;
+		synth.setSampleRate(48000.0f, 5.0f, 60.0f);
+		benchPrecisions(group, 1, 1, n, [&](auto **in, auto **out, int numSamples) {
+			synth.allSoundOff();
+			for (int v = 0; v < 16; ++v)
+			{
+				synth.noteOn(36 + 3*v, 100);
+			}
+			for (int j = 0; j < numSamples; ++j)
+			{
+				out[0][j] = 0;
+			}
+			synth.render(tables.table(4), tables.table(5), out[0], numSamples, 0.3f, 0.3f);
+		});
+	}
+}
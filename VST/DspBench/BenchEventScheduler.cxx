@@ -0,0 +1,106 @@
+#include "DspBench.hxx"
+
+#include "DspCore/EventScheduler.hxx"
+#include "DspCore/GainRamp.hxx"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// MyVstPlugIn-ex1's gain channel driven by a host: gain changes at absolute sample positions,
+// rendered in host blocks of blockSize. With sampleAccurate, each change is sent as an event
+// at its deltaFrames; without, it is applied at the start of the block it falls in, as
+// setParameter() before processReplacing() would.
+struct ScheduledGain
+{
+	int frame;
+	float gain;
+};
+
+static void renderGain(const std::vector<float> &in, std::vector<float> &out, int blockSize,
+                       const std::vector<ScheduledGain> &changes, bool sampleAccurate)
+{
+	LinearSmoother gain;
+	gain.setRampTime(20.0f, 48000.0f);
+	gain.reset(1.0f);
+	EventScheduler<512> events(1);
+
+	const int n = (int)in.size();
+	size_t c = 0;
+	for (int start = 0; start < n; start += blockSize)
+	{
+		const int len = n - start < blockSize ? n - start : blockSize;
+		for (; c < changes.size() && changes[c].frame < start + len; ++c)
+		{
+			events.pushParameter(sampleAccurate ? changes[c].frame - start : 0, 0, changes[c].gain);
+		}
+		events.process(len,
+			[&](const ScheduledEvent &event) { gain.setTarget(event.value); },
+			[&](int from, int length) { applySmoothedGain(gain, &in[start + from], &out[start + from], length); });
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+DSPBENCH(eventScheduler)
+{
+	const int n = 3*4096;
+	std::vector<float> in(n, 0.5f), reference(n), out(n), out32(n);
+	renderGain(in, reference, n, std::vector<ScheduledGain>(), true);
+
+	// Where a gain change at sample 5003 starts to ramp, for several host block sizes (the
+	// first sample of a ramp still has the old gain):
+	std::vector<ScheduledGain> change(1);
+	change[0].frame = 5003;
+	change[0].gain = 0.25f;
+	const int blockSizes[] = { 32, 100, 4096 };
+	for (int b = 0; b < 3; ++b)
+	{
+		for (int accurate = 1; accurate >= 0; --accurate)
+		{
+			renderGain(in, out, blockSizes[b], change, accurate != 0);
+			int first = 0;
+			while (first < n && out[first] == reference[first])
+			{
+				++first;
+			}
+			char variant[64];
+			std::snprintf(variant, sizeof(variant), "%d blocks, %s", blockSizes[b], accurate ? "events" : "block start");
+			benchReport("scheduler/change at 5003", variant, first - 1, "ramp start");
+		}
+	}
+
+	// The same automation in 32 and 4096 sample blocks (differences from float rounding of
+	// the ramp segments only):
+	std::vector<ScheduledGain> automation;
+	for (int i = 0; i < 64; ++i)
+	{
+		ScheduledGain g = { 37 + 191*i, 0.5f + 0.5f*std::sin(0.3f*i) };
+		automation.push_back(g);
+	}
+	renderGain(in, out32, 32, automation, true);
+	renderGain(in, out, 4096, automation, true);
+	double maxDiff = 0.0;
+	for (int j = 0; j < n; ++j)
+	{
+		maxDiff = std::fmax(maxDiff, std::fabs((double)out[j] - (double)out32[j]));
+	}
+	benchReport("scheduler/64 changes", "max |4096 blocks - 32 blocks|", maxDiff, "");
+
+	// Cost of a 4096 sample block with more and more changes (mostly the ramps they start):
+	const int counts[] = { 0, 4, 32, 256 };
+	for (int k = 0; k < 4; ++k)
+	{
+		std::vector<ScheduledGain> changes;
+		for (int i = 0; i < counts[k]; ++i)
+		{
+			ScheduledGain g = { (int)((long)i*4096/counts[k]) + 7, (i & 1) ? 0.3f : 0.9f };
+			changes.push_back(g);
+		}
+		std::vector<float> block(in.begin(), in.begin() + 4096), result(4096);
+		const double ns = benchTime([&]() { renderGain(block, result, 4096, changes, true); benchKeep(result[0]); });
+		char variant[64];
+		std::snprintf(variant, sizeof(variant), "%d events", counts[k]);
+		benchReport("scheduler/4096", variant, ns/4096, "ns/sample");
+	}
+}
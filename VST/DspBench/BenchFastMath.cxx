@@ -0,0 +1,160 @@
+#include "DspBench.hxx"
+
+#include "DspCore/FastMath.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+// Accuracy of the FastMath.hxx approximations against libm in double, over dense sweeps of
+// their ranges (a test: fails above the stated bounds), and their throughput in a loop
+// against the float libm functions (the loops vectorize for the approximations, not for
+// libm).
+
+static const double twoPi = 6.283185307179586476925;
+
+// Largest error of approximation(x) against exact((double)x) over n points from first to
+// last (linear, or geometric if geometric); relative error if relative, else absolute. The
+// points are rounded to the argument type of approximation (float, or double for the
+// polynomials):
+template <typename Argument, typename Result, typename Exact>
+static double maxError(Result (*approximation)(Argument), Exact exact, double first, double last, int n, bool geometric, bool relative)
+{
+	double worst = 0.0;
+	for (int i = 0; i <= n; ++i)
+	{
+		const double position = (double)i/n;
+		const Argument x = (Argument)(geometric ? first*std::pow(last/first, position) : first + (last - first)*position);
+		const double reference = exact((double)x);
+		double error = std::fabs((double)approximation(x) - reference);
+		if (relative)
+		{
+			error /= std::fabs(reference);
+		}
+		worst = std::max(worst, error);
+	}
+	return worst;
+}
+
+// Reports an error and fails the run if it is above the bound:
+static void checkError(const char *variant, double bound, const char *unit, double error)
+{
+	benchReport("fastmath/error", variant, error, unit);
+	char requirement[64];
+	std::snprintf(requirement, sizeof(requirement), "%s error above %.3g", unit, bound);
+	benchCheck(error <= bound, "fastmath/error", variant, requirement);
+}
+
+// ns per value of function over the values of x:
+template <typename Function>
+static double throughput(Function function, const std::vector<float> &x, std::vector<float> &y)
+{
+	const int n = (int)x.size();
+	const double ns = benchTime([&]() {
+		for (int i = 0; i < n; ++i)
+		{
+			y[i] = function(x[i]);
+		}
+		benchKeep(y[0]);
+	});
+	return ns/n;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// The bounds stated in FastMath.hxx, in the order of its table and its polynomials; run by
+// ctest:
+DSPBENCH(fastMathAccuracy)
+{
+	const int points = 1 << 21;
+
+	checkError("fastExp2, [-126, 127]", 2.4e-7, "relative",
+	           maxError(fastExp2, [](double x) { return std::exp2(x); }, -126.0, 127.0, points, false, true));
+	checkError("fastExp2, [-1, 1]", 2.4e-7, "relative",
+	           maxError(fastExp2, [](double x) { return std::exp2(x); }, -1.0, 1.0, points, false, true));
+	checkError("fastLog2, [0.5, 2]", 1.2e-7, "absolute",
+	           maxError(fastLog2, [](double x) { return std::log2(x); }, 0.5, 2.0, points, false, false));
+	checkError("fastLog2, [1e-37, 1e38]", 3.9e-6, "absolute",
+	           maxError(fastLog2, [](double x) { return std::log2(x); }, 1e-37, 1e38, points, true, false));
+	checkError("fastDecibelsToGain, [-120, 24]", 9.3e-7, "relative",
+	           maxError(fastDecibelsToGain, [](double x) { return std::pow(10.0, x/20.0); }, -120.0, 24.0, points, false, true));
+	checkError("fastGainToDecibels, [1e-6, 16]", 1.2e-5, "dB",
+	           maxError(fastGainToDecibels, [](double x) { return 20.0*std::log10(x); }, 1e-6, 16.0, points, true, false));
+	checkError("fastSinCycles, [-4, 4]", 1.6e-7, "absolute",
+	           maxError(fastSinCycles, [](double x) { return std::sin(twoPi*x); }, -4.0, 4.0, points, false, false));
+	checkError("fastCosCycles, [-4, 4]", 1.6e-7, "absolute",
+	           maxError(fastCosCycles, [](double x) { return std::cos(twoPi*x); }, -4.0, 4.0, points, false, false));
+	checkError("fastSin, [-2 pi, 2 pi]", 4.4e-7, "absolute",
+	           maxError(fastSin, [](double x) { return std::sin(x); }, -twoPi, twoPi, points, false, false));
+	checkError("fastCos, [-2 pi, 2 pi]", 4.4e-7, "absolute",
+	           maxError(fastCos, [](double x) { return std::cos(x); }, -twoPi, twoPi, points, false, false));
+	checkError("fastSin, [-1000, 1000]", 8.8e-5, "absolute",
+	           maxError(fastSin, [](double x) { return std::sin(x); }, -1000.0, 1000.0, points, false, false));
+
+	// The polynomials alone, in double:
+	checkError("exp2 polynomial, [-0.5, 0.5]", 7.51e-8, "relative",
+	           maxError(detail::exp2Polynomial<double>, [](double f) { return std::exp2(f); }, -0.5, 0.5, points, false, true));
+	const double tMax = 3.0 - 2.0*std::sqrt(2.0); // t at m = sqrt(2)
+	checkError("log2 polynomial, |t| < 0.172", 3e-8, "absolute",
+	           maxError(detail::log2Polynomial<double>, [](double t) { return std::log2((1.0 + t)/(1.0 - t)); }, -tMax, tMax, points, false, false));
+	checkError("sin polynomial, [-0.25, 0.25]", 6.62e-9, "absolute",
+	           maxError(detail::sinCyclesPolynomial<double>, [](double r) { return std::sin(twoPi*r); }, -0.25, 0.25, points, false, false));
+
+	// Outside the ranges:
+	const float infinity = std::numeric_limits<float>::infinity();
+	benchCheck(fastDecibelsToGain(-infinity) == 0.0f, "fastmath/limits", "fastDecibelsToGain(-inf)", "0");
+	benchCheck(fastExp2(-1e30f) == 0.0f, "fastmath/limits", "fastExp2(-1e30)", "0");
+	benchCheck(fastExp2(infinity) > 1e38f && fastExp2(infinity) < infinity, "fastmath/limits", "fastExp2(inf)", "finite, about 2^127");
+	benchCheck(fastLog2(0.0f) == -126.0f && fastLog2(-1.0f) == -126.0f, "fastmath/limits", "fastLog2(0), fastLog2(-1)", "-126");
+}
+
+// Throughput in a loop, against the float libm functions:
+DSPBENCH(fastMath)
+{
+	// Throughput, over 4096 values in range:
+	const int n = 4096;
+	std::vector<float> x(n), positive(n), decibels(n), y(n);
+	for (int i = 0; i < n; ++i)
+	{
+		x[i] = -8.0f + 16.0f*i/n;
+		positive[i] = 1e-4f + 20.0f*i/n;
+		decibels[i] = -120.0f + 144.0f*i/n;
+	}
+
+	double exact = throughput([](float v) { return std::exp2(v); }, x, y);
+	double fast = throughput([](float v) { return fastExp2(v); }, x, y);
+	benchReport("fastmath/exp2", "std::exp2", exact, "ns/value");
+	benchReport("fastmath/exp2", "fastExp2", fast, "ns/value", exact/fast);
+
+	exact = throughput([](float v) { return std::log2(v); }, positive, y);
+	fast = throughput([](float v) { return fastLog2(v); }, positive, y);
+	benchReport("fastmath/log2", "std::log2", exact, "ns/value");
+	benchReport("fastmath/log2", "fastLog2", fast, "ns/value", exact/fast);
+
+	exact = throughput([](float v) { return std::pow(10.0f, v/20.0f); }, decibels, y);
+	fast = throughput([](float v) { return fastDecibelsToGain(v); }, decibels, y);
+	benchReport("fastmath/dB to gain", "std::pow(10, dB/20)", exact, "ns/value");
+	benchReport("fastmath/dB to gain", "fastDecibelsToGain", fast, "ns/value", exact/fast);
+
+	exact = throughput([](float v) { return 20.0f*std::log10(v); }, positive, y);
+	fast = throughput([](float v) { return fastGainToDecibels(v); }, positive, y);
+	benchReport("fastmath/gain to dB", "20*std::log10(gain)", exact, "ns/value");
+	benchReport("fastmath/gain to dB", "fastGainToDecibels", fast, "ns/value", exact/fast);
+
+	exact = throughput([](float v) { return std::sin(v); }, x, y);
+	fast = throughput([](float v) { return fastSin(v); }, x, y);
+	benchReport("fastmath/sin", "std::sin", exact, "ns/value");
+	benchReport("fastmath/sin", "fastSin", fast, "ns/value", exact/fast);
+
+	exact = throughput([](float v) { return std::cos(v); }, x, y);
+	fast = throughput([](float v) { return fastCos(v); }, x, y);
+	benchReport("fastmath/cos", "std::cos", exact, "ns/value");
+	benchReport("fastmath/cos", "fastCos", fast, "ns/value", exact/fast);
+
+	exact = throughput([](float v) { return std::pow(v, 0.37f); }, positive, y);
+	fast = throughput([](float v) { return fastPow(v, 0.37f); }, positive, y);
+	benchReport("fastmath/pow", "std::pow(x, 0.37)", exact, "ns/value");
+	benchReport("fastmath/pow", "fastPow(x, 0.37)", fast, "ns/value", exact/fast);
+}
@@ -0,0 +1,166 @@
+#include "DspBench.hxx"
+
+#include "DspCore/RealFft.hxx"
+#include "DspCore/StftProcessor.hxx"
+
+#include <cmath>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+// Textbook DFT in double, the reference for the error of RealFft:
+static void referenceDft(const std::vector<float> &x, std::vector<double> &re, std::vector<double> &im)
+{
+	const int n = (int)x.size();
+	const double pi = 3.14159265358979323846;
+	re.assign(n/2 + 1, 0.0);
+	im.assign(n/2 + 1, 0.0);
+	for (int k = 0; k <= n/2; ++k)
+	{
+		for (int j = 0; j < n; ++j)
+		{
+			const long p = ((long)j*k) % n; // exact phase
+			re[k] += x[j]*std::cos(2.0*pi*p/n);
+			im[k] -= x[j]*std::sin(2.0*pi*p/n);
+		}
+	}
+}
+
+// Baseline: the usual textbook complex radix-2 FFT, interleaved data, twiddles computed by
+// recurrence in every butterfly group, run on the real signal with zero imaginary parts:
+static void baselineFft(std::vector<float> &data) // interleaved complex, in place, size n
+{
+	const int n = (int)data.size()/2;
+	for (int i = 1, j = 0; i < n; ++i)
+	{
+		int bit = n >> 1;
+		for (; j & bit; bit >>= 1)
+		{
+			j ^= bit;
+		}
+		j ^= bit;
+		if (i < j)
+		{
+			std::swap(data[2*i], data[2*j]);
+			std::swap(data[2*i + 1], data[2*j + 1]);
+		}
+	}
+	for (int len = 2; len <= n; len *= 2)
+	{
+		const double angle = -2.0*3.14159265358979323846/len;
+		const float wr = (float)std::cos(angle), wi = (float)std::sin(angle);
+		for (int i = 0; i < n; i += len)
+		{
+			float cr = 1.0f, ci = 0.0f;
+			for (int k = 0; k < len/2; ++k)
+			{
+				float *a = &data[2*(i + k)], *b = &data[2*(i + k + len/2)];
+				const float tr = b[0]*cr - b[1]*ci, ti = b[0]*ci + b[1]*cr;
+				b[0] = a[0] - tr;
+				b[1] = a[1] - ti;
+				a[0] += tr;
+				a[1] += ti;
+				const float next = cr*wr - ci*wi;
+				ci = cr*wi + ci*wr;
+				cr = next;
+			}
+		}
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+DSPBENCH(fft)
+{
+	const int sizes[] = { 256, 1024, 4096 };
+	for (int s = 0; s < 3; ++s)
+	{
+		const int n = sizes[s];
+		char group[32];
+		std::snprintf(group, sizeof(group), "fft/%d", n);
+
+		std::vector<float> x(n), y(n), re(n/2 + 1), im(n/2 + 1);
+		for (int j = 0; j < n; ++j)
+		{
+			x[j] = std::sin(0.05f*j) + 0.3f*std::sin(1.3f*j) + 0.1f*(float)((j*7919) % 13 - 6)/6.0f;
+		}
+		RealFft fft;
+		fft.setSize(n);
+
+		// Errors relative to the largest bin / sample:
+		std::vector<double> refRe, refIm;
+		referenceDft(x, refRe, refIm);
+		fft.forward(&x[0], &re[0], &im[0]);
+		double peak = 0.0, error = 0.0;
+		for (int k = 0; k <= n/2; ++k)
+		{
+			peak = std::fmax(peak, std::hypot(refRe[k], refIm[k]));
+			error = std::fmax(error, std::hypot(re[k] - refRe[k], im[k] - refIm[k]));
+		}
+		benchReport(group, "forward error / peak bin", error/peak, "");
+		fft.inverse(&re[0], &im[0], &y[0]);
+		double roundTrip = 0.0;
+		for (int j = 0; j < n; ++j)
+		{
+			roundTrip = std::fmax(roundTrip, std::fabs(y[j]/n - x[j]));
+		}
+		benchReport(group, "max |inverse(forward(x))/n - x|", roundTrip, "");
+
+		// Throughput against a complex FFT of the real signal:
+		std::vector<float> complexData(2*n);
+		double baseline = benchTime([&]() {
+			for (int j = 0; j < n; ++j)
+			{
+				complexData[2*j] = x[j];
+				complexData[2*j + 1] = 0.0f;
+			}
+			baselineFft(complexData);
+			benchKeep(complexData[0]);
+		});
+		benchReport(group, "complex radix-2, recurrence twiddles", baseline, "ns/transform");
+		double forward = benchTime([&]() { fft.forward(&x[0], &re[0], &im[0]); benchKeep(re[0]); });
+		benchReport(group, "RealFft::forward", forward, "ns/transform", baseline/forward);
+		double inverse = benchTime([&]() { fft.inverse(&re[0], &im[0], &y[0]); benchKeep(y[0]); });
+		benchReport(group, "RealFft::inverse", inverse, "ns/transform", baseline/inverse);
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// StftProcessor with unmodified frames: latency and reconstruction error, then the cost per
+// sample of the "block~ 1024 4" configuration with an empty frame callback:
+DSPBENCH(stft)
+{
+	const int configurations[][2] = { { 1024, 2 }, { 1024, 4 }, { 1024, 8 }, { 4096, 4 } };
+	for (int c = 0; c < 4; ++c)
+	{
+		const int windowSize = configurations[c][0], overlap = configurations[c][1];
+		char group[32];
+		std::snprintf(group, sizeof(group), "stft/%d/%d", windowSize, overlap);
+
+		StftProcessor stft;
+		stft.setup(windowSize, overlap);
+		const int n = 8*windowSize;
+		std::vector<float> x(n), y(n);
+		for (int j = 0; j < n; ++j)
+		{
+			x[j] = std::sin(0.05f*j) + 0.3f*std::sin(1.3f*j);
+		}
+		// In odd sized host blocks:
+		for (int j = 0; j < n; j += 100)
+		{
+			stft.process(&x[j], &y[j], n - j < 100 ? n - j : 100, [](float *, float *, int) {});
+		}
+		double error = 0.0;
+		for (int j = stft.latency(); j < n; ++j)
+		{
+			error = std::fmax(error, std::fabs(y[j] - x[j - stft.latency()]));
+		}
+		benchReport(group, "latency", stft.latency(), "samples");
+		benchReport(group, "max |y[n + latency] - x[n]|", error, "");
+
+		std::vector<float> block(x.begin(), x.begin() + 512), out(512);
+		double ns = benchTime([&]() { stft.process(&block[0], &out[0], 512, [](float *, float *, int) {}); benchKeep(out[0]); });
+		benchReport(group, "process, identity", ns/512, "ns/sample");
+	}
+}
@@ -0,0 +1,129 @@
+#include "DspBench.hxx"
+
+#include "DspCore/GainRamp.hxx"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// The per-sample ramp MyVstPlugIn-ex1 used before applyGainRamp() (one channel):
+static void legacyGainRamp(const float *in, float *out, int numSamples, float lastGain, float gain)
+{
+	for (int j = 0; j < numSamples; ++j)
+	{
+		float g = lastGain + (gain - lastGain) * (j/(float)numSamples);
+		out[j] = in[j] * g;
+	}
+}
+
+// The whole stereo loop of the old MyVstPlugIn-ex1::processReplacing():
+static void legacyStereoGain(float **inputs, float **outputs, int numSamples, float lastGainL, float gainL, float lastGainR, float gainR)
+{
+	for (int j = 0; j < numSamples; ++j)
+	{
+		float gl = lastGainL + (gainL - lastGainL) * (j/(float)numSamples);
+		outputs[0][j] = inputs[0][j] * gl;
+		float gr = lastGainR + (gainR - lastGainR) * (j/(float)numSamples);
+		outputs[1][j] = inputs[1][j] * gr;
+	}
+}
+
+// Target of applyGainRamp() against the legacy loop, mono and stereo:
+static const double targetSpeedup = 4.0;
+
+// Checks a speed-up against the target; a copy of the same buffers is the bound once they do
+// not fit in L1:
+static void checkSpeedup(const char *group, const char *variant, double speedup, double copySpeedup)
+{
+	char requirement[96];
+	std::snprintf(requirement, sizeof(requirement), "%.2fx, below the %gx target (copying the buffers: %.2fx)",
+	              speedup, targetSpeedup, copySpeedup);
+	benchCheck(speedup >= targetSpeedup, group, variant, requirement);
+}
+
+// Throughput of every available gain ramp kernel against the legacy loop, ramping and constant,
+// and of a plain copy, which bounds any kernel:
+DSPBENCH(gainRamp)
+{
+	const int blockSizes[] = { 64, 1024, 8192 };
+	for (int b = 0; b < 3; ++b)
+	{
+		const int n = blockSizes[b];
+		std::vector<float> in(n), out(n), reference(n);
+		for (int j = 0; j < n; ++j)
+		{
+			in[j] = std::sin(0.01f*j);
+		}
+
+		char group[32];
+		std::snprintf(group, sizeof(group), "gainRamp/%d", n);
+
+		double legacy = benchTime([&]() { legacyGainRamp(&in[0], &out[0], n, 0.2f, 0.9f); benchKeep(out[0]); });
+		benchReport(group, "legacy ex1 loop", legacy/n, "ns/sample");
+		legacyGainRamp(&in[0], &reference[0], n, 0.2f, 0.9f);
+		std::vector<double> inDouble(in.begin(), in.end()), outDouble(n);
+
+		for (int level = 0; level < kNumSimdLevels; ++level)
+		{
+			GainRampKernel kernel = gainRampKernel((SimdLevel)level);
+			if (kernel == NULL)
+			{
+				continue;
+			}
+			const float step = (0.9f - 0.2f)/n;
+			double ramp = benchTime([&]() { kernel(&in[0], &out[0], n, 0.2f, step); benchKeep(out[0]); });
+
+			float maxError = 0.0f;
+			for (int j = 0; j < n; ++j)
+			{
+				maxError = std::fmax(maxError, std::fabs(out[j] - reference[j]));
+			}
+			char variant[64];
+			std::snprintf(variant, sizeof(variant), "%s ramp (err %.1e)", simdLevelName((SimdLevel)level), maxError);
+			benchReport(group, variant, ramp/n, "ns/sample", legacy/ramp);
+
+			double constant = benchTime([&]() { kernel(&in[0], &out[0], n, 0.7f, 0.0f); benchKeep(out[0]); });
+			std::snprintf(variant, sizeof(variant), "%s constant", simdLevelName((SimdLevel)level));
+			benchReport(group, variant, constant/n, "ns/sample", legacy/constant);
+
+			// The processDoubleReplacing() version (twice the bytes per sample):
+			GainRampKernelDouble kernelDouble = gainRampKernelDouble((SimdLevel)level);
+			const double stepDouble = (0.9 - 0.2)/n;
+			double rampDouble = benchTime([&]() { kernelDouble(&inDouble[0], &outDouble[0], n, 0.2, stepDouble); benchKeep(outDouble[0]); });
+			double maxErrorDouble = 0.0;
+			for (int j = 0; j < n; ++j)
+			{
+				maxErrorDouble = std::fmax(maxErrorDouble, std::fabs(outDouble[j] - (double)reference[j]));
+			}
+			std::snprintf(variant, sizeof(variant), "%s double (err %.1e)", simdLevelName((SimdLevel)level), maxErrorDouble);
+			benchReport(group, variant, rampDouble/n, "ns/sample", legacy/rampDouble);
+		}
+
+		double dispatched = benchTime([&]() { applyGainRamp(&in[0], &out[0], n, 0.2f, 0.9f); benchKeep(out[0]); });
+		benchReport(group, "applyGainRamp", dispatched/n, "ns/sample", legacy/dispatched);
+		double copy = benchTime([&]() { std::memcpy(&out[0], &in[0], n*sizeof(float)); benchKeep(out[0]); });
+		benchReport(group, "memcpy", copy/n, "ns/sample", legacy/copy);
+		checkSpeedup(group, "applyGainRamp", legacy/dispatched, legacy/copy);
+
+		// Stereo, as processed by MyVstPlugIn-ex1:
+		std::vector<float> inR(in), outR(n);
+		float *inputs[2] = { &in[0], &inR[0] };
+		float *outputs[2] = { &out[0], &outR[0] };
+		double legacyStereo = benchTime([&]() { legacyStereoGain(inputs, outputs, n, 0.2f, 0.9f, 0.8f, 0.1f); benchKeep(out[0]); });
+		benchReport(group, "legacy ex1 stereo", legacyStereo/n, "ns/frame");
+		double stereo = benchTime([&]() {
+			applyGainRamp(inputs[0], outputs[0], n, 0.2f, 0.9f);
+			applyGainRamp(inputs[1], outputs[1], n, 0.8f, 0.1f);
+			benchKeep(out[0]);
+		});
+		benchReport(group, "applyGainRamp stereo", stereo/n, "ns/frame", legacyStereo/stereo);
+		double copyStereo = benchTime([&]() {
+			std::memcpy(outputs[0], inputs[0], n*sizeof(float));
+			std::memcpy(outputs[1], inputs[1], n*sizeof(float));
+			benchKeep(out[0]);
+		});
+		benchReport(group, "memcpy stereo", copyStereo/n, "ns/frame", legacyStereo/copyStereo);
+		checkSpeedup(group, "applyGainRamp stereo", legacyStereo/stereo, legacyStereo/copyStereo);
+	}
+}
@@ -0,0 +1,112 @@
+#include "DspBench.hxx"
+
+#include "DspCore/Wavetable.hxx"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// The oscillator loop of MyVstPlugIn-ex4 before the wavetables (constant parameters, no gain):
+static void legacyOscillator(float *out, int numSamples, float f, float b, float sampleRate, float &phase)
+{
+	const float pi = 3.14159265359f;
+	for (int j = 0; j < numSamples; ++j)
+	{
+		phase += (2.0f * pi * f / sampleRate);
+		if (phase > 2.0f*pi) phase -= 2.0f*pi;
+		float x = std::sin(phase) * std::pow((1-b),-2);
+		out[j] = x < -1 ? -1 : (x > 1 ? 1 : x);
+	}
+}
+
+// Energy off the harmonic bins, relative to the total, in dB. The fundamental must be bin k0
+// of the x.size() point DFT: harmonics then fall on multiples of k0, aliases elsewhere.
+static double aliasingDb(const std::vector<float> &x, int k0)
+{
+	const int n = (int)x.size();
+	std::vector<double> cosine(n), sine(n);
+	for (int i = 0; i < n; ++i)
+	{
+		cosine[i] = std::cos(2.0*3.14159265358979323846*i/n);
+		sine[i] = std::sin(2.0*3.14159265358979323846*i/n);
+	}
+	double harmonic = 0.0, alias = 0.0;
+	for (int k = 1; k < n/2; ++k)
+	{
+		double re = 0.0, im = 0.0;
+		for (int i = 0; i < n; ++i)
+		{
+			const int idx = (int)(((long)k*i) % n);
+			re += x[i]*cosine[idx];
+			im -= x[i]*sine[idx];
+		}
+		const double power = re*re + im*im;
+		if (k % k0 == 0)
+		{
+			harmonic += power;
+		}
+		else
+		{
+			alias += power;
+		}
+	}
+	return 10.0*std::log10(alias/(harmonic + alias) + 1e-30);
+}
+
+// ex4 timbre at 48 kHz: legacy sin/pow/clip loop against the band-limited wavetables.
+DSPBENCH(oscillator)
+{
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point start = Clock::now();
+	const ClippedSineWavetables &tables = clippedSineWavetables();
+	benchReport("oscillator/build", "ClippedSineWavetables", std::chrono::duration<double, std::milli>(Clock::now() - start).count(), "ms");
+
+	const float sampleRate = 48000.0f;
+	const int dftSize = 4096;
+	const int bins[] = { 9, 87, 347 }; // about 105 Hz, 1 kHz and 4 kHz
+	const float brightnesses[] = { 0.25f, 0.75f };
+	for (int bi = 0; bi < 2; ++bi)
+	{
+		for (int fi = 0; fi < 3; ++fi)
+		{
+			const float b = brightnesses[bi];
+			const float f = sampleRate*bins[fi]/dftSize;
+			std::vector<float> legacy(dftSize), wavetable(dftSize);
+
+			float phase = 0.0f;
+			legacyOscillator(&legacy[0], dftSize, f, b, sampleRate, phase);
+
+			int table;
+			float mix;
+			ClippedSineWavetables::position(b, table, mix);
+			WavetableOscillator oscillator;
+			oscillator.process(tables.table(table), tables.table(table + 1), &wavetable[0], dftSize,
+			                   f/sampleRate, f/sampleRate, mix, mix);
+
+			char group[64], variant[64];
+			std::snprintf(group, sizeof(group), "oscillator/aliasing b=%.2f", b);
+			std::snprintf(variant, sizeof(variant), "legacy %.0f Hz", f);
+			benchReport(group, variant, aliasingDb(legacy, bins[fi]), "dB");
+			std::snprintf(variant, sizeof(variant), "wavetable %.0f Hz", f);
+			benchReport(group, variant, aliasingDb(wavetable, bins[fi]), "dB");
+		}
+	}
+
+	const int n = 1024;
+	std::vector<float> out(n);
+	float phase = 0.0f;
+	double legacy = benchTime([&]() { legacyOscillator(&out[0], n, 440.0f, 0.5f, sampleRate, phase); benchKeep(out[0]); });
+	benchReport("oscillator/1024", "legacy sin/pow/clip", legacy/n, "ns/sample");
+
+	WavetableOscillator oscillator;
+	int table;
+	float mix;
+	ClippedSineWavetables::position(0.5f, table, mix);
+	double wavetable = benchTime([&]() {
+		oscillator.process(tables.table(table), tables.table(table + 1), &out[0], n,
+		                   440.0/sampleRate, 440.0/sampleRate, mix, mix);
+		benchKeep(out[0]);
+	});
+	benchReport("oscillator/1024", "WavetableOscillator", wavetable/n, "ns/sample", legacy/wavetable);
+}
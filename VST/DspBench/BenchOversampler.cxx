@@ -0,0 +1,134 @@
+#include "DspBench.hxx"
+
+#include "DspCore/Oversampler.hxx"
+#include "DspCore/RealFft.hxx"
+#include "DspCore/Wavetable.hxx"
+#include "DspCore/WavetableSynth.hxx"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// The ex4 clipper, MIN(MAX(x*drive, -1), 1):
+static void clip(float *x, int numSamples, float drive)
+{
+	for (int j = 0; j < numSamples; ++j)
+	{
+		const float y = x[j]*drive;
+		x[j] = y < -1.0f ? -1.0f : (y > 1.0f ? 1.0f : y);
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Delay and passband gain with an identity shaper, then the energy that a hard clipped sine
+// of bin 373 of 4096 (4.0 kHz at 44.1 kHz) puts outside its own odd harmonics, relative to
+// them: aliasing, plus the stopband leakage of the filters:
+DSPBENCH(oversamplerQuality)
+{
+	const int n = 4096, bin = 373;
+	RealFft fft;
+	fft.setSize(n);
+	std::vector<float> x(3*n), re(n/2 + 1), im(n/2 + 1);
+
+	const int factors[] = { 1, 2, 4, 8 };
+	for (int f = 0; f < 4; ++f)
+	{
+		char group[32];
+		std::snprintf(group, sizeof(group), "oversampler/%dx", factors[f]);
+		Oversampler oversampler;
+		oversampler.setup(factors[f]);
+
+		// Impulse: the peak is at the rounded latency.
+		std::fill(x.begin(), x.end(), 0.0f);
+		x[0] = 1.0f;
+		oversampler.process(&x[0], 256, [](float *, int) {});
+		int peak = 0;
+		for (int j = 1; j < 256; ++j)
+		{
+			peak = std::fabs(x[j]) > std::fabs(x[peak]) ? j : peak;
+		}
+		benchReport(group, "latency()", oversampler.latency(), "samples");
+		benchReport(group, "impulse response peak", peak, "samples");
+
+		// Gain of a sine at 0.4 fs, from its power:
+		oversampler.reset();
+		for (int j = 0; j < 3*n; ++j)
+		{
+			x[j] = std::sin(2.0f*3.14159265f*0.4f*j);
+		}
+		oversampler.process(&x[0], 3*n, [](float *, int) {});
+		double power = 0.0;
+		for (int j = 2*n; j < 3*n; ++j)
+		{
+			power += (double)x[j]*x[j];
+		}
+		benchReport(group, "gain at 0.4 fs", 10.0*std::log10(2.0*power/n), "dB");
+
+		// Clipped sine, periodic in n once the filters have settled:
+		oversampler.reset();
+		for (int j = 0; j < 3*n; ++j)
+		{
+			x[j] = 0.9f*std::sin(2.0*3.14159265358979*bin*(j % n)/n);
+		}
+		oversampler.process(&x[0], 3*n, [](float *y, int numSamples) { clip(y, numSamples, 10.0f); });
+		fft.forward(&x[2*n], &re[0], &im[0]);
+		double harmonics = 0.0, other = 0.0;
+		for (int k = 1; k <= n/2; ++k)
+		{
+			const double power = (double)re[k]*re[k] + (double)im[k]*im[k];
+			if (k % bin == 0 && (k/bin) % 2 == 1)
+			{
+				harmonics += power;
+			}
+			else
+			{
+				other += power;
+			}
+		}
+		benchReport(group, "clipped sine, alias / harmonics", 10.0*std::log10(other/harmonics), "dB");
+	}
+}
+
+// Cost per base rate sample of the oversampled clipper, against rendering the 16 voice synth
+// at the higher rate instead (what running all of ex4 oversampled would cost):
+DSPBENCH(oversampler)
+{
+	const int blockSize = 256;
+	std::vector<float> x(blockSize), y(blockSize);
+	for (int j = 0; j < blockSize; ++j)
+	{
+		x[j] = std::sin(0.1f*j);
+	}
+
+	const ClippedSineWavetables &tables = clippedSineWavetables();
+	WavetableSynth synth;
+	for (int v = 0; v < 16; ++v)
+	{
+		synth.noteOn(36 + 3*v, 100);
+	}
+
+	const int factors[] = { 1, 2, 4, 8 };
+	for (int f = 0; f < 4; ++f)
+	{
+		char group[32];
+		std::snprintf(group, sizeof(group), "oversampler/%dx", factors[f]);
+		Oversampler oversampler;
+		oversampler.setup(factors[f]);
+		double ns = benchTime([&]() {
+			std::copy(x.begin(), x.end(), y.begin());
+			oversampler.process(&y[0], blockSize, [](float *z, int numSamples) { clip(z, numSamples, 10.0f); });
+			benchKeep(y[0]);
+		});
+		benchReport(group, "oversampled clipper", ns/blockSize, "ns/sample");
+
+		synth.setSampleRate(44100.0f*factors[f], 5.0f, 60000.0f);
+		std::vector<float> out(blockSize*factors[f]);
+		double synthNs = benchTime([&]() {
+			std::fill(out.begin(), out.end(), 0.0f);
+			synth.render(tables.table(4), tables.table(5), &out[0], (int)out.size(), 0.3f, 0.3f);
+			benchKeep(out[0]);
+		});
+		benchReport(group, "16 voices rendered at this rate", synthNs/blockSize, "ns/sample");
+	}
+}
@@ -0,0 +1,73 @@
+#include "DspBench.hxx"
+
+#include "DspCore/PanLaw.hxx"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// The per-sample balance loop MyVstPlugIn-ex2 used before applySmoothedPan():
+static void legacyBalance(float **inputs, float **outputs, int numSamples, float lastGain, float gain, float lastBalance, float balance)
+{
+	for (int j = 0; j < numSamples; ++j)
+	{
+		float g = lastGain + (gain - lastGain) * (j/(float)numSamples);
+		float b = lastBalance + (balance - lastBalance) * (j/(float)numSamples);
+		outputs[0][j] = inputs[0][j] * g * std::sqrt(1-b);
+		outputs[1][j] = inputs[1][j] * g * std::sqrt(b);
+	}
+}
+
+// Table accuracy of every law, and stereo throughput against the legacy sqrt loop:
+DSPBENCH(panLaw)
+{
+	for (int law = 0; law < kNumPanLaws; ++law)
+	{
+		float maxError = 0.0f;
+		for (int i = 0; i <= 100000; ++i)
+		{
+			float l, r, exactL, exactR;
+			panGains((PanLaw)law, i*1e-5f, l, r);
+			panGainsExact((PanLaw)law, i*1e-5f, exactL, exactR);
+			maxError = std::fmax(maxError, std::fmax(std::fabs(l - exactL), std::fabs(r - exactR)));
+		}
+		benchReport("panLaw/accuracy", panLawName((PanLaw)law), maxError, "max error");
+	}
+
+	const int blockSizes[] = { 64, 1024 };
+	for (int b = 0; b < 2; ++b)
+	{
+		const int n = blockSizes[b];
+		std::vector<float> inL(n), inR(n), outL(n), outR(n);
+		for (int j = 0; j < n; ++j)
+		{
+			inL[j] = std::sin(0.01f*j);
+			inR[j] = std::cos(0.013f*j);
+		}
+		float *inputs[2] = { &inL[0], &inR[0] };
+		float *outputs[2] = { &outL[0], &outR[0] };
+
+		char group[32];
+		std::snprintf(group, sizeof(group), "panLaw/%d", n);
+
+		double legacy = benchTime([&]() { legacyBalance(inputs, outputs, n, 0.8f, 0.9f, 0.3f, 0.6f); benchKeep(outL[0]); });
+		benchReport(group, "legacy ex2 loop", legacy/n, "ns/frame");
+
+		// Balance ramping through the whole block, like the legacy loop:
+		LinearSmoother gain, balance;
+		gain.setRampTime(1000.0f, 1000.0f*n);
+		balance.setRampTime(1000.0f, 1000.0f*n);
+		double ramping = benchTime([&]() {
+			gain.reset(0.8f);
+			balance.reset(0.3f);
+			gain.setTarget(0.9f);
+			balance.setTarget(0.6f);
+			applySmoothedPan(kPanLaw3dB, gain, balance, inputs, outputs, n);
+			benchKeep(outL[0]);
+		});
+		benchReport(group, "applySmoothedPan ramping", ramping/n, "ns/frame", legacy/ramping);
+
+		double steady = benchTime([&]() { applySmoothedPan(kPanLaw3dB, gain, balance, inputs, outputs, n); benchKeep(outL[0]); });
+		benchReport(group, "applySmoothedPan steady", steady/n, "ns/frame", legacy/steady);
+	}
+}
@@ -0,0 +1,28 @@
+#include "DspBench.hxx"
+
+#include "DspCore/ParameterMapping.hxx"
+
+#include <vector>
+
+// Cost of the parameter mapping helpers, per call:
+DSPBENCH(parameterMapping)
+{
+	const int n = 1024;
+	std::vector<float> normalized(n), mapped(n);
+	for (int i = 0; i < n; ++i)
+	{
+		normalized[i] = (float)i/(n - 1);
+	}
+
+	double ns = benchTime([&]() { for (int i = 0; i < n; ++i) mapped[i] = norm2lin(normalized[i], 0.01f, 10.0f); benchKeep(mapped[0]); });
+	benchReport("parameterMapping", "norm2lin", ns/n, "ns/call");
+
+	ns = benchTime([&]() { for (int i = 0; i < n; ++i) mapped[i] = norm2exp(normalized[i], 20.0f, 10000.0f); benchKeep(mapped[0]); });
+	benchReport("parameterMapping", "norm2exp", ns/n, "ns/call");
+
+	ns = benchTime([&]() { for (int i = 0; i < n; ++i) mapped[i] = exp2norm(20.0f + normalized[i]*9980.0f, 20.0f, 10000.0f); benchKeep(mapped[0]); });
+	benchReport("parameterMapping", "exp2norm", ns/n, "ns/call");
+
+	ns = benchTime([&]() { for (int i = 0; i < n; ++i) mapped[i] = norm2gainFactor(normalized[i]); benchKeep(mapped[0]); });
+	benchReport("parameterMapping", "norm2gainFactor", ns/n, "ns/call");
+}
@@ -0,0 +1,76 @@
+#include "DspBench.hxx"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+struct BenchEntry
+{
+	const char *name;
+	BenchFunction function;
+};
+
+// Function-local static, so registration order between translation units does not matter:
+static std::vector<BenchEntry> &benchRegistry()
+{
+	static std::vector<BenchEntry> registry;
+	return registry;
+}
+
+static int benchFailures = 0;
+
+BenchRegistrar::BenchRegistrar(const char *name, BenchFunction function)
+{
+	BenchEntry entry = { name, function };
+	benchRegistry().push_back(entry);
+}
+
+void benchReport(const char *group, const char *variant, double value, const char *unit, double speedup)
+{
+	if (speedup > 0.0)
+	{
+		std::printf("%-24s %-28s %12.4g %-10s %6.2fx\n", group, variant, value, unit, speedup);
+	}
+	else
+	{
+		std::printf("%-24s %-28s %12.4g %-10s\n", group, variant, value, unit);
+	}
+	std::fflush(stdout);
+}
+
+void benchCheck(bool passed, const char *group, const char *variant, const char *requirement)
+{
+	if (!passed)
+	{
+		std::printf("FAILED %s %s: %s\n", group, variant, requirement);
+		std::fflush(stdout);
+		++benchFailures;
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// Main:
+// ---------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+	std::vector<BenchEntry> &registry = benchRegistry();
+	for (size_t i = 0; i < registry.size(); ++i)
+	{
+		bool selected = argc < 2;
+		for (int a = 1; a < argc && !selected; ++a)
+		{
+			selected = std::strstr(registry[i].name, argv[a]) != NULL;
+		}
+		if (selected)
+		{
+			registry[i].function();
+		}
+	}
+	if (benchFailures > 0)
+	{
+		std::printf("%d check%s failed\n", benchFailures, benchFailures == 1 ? "" : "s");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,62 @@
+#ifndef INCLUDED_DSPBENCH_HXX
+#define INCLUDED_DSPBENCH_HXX
+
+#include <chrono>
+
+// Tiny micro-benchmark harness for the DspCore kernels.
+//
+// Each DspBench/Bench*.cxx file registers its benchmarks with DSPBENCH(name) { ... } and
+// reports results through benchReport(). DspBench runs all of them, or only those whose
+// name contains one of the words given on the command line. Results with a bound to meet
+// also go through benchCheck(); DspBench exits with 1 if any of those fails.
+
+typedef void (*BenchFunction)();
+
+struct BenchRegistrar
+{
+	BenchRegistrar(const char *name, BenchFunction function);
+};
+
+#define DSPBENCH(name) \
+	static void name(); \
+	static BenchRegistrar name##Registrar(#name, name); \
+	static void name()
+
+// Keeps the optimizer from discarding a computed value:
+template <typename T>
+inline void benchKeep(const T &value)
+{
+	asm volatile("" : : "g"(&value) : "memory");
+}
+
+// Calls function() repeatedly for at least minSeconds and returns the mean time per call in ns.
+template <typename Function>
+double benchTime(Function function, double minSeconds = 0.2)
+{
+	typedef std::chrono::steady_clock Clock;
+	function(); // warm-up (caches, page faults, lazy tables)
+
+	long calls = 0;
+	long batch = 1;
+	Clock::time_point start = Clock::now();
+	double elapsed = 0.0;
+	while (elapsed < minSeconds)
+	{
+		for (long i = 0; i < batch; ++i)
+		{
+			function();
+		}
+		calls += batch;
+		batch *= 2;
+		elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+	}
+	return 1e9*elapsed/calls;
+}
+
+// Prints one result line: "<group> <variant> <value> <unit>" plus an optional speed-up ratio.
+void benchReport(const char *group, const char *variant, double value, const char *unit, double speedup = 0.0);
+
+// Prints "FAILED <group> <variant>: <requirement>" unless passed, and fails the run:
+void benchCheck(bool passed, const char *group, const char *variant, const char *requirement);
+
+#endif
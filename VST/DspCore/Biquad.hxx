@@ -0,0 +1,207 @@
+#ifndef INCLUDED_BIQUAD_HXX
+#define INCLUDED_BIQUAD_HXX
+
+#include <cmath>
+
+// ---------------------------------------------------------------------------------------
+// Second order IIR section.
+// ---------------------------------------------------------------------------------------
+
+// Coefficients normalised by a0, so the filter loop has no divisions:
+//   y[n] = b0*x[n] + b1*x[n-1] + b2*x[n-2] - a1*y[n-1] - a2*y[n-2]
+template <typename Coeff>
+struct BiquadCoeffs
+{
+	Coeff b0, b1, b2, a1, a2;
+
+	static BiquadCoeffs identity()
+	{
+		BiquadCoeffs c = { Coeff(1), Coeff(0), Coeff(0), Coeff(0), Coeff(0) };
+		return c;
+	}
+
+	static BiquadCoeffs normalized(double b0, double b1, double b2, double a0, double a1, double a2)
+	{
+		const double inv = 1.0/a0;
+		BiquadCoeffs c = { Coeff(b0*inv), Coeff(b1*inv), Coeff(b2*inv), Coeff(a1*inv), Coeff(a2*inv) };
+		return c;
+	}
+
+	// Low-pass from the RBJ Audio EQ Cookbook, computed in double:
+	static BiquadCoeffs lowPass(double freq, double q, double sampleRate)
+	{
+		const double w0 = 2.0*3.14159265358979323846*freq/sampleRate;
+		const double cosW0 = std::cos(w0);
+		const double alpha = std::sin(w0)/(2.0*q);
+		return normalized((1.0 - cosW0)/2.0, 1.0 - cosW0, (1.0 - cosW0)/2.0,
+		                  1.0 + alpha, -2.0*cosW0, 1.0 - alpha);
+	}
+
+	// Largest pole magnitude: the impulse response decays like radius^n (1 or more: unstable):
+	double poleRadius() const
+	{
+		const double d = (double)a1*a1 - 4.0*(double)a2;
+		if (d < 0.0)
+		{
+			return std::sqrt((double)a2); // complex pair, |p|^2 = a2
+		}
+		const double s = std::sqrt(d);
+		return std::fmax(std::fabs(-a1 + s), std::fabs(-a1 - s))/2.0;
+	}
+
+	// Samples for the impulse response envelope to fall to level (e.g. 1e-6 = -120 dB), the
+	// tail reported to hosts; -1 if it never does:
+	long decaySamples(double level) const
+	{
+		const double radius = poleRadius();
+		if (radius >= 1.0)
+		{
+			return -1;
+		}
+		return radius <= 0.0 ? 2 : 2 + (long)std::ceil(std::log(level)/std::log(radius));
+	}
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Biquad in transposed direct form II: two state variables, no shifting of history arrays.
+// Sample is the I/O type, Coeff the type of coefficients and state (e.g. float I/O with a
+// double recursion for low cutoffs). The block process() also takes the other floating
+// point type, converted on the way.
+template <typename Sample, typename Coeff = Sample>
+class Biquad
+{
+public:
+	Biquad() : c_(BiquadCoeffs<Coeff>::identity()), target_(c_), step_(c_), rampRemaining_(0), z1_(0), z2_(0) {}
+
+	// Sets the coefficients at once (and cancels a ramp in progress):
+	void setCoefficients(const BiquadCoeffs<Coeff> &coeffs)
+	{
+		c_ = target_ = coeffs;
+		rampRemaining_ = 0;
+	}
+	const BiquadCoeffs<Coeff> &coefficients() const { return c_; }
+
+	void setLowPass(double freq, double q, double sampleRate)
+	{
+		setCoefficients(BiquadCoeffs<Coeff>::lowPass(freq, q, sampleRate));
+	}
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Coefficient ramps, as in BiquadBank: setTarget() stores the next coefficients (of any
+	// precision), rampToTarget(n) moves linearly to them over the next n processed samples.
+
+	template <typename Other>
+	void setTarget(const BiquadCoeffs<Other> &coeffs)
+	{
+		target_.b0 = (Coeff)coeffs.b0;
+		target_.b1 = (Coeff)coeffs.b1;
+		target_.b2 = (Coeff)coeffs.b2;
+		target_.a1 = (Coeff)coeffs.a1;
+		target_.a2 = (Coeff)coeffs.a2;
+	}
+
+	void rampToTarget(int numSamples)
+	{
+		if (numSamples <= 0)
+		{
+			c_ = target_;
+			rampRemaining_ = 0;
+			return;
+		}
+		const Coeff scale = Coeff(1)/(Coeff)numSamples;
+		step_.b0 = (target_.b0 - c_.b0)*scale;
+		step_.b1 = (target_.b1 - c_.b1)*scale;
+		step_.b2 = (target_.b2 - c_.b2)*scale;
+		step_.a1 = (target_.a1 - c_.a1)*scale;
+		step_.a2 = (target_.a2 - c_.a2)*scale;
+		rampRemaining_ = numSamples;
+	}
+
+	bool isRamping() const { return rampRemaining_ > 0; }
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+	void reset()
+	{
+		z1_ = z2_ = Coeff(0);
+	}
+
+	// True when both state variables are within threshold of zero (see BiquadBank::isQuiet()):
+	bool isQuiet(Coeff threshold) const
+	{
+		return std::fabs(z1_) <= threshold && std::fabs(z2_) <= threshold;
+	}
+
+	// One sample, with the current coefficients (no ramp):
+	Sample process(Sample input)
+	{
+		const Coeff x = (Coeff)input;
+		const Coeff y = c_.b0*x + z1_;
+		z1_ = c_.b1*x - c_.a1*y + z2_;
+		z2_ = c_.b2*x - c_.a2*y;
+		return (Sample)y;
+	}
+
+	// in and out may be the same buffer.
+	template <typename Audio>
+	void process(const Audio *in, Audio *out, int numSamples)
+	{
+		int j = 0;
+		if (rampRemaining_ > 0)
+		{
+			j = rampRemaining_ < numSamples ? rampRemaining_ : numSamples;
+			processRamp(in, out, j);
+		}
+
+		// Local copies, so the recursion stays in registers:
+		const Coeff b0 = c_.b0, b1 = c_.b1, b2 = c_.b2, a1 = c_.a1, a2 = c_.a2;
+		Coeff z1 = z1_, z2 = z2_;
+		for (; j < numSamples; ++j)
+		{
+			const Coeff x = (Coeff)in[j];
+			const Coeff y = b0*x + z1;
+			z1 = (b1*x + z2) - a1*y; // y enters last: one multiply-subtract on the recursive path
+			z2 = b2*x - a2*y;
+			out[j] = (Audio)y;
+		}
+		z1_ = z1;
+		z2_ = z2;
+	}
+
+private:
+	// First len <= rampRemaining_ samples, stepping the coefficients after every sample:
+	template <typename Audio>
+	void processRamp(const Audio *in, Audio *out, int len)
+	{
+		BiquadCoeffs<Coeff> c = c_;
+		const BiquadCoeffs<Coeff> step = step_;
+		Coeff z1 = z1_, z2 = z2_;
+		for (int j = 0; j < len; ++j)
+		{
+			const Coeff x = (Coeff)in[j];
+			const Coeff y = c.b0*x + z1;
+			z1 = (c.b1*x + z2) - c.a1*y;
+			z2 = c.b2*x - c.a2*y;
+			out[j] = (Audio)y;
+			c.b0 += step.b0;
+			c.b1 += step.b1;
+			c.b2 += step.b2;
+			c.a1 += step.a1;
+			c.a2 += step.a2;
+		}
+		z1_ = z1;
+		z2_ = z2;
+
+		rampRemaining_ -= len;
+		c_ = rampRemaining_ == 0 ? target_ : c; // exactly on target, without accumulated rounding
+	}
+
+	BiquadCoeffs<Coeff> c_;      // current coefficients
+	BiquadCoeffs<Coeff> target_; // end of the ramp
+	BiquadCoeffs<Coeff> step_;   // per sample increment while ramping
+	int rampRemaining_;
+	Coeff z1_, z2_;
+};
+
+#endif
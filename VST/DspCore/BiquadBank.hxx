@@ -0,0 +1,415 @@
+#ifndef INCLUDED_BIQUADBANK_HXX
+#define INCLUDED_BIQUADBANK_HXX
+
+#include "Biquad.hxx"
+
+#if defined(__SSE2__)
+#include <xmmintrin.h>
+#endif
+
+namespace detail
+{
+	// chunk[j][l] = in[l][start + j] for l < numChannels, j < len:
+	template <typename T, int Lanes, typename Sample>
+	inline void interleaveChunk(const Sample *const *in, int start, int numChannels, int len, T (*chunk)[Lanes])
+	{
+		for (int l = 0; l < numChannels; ++l)
+		{
+			const Sample *x = in[l] + start;
+			for (int j = 0; j < len; ++j)
+			{
+				chunk[j][l] = (T)x[j];
+			}
+		}
+	}
+
+	// out[l][start + j] = chunk[j][l] for l < numChannels, j < len:
+	template <typename T, int Lanes, typename Sample>
+	inline void deinterleaveChunk(T (*chunk)[Lanes], int start, int numChannels, int len, Sample *const *out)
+	{
+		for (int l = 0; l < numChannels; ++l)
+		{
+			Sample *y = out[l] + start;
+			for (int j = 0; j < len; ++j)
+			{
+				y[j] = (Sample)chunk[j][l];
+			}
+		}
+	}
+
+#if defined(__SSE2__)
+	// Float lanes and float audio: 4x4 register transposes instead of strided scalar copies.
+	template <int Lanes>
+	inline void interleaveChunk(const float *const *in, int start, int numChannels, int len, float (*chunk)[Lanes])
+	{
+		const int quadChannels = numChannels & ~3;
+		const int quadSamples = len & ~3;
+		for (int l = 0; l < quadChannels; l += 4)
+		{
+			const float *x0 = in[l] + start, *x1 = in[l + 1] + start, *x2 = in[l + 2] + start, *x3 = in[l + 3] + start;
+			for (int j = 0; j < quadSamples; j += 4)
+			{
+				__m128 r0 = _mm_loadu_ps(x0 + j), r1 = _mm_loadu_ps(x1 + j), r2 = _mm_loadu_ps(x2 + j), r3 = _mm_loadu_ps(x3 + j);
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+				_mm_storeu_ps(&chunk[j][l], r0);
+				_mm_storeu_ps(&chunk[j + 1][l], r1);
+				_mm_storeu_ps(&chunk[j + 2][l], r2);
+				_mm_storeu_ps(&chunk[j + 3][l], r3);
+			}
+			for (int j = quadSamples; j < len; ++j)
+			{
+				chunk[j][l] = x0[j];
+				chunk[j][l + 1] = x1[j];
+				chunk[j][l + 2] = x2[j];
+				chunk[j][l + 3] = x3[j];
+			}
+		}
+		interleaveChunk<float, Lanes>(in + quadChannels, start, numChannels - quadChannels, len, (float (*)[Lanes])&chunk[0][quadChannels]);
+	}
+
+	template <int Lanes>
+	inline void deinterleaveChunk(float (*chunk)[Lanes], int start, int numChannels, int len, float *const *out)
+	{
+		const int quadChannels = numChannels & ~3;
+		const int quadSamples = len & ~3;
+		for (int l = 0; l < quadChannels; l += 4)
+		{
+			float *y0 = out[l] + start, *y1 = out[l + 1] + start, *y2 = out[l + 2] + start, *y3 = out[l + 3] + start;
+			for (int j = 0; j < quadSamples; j += 4)
+			{
+				__m128 r0 = _mm_loadu_ps(&chunk[j][l]), r1 = _mm_loadu_ps(&chunk[j + 1][l]);
+				__m128 r2 = _mm_loadu_ps(&chunk[j + 2][l]), r3 = _mm_loadu_ps(&chunk[j + 3][l]);
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+				_mm_storeu_ps(y0 + j, r0);
+				_mm_storeu_ps(y1 + j, r1);
+				_mm_storeu_ps(y2 + j, r2);
+				_mm_storeu_ps(y3 + j, r3);
+			}
+			for (int j = quadSamples; j < len; ++j)
+			{
+				y0[j] = chunk[j][l];
+				y1[j] = chunk[j][l + 1];
+				y2[j] = chunk[j][l + 2];
+				y3[j] = chunk[j][l + 3];
+			}
+		}
+		deinterleaveChunk<float, Lanes>((float (*)[Lanes])&chunk[0][quadChannels], start, numChannels - quadChannels, len, out + quadChannels);
+	}
+
+	// Float lanes and double audio: 4 channels at a time are converted into a small buffer,
+	// contiguously (so the conversion vectorizes), and transposed from there as floats.
+	enum { kConvertSamples = 64 };
+
+	template <int Lanes>
+	inline void interleaveChunk(const double *const *in, int start, int numChannels, int len, float (*chunk)[Lanes])
+	{
+		float converted[4][kConvertSamples];
+		const float *rows[4] = { converted[0], converted[1], converted[2], converted[3] };
+		const int quadChannels = numChannels & ~3;
+		for (int l = 0; l < quadChannels; l += 4)
+		{
+			for (int begin = 0; begin < len; begin += kConvertSamples)
+			{
+				const int count = len - begin < kConvertSamples ? len - begin : kConvertSamples;
+				for (int k = 0; k < 4; ++k)
+				{
+					const double *x = in[l + k] + start + begin;
+					for (int j = 0; j < count; ++j)
+					{
+						converted[k][j] = (float)x[j];
+					}
+				}
+				interleaveChunk<Lanes>(rows, 0, 4, count, (float (*)[Lanes])&chunk[begin][l]);
+			}
+		}
+		interleaveChunk<float, Lanes>(in + quadChannels, start, numChannels - quadChannels, len, (float (*)[Lanes])&chunk[0][quadChannels]);
+	}
+
+	template <int Lanes>
+	inline void deinterleaveChunk(float (*chunk)[Lanes], int start, int numChannels, int len, double *const *out)
+	{
+		float converted[4][kConvertSamples];
+		float *rows[4] = { converted[0], converted[1], converted[2], converted[3] };
+		const int quadChannels = numChannels & ~3;
+		for (int l = 0; l < quadChannels; l += 4)
+		{
+			for (int begin = 0; begin < len; begin += kConvertSamples)
+			{
+				const int count = len - begin < kConvertSamples ? len - begin : kConvertSamples;
+				deinterleaveChunk<Lanes>((float (*)[Lanes])&chunk[begin][l], 0, 4, count, rows);
+				for (int k = 0; k < 4; ++k)
+				{
+					double *y = out[l + k] + start + begin;
+					for (int j = 0; j < count; ++j)
+					{
+						y[j] = converted[k][j];
+					}
+				}
+			}
+		}
+		deinterleaveChunk<float, Lanes>((float (*)[Lanes])&chunk[0][quadChannels], start, numChannels - quadChannels, len, out + quadChannels);
+	}
+#endif
+}
+
+// ---------------------------------------------------------------------------------------
+// Bank of Lanes independent biquads in structure-of-arrays layout.
+// ---------------------------------------------------------------------------------------
+
+// Coefficients and TDF-II state are stored lane by lane (the b0 of all lanes, then all b1,
+// ...), so every step of the recursion is one operation on Lanes channels at once and the
+// inner loop over lanes vectorizes: 4 float lanes fill an SSE register, 8 an AVX one, 16 an AVX-512 one.
+// Wider banks on narrower hardware still help, since their registers form independent
+// recursion chains that hide the multiply-add latency.
+//
+// Each lane has its own coefficients. Audio is non-interleaved (one pointer per channel, as
+// in processReplacing()); it is transposed into a small interleaved chunk buffer and back.
+// The audio may be float or double whatever T is; it is converted on the way.
+template <typename T, int Lanes>
+class BiquadBank
+{
+public:
+	enum { kLanes = Lanes, kChunkSize = 64 };
+
+	BiquadBank() : rampRemaining_(0)
+	{
+		setCoefficients(BiquadCoeffs<T>::identity());
+		reset();
+	}
+
+	// Sets lane's coefficients at once (and cancels a ramp in progress):
+	void setCoefficients(int lane, const BiquadCoeffs<T> &coeffs)
+	{
+		setTarget(lane, coeffs);
+		for (int k = 0; k < kNumCoeffs; ++k)
+		{
+			c_[k][lane] = target_[k][lane];
+		}
+		rampRemaining_ = 0;
+	}
+
+	// Same coefficients for all lanes:
+	void setCoefficients(const BiquadCoeffs<T> &coeffs)
+	{
+		for (int l = 0; l < Lanes; ++l)
+		{
+			setCoefficients(l, coeffs);
+		}
+	}
+
+	void setLowPass(int lane, double freq, double q, double sampleRate)
+	{
+		setCoefficients(lane, BiquadCoeffs<T>::lowPass(freq, q, sampleRate));
+	}
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Coefficient ramps:
+	//
+	// setTarget() stores the next coefficients of a lane; rampToTarget(n) then moves all lanes
+	// linearly from their current coefficients to the targets over the next n processed
+	// samples. Every intermediate set is a convex combination of the two end points, and the
+	// biquad stability region (|a2| < 1, |a1| < 1 + a2) is convex, so it stays stable.
+	// Ramping costs five more adds per lane and sample: with a new target every 32 samples,
+	// a 16 lane float bank runs at about 0.6x its speed with fixed coefficients (DspBench
+	// lowpasstable, 0.5 to 0.7x from run to run).
+
+	void setTarget(int lane, const BiquadCoeffs<T> &coeffs)
+	{
+		target_[kB0][lane] = coeffs.b0;
+		target_[kB1][lane] = coeffs.b1;
+		target_[kB2][lane] = coeffs.b2;
+		target_[kA1][lane] = coeffs.a1;
+		target_[kA2][lane] = coeffs.a2;
+	}
+
+	void setTarget(const BiquadCoeffs<T> &coeffs)
+	{
+		for (int l = 0; l < Lanes; ++l)
+		{
+			setTarget(l, coeffs);
+		}
+	}
+
+	void rampToTarget(int numSamples)
+	{
+		if (numSamples <= 0)
+		{
+			finishRamp();
+			return;
+		}
+		const T scale = T(1)/(T)numSamples;
+		for (int k = 0; k < kNumCoeffs; ++k)
+		{
+			for (int l = 0; l < Lanes; ++l)
+			{
+				step_[k][l] = (target_[k][l] - c_[k][l])*scale;
+			}
+		}
+		rampRemaining_ = numSamples;
+	}
+
+	bool isRamping() const { return rampRemaining_ > 0; }
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+	void reset()
+	{
+		for (int l = 0; l < Lanes; ++l)
+		{
+			z1_[l] = z2_[l] = T(0);
+		}
+	}
+
+	// True when the state of every lane is within threshold of zero: fed silence, the output
+	// is then below about threshold and only decays further (see Silence.hxx):
+	bool isQuiet(T threshold) const
+	{
+		bool quiet = true;
+		for (int l = 0; l < Lanes; ++l)
+		{
+			const T z1 = z1_[l] < T(0) ? -z1_[l] : z1_[l];
+			const T z2 = z2_[l] < T(0) ? -z2_[l] : z2_[l];
+			quiet = quiet && z1 <= threshold && z2 <= threshold;
+		}
+		return quiet;
+	}
+
+	// Filters channels 0..numChannels-1 (numChannels <= Lanes) of in into out; the remaining
+	// lanes are fed silence. in and out may be the same buffers. Sample is float or double.
+	template <typename Sample>
+	void process(const Sample *const *in, Sample *const *out, int numChannels, int numSamples)
+	{
+		for (int l = numChannels; l < Lanes; ++l)
+		{
+			for (int j = 0; j < kChunkSize; ++j)
+			{
+				chunk_[j][l] = T(0);
+			}
+		}
+
+		for (int start = 0; start < numSamples; start += kChunkSize)
+		{
+			const int len = numSamples - start < kChunkSize ? numSamples - start : kChunkSize;
+
+			detail::interleaveChunk(in, start, numChannels, len, chunk_);
+			int done = 0;
+			if (rampRemaining_ > 0)
+			{
+				done = rampRemaining_ < len ? rampRemaining_ : len;
+				filterChunkRamp(done);
+			}
+			filterChunk(done, len);
+			detail::deinterleaveChunk(chunk_, start, numChannels, len, out);
+		}
+	}
+
+private:
+	enum { kB0, kB1, kB2, kA1, kA2, kNumCoeffs };
+
+	void finishRamp()
+	{
+		for (int k = 0; k < kNumCoeffs; ++k)
+		{
+			for (int l = 0; l < Lanes; ++l)
+			{
+				c_[k][l] = target_[k][l];
+			}
+		}
+		rampRemaining_ = 0;
+	}
+
+	// In place on chunk_[begin..end-1].
+	//
+	// Local copies: the compiler then knows they do not alias chunk_ and keeps them in
+	// registers across the whole chunk.
+	void filterChunk(int begin, int end)
+	{
+		T b0[Lanes], b1[Lanes], b2[Lanes], a1[Lanes], a2[Lanes], z1[Lanes], z2[Lanes];
+		for (int l = 0; l < Lanes; ++l)
+		{
+			b0[l] = c_[kB0][l];
+			b1[l] = c_[kB1][l];
+			b2[l] = c_[kB2][l];
+			a1[l] = c_[kA1][l];
+			a2[l] = c_[kA2][l];
+			z1[l] = z1_[l];
+			z2[l] = z2_[l];
+		}
+		for (int j = begin; j < end; ++j)
+		{
+			T *v = chunk_[j];
+			for (int l = 0; l < Lanes; ++l)
+			{
+				const T x = v[l];
+				const T y = b0[l]*x + z1[l];
+				z1[l] = (b1[l]*x + z2[l]) - a1[l]*y;
+				z2[l] = b2[l]*x - a2[l]*y;
+				v[l] = y;
+			}
+		}
+		for (int l = 0; l < Lanes; ++l)
+		{
+			z1_[l] = z1[l];
+			z2_[l] = z2[l];
+		}
+	}
+
+	// In place on chunk_[0..len-1], len <= rampRemaining_, stepping the coefficients by step_
+	// after every sample:
+	void filterChunkRamp(int len)
+	{
+		T c[kNumCoeffs][Lanes], step[kNumCoeffs][Lanes], z1[Lanes], z2[Lanes];
+		for (int l = 0; l < Lanes; ++l)
+		{
+			for (int k = 0; k < kNumCoeffs; ++k)
+			{
+				c[k][l] = c_[k][l];
+				step[k][l] = step_[k][l];
+			}
+			z1[l] = z1_[l];
+			z2[l] = z2_[l];
+		}
+		for (int j = 0; j < len; ++j)
+		{
+			T *v = chunk_[j];
+			for (int l = 0; l < Lanes; ++l)
+			{
+				const T x = v[l];
+				const T y = c[kB0][l]*x + z1[l];
+				z1[l] = (c[kB1][l]*x + z2[l]) - c[kA1][l]*y;
+				z2[l] = c[kB2][l]*x - c[kA2][l]*y;
+				v[l] = y;
+				for (int k = 0; k < kNumCoeffs; ++k)
+				{
+					c[k][l] += step[k][l];
+				}
+			}
+		}
+		for (int l = 0; l < Lanes; ++l)
+		{
+			for (int k = 0; k < kNumCoeffs; ++k)
+			{
+				c_[k][l] = c[k][l];
+			}
+			z1_[l] = z1[l];
+			z2_[l] = z2[l];
+		}
+
+		rampRemaining_ -= len;
+		if (rampRemaining_ == 0)
+		{
+			finishRamp(); // exactly on target, without accumulated rounding
+		}
+	}
+
+	// 16 byte alignment is all operator new guarantees before C++17:
+	alignas(16) T c_[kNumCoeffs][Lanes];      // current coefficients
+	alignas(16) T target_[kNumCoeffs][Lanes]; // end of the ramp
+	alignas(16) T step_[kNumCoeffs][Lanes];   // per sample increment while ramping
+	alignas(16) T z1_[Lanes];
+	alignas(16) T z2_[Lanes];
+	alignas(16) T chunk_[kChunkSize][Lanes];
+	int rampRemaining_;
+};
+
+#endif
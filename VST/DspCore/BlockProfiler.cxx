@@ -0,0 +1,328 @@
+#include "BlockProfiler.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Environment variable naming the directory of the snapshots:
+static const char *const kProfileVariable = "DSPCORE_PROFILE";
+
+// Period of the drain thread:
+static const int kDrainMilliseconds = 50;
+
+// ---------------------------------------------------------------------------------------
+// Histogram bins:
+// ---------------------------------------------------------------------------------------
+
+int profileHistogramBin(double load)
+{
+	if (!(load > 0.0))
+	{
+		return 0;
+	}
+	const int bin = (int)std::floor(4.0*std::log2(load)) + kProfileDeadlineBin;
+	return std::min(std::max(bin, 0), kProfileHistogramBins - 1);
+}
+
+double profileHistogramLoad(int bin)
+{
+	return bin <= 0 ? 0.0 : std::exp2((bin - kProfileDeadlineBin)*0.25);
+}
+
+// ---------------------------------------------------------------------------------------
+// Drain thread:
+// ---------------------------------------------------------------------------------------
+
+// One per module (the plug-ins each link their own dspcore), alive while at least one of its
+// profilers is registered. Holds the mutex while it drains, so remove() returning means the
+// profiler is no longer touched. The audio threads never take the mutex.
+//
+// Hosts often exit, or unload the module, without deleting every instance: the destructor of
+// the static then stops the thread itself (a joinable std::thread would call terminate()),
+// and the profilers left behind no longer look for it.
+class ProfileDrain
+{
+public:
+	static ProfileDrain &instance()
+	{
+		static ProfileDrain drain;
+		return drain;
+	}
+
+	// False once the static has been destroyed (a plain bool, valid until the module unloads):
+	static bool alive() { return alive_; }
+
+	~ProfileDrain();
+
+	void add(BlockProfiler *profiler);
+	void remove(BlockProfiler *profiler);
+
+private:
+	ProfileDrain() : snapshot_(NULL), quit_(false), startTicks_(0) {}
+	ProfileDrain(const ProfileDrain &);
+	ProfileDrain &operator=(const ProfileDrain &);
+
+	bool start(const char *name); // mutex held
+	void stop(std::unique_lock<std::mutex> &lock); // mutex held, released while joining
+	void run();
+	void drain(); // mutex held
+
+	static bool alive_;
+
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::vector<BlockProfiler *> profilers_;
+	std::thread thread_;
+	ProfileSnapshot *snapshot_; // NULL when not draining
+	bool quit_;
+
+	// Timestamp counter rate, measured against steady_clock since start():
+	uint64_t startTicks_;
+	std::chrono::steady_clock::time_point startTime_;
+};
+
+bool ProfileDrain::alive_ = true;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+ProfileDrain::~ProfileDrain()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	if (thread_.joinable())
+	{
+		drain(); // the last blocks of the instances left behind
+		stop(lock);
+	}
+	alive_ = false;
+}
+
+void ProfileDrain::add(BlockProfiler *profiler)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (profilers_.empty() && !start(profiler->name_))
+	{
+		profilers_.push_back(profiler); // counters only
+		return;
+	}
+	profilers_.push_back(profiler);
+	if (snapshot_ == NULL)
+	{
+		return;
+	}
+
+	// A new slot while there is one, so the stats of deleted instances stay readable:
+	int slot = snapshot_->numInstances;
+	if (slot == kProfileMaxInstances)
+	{
+		for (slot = 0; slot < kProfileMaxInstances && snapshot_->instances[slot].active; ++slot)
+		{
+		}
+		if (slot == kProfileMaxInstances)
+		{
+			return; // not exported
+		}
+	}
+
+	snapshot_->sequence.fetch_add(1, std::memory_order_acq_rel);
+	ProfileInstanceStats &stats = snapshot_->instances[slot];
+	std::memset(&stats, 0, sizeof(stats));
+	std::snprintf(stats.name, sizeof(stats.name), "%.19s#%d", profiler->name_, slot + 1);
+	stats.active = 1;
+	stats.sampleRate = profiler->sampleRate_.load(std::memory_order_relaxed);
+	snapshot_->numInstances = std::max(snapshot_->numInstances, slot + 1);
+	snapshot_->sequence.fetch_add(1, std::memory_order_release);
+
+	profiler->slot_ = slot;
+	profiler->draining_.store(true, std::memory_order_relaxed);
+}
+
+void ProfileDrain::remove(BlockProfiler *profiler)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	if (snapshot_ != NULL && profiler->slot_ >= 0)
+	{
+		drain(); // its last blocks
+		snapshot_->sequence.fetch_add(1, std::memory_order_acq_rel);
+		snapshot_->instances[profiler->slot_].active = 0;
+		snapshot_->sequence.fetch_add(1, std::memory_order_release);
+	}
+	profilers_.erase(std::remove(profilers_.begin(), profilers_.end(), profiler), profilers_.end());
+
+	// Last one out stops the thread:
+	if (profilers_.empty() && thread_.joinable())
+	{
+		stop(lock);
+	}
+}
+
+// Joins the thread and unmaps the snapshot, which stays behind for ProfileReport:
+void ProfileDrain::stop(std::unique_lock<std::mutex> &lock)
+{
+	std::thread thread;
+	thread.swap(thread_);
+	quit_ = true;
+	lock.unlock();
+	wake_.notify_all();
+	thread.join();
+	lock.lock();
+	munmap(snapshot_, sizeof(ProfileSnapshot));
+	snapshot_ = NULL;
+	quit_ = false;
+}
+
+// Maps <DSPCORE_PROFILE>/<name>-<pid>.prof and starts the thread; false if not profiling. A
+// host that unloads and reloads the module keeps adding to the snapshot of its process:
+bool ProfileDrain::start(const char *name)
+{
+	const char *directory = std::getenv(kProfileVariable);
+	if (directory == NULL || directory[0] == '\0')
+	{
+		return false;
+	}
+
+	char path[4096];
+	std::snprintf(path, sizeof(path), "%s/%s-%d.prof", directory, name, (int)getpid());
+	const int file = open(path, O_RDWR | O_CREAT, 0644);
+	if (file < 0)
+	{
+		std::fprintf(stderr, "%s: cannot create %s\n", kProfileVariable, path);
+		return false;
+	}
+	void *memory = MAP_FAILED;
+	if (ftruncate(file, sizeof(ProfileSnapshot)) == 0)
+	{
+		memory = mmap(NULL, sizeof(ProfileSnapshot), PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+	}
+	close(file);
+	if (memory == MAP_FAILED)
+	{
+		std::fprintf(stderr, "%s: cannot map %s\n", kProfileVariable, path);
+		return false;
+	}
+
+	// Fresh pages read as zero, a valid (even) sequence:
+	snapshot_ = (ProfileSnapshot *)memory;
+	if (snapshot_->magic != kProfileMagic || snapshot_->version != kProfileVersion || snapshot_->pid != (int32_t)getpid())
+	{
+		std::memset((void *)snapshot_, 0, sizeof(ProfileSnapshot));
+		snapshot_->version = kProfileVersion;
+		snapshot_->pid = (int32_t)getpid();
+		snapshot_->ticksPerSecond = 1e9;
+		snapshot_->magic = kProfileMagic;
+	}
+
+	startTicks_ = profilerTicks();
+	startTime_ = std::chrono::steady_clock::now();
+	thread_ = std::thread(&ProfileDrain::run, this);
+	return true;
+}
+
+void ProfileDrain::run()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (!quit_)
+	{
+		wake_.wait_for(lock, std::chrono::milliseconds(kDrainMilliseconds));
+		drain();
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void ProfileDrain::drain()
+{
+	// The rate estimate gets better with time; the first pass is 50 ms in (1e-5 or better):
+	const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime_).count();
+#if defined(__x86_64__) || defined(__i386__)
+	const double ticksPerSecond = elapsed > 0.0 ? (double)(profilerTicks() - startTicks_)/elapsed : 1e9;
+#else
+	const double ticksPerSecond = 1e9; // steady_clock nanoseconds
+#endif
+	const double secondsPerTick = 1.0/ticksPerSecond;
+
+	snapshot_->sequence.fetch_add(1, std::memory_order_acq_rel);
+	snapshot_->ticksPerSecond = ticksPerSecond;
+	snapshot_->updated = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+	for (size_t i = 0; i < profilers_.size(); ++i)
+	{
+		BlockProfiler &profiler = *profilers_[i];
+		if (profiler.slot_ < 0)
+		{
+			continue;
+		}
+		ProfileInstanceStats &stats = snapshot_->instances[profiler.slot_];
+		const float sampleRate = profiler.sampleRate_.load(std::memory_order_relaxed);
+		stats.sampleRate = sampleRate;
+
+		BlockRecord block;
+		while (profiler.ring_.pop(block))
+		{
+			if (block.numSamples <= 0)
+			{
+				continue;
+			}
+			const double seconds = block.ticks*secondsPerTick;
+			const double deadline = block.numSamples/(double)sampleRate;
+			const double load = seconds/deadline;
+			++stats.histogram[profileHistogramBin(load)];
+			stats.processSeconds += seconds;
+			stats.audioSeconds += deadline;
+			stats.maxLoad = std::max(stats.maxLoad, load);
+			stats.maxSeconds = std::max(stats.maxSeconds, seconds);
+			if (load > 1.0)
+			{
+				++stats.misses;
+			}
+		}
+
+		stats.blocks = profiler.blocks();
+		stats.samples = profiler.samples();
+		stats.rampBlocks = profiler.rampBlocks();
+		stats.skippedBlocks = profiler.skippedBlocks();
+		stats.dropped = profiler.dropped();
+	}
+
+	snapshot_->sequence.fetch_add(1, std::memory_order_release);
+}
+
+// ---------------------------------------------------------------------------------------
+// BlockProfiler:
+// ---------------------------------------------------------------------------------------
+
+BlockProfiler::BlockProfiler()
+	: flags_(0), blocks_(0), samples_(0), rampBlocks_(0), skippedBlocks_(0), dropped_(0),
+	  draining_(false), sampleRate_(44100.0f), registered_(false), slot_(-1)
+{
+	name_[0] = '\0';
+}
+
+BlockProfiler::~BlockProfiler()
+{
+	if (registered_ && ProfileDrain::alive())
+	{
+		ProfileDrain::instance().remove(this);
+	}
+}
+
+void BlockProfiler::setup(const char *name, float sampleRate)
+{
+	sampleRate_.store(sampleRate > 0.0f ? sampleRate : 44100.0f, std::memory_order_relaxed);
+	if (!registered_)
+	{
+		std::snprintf(name_, sizeof(name_), "%s", name);
+		registered_ = true;
+		ProfileDrain::instance().add(this);
+	}
+}
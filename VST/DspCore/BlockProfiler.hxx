@@ -0,0 +1,212 @@
+#ifndef INCLUDED_BLOCKPROFILER_HXX
+#define INCLUDED_BLOCKPROFILER_HXX
+
+#include "SpscRing.hxx"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// ---------------------------------------------------------------------------------------
+// Always-on cost measurement of every process call, per plug-in instance.
+// ---------------------------------------------------------------------------------------
+
+// Benchmarks give the average cost of a plug-in; a dropout is one block that missed its
+// deadline (numSamples/sampleRate) on a loaded machine. Each instance owns a BlockProfiler
+// and opens a BlockProfiler::Scope at the top of processReplacing()/processDoubleReplacing():
+// the scope bumps the instance's counters (blocks, samples, blocks with a parameter ramp,
+// blocks skipped as silent) and, while a drain thread is listening, reads the timestamp
+// counter on entry and exit and pushes one BlockRecord into the instance's SpscRing. No call,
+// lock or allocation on the audio thread: a few stores, plus two rdtsc when draining.
+//
+// The drain thread runs when the environment variable DSPCORE_PROFILE names a directory (one
+// per plug-in module, started by the first setup()). It empties the rings every 50 ms, sorts
+// the blocks into a histogram of their load (cost / deadline) and keeps the result in
+// <directory>/<name>-<pid>.prof, a memory mapped ProfileSnapshot: use /dev/shm for shared
+// memory that other processes can watch live, or a disk directory for a file that outlives
+// the process. ProfileReport prints either. The timestamps are the expensive part (rdtsc
+// takes 20 to 70 cycles, more under some hypervisors), so without the variable only the
+// counters run and a release build costs next to nothing per block.
+
+// Timestamp: the TSC on x86 (constant rate on every CPU of the last fifteen years, not
+// serializing, ~20 cycles), steady_clock nanoseconds elsewhere:
+inline uint64_t profilerTicks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// One process call:
+struct BlockRecord
+{
+	uint32_t ticks;		// duration, in profilerTicks() (saturated at 2^32-1)
+	int32_t numSamples;
+	uint32_t flags;		// BlockProfiler::Flags
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Snapshot written by the drain thread (plain data, shared with ProfileReport):
+
+enum
+{
+	kProfileMagic = 0x50505644, // "DVPP"
+	kProfileVersion = 1,
+	kProfileMaxInstances = 64,	// per module; later instances are counted but not exported
+	kProfileNameSize = 32,
+	kProfileHistogramBins = 64,	// 4 per octave of load, bin kProfileDeadlineBin = [1, 2^0.25)
+	kProfileDeadlineBin = 56	// so bin 0 is load < 2^-13.75 (0.007%) and the last one load >= 2^1.75
+};
+
+struct ProfileInstanceStats
+{
+	char name[kProfileNameSize];	// "<module name>#<instance number>"
+	uint32_t active;				// 0 once the instance is deleted
+	float sampleRate;
+	uint64_t blocks;				// counters of the instance
+	uint64_t samples;
+	uint64_t rampBlocks;			// blocks with a parameter ramp in progress
+	uint64_t skippedBlocks;			// blocks found silent and skipped
+	uint64_t dropped;				// records lost to a full ring (not in the histogram)
+	uint64_t misses;				// drained blocks that took longer than their deadline
+	double processSeconds;			// time spent in the drained blocks
+	double audioSeconds;			// audio length of the drained blocks
+	double maxLoad;					// worst block cost / deadline
+	double maxSeconds;				// worst block cost
+	uint64_t histogram[kProfileHistogramBins];
+};
+
+struct ProfileSnapshot
+{
+	uint32_t magic;
+	uint32_t version;
+	std::atomic<uint32_t> sequence; // odd while the drain thread updates (seqlock)
+	int32_t pid;
+	int32_t numInstances;			// used entries of instances
+	double ticksPerSecond;
+	double updated;					// seconds since the epoch of the last update
+	ProfileInstanceStats instances[kProfileMaxInstances];
+};
+
+// Histogram bin of a block whose cost is load times its deadline:
+int profileHistogramBin(double load);
+// Lower edge of a bin, as a load (the upper edge is the next bin's):
+double profileHistogramLoad(int bin);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+class BlockProfiler
+{
+public:
+	enum Flags
+	{
+		kRamping = 1,	// a parameter ramp was in progress
+		kSkipped = 2,	// the block was silent and skipped
+		kDouble = 4		// processDoubleReplacing()
+	};
+
+	BlockProfiler();
+	~BlockProfiler(); // leaves the drain thread; not on the audio thread
+
+	// From resume(): the deadlines follow sampleRate. The first call registers the instance
+	// with the drain thread, starting it if DSPCORE_PROFILE is set (allocates, opens files).
+	// name is the module's ("MyVstPlugIn-ex3"), the same for all its instances.
+	void setup(const char *name, float sampleRate);
+
+	// Audio thread, inside a Scope: flags for the current block.
+	void mark(unsigned flags) { flags_ |= flags; }
+
+	// Times the process call it is declared in:
+	class Scope
+	{
+	public:
+		Scope(BlockProfiler &profiler, int numSamples, unsigned flags = 0)
+			: profiler_(profiler), numSamples_(numSamples)
+		{
+			profiler_.flags_ = flags;
+			start_ = profiler_.draining_.load(std::memory_order_relaxed) ? profilerTicks() : 0;
+		}
+
+		~Scope()
+		{
+			profiler_.record(start_, numSamples_);
+		}
+
+	private:
+		Scope(const Scope &);
+		Scope &operator=(const Scope &);
+
+		BlockProfiler &profiler_;
+		int numSamples_;
+		uint64_t start_; // 0 if not timed
+	};
+
+	// Counters, from any thread:
+	uint64_t blocks() const { return blocks_.load(std::memory_order_relaxed); }
+	uint64_t samples() const { return samples_.load(std::memory_order_relaxed); }
+	uint64_t rampBlocks() const { return rampBlocks_.load(std::memory_order_relaxed); }
+	uint64_t skippedBlocks() const { return skippedBlocks_.load(std::memory_order_relaxed); }
+	uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+	BlockProfiler(const BlockProfiler &);
+	BlockProfiler &operator=(const BlockProfiler &);
+
+	friend class ProfileDrain;
+
+	// Single writer: plain load and store, no locked read-modify-write.
+	static void increment(std::atomic<uint64_t> &counter, uint64_t amount)
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+	}
+
+	void record(uint64_t start, int numSamples)
+	{
+		increment(blocks_, 1);
+		increment(samples_, (uint64_t)numSamples);
+		if (flags_ & kRamping)
+		{
+			increment(rampBlocks_, 1);
+		}
+		if (flags_ & kSkipped)
+		{
+			increment(skippedBlocks_, 1);
+		}
+		if (start != 0)
+		{
+			const uint64_t ticks = profilerTicks() - start;
+			BlockRecord block;
+			block.ticks = ticks < 0xffffffffu ? (uint32_t)ticks : 0xffffffffu;
+			block.numSamples = numSamples;
+			block.flags = flags_;
+			if (!ring_.push(block))
+			{
+				increment(dropped_, 1);
+			}
+		}
+	}
+
+	// Audio thread:
+	unsigned flags_;
+	std::atomic<uint64_t> blocks_;
+	std::atomic<uint64_t> samples_;
+	std::atomic<uint64_t> rampBlocks_;
+	std::atomic<uint64_t> skippedBlocks_;
+	std::atomic<uint64_t> dropped_;
+	SpscRing<BlockRecord, 1024> ring_; // 1.4 s of 64 sample blocks at 48 kHz
+
+	// Set up outside the audio thread:
+	std::atomic<bool> draining_;
+	std::atomic<float> sampleRate_;
+	char name_[kProfileNameSize];
+	bool registered_;
+	int slot_; // in the snapshot, -1 if none
+};
+
+#endif
@@ -0,0 +1,96 @@
+#include "CpuFeatures.hxx"
+
+#include <cstdlib>
+#include <cstring>
+
+// ---------------------------------------------------------------------------------------
+// CPU feature detection:
+// ---------------------------------------------------------------------------------------
+
+#if defined(__x86_64__) || defined(__i386__)
+	#define DSPCORE_X86 1
+#endif
+
+static bool cpuSupports(SimdLevel level)
+{
+	switch (level)
+	{
+		case kSimdScalar:
+			return true;
+#if DSPCORE_X86 && (defined(__GNUC__) || defined(__clang__))
+		case kSimdSse2:
+			return __builtin_cpu_supports("sse2");
+		case kSimdAvx2:
+			return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+		case kSimdAvx512:
+			return __builtin_cpu_supports("avx512f");
+#endif
+		default:
+			return false;
+	}
+}
+
+static bool isCompiledIn(SimdLevel level)
+{
+	switch (level)
+	{
+		case kSimdScalar:
+			return true;
+#if DSPCORE_X86
+		case kSimdSse2:
+			return true;
+#endif
+#ifdef DSPCORE_HAVE_AVX2
+		case kSimdAvx2:
+			return true;
+#endif
+#ifdef DSPCORE_HAVE_AVX512
+		case kSimdAvx512:
+			return true;
+#endif
+		default:
+			return false;
+	}
+}
+
+bool isSimdLevelAvailable(SimdLevel level)
+{
+	return isCompiledIn(level) && cpuSupports(level);
+}
+
+SimdLevel detectSimdLevel()
+{
+	int cap = kNumSimdLevels - 1;
+	const char *requested = std::getenv("DSPCORE_SIMD");
+	if (requested != NULL)
+	{
+		for (int level = 0; level < kNumSimdLevels; ++level)
+		{
+			if (std::strcmp(requested, simdLevelName((SimdLevel)level)) == 0)
+			{
+				cap = level;
+			}
+		}
+	}
+
+	for (int level = cap; level > kSimdScalar; --level)
+	{
+		if (isSimdLevelAvailable((SimdLevel)level))
+		{
+			return (SimdLevel)level;
+		}
+	}
+	return kSimdScalar;
+}
+
+const char *simdLevelName(SimdLevel level)
+{
+	switch (level)
+	{
+		case kSimdScalar: return "scalar";
+		case kSimdSse2:   return "sse2";
+		case kSimdAvx2:   return "avx2";
+		case kSimdAvx512: return "avx512";
+		default:          return "";
+	}
+}
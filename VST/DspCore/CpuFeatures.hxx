@@ -0,0 +1,26 @@
+#ifndef INCLUDED_CPUFEATURES_HXX
+#define INCLUDED_CPUFEATURES_HXX
+
+// Instruction set levels the DspCore kernels are compiled for.
+//
+// Each kernel has one implementation per level (in its own translation unit, compiled with the
+// matching -m flags) and picks the best one the running CPU supports when the plug-in is loaded.
+enum SimdLevel
+{
+	kSimdScalar,
+	kSimdSse2,
+	kSimdAvx2,   // AVX2 + FMA
+	kSimdAvx512, // AVX-512F
+	kNumSimdLevels
+};
+
+// Best level supported by both the running CPU and this build.
+// Setting the environment variable DSPCORE_SIMD to scalar, sse2, avx2 or avx512 caps it (for benchmarks).
+SimdLevel detectSimdLevel();
+
+// True if this build contains kernels for the given level and the CPU can run them.
+bool isSimdLevelAvailable(SimdLevel level);
+
+const char *simdLevelName(SimdLevel level);
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef INCLUDED_EVENTSCHEDULER_HXX
+#define INCLUDED_EVENTSCHEDULER_HXX
+
+// ---------------------------------------------------------------------------------------
+// Sample accurate events.
+// ---------------------------------------------------------------------------------------
+
+// A MIDI message or a parameter change, at a frame (sample offset) of the next block:
+struct ScheduledEvent
+{
+	int frame;
+	int parameter;       // parameter index, or -1 for a MIDI message
+	float value;         // normalized parameter value (0..1)
+	unsigned char status; // MIDI message (parameter == -1)
+	unsigned char data1;
+	unsigned char data2;
+
+	bool isParameter() const { return parameter >= 0; }
+};
+
+// Fixed capacity queue of the events of the next block, filled from processEvents() and
+// drained by the next processReplacing(), both on the audio thread. process() splits the
+// block at the event frames, so each event takes effect on its exact sample whatever block
+// size the host uses, while the plug-in still renders sub-blocks with its vectorised loops.
+//
+// VST 2.4 has no timestamped automation (setParameter() has no sample position), but MIDI
+// events carry deltaFrames: control change kFirstParameterController + i (CC 20..51, left
+// undefined by the MIDI specification) is queued as a change of parameter i to value/127.
+//
+// Events are kept sorted by frame; events with the same frame keep their order. When full,
+// further events are dropped; there is no allocation.
+template <int Capacity>
+class EventScheduler
+{
+public:
+	enum { kCapacity = Capacity, kFirstParameterController = 20, kMaxParameterControllers = 32 };
+
+	// numParameters: parameters reachable through control changes (0 = none).
+	explicit EventScheduler(int numParameters = 0)
+		: size_(0), numParameters_(numParameters < kMaxParameterControllers ? numParameters : kMaxParameterControllers)
+	{
+	}
+
+	bool pushMidi(int frame, unsigned char status, unsigned char data1, unsigned char data2)
+	{
+		const int parameter = data1 - kFirstParameterController;
+		if ((status & 0xF0) == 0xB0 && parameter >= 0 && parameter < numParameters_)
+		{
+			return pushParameter(frame, parameter, (float)(data2 & 127)/127.0f);
+		}
+		ScheduledEvent *event = insert(frame);
+		if (event == NULL)
+		{
+			return false;
+		}
+		event->parameter = -1;
+		event->value = 0.0f;
+		event->status = status;
+		event->data1 = data1;
+		event->data2 = data2;
+		return true;
+	}
+
+	bool pushParameter(int frame, int parameter, float value)
+	{
+		ScheduledEvent *event = insert(frame);
+		if (event == NULL)
+		{
+			return false;
+		}
+		event->parameter = parameter;
+		event->value = value;
+		event->status = event->data1 = event->data2 = 0;
+		return true;
+	}
+
+	void clear() { size_ = 0; }
+	int size() const { return size_; }
+	bool empty() const { return size_ == 0; }
+	const ScheduledEvent &operator[](int i) const { return events_[i]; }
+
+	// Runs one block of numSamples and empties the queue: handle(event) for the events due at
+	// the start of each sub-block, then render(start, length) for the sub-block up to the next
+	// event. Events stamped at or past the end of the block (should not happen) are handled
+	// after the last sub-block.
+	template <typename Handle, typename Render>
+	void process(int numSamples, Handle handle, Render render)
+	{
+		int e = 0;
+		for (int start = 0; start < numSamples; )
+		{
+			while (e < size_ && events_[e].frame <= start)
+			{
+				handle(events_[e++]);
+			}
+			const int end = e < size_ && events_[e].frame < numSamples ? events_[e].frame : numSamples;
+			render(start, end - start);
+			start = end;
+		}
+		while (e < size_)
+		{
+			handle(events_[e++]);
+		}
+		size_ = 0;
+	}
+
+private:
+	// Slot for a new event at frame, in order; NULL if full:
+	ScheduledEvent *insert(int frame)
+	{
+		if (size_ == Capacity)
+		{
+			return NULL;
+		}
+		// Hosts send events in order, so this normally inserts at the end:
+		int i = size_;
+		while (i > 0 && events_[i - 1].frame > frame)
+		{
+			events_[i] = events_[i - 1];
+			--i;
+		}
+		events_[i].frame = frame;
+		++size_;
+		return &events_[i];
+	}
+
+	ScheduledEvent events_[Capacity];
+	int size_;
+	int numParameters_;
+};
+
+#endif
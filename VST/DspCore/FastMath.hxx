@@ -0,0 +1,145 @@
+#ifndef INCLUDED_FASTMATH_HXX
+#define INCLUDED_FASTMATH_HXX
+
+#include <cstdint>
+#include <cstring>
+
+// ---------------------------------------------------------------------------------------
+// Float approximations of exp2, log2, dB <-> gain and sin/cos for the audio thread.
+// ---------------------------------------------------------------------------------------
+
+// libm's exp2f/powf/sinf are correctly rounded or nearly so, which costs branches for the
+// special cases, table lookups and a call per value, and a loop over them does not
+// vectorize. These are minimax polynomials (fitted by Remez exchange) around a range
+// reduction done with bit operations: no table, no call and no floating point comparison
+// (with GCC's default -ftrapping-math a float select keeps a loop from vectorizing, so the
+// clamps and folds work on integers), so a loop over them vectorizes in the -O3 Release
+// build, 4 values per SSE2 instruction. Maximum errors against libm in double over the
+// stated range (the polynomial's own error plus float rounding), checked by DspBench
+// fastMathAccuracy, a ctest test, along with the errors of the polynomials given below:
+//
+//   fastExp2(x)            x in [-126, 127]         relative 2.4e-7 (2 ulp)
+//   fastLog2(x)            x in [0.5, 2]            absolute 1.2e-7
+//                          x in [1e-37, 1e38]       absolute 3.9e-6 (1 ulp of a result near 126)
+//   fastDecibelsToGain(dB) dB in [-120, 24]         relative 9.3e-7 (mostly the rounding of dB*log2(10)/20)
+//   fastGainToDecibels(g)  g in [1e-6, 16]          absolute 1.2e-5 dB (1 ulp of a result near -120)
+//   fastSinCycles(p)       p in [-4, 4] cycles      absolute 1.6e-7; larger |p| (up to 2^21) adds the rounding of p
+//   fastSin(x), fastCos(x) x in [-2 pi, 2 pi]       absolute 4.4e-7
+//                          x in [-1000, 1000]       absolute 8.8e-5 (the rounding of x/(2 pi): use cycles)
+//
+// Outside the ranges: fastExp2 clamps x to [-127, 127], so it stays finite (at most
+// 2^127) and gives 0 below -126.5, where the result would not be a normal float (-inf
+// included: fastDecibelsToGain(-inf) is 0); fastLog2 returns -126 for zero, subnormal and
+// negative input; NaN input, and infinite input to the others, give garbage.
+// They need the default rounding mode and no -ffast-math reassociation, like the rest of
+// dspcore. Parameter mapping, dB conversion and smoother jumps on the audio thread go
+// through these; table builders and anything else that runs once stay with libm in double.
+
+namespace detail
+{
+	inline float bitsToFloat(uint32_t bits)
+	{
+		float x;
+		std::memcpy(&x, &bits, sizeof(x));
+		return x;
+	}
+
+	inline uint32_t floatToBits(float x)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &x, sizeof(bits));
+		return bits;
+	}
+
+	// Round to nearest integer, for |x| < 2^22: adding 1.5*2^23 pushes the fraction out of
+	// the mantissa (plain SSE2, where floor() would be a call):
+	inline float roundNearest(float x)
+	{
+		const float magic = 12582912.0f;
+		return (x + magic) - magic;
+	}
+
+	// The polynomials of the functions below on their reduced ranges, templates so that the
+	// accuracy test can evaluate them in double, without the float rounding:
+	template <typename T>
+	inline T exp2Polynomial(T f) // 2^f, f in [-0.5, 0.5]
+	{
+		return T(1.0000000717) + f*(T(0.69314696706) + f*(T(0.24022119724) + f*(T(0.055507132735) + f*(T(0.0096755413342) + f*T(0.0013276471979)))));
+	}
+
+	template <typename T>
+	inline T log2Polynomial(T t) // log2((1 + t)/(1 - t)), |t| < 0.172
+	{
+		const T s = t*t;
+		return t*(T(2.8853912894) + s*(T(0.96147080895) + s*T(0.59897388582)));
+	}
+
+	template <typename T>
+	inline T sinCyclesPolynomial(T r) // sin(2 pi r), r in [-0.25, 0.25]
+	{
+		const T s = r*r;
+		return r*(T(6.2831850391) + s*(T(-41.341629245) + s*(T(81.599520016) + s*(T(-76.518140996) + s*T(39.311800331)))));
+	}
+}
+
+// 2^x. x = n + f with n integer and f in [-0.5, 0.5]; 2^n goes straight into the exponent
+// bits, 2^f is a degree 5 polynomial (relative error 7.51e-8). |x| is clamped to 127 first,
+// on the bits, so infinities round and convert like any other value; n = -127 makes the
+// exponent bits 0, and the result 0:
+inline float fastExp2(float x)
+{
+	const uint32_t bits = detail::floatToBits(x);
+	int32_t magnitude = (int32_t)(bits & 0x7fffffffu);
+	magnitude = magnitude > 0x42fe0000 ? 0x42fe0000 : magnitude; // 127
+	x = detail::bitsToFloat((bits & 0x80000000u) | (uint32_t)magnitude);
+	const float n = detail::roundNearest(x);
+	const float f = x - n;
+	const int32_t k = (int32_t)n;
+	return detail::exp2Polynomial(f)*detail::bitsToFloat((uint32_t)(k + 127) << 23);
+}
+
+// log2(x), x > 0. x = 2^e*m with m in [sqrt(1/2), sqrt(2)) (taken from the bits, relative to
+// those of sqrt(1/2)); log2(m) = t*q(t^2) with t = (m - 1)/(m + 1), |t| < 0.172, q a degree
+// 2 polynomial (absolute error 3e-8). e is negative for x < sqrt(1/2), so the exponent is
+// taken with 128 added, in unsigned arithmetic (no shift of a negative value):
+inline float fastLog2(float x)
+{
+	int32_t bits = (int32_t)detail::floatToBits(x);
+	bits = bits < 0x00800000 ? 0x00800000 : bits; // smallest normal float; also catches x < 0
+	const uint32_t biased = ((uint32_t)bits - 0x3f3504f3u + 0x40000000u) >> 23; // e + 128; 0x3f3504f3 = sqrt(1/2)
+	const int32_t e = (int32_t)biased - 128;
+	const float m = detail::bitsToFloat((uint32_t)bits - (biased << 23) + 0x40000000u);
+	return (float)e + detail::log2Polynomial((m - 1.0f)/(m + 1.0f));
+}
+
+inline float fastExp(float x) { return fastExp2(x*1.44269504089f); }	// log2(e)
+inline float fastLog(float x) { return fastLog2(x)*0.69314718056f; }	// ln(2)
+
+// x^y for x > 0:
+inline float fastPow(float x, float y) { return fastExp2(y*fastLog2(x)); }
+
+// 10^(dB/20) and back:
+inline float fastDecibelsToGain(float decibels) { return fastExp2(decibels*0.16609640474f); }	// log2(10)/20
+inline float fastGainToDecibels(float gain) { return fastLog2(gain)*6.0205999133f; }			// 20*log10(2)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// sin(2 pi phase), phase in cycles: phase = q/2 + r with q integer and r in [-0.25, 0.25],
+// sin(2 pi r) = r*p(r^2) with p a degree 4 polynomial (absolute error 6.62e-9), and every odd
+// half cycle flips the sign (sin(a + pi) = -sin(a)), straight into the sign bit. Phase
+// accumulators in cycles keep their precision, so oscillators should use this one:
+inline float fastSinCycles(float phase)
+{
+	const float q = detail::roundNearest(phase + phase);
+	const float r = phase - 0.5f*q;
+	const float v = detail::sinCyclesPolynomial(r);
+	return detail::bitsToFloat(detail::floatToBits(v) ^ ((uint32_t)(int32_t)q << 31));
+}
+
+inline float fastCosCycles(float phase) { return fastSinCycles(phase + 0.25f); }
+
+// Radians:
+inline float fastSin(float x) { return fastSinCycles(x*0.15915494309f); }	// 1/(2 pi)
+inline float fastCos(float x) { return fastSinCycles(x*0.15915494309f + 0.25f); }
+
+#endif
@@ -0,0 +1,112 @@
+#include "GainRamp.hxx"
+
+#include <cstring>
+
+// Implementations in GainRamp<Level>.cxx, each built with its own instruction set flags:
+void gainRampSse2(const float *in, float *out, int numSamples, float gain, float step);
+void gainRampAvx2(const float *in, float *out, int numSamples, float gain, float step);
+void gainRampAvx512(const float *in, float *out, int numSamples, float gain, float step);
+void gainRampSse2(const double *in, double *out, int numSamples, double gain, double step);
+void gainRampAvx2(const double *in, double *out, int numSamples, double gain, double step);
+void gainRampAvx512(const double *in, double *out, int numSamples, double gain, double step);
+
+// ---------------------------------------------------------------------------------------
+// Scalar reference:
+// ---------------------------------------------------------------------------------------
+
+template <typename Sample>
+static void gainRampScalar(const Sample *in, Sample *out, int numSamples, Sample gain, Sample step)
+{
+	for (int j = 0; j < numSamples; ++j)
+	{
+		out[j] = in[j]*(gain + step*(Sample)j);
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// Dispatch:
+// ---------------------------------------------------------------------------------------
+
+GainRampKernel gainRampKernel(SimdLevel level)
+{
+	if (!isSimdLevelAvailable(level))
+	{
+		return NULL;
+	}
+	switch (level)
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		case kSimdSse2:
+			return gainRampSse2;
+#endif
+#ifdef DSPCORE_HAVE_AVX2
+		case kSimdAvx2:
+			return gainRampAvx2;
+#endif
+#ifdef DSPCORE_HAVE_AVX512
+		case kSimdAvx512:
+			return gainRampAvx512;
+#endif
+		default:
+			return gainRampScalar<float>;
+	}
+}
+
+GainRampKernelDouble gainRampKernelDouble(SimdLevel level)
+{
+	if (!isSimdLevelAvailable(level))
+	{
+		return NULL;
+	}
+	switch (level)
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		case kSimdSse2:
+			return gainRampSse2;
+#endif
+#ifdef DSPCORE_HAVE_AVX2
+		case kSimdAvx2:
+			return gainRampAvx2;
+#endif
+#ifdef DSPCORE_HAVE_AVX512
+		case kSimdAvx512:
+			return gainRampAvx512;
+#endif
+		default:
+			return gainRampScalar<double>;
+	}
+}
+
+// Resolved once, when the plug-in (and with it dspcore) is loaded:
+static const GainRampKernel selectedGainRamp = gainRampKernel(detectSimdLevel());
+static const GainRampKernelDouble selectedGainRampDouble = gainRampKernelDouble(detectSimdLevel());
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void applyGainRamp(const float *in, float *out, int numSamples, float startGain, float endGain)
+{
+	if (startGain == endGain && startGain == 1.0f)
+	{
+		if (in != out)
+		{
+			std::memcpy(out, in, numSamples*sizeof(float));
+		}
+		return;
+	}
+	const float step = startGain == endGain ? 0.0f : (endGain - startGain)/(float)numSamples;
+	selectedGainRamp(in, out, numSamples, startGain, step);
+}
+
+void applyGainRamp(const double *in, double *out, int numSamples, double startGain, double endGain)
+{
+	if (startGain == endGain && startGain == 1.0)
+	{
+		if (in != out)
+		{
+			std::memcpy(out, in, numSamples*sizeof(double));
+		}
+		return;
+	}
+	const double step = startGain == endGain ? 0.0 : (endGain - startGain)/(double)numSamples;
+	selectedGainRampDouble(in, out, numSamples, startGain, step);
+}
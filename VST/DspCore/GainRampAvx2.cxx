@@ -0,0 +1,75 @@
+// AVX2/FMA implementations of the gain ramp, float and double (see GainRamp.hxx). Built with -mavx2 -mfma.
+
+#ifdef DSPCORE_HAVE_AVX2
+
+#include <immintrin.h>
+
+void gainRampAvx2(const float *in, float *out, int numSamples, float gain, float step)
+{
+	const __m256 g0 = _mm256_set1_ps(gain);
+	int j = 0;
+	if (step == 0.0f)
+	{
+		for (; j + 16 <= numSamples; j += 16)
+		{
+			_mm256_storeu_ps(out + j, _mm256_mul_ps(_mm256_loadu_ps(in + j), g0));
+			_mm256_storeu_ps(out + j + 8, _mm256_mul_ps(_mm256_loadu_ps(in + j + 8), g0));
+		}
+	}
+	else
+	{
+		const __m256 s = _mm256_set1_ps(step);
+		const __m256 sixteen = _mm256_set1_ps(16.0f);
+		__m256 idx0 = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+		__m256 idx1 = _mm256_add_ps(idx0, _mm256_set1_ps(8.0f));
+		for (; j + 16 <= numSamples; j += 16)
+		{
+			__m256 gA = _mm256_fmadd_ps(idx0, s, g0);
+			__m256 gB = _mm256_fmadd_ps(idx1, s, g0);
+			_mm256_storeu_ps(out + j, _mm256_mul_ps(_mm256_loadu_ps(in + j), gA));
+			_mm256_storeu_ps(out + j + 8, _mm256_mul_ps(_mm256_loadu_ps(in + j + 8), gB));
+			idx0 = _mm256_add_ps(idx0, sixteen);
+			idx1 = _mm256_add_ps(idx1, sixteen);
+		}
+	}
+	for (; j < numSamples; ++j)
+	{
+		out[j] = in[j]*(gain + step*(float)j);
+	}
+}
+
+void gainRampAvx2(const double *in, double *out, int numSamples, double gain, double step)
+{
+	const __m256d g0 = _mm256_set1_pd(gain);
+	int j = 0;
+	if (step == 0.0)
+	{
+		for (; j + 8 <= numSamples; j += 8)
+		{
+			_mm256_storeu_pd(out + j, _mm256_mul_pd(_mm256_loadu_pd(in + j), g0));
+			_mm256_storeu_pd(out + j + 4, _mm256_mul_pd(_mm256_loadu_pd(in + j + 4), g0));
+		}
+	}
+	else
+	{
+		const __m256d s = _mm256_set1_pd(step);
+		const __m256d eight = _mm256_set1_pd(8.0);
+		__m256d idx0 = _mm256_setr_pd(0.0, 1.0, 2.0, 3.0);
+		__m256d idx1 = _mm256_setr_pd(4.0, 5.0, 6.0, 7.0);
+		for (; j + 8 <= numSamples; j += 8)
+		{
+			__m256d gA = _mm256_fmadd_pd(idx0, s, g0);
+			__m256d gB = _mm256_fmadd_pd(idx1, s, g0);
+			_mm256_storeu_pd(out + j, _mm256_mul_pd(_mm256_loadu_pd(in + j), gA));
+			_mm256_storeu_pd(out + j + 4, _mm256_mul_pd(_mm256_loadu_pd(in + j + 4), gB));
+			idx0 = _mm256_add_pd(idx0, eight);
+			idx1 = _mm256_add_pd(idx1, eight);
+		}
+	}
+	for (; j < numSamples; ++j)
+	{
+		out[j] = in[j]*(gain + step*(double)j);
+	}
+}
+
+#endif
@@ -0,0 +1,90 @@
+// AVX-512F implementations of the gain ramp, float and double (see GainRamp.hxx). Built with -mavx512f.
+
+#ifdef DSPCORE_HAVE_AVX512
+
+#include <immintrin.h>
+
+void gainRampAvx512(const float *in, float *out, int numSamples, float gain, float step)
+{
+	const __m512 g0 = _mm512_set1_ps(gain);
+	const __m512 s = _mm512_set1_ps(step);
+	const __m512 sixteen = _mm512_set1_ps(16.0f);
+	__m512 idx = _mm512_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f,
+	                            8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f);
+	int j = 0;
+	if (step == 0.0f)
+	{
+		for (; j + 32 <= numSamples; j += 32)
+		{
+			_mm512_storeu_ps(out + j, _mm512_mul_ps(_mm512_loadu_ps(in + j), g0));
+			_mm512_storeu_ps(out + j + 16, _mm512_mul_ps(_mm512_loadu_ps(in + j + 16), g0));
+		}
+	}
+	else
+	{
+		const __m512 thirtyTwo = _mm512_set1_ps(32.0f);
+		__m512 idx1 = _mm512_add_ps(idx, sixteen);
+		for (; j + 32 <= numSamples; j += 32)
+		{
+			__m512 gA = _mm512_fmadd_ps(idx, s, g0);
+			__m512 gB = _mm512_fmadd_ps(idx1, s, g0);
+			_mm512_storeu_ps(out + j, _mm512_mul_ps(_mm512_loadu_ps(in + j), gA));
+			_mm512_storeu_ps(out + j + 16, _mm512_mul_ps(_mm512_loadu_ps(in + j + 16), gB));
+			idx = _mm512_add_ps(idx, thirtyTwo);
+			idx1 = _mm512_add_ps(idx1, thirtyTwo);
+		}
+	}
+
+	// Remainder (fewer than 32 samples) with masked loads/stores:
+	for (; j < numSamples; j += 16)
+	{
+		const int remaining = numSamples - j;
+		const __mmask16 mask = remaining >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1u << remaining) - 1u);
+		__m512 g = _mm512_fmadd_ps(idx, s, g0);
+		_mm512_mask_storeu_ps(out + j, mask, _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, in + j), g));
+		idx = _mm512_add_ps(idx, sixteen);
+	}
+}
+
+void gainRampAvx512(const double *in, double *out, int numSamples, double gain, double step)
+{
+	const __m512d g0 = _mm512_set1_pd(gain);
+	const __m512d s = _mm512_set1_pd(step);
+	const __m512d eight = _mm512_set1_pd(8.0);
+	__m512d idx = _mm512_setr_pd(0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0);
+	int j = 0;
+	if (step == 0.0)
+	{
+		for (; j + 16 <= numSamples; j += 16)
+		{
+			_mm512_storeu_pd(out + j, _mm512_mul_pd(_mm512_loadu_pd(in + j), g0));
+			_mm512_storeu_pd(out + j + 8, _mm512_mul_pd(_mm512_loadu_pd(in + j + 8), g0));
+		}
+	}
+	else
+	{
+		const __m512d sixteen = _mm512_set1_pd(16.0);
+		__m512d idx1 = _mm512_add_pd(idx, eight);
+		for (; j + 16 <= numSamples; j += 16)
+		{
+			__m512d gA = _mm512_fmadd_pd(idx, s, g0);
+			__m512d gB = _mm512_fmadd_pd(idx1, s, g0);
+			_mm512_storeu_pd(out + j, _mm512_mul_pd(_mm512_loadu_pd(in + j), gA));
+			_mm512_storeu_pd(out + j + 8, _mm512_mul_pd(_mm512_loadu_pd(in + j + 8), gB));
+			idx = _mm512_add_pd(idx, sixteen);
+			idx1 = _mm512_add_pd(idx1, sixteen);
+		}
+	}
+
+	// Remainder (fewer than 16 samples) with masked loads/stores:
+	for (; j < numSamples; j += 8)
+	{
+		const int remaining = numSamples - j;
+		const __mmask8 mask = remaining >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << remaining) - 1u);
+		__m512d g = _mm512_fmadd_pd(idx, s, g0);
+		_mm512_mask_storeu_pd(out + j, mask, _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, in + j), g));
+		idx = _mm512_add_pd(idx, eight);
+	}
+}
+
+#endif
@@ -0,0 +1,76 @@
+// SSE2 implementations of the gain ramp, float and double (see GainRamp.hxx).
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <emmintrin.h>
+
+void gainRampSse2(const float *in, float *out, int numSamples, float gain, float step)
+{
+	const __m128 g0 = _mm_set1_ps(gain);
+	int j = 0;
+	if (step == 0.0f)
+	{
+		for (; j + 8 <= numSamples; j += 8)
+		{
+			_mm_storeu_ps(out + j, _mm_mul_ps(_mm_loadu_ps(in + j), g0));
+			_mm_storeu_ps(out + j + 4, _mm_mul_ps(_mm_loadu_ps(in + j + 4), g0));
+		}
+	}
+	else
+	{
+		// Gain computed from the sample index rather than accumulated, so it cannot drift:
+		const __m128 s = _mm_set1_ps(step);
+		const __m128 eight = _mm_set1_ps(8.0f);
+		__m128 idx0 = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+		__m128 idx1 = _mm_setr_ps(4.0f, 5.0f, 6.0f, 7.0f);
+		for (; j + 8 <= numSamples; j += 8)
+		{
+			__m128 gA = _mm_add_ps(g0, _mm_mul_ps(idx0, s));
+			__m128 gB = _mm_add_ps(g0, _mm_mul_ps(idx1, s));
+			_mm_storeu_ps(out + j, _mm_mul_ps(_mm_loadu_ps(in + j), gA));
+			_mm_storeu_ps(out + j + 4, _mm_mul_ps(_mm_loadu_ps(in + j + 4), gB));
+			idx0 = _mm_add_ps(idx0, eight);
+			idx1 = _mm_add_ps(idx1, eight);
+		}
+	}
+	for (; j < numSamples; ++j)
+	{
+		out[j] = in[j]*(gain + step*(float)j);
+	}
+}
+
+void gainRampSse2(const double *in, double *out, int numSamples, double gain, double step)
+{
+	const __m128d g0 = _mm_set1_pd(gain);
+	int j = 0;
+	if (step == 0.0)
+	{
+		for (; j + 4 <= numSamples; j += 4)
+		{
+			_mm_storeu_pd(out + j, _mm_mul_pd(_mm_loadu_pd(in + j), g0));
+			_mm_storeu_pd(out + j + 2, _mm_mul_pd(_mm_loadu_pd(in + j + 2), g0));
+		}
+	}
+	else
+	{
+		const __m128d s = _mm_set1_pd(step);
+		const __m128d four = _mm_set1_pd(4.0);
+		__m128d idx0 = _mm_setr_pd(0.0, 1.0);
+		__m128d idx1 = _mm_setr_pd(2.0, 3.0);
+		for (; j + 4 <= numSamples; j += 4)
+		{
+			__m128d gA = _mm_add_pd(g0, _mm_mul_pd(idx0, s));
+			__m128d gB = _mm_add_pd(g0, _mm_mul_pd(idx1, s));
+			_mm_storeu_pd(out + j, _mm_mul_pd(_mm_loadu_pd(in + j), gA));
+			_mm_storeu_pd(out + j + 2, _mm_mul_pd(_mm_loadu_pd(in + j + 2), gB));
+			idx0 = _mm_add_pd(idx0, four);
+			idx1 = _mm_add_pd(idx1, four);
+		}
+	}
+	for (; j < numSamples; ++j)
+	{
+		out[j] = in[j]*(gain + step*(double)j);
+	}
+}
+
+#endif
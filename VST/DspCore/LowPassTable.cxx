@@ -0,0 +1,86 @@
+#include "LowPassTable.hxx"
+
+#include "ParameterMapping.hxx"
+
+#include <cmath>
+
+// ---------------------------------------------------------------------------------------
+// Building:
+// ---------------------------------------------------------------------------------------
+
+LowPassTable::LowPassTable()
+	: sampleRate_(44100.0), minFreq_(0.0), maxFreq_(0.0), minQ_(0.0), maxQ_(0.0)
+{
+	for (int i = 0; i <= kQPositionSteps; ++i)
+	{
+		qPosition_[i] = 0.0f;
+	}
+}
+
+void LowPassTable::build(double sampleRate, double minFreq, double maxFreq, double minQ, double maxQ)
+{
+	sampleRate_ = sampleRate;
+	minFreq_ = minFreq;
+	maxFreq_ = maxFreq;
+	minQ_ = minQ;
+	maxQ_ = maxQ;
+
+	table_.resize((size_t)(kQSteps + 1)*(kCutoffSteps + 1));
+	for (int k = 0; k <= kQSteps; ++k)
+	{
+		const double q = norm2exp((double)k/kQSteps, minQ, maxQ);
+		for (int i = 0; i <= kCutoffSteps; ++i)
+		{
+			const double freq = norm2exp((double)i/kCutoffSteps, minFreq, maxFreq);
+			table_[(size_t)k*(kCutoffSteps + 1) + i] = BiquadCoeffs<float>::lowPass(freq, q, sampleRate);
+		}
+	}
+
+	// Q parameter (linear) to row position (logarithmic):
+	for (int i = 0; i <= kQPositionSteps; ++i)
+	{
+		const double q = norm2lin((double)i/kQPositionSteps, minQ, maxQ);
+		qPosition_[i] = (float)(exp2norm(q, minQ, maxQ)*kQSteps);
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// Lookup:
+// ---------------------------------------------------------------------------------------
+
+static inline float clipUnit(float x)
+{
+	return x < 0.0f ? 0.0f : (x > 1.0f ? 1.0f : x);
+}
+
+static inline BiquadCoeffs<float> mix(const BiquadCoeffs<float> &x, const BiquadCoeffs<float> &y, float fraction)
+{
+	BiquadCoeffs<float> c = {
+		x.b0 + fraction*(y.b0 - x.b0),
+		x.b1 + fraction*(y.b1 - x.b1),
+		x.b2 + fraction*(y.b2 - x.b2),
+		x.a1 + fraction*(y.a1 - x.a1),
+		x.a2 + fraction*(y.a2 - x.a2)
+	};
+	return c;
+}
+
+BiquadCoeffs<float> LowPassTable::lookup(float cutoff, float q) const
+{
+	const float x = clipUnit(cutoff)*(float)kCutoffSteps;
+	const float p = clipUnit(q)*(float)kQPositionSteps;
+	const int pi = p < (float)kQPositionSteps ? (int)p : kQPositionSteps - 1;
+	const float y = qPosition_[pi] + (p - (float)pi)*(qPosition_[pi + 1] - qPosition_[pi]);
+	const int i = x < (float)kCutoffSteps ? (int)x : kCutoffSteps - 1;
+	const int k = y < (float)kQSteps ? (int)y : kQSteps - 1;
+
+	const BiquadCoeffs<float> *row = &table_[(size_t)k*(kCutoffSteps + 1) + i];
+	const float fx = x - (float)i;
+	return mix(mix(row[0], row[1], fx), mix(row[kCutoffSteps + 1], row[kCutoffSteps + 2], fx), y - (float)k);
+}
+
+BiquadCoeffs<float> LowPassTable::exact(float cutoff, float q) const
+{
+	return BiquadCoeffs<float>::lowPass(norm2exp((double)clipUnit(cutoff), minFreq_, maxFreq_),
+	                                    norm2lin((double)clipUnit(q), minQ_, maxQ_), sampleRate_);
+}
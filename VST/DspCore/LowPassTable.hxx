@@ -0,0 +1,51 @@
+#ifndef INCLUDED_LOWPASSTABLE_HXX
+#define INCLUDED_LOWPASSTABLE_HXX
+
+#include "Biquad.hxx"
+
+#include <vector>
+
+// ---------------------------------------------------------------------------------------
+// Precomputed low-pass coefficients.
+// ---------------------------------------------------------------------------------------
+
+// RBJ low-pass coefficients on a grid of cutoff frequencies and Q values, so a cutoff or Q
+// change costs a bilinear interpolation instead of sin/cos/division. The parameters are the
+// normalized ones of the plug-ins: cutoff maps to norm2exp(cutoff, minFreq, maxFreq) and Q to
+// norm2lin(q, minQ, maxQ).
+//
+// Both grid axes are logarithmic: the cutoff rows are uniform in the normalized cutoff
+// (1/kCutoffSteps is about 0.07 octave over 20 Hz..10 kHz), the Q columns uniform in log(Q),
+// found through a small position table since the Q parameter is linear. The filter shape
+// changes far more between Q 0.01 and 0.3 than between 5 and 10.
+//
+// An interpolated set of coefficients is a convex combination of four stable filters and
+// the biquad stability region is convex, so it is always stable. See DspBench
+// "lowpasstable" for the error of the magnitude response.
+class LowPassTable
+{
+public:
+	enum { kCutoffSteps = 128, kQSteps = 32, kQPositionSteps = 256 };
+
+	LowPassTable();
+
+	// Allocates and fills the table: call from resume(), not from the audio thread. minQ > 0.
+	void build(double sampleRate, double minFreq, double maxFreq, double minQ, double maxQ);
+	bool isBuilt() const { return !table_.empty(); }
+
+	// Coefficients for a normalized cutoff and Q (0..1, clipped), interpolated. The table
+	// must have been built.
+	BiquadCoeffs<float> lookup(float cutoff, float q) const;
+
+	// Same, computed exactly with the parameters of the last build(), for reference:
+	BiquadCoeffs<float> exact(float cutoff, float q) const;
+
+private:
+	std::vector<BiquadCoeffs<float> > table_; // (kQSteps + 1) rows of kCutoffSteps + 1 entries
+	float qPosition_[kQPositionSteps + 1];    // row position of normalized Q i/kQPositionSteps
+	double sampleRate_;
+	double minFreq_, maxFreq_;
+	double minQ_, maxQ_;
+};
+
+#endif
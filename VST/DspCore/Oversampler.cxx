@@ -0,0 +1,185 @@
+#include "Oversampler.hxx"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <xmmintrin.h>
+#endif
+
+// Half-band length and stopband attenuation of the stages, from the base rate up (see
+// Oversampler in the header):
+static const int STAGE_HALF_LENGTHS[] = { 16, 8, 4 };
+static const double STAGE_ATTENUATION_DB = 80.0;
+
+// Modified Bessel function of the first kind, order 0 (series), for the Kaiser window:
+static double besselI0(double x)
+{
+	double sum = 1.0, term = 1.0;
+	for (int k = 1; k < 50 && term > 1e-12*sum; ++k)
+	{
+		term *= (x/(2.0*k))*(x/(2.0*k));
+		sum += term;
+	}
+	return sum;
+}
+
+// out[j] = sum of taps[t]*x[j + t], t < numTaps, for j < numSamples:
+static void convolve(const float *taps, int numTaps, const float *x, float *out, int numSamples)
+{
+	int j = 0;
+#if defined(__SSE2__)
+	for (; j + 4 <= numSamples; j += 4)
+	{
+		__m128 acc = _mm_setzero_ps();
+		for (int t = 0; t < numTaps; ++t)
+		{
+			acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(taps[t]), _mm_loadu_ps(x + j + t)));
+		}
+		_mm_storeu_ps(out + j, acc);
+	}
+#endif
+	for (; j < numSamples; ++j)
+	{
+		float acc = 0.0f;
+		for (int t = 0; t < numTaps; ++t)
+		{
+			acc += taps[t]*x[j + t];
+		}
+		out[j] = acc;
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// HalfBandStage:
+// ---------------------------------------------------------------------------------------
+
+HalfBandStage::HalfBandStage()
+	: halfLength_(0)
+{
+}
+
+void HalfBandStage::setup(int halfLength, double attenuation, int maxInputSamples)
+{
+	halfLength_ = halfLength;
+
+	// h[c + j] = sinc(j/2)/2 times the window, c = 2*halfLength - 1; zero for even j except 0,
+	// so the nonzero side taps are the odd j up to +-c:
+	const double pi = 3.14159265358979323846;
+	const double beta = attenuation > 50.0 ? 0.1102*(attenuation - 8.7) : 0.5842*std::pow(attenuation - 21.0, 0.4) + 0.07886*(attenuation - 21.0);
+	const int numTaps = 2*halfLength;
+	const double centre = numTaps - 1;
+	std::vector<double> taps(numTaps);
+	double sum = 0.0;
+	for (int t = 0; t < numTaps; ++t)
+	{
+		const double j = 2.0*t - centre; // odd
+		const double r = j/(centre + 1.0); // the window ends at the zero taps just outside
+		const double window = besselI0(beta*std::sqrt(std::max(0.0, 1.0 - r*r)))/besselI0(beta);
+		taps[t] = std::sin(0.5*pi*j)/(pi*j)*window;
+		sum += taps[t];
+	}
+	// Exactly 1/2 at DC for the side taps, like the centre tap, so both phases have unity gain:
+	taps_.resize(numTaps);
+	for (int t = 0; t < numTaps; ++t)
+	{
+		taps_[t] = (float)(taps[t]/sum); // symmetric, so reversed as well; times 2 for the upsampler
+	}
+
+	upInput_.assign(numTaps - 1 + maxInputSamples, 0.0f);
+	downEven_.assign(numTaps - 1 + maxInputSamples, 0.0f);
+	downOdd_.assign(halfLength + maxInputSamples, 0.0f);
+}
+
+void HalfBandStage::reset()
+{
+	std::fill(upInput_.begin(), upInput_.end(), 0.0f);
+	std::fill(downEven_.begin(), downEven_.end(), 0.0f);
+	std::fill(downOdd_.begin(), downOdd_.end(), 0.0f);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// out[2n] = sum of taps[t]*x[n - c + t], out[2n + 1] = x[n - halfLength + 1]:
+void HalfBandStage::upsample(const float *in, float *out, int numSamples)
+{
+	const int numTaps = 2*halfLength_;
+	const int history = numTaps - 1;
+	float *x = &upInput_[0];
+	std::copy(in, in + numSamples, x + history);
+
+	// The even phase goes to the second half of out first; interleaving from the start never
+	// overwrites a value not read yet:
+	float *even = out + numSamples;
+	convolve(&taps_[0], numTaps, x, even, numSamples);
+	for (int n = 0; n < numSamples; ++n)
+	{
+		const float value = even[n];
+		out[2*n] = value;
+		out[2*n + 1] = x[n + halfLength_];
+	}
+
+	std::copy(x + numSamples, x + numSamples + history, x);
+}
+
+// out[n] = (sum of taps[t]*even[n - c + t] + odd[n - halfLength])/2:
+void HalfBandStage::downsample(const float *in, float *out, int numSamples)
+{
+	const int numTaps = 2*halfLength_;
+	const int history = numTaps - 1;
+	float *even = &downEven_[0];
+	float *odd = &downOdd_[0];
+	for (int n = 0; n < numSamples; ++n)
+	{
+		even[history + n] = in[2*n];
+		odd[halfLength_ + n] = in[2*n + 1];
+	}
+
+	convolve(&taps_[0], numTaps, even, out, numSamples);
+	for (int n = 0; n < numSamples; ++n)
+	{
+		out[n] = 0.5f*(out[n] + odd[n]);
+	}
+
+	std::copy(even + numSamples, even + numSamples + history, even);
+	std::copy(odd + numSamples, odd + numSamples + halfLength_, odd);
+}
+
+// ---------------------------------------------------------------------------------------
+// Oversampler:
+// ---------------------------------------------------------------------------------------
+
+Oversampler::Oversampler()
+	: factor_(1)
+{
+	std::fill(&work_[0][0], &work_[0][0] + 4*kChunkSize*kMaxFactor, 0.0f);
+}
+
+void Oversampler::setup(int factor)
+{
+	factor_ = factor >= 8 ? 8 : (factor >= 4 ? 4 : (factor >= 2 ? 2 : 1));
+	stages_.clear();
+	for (int rate = 1, s = 0; rate < factor_; rate *= 2, ++s)
+	{
+		stages_.push_back(HalfBandStage());
+		stages_.back().setup(STAGE_HALF_LENGTHS[s], STAGE_ATTENUATION_DB, kChunkSize*rate);
+	}
+}
+
+void Oversampler::reset()
+{
+	for (size_t s = 0; s < stages_.size(); ++s)
+	{
+		stages_[s].reset();
+	}
+}
+
+double Oversampler::latency() const
+{
+	double latency = 0.0;
+	for (size_t s = 0; s < stages_.size(); ++s)
+	{
+		latency += stages_[s].latency()/(double)(2 << s); // stage s runs at 2^(s + 1) times the base rate
+	}
+	return latency;
+}
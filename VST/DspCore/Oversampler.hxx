@@ -0,0 +1,98 @@
+#ifndef INCLUDED_OVERSAMPLER_HXX
+#define INCLUDED_OVERSAMPLER_HXX
+
+#include <vector>
+
+// ---------------------------------------------------------------------------------------
+// Oversampling for nonlinearities.
+// ---------------------------------------------------------------------------------------
+
+// One 2x stage: a linear phase half-band FIR of 4*halfLength - 1 taps (Kaiser windowed
+// sinc), run in polyphase form. Every other tap of a half-band filter is zero and the centre
+// one is 1/2, so upsampling computes only the even output phase (2*halfLength taps) and
+// copies the input, delayed, to the odd one; downsampling filters the even input phase and
+// adds the odd one, delayed. The convolutions compute 4 outputs per SSE operation.
+class HalfBandStage
+{
+public:
+	HalfBandStage();
+
+	// halfLength >= 2; attenuation in dB sets the Kaiser window. Allocates, clears the state.
+	void setup(int halfLength, double attenuation, int maxInputSamples);
+	void reset();
+
+	// Delay of up plus down, in samples at the higher rate of this stage:
+	int latency() const { return 4*halfLength_ - 2; }
+
+	void upsample(const float *in, float *out, int numSamples);   // out: 2*numSamples
+	void downsample(const float *in, float *out, int numSamples); // in: 2*numSamples
+
+private:
+	int halfLength_;
+	std::vector<float> taps_;     // the 2*halfLength nonzero side taps, reversed, times 2
+	std::vector<float> upInput_;  // 2*halfLength - 1 samples of history, then the block
+	std::vector<float> downEven_; // same for the even and odd phases of the downsampler input
+	std::vector<float> downOdd_;
+};
+
+// Runs a nonlinearity at 2, 4 or 8 times the sample rate: upsamples by a cascade of
+// HalfBandStage, calls the shaper on the oversampled signal and decimates back.
+//
+// The first stage, next to the base rate, has the long filter (flat within 0.01 dB to
+// 0.43 fs, 80 dB down from 0.58 fs); the later ones only have to keep that band and remove
+// its images, and are shorter. What the shaper generates between 0.43 and 0.5 fs, or above
+// the oversampled Nyquist frequency, still folds back.
+//
+// The delay, latency() samples at the base rate, is not a whole number of samples for 4x and
+// 8x; report the rounded value to the host. Factor 1 calls the shaper directly, no delay.
+//
+// setup() allocates; process() does not (it works through fixed chunks of kChunkSize).
+class Oversampler
+{
+public:
+	enum { kMaxFactor = 8, kChunkSize = 64 };
+
+	Oversampler();
+
+	void setup(int factor); // 1, 2, 4 or 8; clears the state
+	void reset();
+
+	int factor() const { return factor_; }
+	double latency() const;
+
+	// Replaces numSamples of buffer by the shaped signal. shaper(float *x, int n) transforms
+	// n samples at the oversampled rate in place (n <= kChunkSize*factor()).
+	template <typename Sample, typename Shaper>
+	void process(Sample *buffer, int numSamples, Shaper shaper)
+	{
+		for (int start = 0; start < numSamples; start += kChunkSize)
+		{
+			const int n = numSamples - start < kChunkSize ? numSamples - start : (int)kChunkSize;
+			for (int j = 0; j < n; ++j)
+			{
+				work_[0][j] = (float)buffer[start + j];
+			}
+			const int numStages = (int)stages_.size();
+			for (int s = 0; s < numStages; ++s)
+			{
+				stages_[s].upsample(work_[s], work_[s + 1], n << s);
+			}
+			shaper(work_[numStages], n << numStages);
+			for (int s = numStages - 1; s >= 0; --s)
+			{
+				stages_[s].downsample(work_[s + 1], work_[s], n << s);
+			}
+			for (int j = 0; j < n; ++j)
+			{
+				buffer[start + j] = (Sample)work_[0][j];
+			}
+		}
+	}
+
+private:
+	int factor_;
+	std::vector<HalfBandStage> stages_;
+	float work_[4][kChunkSize*kMaxFactor]; // the signal at 1x, 2x, 4x and 8x
+};
+
+#endif
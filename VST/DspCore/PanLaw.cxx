@@ -0,0 +1,142 @@
+#include "PanLaw.hxx"
+
+#include "GainRamp.hxx"
+
+#include <cmath>
+
+// ---------------------------------------------------------------------------------------
+// Gain tables:
+// ---------------------------------------------------------------------------------------
+
+const int PAN_TABLE_SIZE = 256; // segments per law
+const int PAN_RAMP_CHUNK = 32;  // samples per straight gain segment while the balance ramps
+
+static float leftGainExact(PanLaw law, double balance)
+{
+	const double halfPi = 1.57079632679489661923;
+	switch (law)
+	{
+		case kPanLawLinear:
+			return (float)(balance < 0.5 ? 1.0 : 2.0*(1.0 - balance));
+		case kPanLaw3dB:
+			return (float)std::cos(balance*halfPi);
+		case kPanLaw4_5dB:
+			return (float)std::sqrt((1.0 - balance)*std::cos(balance*halfPi));
+		case kPanLaw6dB:
+		default:
+			return (float)(1.0 - balance);
+	}
+}
+
+// Left channel gain at balance i/PAN_TABLE_SIZE, plus one guard entry for the interpolation:
+struct PanTables
+{
+	float left[kNumPanLaws][PAN_TABLE_SIZE + 2];
+
+	PanTables()
+	{
+		for (int law = 0; law < kNumPanLaws; ++law)
+		{
+			for (int i = 0; i <= PAN_TABLE_SIZE; ++i)
+			{
+				left[law][i] = leftGainExact((PanLaw)law, (double)i/PAN_TABLE_SIZE);
+			}
+			left[law][PAN_TABLE_SIZE + 1] = left[law][PAN_TABLE_SIZE];
+		}
+	}
+};
+
+static const PanTables panTables; // built when the library is loaded, not on the audio thread
+
+static inline float lookupLeft(const float *table, float balance)
+{
+	float position = balance*(float)PAN_TABLE_SIZE;
+	position = position < 0.0f ? 0.0f : (position > (float)PAN_TABLE_SIZE ? (float)PAN_TABLE_SIZE : position);
+	const int index = (int)position;
+	const float fraction = position - (float)index;
+	return table[index] + fraction*(table[index + 1] - table[index]);
+}
+
+// ---------------------------------------------------------------------------------------
+// Gains:
+// ---------------------------------------------------------------------------------------
+
+const char *panLawName(PanLaw law)
+{
+	switch (law)
+	{
+		case kPanLawLinear: return "0 dB";
+		case kPanLaw3dB:    return "-3 dB";
+		case kPanLaw4_5dB:  return "-4.5 dB";
+		case kPanLaw6dB:    return "-6 dB";
+		default:            return "";
+	}
+}
+
+void panGains(PanLaw law, float balance, float &gainL, float &gainR)
+{
+	const float *table = panTables.left[(unsigned int)law < (unsigned int)kNumPanLaws ? law : kPanLaw3dB];
+	gainL = lookupLeft(table, balance);
+	gainR = lookupLeft(table, 1.0f - balance);
+}
+
+void panGainsExact(PanLaw law, float balance, float &gainL, float &gainR)
+{
+	gainL = leftGainExact(law, balance);
+	gainR = leftGainExact(law, 1.0 - balance);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+template <typename Sample>
+static void smoothedPan(PanLaw law, LinearSmoother &gain, LinearSmoother &balance,
+                        const Sample *const *inputs, Sample *const *outputs, int numSamples)
+{
+	float startL, startR;
+	panGains(law, balance.current(), startL, startR);
+
+	int done = 0;
+	while (done < numSamples)
+	{
+		// One straight segment for both smoothers, short enough to follow the curve of the law:
+		const int remaining = numSamples - done;
+		int length = gain.segmentLength(remaining);
+		if (balance.segmentLength(remaining) < length)
+		{
+			length = balance.segmentLength(remaining);
+		}
+		if (balance.isSmoothing() && length > PAN_RAMP_CHUNK)
+		{
+			length = PAN_RAMP_CHUNK;
+		}
+
+		const float startGain = gain.current();
+		const bool balanceMoves = balance.isSmoothing();
+		gain.skip(length);
+		balance.skip(length);
+
+		float endL = startL, endR = startR;
+		if (balanceMoves)
+		{
+			panGains(law, balance.current(), endL, endR);
+		}
+		applyGainRamp(inputs[0] + done, outputs[0] + done, length, startGain*startL, gain.current()*endL);
+		applyGainRamp(inputs[1] + done, outputs[1] + done, length, startGain*startR, gain.current()*endR);
+
+		startL = endL;
+		startR = endR;
+		done += length;
+	}
+}
+
+void applySmoothedPan(PanLaw law, LinearSmoother &gain, LinearSmoother &balance,
+                      const float *const *inputs, float *const *outputs, int numSamples)
+{
+	smoothedPan(law, gain, balance, inputs, outputs, numSamples);
+}
+
+void applySmoothedPan(PanLaw law, LinearSmoother &gain, LinearSmoother &balance,
+                      const double *const *inputs, double *const *outputs, int numSamples)
+{
+	smoothedPan(law, gain, balance, inputs, outputs, numSamples);
+}
@@ -0,0 +1,41 @@
+#ifndef INCLUDED_PANLAW_HXX
+#define INCLUDED_PANLAW_HXX
+
+#include "Smoother.hxx"
+
+// ---------------------------------------------------------------------------------------
+// Stereo balance/pan laws.
+//
+// balance goes from 0 (left) through 0.5 (centre) to 1 (right). Every law is symmetric:
+// gainR(b) = gainL(1 - b).
+// ---------------------------------------------------------------------------------------
+
+enum PanLaw
+{
+	kPanLawLinear,    // 0 dB centre: the far side fades out linearly, the near side stays at 1
+	kPanLaw3dB,       // -3 dB centre, constant power: cos/sin
+	kPanLaw4_5dB,     // -4.5 dB centre: geometric mean of the -3 dB and -6 dB laws
+	kPanLaw6dB,       // -6 dB centre, constant amplitude: 1 - b, b
+	kNumPanLaws
+};
+
+const char *panLawName(PanLaw law); // short display name, fits kVstMaxParamStrLen
+
+// Gains for a balance value. Interpolated from a 256 segment table built when the library is
+// loaded, so there is no sqrt or trig per call; the error is below 1e-5 for all laws.
+void panGains(PanLaw law, float balance, float &gainL, float &gainR);
+
+// Exact (libm) version of panGains(), for reference.
+void panGainsExact(PanLaw law, float balance, float &gainL, float &gainR);
+
+// Scale a stereo block by a smoothed gain and balance.
+//
+// Each channel goes through the vectorised applyGainRamp(). While the balance ramps, the law
+// is evaluated every PAN_RAMP_CHUNK samples and the gains interpolated linearly in between.
+// The float and double versions share one implementation.
+void applySmoothedPan(PanLaw law, LinearSmoother &gain, LinearSmoother &balance,
+                      const float *const *inputs, float *const *outputs, int numSamples);
+void applySmoothedPan(PanLaw law, LinearSmoother &gain, LinearSmoother &balance,
+                      const double *const *inputs, double *const *outputs, int numSamples);
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef INCLUDED_PARAMETERMAPPING_HXX
+#define INCLUDED_PARAMETERMAPPING_HXX
+
+#include "FastMath.hxx"
+
+#include <cmath>
+
+// ---------------------------------------------------------------------------------------
+// Helper functions for parameters, shared by all plug-ins.
+//
+// VST parameters are normalized floats (0.0f..1.0f); these map them to their natural scale and
+// back. All of them are inline or constexpr templates on the value type, defined here (nothing
+// to link), so they work for float and double alike and fold into constants where they can;
+// the bounds are deduced from the first argument, so norm2exp(value, 20, 10000) still works.
+// The float versions, called from the audio thread on every parameter change, go through the
+// FastMath.hxx approximations (relative error below 1e-6); the double versions, used to build
+// tables, stay exact.
+// ---------------------------------------------------------------------------------------
+
+namespace detail
+{
+	// Turns off template argument deduction for the parameters that use it:
+	template <typename T> struct NonDeduced { typedef T type; };
+
+	inline float exp2(float x) { return fastExp2(x); }
+	inline double exp2(double x) { return std::exp2(x); }
+	inline float log2(float x) { return fastLog2(x); }
+	inline double log2(double x) { return std::log2(x); }
+	inline float decibelsToGain(float decibels) { return fastDecibelsToGain(decibels); }
+	inline double decibelsToGain(double decibels) { return std::pow(10.0, decibels/20.0); }
+}
+
+// Convert normalized value (0..1) to linear scale (min..max):
+template <typename T>
+constexpr T norm2lin(T normalized, typename detail::NonDeduced<T>::type min, typename detail::NonDeduced<T>::type max)
+{
+	return min + (max - min)*normalized;
+}
+
+// Convert linear scale (min..max) to normalized value (0..1):
+template <typename T>
+constexpr T lin2norm(T v, typename detail::NonDeduced<T>::type min, typename detail::NonDeduced<T>::type max)
+{
+	return (v - min)/(max - min);
+}
+
+// Convert normalized value (0..1) to exponential scale (min..max):
+template <typename T>
+inline T norm2exp(T normalized, typename detail::NonDeduced<T>::type min, typename detail::NonDeduced<T>::type max)
+{
+	return min*detail::exp2(normalized*detail::log2(max/min));
+}
+
+// Convert exponential scale (min..max) to normalized value (0..1):
+template <typename T>
+inline T exp2norm(T v, typename detail::NonDeduced<T>::type min, typename detail::NonDeduced<T>::type max)
+{
+	return detail::log2(v/min)/detail::log2(max/min);
+}
+
+// Convert normalized value (0..1) to gain factor.
+// Gain is linear on a dB scale, but below some threshold tapers off linearly (on a linear scale) to 0 (-inf dB).
+// with minDecibels = -36, maxDecibels = 12, norm = 0.75 -> 0 dB
+template <typename T>
+inline T norm2gainFactor(T normalized, typename detail::NonDeduced<T>::type minDecibels = T(-36),
+                         typename detail::NonDeduced<T>::type maxDecibels = T(12), typename detail::NonDeduced<T>::type th = T(0.2))
+{
+	if (normalized >= th)
+	{
+		T gainDecibels = norm2lin(normalized, minDecibels, maxDecibels); // linear on dB scale
+		return detail::decibelsToGain(gainDecibels);
+	}
+	else
+	{
+		T dbAtTh = norm2lin(th, minDecibels, maxDecibels);
+		T linAtTh = detail::decibelsToGain(dbAtTh); // less than 0.05 (with default parameters), so already quite small
+		return linAtTh*normalized/th; // scale so gainFactor is continuous
+	}
+}
+
+// Convert normalized value (0..1) to index (0..n-1):
+template <typename T>
+constexpr int norm2switch(T normalized, int numCases)
+{
+	return (int)(normalized*(numCases - 1) + T(0.5)); // round (for positive values only!)
+}
+
+// Convert index (0..n-1) to normalized value (0..1):
+template <typename T = float>
+constexpr T switch2norm(int idx, int numCases)
+{
+	return (T)idx/(T)(numCases - 1);
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef INCLUDED_PARAMETERSTATE_HXX
+#define INCLUDED_PARAMETERSTATE_HXX
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free handoff of parameter values from the host/GUI thread(s) to the audio thread.
+//
+// setParameter() (any thread) stores the new normalized value and raises the parameter's
+// "changed" bit; the audio thread calls takeChanges() once per block, which returns and clears
+// those bits, and reads the values it needs. No locks, no allocation, safe with several writer
+// threads. Only the latest value of each parameter is seen, which is all a smoother needs.
+class ParameterState
+{
+public:
+	enum { kMaxParameters = 32 }; // one changed bit per parameter in a 32 bit mask
+
+	ParameterState() : changed_(0)
+	{
+		for (int i = 0; i < kMaxParameters; ++i)
+		{
+			values_[i].store(0.0f, std::memory_order_relaxed);
+		}
+	}
+
+	// Any thread:
+	void set(int index, float value)
+	{
+		if (index < 0 || index >= kMaxParameters)
+		{
+			return;
+		}
+		values_[index].store(value, std::memory_order_relaxed);
+		changed_.fetch_or(1u << index, std::memory_order_release); // publishes the value above
+	}
+
+	float get(int index) const
+	{
+		return (index >= 0 && index < kMaxParameters) ? values_[index].load(std::memory_order_relaxed) : 0.0f;
+	}
+
+	// Audio thread: bit i set <=> parameter i changed since the previous call.
+	uint32_t takeChanges()
+	{
+		return changed_.exchange(0, std::memory_order_acquire);
+	}
+
+	static bool hasChanged(uint32_t changes, int index)
+	{
+		return (changes & (1u << index)) != 0;
+	}
+
+private:
+	std::atomic<float> values_[kMaxParameters];
+	std::atomic<uint32_t> changed_;
+};
+
+#endif
@@ -0,0 +1,203 @@
+#include "PartitionedConvolver.hxx"
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <xmmintrin.h>
+#endif
+
+void complexMultiplyAdd(const float *xRe, const float *xIm, const float *hRe, const float *hIm,
+                        float *accRe, float *accIm, int numBins)
+{
+	int k = 0;
+#if defined(__SSE2__)
+	for (; k + 4 <= numBins; k += 4)
+	{
+		const __m128 xr = _mm_loadu_ps(xRe + k), xi = _mm_loadu_ps(xIm + k);
+		const __m128 hr = _mm_loadu_ps(hRe + k), hi = _mm_loadu_ps(hIm + k);
+		_mm_storeu_ps(accRe + k, _mm_add_ps(_mm_loadu_ps(accRe + k), _mm_sub_ps(_mm_mul_ps(xr, hr), _mm_mul_ps(xi, hi))));
+		_mm_storeu_ps(accIm + k, _mm_add_ps(_mm_loadu_ps(accIm + k), _mm_add_ps(_mm_mul_ps(xr, hi), _mm_mul_ps(xi, hr))));
+	}
+#endif
+	for (; k < numBins; ++k)
+	{
+		accRe[k] += xRe[k]*hRe[k] - xIm[k]*hIm[k];
+		accIm[k] += xRe[k]*hIm[k] + xIm[k]*hRe[k];
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// Setup:
+// ---------------------------------------------------------------------------------------
+
+PartitionedConvolver::PartitionedConvolver()
+	: blockSize_(0)
+{
+}
+
+void PartitionedConvolver::setup(const float *ir, int irLength, int blockSize, int maxPartitionSize)
+{
+	blockSize_ = blockSize;
+	stages_.clear();
+	inChunk_.assign(blockSize, 0.0f);
+	outChunk_.assign(blockSize, 0.0f);
+
+	// Stage boundaries: the first stage covers [0, 7*blockSize), a later one of partition size
+	// N [2N - blockSize, 8N - blockSize), where the next one starts:
+	for (int size = blockSize; ; size *= 4)
+	{
+		const int start = size == blockSize ? 0 : 2*size - blockSize;
+		const bool last = size*4 > maxPartitionSize;
+		const int end = last ? irLength : std::min(irLength, 8*size - blockSize);
+		if (start >= irLength)
+		{
+			break;
+		}
+
+		stages_.push_back(Stage());
+		Stage &stage = stages_.back();
+		const int bins = size + 1;
+		stage.size = size;
+		stage.numPartitions = (end - start + size - 1)/size;
+		stage.spread = size > blockSize;
+		stage.fft.setSize(2*size);
+		stage.irRe.assign((size_t)stage.numPartitions*bins, 0.0f);
+		stage.irIm.assign((size_t)stage.numPartitions*bins, 0.0f);
+		stage.fdlRe.assign((size_t)stage.numPartitions*bins, 0.0f);
+		stage.fdlIm.assign((size_t)stage.numPartitions*bins, 0.0f);
+		stage.accRe.assign(bins, 0.0f);
+		stage.accIm.assign(bins, 0.0f);
+		stage.input.assign(2*size, 0.0f);
+		stage.output.assign(size, 0.0f);
+		stage.frame.assign(2*size, 0.0f);
+
+		// Partition spectra, with the 1/2N of the inverse FFT folded in:
+		const float scale = 1.0f/(2.0f*size);
+		for (int p = 0; p < stage.numPartitions; ++p)
+		{
+			std::fill(stage.frame.begin(), stage.frame.end(), 0.0f);
+			for (int n = 0; n < size && start + p*size + n < end; ++n)
+			{
+				stage.frame[n] = ir[start + p*size + n]*scale;
+			}
+			stage.fft.forward(&stage.frame[0], &stage.irRe[(size_t)p*bins], &stage.irIm[(size_t)p*bins]);
+		}
+
+		if (last)
+		{
+			break;
+		}
+	}
+	reset();
+}
+
+void PartitionedConvolver::reset()
+{
+	for (size_t s = 0; s < stages_.size(); ++s)
+	{
+		Stage &stage = stages_[s];
+		std::fill(stage.fdlRe.begin(), stage.fdlRe.end(), 0.0f);
+		std::fill(stage.fdlIm.begin(), stage.fdlIm.end(), 0.0f);
+		std::fill(stage.input.begin(), stage.input.end(), 0.0f);
+		std::fill(stage.output.begin(), stage.output.end(), 0.0f);
+		std::fill(stage.frame.begin(), stage.frame.end(), 0.0f);
+		std::fill(stage.accRe.begin(), stage.accRe.end(), 0.0f);
+		std::fill(stage.accIm.begin(), stage.accIm.end(), 0.0f);
+		stage.fill = 0;
+		stage.head = 0;
+		stage.task = stage.numPartitions + 2; // nothing in progress
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// Processing:
+// ---------------------------------------------------------------------------------------
+
+// numSamples does not cross a blockSize boundary, so no stage completes a block in the middle:
+void PartitionedConvolver::processChunk(const float *in, float *out, int numSamples)
+{
+	std::fill(out, out + numSamples, 0.0f);
+	for (size_t s = 0; s < stages_.size(); ++s)
+	{
+		Stage &stage = stages_[s];
+		float *input = &stage.input[stage.size + stage.fill];
+		const float *output = &stage.output[stage.fill];
+		for (int j = 0; j < numSamples; ++j)
+		{
+			input[j] = in[j];
+			out[j] += output[j];
+		}
+		stage.fill += numSamples;
+		if (stage.fill == stage.size)
+		{
+			startBlock(stage);
+			stage.fill = 0;
+		}
+		if (stage.spread && stage.fill % blockSize_ == 0)
+		{
+			// The share of sub-block k of the partition: the tasks up to (k + 1)/numSubBlocks of
+			// them, so the last sub-block finishes the block:
+			const int numSubBlocks = stage.size/blockSize_;
+			runTasks(stage, (stage.fill/blockSize_ + 1)*(stage.numPartitions + 2)/numSubBlocks);
+		}
+	}
+}
+
+// A block of input is complete: it goes to frame for the tasks, which the first stage runs
+// right away and a later stage over the next partition, once the result of the block before
+// has been handed to output:
+void PartitionedConvolver::startBlock(Stage &stage)
+{
+	const int size = stage.size;
+	const int numTasks = stage.numPartitions + 2;
+	if (stage.spread)
+	{
+		runTasks(stage, numTasks); // normally done, by the last sub-block
+		std::copy(stage.frame.begin() + size, stage.frame.end(), stage.output.begin());
+	}
+	std::copy(stage.input.begin(), stage.input.end(), stage.frame.begin());
+	std::copy(stage.input.begin() + size, stage.input.end(), stage.input.begin());
+	stage.task = 0;
+	if (!stage.spread)
+	{
+		runTasks(stage, numTasks);
+		std::copy(stage.frame.begin() + size, stage.frame.end(), stage.output.begin());
+	}
+}
+
+void PartitionedConvolver::runTasks(Stage &stage, int until)
+{
+	for (; stage.task < until; ++stage.task)
+	{
+		runTask(stage, stage.task);
+	}
+}
+
+// Overlap-save: of the inverse transform of the 2N point circular convolution, the last N
+// samples are the linear convolution of the newest input block. Task 0 transforms the input
+// into the delay line, task 1 + p adds the product of partition p and the input spectrum of p
+// blocks ago, the last task transforms the sum back into frame.
+void PartitionedConvolver::runTask(Stage &stage, int task)
+{
+	const int bins = stage.size + 1;
+	const int partitions = stage.numPartitions;
+	if (task == 0)
+	{
+		stage.head = stage.head + 1 == partitions ? 0 : stage.head + 1;
+		stage.fft.forward(&stage.frame[0], &stage.fdlRe[(size_t)stage.head*bins], &stage.fdlIm[(size_t)stage.head*bins]);
+		std::fill(stage.accRe.begin(), stage.accRe.end(), 0.0f);
+		std::fill(stage.accIm.begin(), stage.accIm.end(), 0.0f);
+	}
+	else if (task <= partitions)
+	{
+		const int p = task - 1;
+		const int slot = stage.head >= p ? stage.head - p : stage.head - p + partitions;
+		complexMultiplyAdd(&stage.fdlRe[(size_t)slot*bins], &stage.fdlIm[(size_t)slot*bins],
+		                   &stage.irRe[(size_t)p*bins], &stage.irIm[(size_t)p*bins],
+		                   &stage.accRe[0], &stage.accIm[0], bins);
+	}
+	else
+	{
+		stage.fft.inverse(&stage.accRe[0], &stage.accIm[0], &stage.frame[0]);
+	}
+}
@@ -0,0 +1,114 @@
+#ifndef INCLUDED_PARTITIONEDCONVOLVER_HXX
+#define INCLUDED_PARTITIONEDCONVOLVER_HXX
+
+#include "RealFft.hxx"
+
+#include <vector>
+
+// ---------------------------------------------------------------------------------------
+// FFT convolution with long impulse responses.
+// ---------------------------------------------------------------------------------------
+
+// Adds the products of the complex spectra x and h to acc, all in split format:
+// acc[k] += x[k]*h[k] for k < numBins. SSE when available.
+void complexMultiplyAdd(const float *xRe, const float *xIm, const float *hRe, const float *hIm,
+                        float *accRe, float *accIm, int numBins);
+
+// Partitioned overlap-save convolution of one channel with an impulse response.
+//
+// The response is cut into partitions whose spectra are computed once in setup(). A stage of
+// partition size N collects N input samples, transforms the last 2N into its frequency-domain
+// delay line (the spectra of the last input blocks, one per partition) and multiplies and
+// adds the delay line with the partition spectra, so a block costs one forward and one
+// inverse FFT of size 2N whatever the response length.
+//
+// Uniform: a single stage of blockSize partitions. Non-uniform: the head of the response in
+// blockSize partitions and the rest in stages of partitions 4x larger each, up to
+// maxPartitionSize, so long responses cost a few large FFTs instead of thousands of small
+// products per block. The first stage computes its block as soon as it completes. A later
+// stage of partition size N starts at response offset 2N - blockSize, one partition later
+// than its N samples of buffering and the blockSize latency would need: its output is due one
+// partition after the input completes, so the forward transform, the products and the inverse
+// transform are spread over the N/blockSize sub-blocks of the next partition (tasks run at
+// the blockSize boundaries), and no host block pays for a whole large stage. Each stage then
+// has 6 partitions (the first 7) but the last.
+//
+// The output is the convolution delayed by latency() = blockSize samples, whatever the host
+// block size. setup() allocates (call it from resume()); process() does not.
+class PartitionedConvolver
+{
+public:
+	PartitionedConvolver();
+
+	// blockSize and maxPartitionSize: powers of two, maxPartitionSize >= blockSize (equal for
+	// uniform partitioning). Clears the delay lines.
+	void setup(const float *ir, int irLength, int blockSize, int maxPartitionSize);
+	void reset(); // silence in the delay lines, as after setup()
+
+	int latency() const { return blockSize_; }
+	int numStages() const { return (int)stages_.size(); }
+	int partitionSize(int stage) const { return stages_[stage].size; }
+	int numPartitions(int stage) const { return stages_[stage].numPartitions; }
+
+	// Streams numSamples from in to out (may be the same buffer), float or double either.
+	// Silence before setup().
+	template <typename InSample, typename OutSample>
+	void process(const InSample *in, OutSample *out, int numSamples)
+	{
+		if (stages_.empty())
+		{
+			for (int j = 0; j < numSamples; ++j)
+			{
+				out[j] = OutSample(0);
+			}
+			return;
+		}
+		while (numSamples > 0)
+		{
+			// Up to the next blockSize boundary, where every stage's partitions start:
+			const int n = blockSize_ - stages_[0].fill < numSamples ? blockSize_ - stages_[0].fill : numSamples;
+			for (int j = 0; j < n; ++j)
+			{
+				inChunk_[j] = (float)in[j];
+			}
+			processChunk(&inChunk_[0], &outChunk_[0], n);
+			for (int j = 0; j < n; ++j)
+			{
+				out[j] = (OutSample)outChunk_[j];
+			}
+			in += n;
+			out += n;
+			numSamples -= n;
+		}
+	}
+
+private:
+	struct Stage
+	{
+		int size;          // partition size N, FFT size 2N
+		int numPartitions;
+		int fill;          // input samples collected in the current block
+		int head;          // delay line slot of the newest input spectrum
+		bool spread;       // output one partition late, computed over the next partition
+		int task;          // next task of the block being computed, numPartitions + 2 when done
+		RealFft fft;
+		std::vector<float> irRe, irIm;   // numPartitions spectra of N + 1 bins, scaled by 1/2N
+		std::vector<float> fdlRe, fdlIm; // numPartitions input spectra, ring
+		std::vector<float> accRe, accIm;
+		std::vector<float> input;        // previous and current block, 2N
+		std::vector<float> output;       // last computed block, read during the next N samples
+		std::vector<float> frame;        // 2N: the input being transformed, then its result
+	};
+
+	void processChunk(const float *in, float *out, int numSamples);
+	void startBlock(Stage &stage);
+	void runTasks(Stage &stage, int numTasks);
+	void runTask(Stage &stage, int task);
+
+	int blockSize_;
+	std::vector<Stage> stages_;
+	std::vector<float> inChunk_;  // blockSize_, for the float conversion
+	std::vector<float> outChunk_;
+};
+
+#endif
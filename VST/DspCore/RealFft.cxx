@@ -0,0 +1,205 @@
+#include "RealFft.hxx"
+
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <xmmintrin.h>
+#endif
+
+RealFft::RealFft()
+	: size_(0), half_(0)
+{
+}
+
+void RealFft::setSize(int size)
+{
+	if (size == size_)
+	{
+		return;
+	}
+	size_ = size;
+	half_ = size/2;
+
+	int bits = 0;
+	while ((1 << bits) < half_)
+	{
+		++bits;
+	}
+	bitReverse_.resize(half_);
+	for (int n = 0; n < half_; ++n)
+	{
+		int reversed = 0;
+		for (int b = 0; b < bits; ++b)
+		{
+			reversed |= ((n >> b) & 1) << (bits - 1 - b);
+		}
+		bitReverse_[n] = reversed;
+	}
+
+	const double pi = 3.14159265358979323846;
+	stageRe_.assign(half_, 0.0f);
+	stageIm_.assign(half_, 0.0f);
+	for (int h = 1; h < half_; h *= 2)
+	{
+		for (int k = 0; k < h; ++k)
+		{
+			stageRe_[h - 1 + k] = (float)std::cos(pi*k/h);
+			stageIm_[h - 1 + k] = (float)-std::sin(pi*k/h);
+		}
+	}
+
+	splitRe_.resize(half_/2 + 1);
+	splitIm_.resize(half_/2 + 1);
+	for (int k = 0; k <= half_/2; ++k)
+	{
+		splitRe_[k] = (float)std::cos(2.0*pi*k/size);
+		splitIm_[k] = (float)-std::sin(2.0*pi*k/size);
+	}
+
+	workRe_.assign(half_ + 1, 0.0f);
+	workIm_.assign(half_ + 1, 0.0f);
+}
+
+// ---------------------------------------------------------------------------------------
+// Complex FFT:
+// ---------------------------------------------------------------------------------------
+
+void RealFft::complexFft(float *re, float *im) const
+{
+	const int n = half_;
+
+	// Stages 1 and 2 (twiddles 1 and -i) together:
+	for (int a = 0; a + 4 <= n; a += 4)
+	{
+		const float r0 = re[a] + re[a + 1], i0 = im[a] + im[a + 1];
+		const float r1 = re[a] - re[a + 1], i1 = im[a] - im[a + 1];
+		const float r2 = re[a + 2] + re[a + 3], i2 = im[a + 2] + im[a + 3];
+		const float r3 = re[a + 2] - re[a + 3], i3 = im[a + 2] - im[a + 3];
+		re[a] = r0 + r2;
+		im[a] = i0 + i2;
+		re[a + 2] = r0 - r2;
+		im[a + 2] = i0 - i2;
+		re[a + 1] = r1 + i3; // (r3 + i*i3)*(-i) = i3 - i*r3
+		im[a + 1] = i1 - r3;
+		re[a + 3] = r1 - i3;
+		im[a + 3] = i1 + r3;
+	}
+	if (n == 2)
+	{
+		const float r0 = re[0], i0 = im[0];
+		re[0] = r0 + re[1];
+		im[0] = i0 + im[1];
+		re[1] = r0 - re[1];
+		im[1] = i0 - im[1];
+	}
+
+	for (int h = 4; h < n; h *= 2)
+	{
+		const float *wr = &stageRe_[h - 1];
+		const float *wi = &stageIm_[h - 1];
+		for (int start = 0; start < n; start += 2*h)
+		{
+			float *ar = re + start, *ai = im + start;
+			float *br = ar + h, *bi = ai + h;
+#if defined(__SSE2__)
+			// h is a multiple of 4 from here on:
+			for (int k = 0; k < h; k += 4)
+			{
+				const __m128 r = _mm_loadu_ps(br + k), i = _mm_loadu_ps(bi + k);
+				const __m128 c = _mm_loadu_ps(wr + k), s = _mm_loadu_ps(wi + k);
+				const __m128 tr = _mm_sub_ps(_mm_mul_ps(r, c), _mm_mul_ps(i, s));
+				const __m128 ti = _mm_add_ps(_mm_mul_ps(r, s), _mm_mul_ps(i, c));
+				const __m128 xr = _mm_loadu_ps(ar + k), xi = _mm_loadu_ps(ai + k);
+				_mm_storeu_ps(br + k, _mm_sub_ps(xr, tr));
+				_mm_storeu_ps(bi + k, _mm_sub_ps(xi, ti));
+				_mm_storeu_ps(ar + k, _mm_add_ps(xr, tr));
+				_mm_storeu_ps(ai + k, _mm_add_ps(xi, ti));
+			}
+#else
+			for (int k = 0; k < h; ++k)
+			{
+				const float tr = br[k]*wr[k] - bi[k]*wi[k];
+				const float ti = br[k]*wi[k] + bi[k]*wr[k];
+				br[k] = ar[k] - tr;
+				bi[k] = ai[k] - ti;
+				ar[k] += tr;
+				ai[k] += ti;
+			}
+#endif
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// Real FFT:
+// ---------------------------------------------------------------------------------------
+
+// With Z the complex FFT of z[n] = x[2n] + i*x[2n + 1], the spectra of the even and odd
+// samples are E[k] = (Z[k] + conj(Z[M - k]))/2 and O[k] = (Z[k] - conj(Z[M - k]))/(2i), and
+// X[k] = E[k] + W^k*O[k], X[M - k] = conj(E[k] - W^k*O[k]), W = e^(-2*i*pi/size), M = size/2.
+
+void RealFft::forward(const float *in, float *re, float *im)
+{
+	const int m = half_;
+	for (int n = 0; n < m; ++n)
+	{
+		re[bitReverse_[n]] = in[2*n];
+		im[bitReverse_[n]] = in[2*n + 1];
+	}
+	complexFft(re, im);
+
+	const float r0 = re[0], i0 = im[0];
+	re[0] = r0 + i0;
+	im[0] = 0.0f;
+	re[m] = r0 - i0;
+	im[m] = 0.0f;
+	for (int k = 1; k <= m/2; ++k)
+	{
+		const int l = m - k;
+		const float er = 0.5f*(re[k] + re[l]), ei = 0.5f*(im[k] - im[l]);
+		const float orr = 0.5f*(im[k] + im[l]), oi = 0.5f*(re[l] - re[k]);
+		const float tr = orr*splitRe_[k] - oi*splitIm_[k];
+		const float ti = orr*splitIm_[k] + oi*splitRe_[k];
+		re[k] = er + tr;
+		im[k] = ei + ti;
+		re[l] = er - tr;
+		im[l] = ti - ei;
+	}
+}
+
+// The inverse undoes the split, E[k] = X[k] + conj(X[M - k]) and
+// O[k] = (X[k] - conj(X[M - k]))*conj(W^k) (both times 2, part of the size scale), then runs
+// the complex FFT with real and imaginary parts swapped, which conjugates it into an inverse.
+void RealFft::inverse(const float *re, const float *im, float *out)
+{
+	const int m = half_;
+	float *zr = &workRe_[0];
+	float *zi = &workIm_[0];
+
+	// Z[k] = E[k] + i*O[k], stored bit reversed:
+	zr[bitReverse_[0]] = re[0] + re[m];
+	zi[bitReverse_[0]] = re[0] - re[m];
+	for (int k = 1; k <= m/2; ++k)
+	{
+		const int l = m - k;
+		const float er = re[k] + re[l], ei = im[k] - im[l];
+		const float dr = re[k] - re[l], di = im[k] + im[l];
+		const float orr = dr*splitRe_[k] + di*splitIm_[k]; // (dr + i*di)*conj(W^k)
+		const float oi = di*splitRe_[k] - dr*splitIm_[k];
+		zr[bitReverse_[k]] = er - oi;
+		zi[bitReverse_[k]] = ei + orr;
+		if (l != k)
+		{
+			// E and O are spectra of real signals: E[l] = conj(E[k]), O[l] = conj(O[k]):
+			zr[bitReverse_[l]] = er + oi;
+			zi[bitReverse_[l]] = orr - ei;
+		}
+	}
+
+	complexFft(zi, zr);
+	for (int n = 0; n < m; ++n)
+	{
+		out[2*n] = zr[n];
+		out[2*n + 1] = zi[n];
+	}
+}
@@ -0,0 +1,50 @@
+#ifndef INCLUDED_REALFFT_HXX
+#define INCLUDED_REALFFT_HXX
+
+#include <vector>
+
+// ---------------------------------------------------------------------------------------
+// FFT of real signals.
+// ---------------------------------------------------------------------------------------
+
+// Real FFT of a power of two size, computed as a complex FFT of half the size (even samples
+// as real part, odd samples as imaginary part) plus a split pass.
+//
+// Spectra are in split format: size/2 + 1 bins of real parts and as many imaginary parts, in
+// two arrays (the imaginary parts of bins 0 and size/2 are 0). The complex FFT works on the
+// same split arrays, so its butterflies are plain loops over contiguous floats that the
+// compiler vectorises. The twiddles of every stage are precomputed, in double, and stored
+// contiguously; the bit reversal is a table.
+//
+// Neither direction is scaled: inverse(forward(x)) = size*x.
+class RealFft
+{
+public:
+	RealFft();
+
+	// Allocates the tables for a size (power of two, >= 4): call from resume(), not from the
+	// audio thread.
+	void setSize(int size);
+	int size() const { return size_; }
+	int numBins() const { return size_/2 + 1; }
+
+	// in: size() samples; re, im: numBins() values each. No allocation.
+	void forward(const float *in, float *re, float *im);
+	void inverse(const float *re, const float *im, float *out);
+
+private:
+	// In place complex FFT of half_ points, input in bit reversed order:
+	void complexFft(float *re, float *im) const;
+
+	int size_;
+	int half_;                       // size_/2, the size of the complex FFT
+	std::vector<int> bitReverse_;    // half_ entries
+	std::vector<float> stageRe_;     // twiddles of the stages, e^(-i*pi*k/h) for k < h, at h - 1
+	std::vector<float> stageIm_;
+	std::vector<float> splitRe_;     // e^(-2*i*pi*k/size) for k <= half_/2
+	std::vector<float> splitIm_;
+	std::vector<float> workRe_;      // half_ + 1, for inverse()
+	std::vector<float> workIm_;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef INCLUDED_SILENCE_HXX
+#define INCLUDED_SILENCE_HXX
+
+// ---------------------------------------------------------------------------------------
+// Silence detection, so that idle tracks cost next to nothing.
+// ---------------------------------------------------------------------------------------
+
+// Peak level at or below which a block counts as silent: -120 dBFS, far below the noise
+// floor of 16 bit audio and far above the subnormal range.
+const float kSilenceThreshold = 1e-6f;
+
+// True if no sample of channels 0..numChannels-1 exceeds threshold in magnitude. The inner
+// loop has no early exit and ORs comparisons rather than tracking a peak (a floating point
+// max reduction does not vectorize without -ffast-math); the test is per channel.
+template <typename Sample>
+inline bool isSilent(const Sample *const *channels, int numChannels, int numSamples, float threshold = kSilenceThreshold)
+{
+	for (int c = 0; c < numChannels; ++c)
+	{
+		const Sample *x = channels[c];
+		const Sample high = (Sample)threshold, low = -high;
+		int loud = 0;
+		for (int j = 0; j < numSamples; ++j)
+		{
+			loud |= (x[j] > high) | (x[j] < low);
+		}
+		if (loud != 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+template <typename Sample>
+inline void clearChannels(Sample *const *channels, int numChannels, int numSamples)
+{
+	for (int c = 0; c < numChannels; ++c)
+	{
+		for (int j = 0; j < numSamples; ++j)
+		{
+			channels[c][j] = Sample(0);
+		}
+	}
+}
+
+// Decides, block by block, when an effect can stop processing: once its input has been
+// silent for longer than its tail (how long the output rings after the last non-silent
+// input: latency plus impulse response length, say), the output is silence too and the
+// block is skipped, outputs cleared. The first non-silent block re-arms it.
+//
+// Skipping is exact up to the threshold: the state the effect is left with only holds the
+// silent input of the last tail samples, as it would after processing the skipped blocks.
+class SilenceGate
+{
+public:
+	SilenceGate() : tail_(0), remaining_(0) {}
+
+	void setTail(int numSamples) { tail_ = numSamples; }
+	int tail() const { return tail_; }
+
+	// Idle, as after a reset of the effect's state:
+	void reset() { remaining_ = 0; }
+
+	// Call once per block; false if the block can be skipped:
+	bool next(bool inputSilent, int numSamples)
+	{
+		if (!inputSilent)
+		{
+			remaining_ = tail_; // counted from the end of this block
+			return true;
+		}
+		if (remaining_ > 0)
+		{
+			remaining_ -= numSamples;
+			return true;
+		}
+		return false;
+	}
+
+	bool isIdle() const { return remaining_ <= 0; }
+
+private:
+	int tail_;
+	int remaining_;
+};
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef INCLUDED_SMOOTHER_HXX
+#define INCLUDED_SMOOTHER_HXX
+
+#include "FastMath.hxx"
+
+#include <algorithm>
+#include <cmath>
+
+// ---------------------------------------------------------------------------------------
+// Parameter smoothers, used on the audio thread only.
+//
+// Ramp times are given in milliseconds, so the result does not depend on the block size the
+// host happens to use. Call setRampTime()/setTimeConstant() from resume(), when the sample
+// rate is known.
+// ---------------------------------------------------------------------------------------
+
+// Linear ramp to the target in a fixed time.
+class LinearSmoother
+{
+public:
+	LinearSmoother() : current_(0.0f), target_(0.0f), step_(0.0f), rampSamples_(1), remaining_(0) {}
+
+	void setRampTime(float milliseconds, float sampleRate)
+	{
+		rampSamples_ = (int)(milliseconds*0.001f*sampleRate + 0.5f);
+		if (rampSamples_ < 1)
+		{
+			rampSamples_ = 1;
+		}
+	}
+
+	// Jump to value without ramping:
+	void reset(float value)
+	{
+		current_ = target_ = value;
+		step_ = 0.0f;
+		remaining_ = 0;
+	}
+
+	// Start a new ramp from the current value:
+	void setTarget(float target)
+	{
+		if (target == target_)
+		{
+			return;
+		}
+		target_ = target;
+		remaining_ = rampSamples_;
+		step_ = (target_ - current_)/(float)rampSamples_;
+	}
+
+	float current() const { return current_; }
+	float target() const { return target_; }
+	bool isSmoothing() const { return remaining_ > 0; }
+
+	// Per-sample use: returns the value for this sample and advances to the next one
+	// (so sample k of a ramp gets start + step*k, like applyGainRamp()).
+	float next()
+	{
+		const float value = current_;
+		if (remaining_ > 0)
+		{
+			current_ = --remaining_ > 0 ? current_ + step_ : target_;
+		}
+		return value;
+	}
+
+	// Block use: within the next maxSamples, the number of samples that form one straight
+	// segment (the rest of the ramp, or everything if not ramping).
+	int segmentLength(int maxSamples) const
+	{
+		return (remaining_ > 0 && remaining_ < maxSamples) ? remaining_ : maxSamples;
+	}
+
+	// Advance numSamples samples at once (numSamples <= segmentLength() keeps it exact):
+	void skip(int numSamples)
+	{
+		if (remaining_ <= 0)
+		{
+			return;
+		}
+		if (numSamples >= remaining_)
+		{
+			reset(target_);
+		}
+		else
+		{
+			remaining_ -= numSamples;
+			current_ += step_*(float)numSamples;
+		}
+	}
+
+private:
+	float current_;
+	float target_;
+	float step_;
+	int rampSamples_;
+	int remaining_;
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Exponential (one-pole low-pass) approach to the target; feels natural for frequencies.
+class OnePoleSmoother
+{
+public:
+	OnePoleSmoother() : current_(0.0f), target_(0.0f), coeff_(1.0f), log2Decay_(-126.0f), threshold_(1e-5f) {}
+
+	// Time to cover 1 - 1/e (63%) of a jump:
+	void setTimeConstant(float milliseconds, float sampleRate)
+	{
+		const float samples = milliseconds*0.001f*sampleRate;
+		coeff_ = samples > 1.0f ? 1.0f - std::exp(-1.0f/samples) : 1.0f;
+		log2Decay_ = coeff_ < 1.0f ? std::max(std::log2(1.0f - coeff_), -126.0f) : -126.0f;
+	}
+
+	// Distance to the target below which the smoother snaps to it and stops:
+	void setThreshold(float threshold) { threshold_ = threshold; }
+
+	void reset(float value) { current_ = target_ = value; }
+	void setTarget(float target) { target_ = target; }
+
+	float current() const { return current_; }
+	float target() const { return target_; }
+	bool isSmoothing() const { return current_ != target_; }
+
+	float next()
+	{
+		if (current_ != target_)
+		{
+			current_ += coeff_*(target_ - current_);
+			if (std::fabs(target_ - current_) < threshold_)
+			{
+				current_ = target_;
+			}
+		}
+		return current_;
+	}
+
+	// Advance numSamples samples at once (closed form of numSamples calls to next(), with
+	// (1 - coeff)^numSamples as a fastExp2(), no pow() per block):
+	void skip(int numSamples)
+	{
+		if (current_ != target_)
+		{
+			current_ = target_ + (current_ - target_)*fastExp2(log2Decay_*(float)numSamples);
+			if (std::fabs(target_ - current_) < threshold_)
+			{
+				current_ = target_;
+			}
+		}
+	}
+
+private:
+	float current_;
+	float target_;
+	float coeff_;
+	float log2Decay_; // log2(1 - coeff_), at least -126
+	float threshold_;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef INCLUDED_SPSCRING_HXX
+#define INCLUDED_SPSCRING_HXX
+
+#include <atomic>
+
+// ---------------------------------------------------------------------------------------
+// Lock-free ring buffer with one producer thread and one consumer thread.
+// ---------------------------------------------------------------------------------------
+
+// Neither side ever waits: push() on a full ring and pop() on an empty one return false. The
+// producer only writes head_ and the consumer only tail_, each publishing its slot with a
+// release store that the other side reads with an acquire load; the two indexes sit on
+// separate cache lines so that the audio thread pushing does not keep stealing the line the
+// consumer writes. T is copied by assignment, so keep it small and trivially copyable.
+// Capacity must be a power of two (the indexes wrap freely and are masked).
+template <typename T, int Capacity>
+class SpscRing
+{
+public:
+	SpscRing() : head_(0), tail_(0) {}
+
+	// Producer side; false (and the item is dropped) when the ring is full:
+	bool push(const T &item)
+	{
+		const unsigned head = head_.load(std::memory_order_relaxed);
+		if (head - tail_.load(std::memory_order_acquire) == (unsigned)Capacity)
+		{
+			return false;
+		}
+		items_[head & kMask] = item;
+		head_.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side; false when the ring is empty:
+	bool pop(T &item)
+	{
+		const unsigned tail = tail_.load(std::memory_order_relaxed);
+		if (tail == head_.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		item = items_[tail & kMask];
+		tail_.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Items waiting, from either side (a snapshot: the other side may change it right away):
+	int size() const { return (int)(head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire)); }
+	static int capacity() { return Capacity; }
+
+private:
+	SpscRing(const SpscRing &);
+	SpscRing &operator=(const SpscRing &);
+
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+	enum { kMask = Capacity - 1 };
+
+	std::atomic<unsigned> head_; // next slot to write, producer only
+	char padding0_[64];
+	std::atomic<unsigned> tail_; // next slot to read, consumer only
+	char padding1_[64];
+	T items_[Capacity];
+};
+
+#endif
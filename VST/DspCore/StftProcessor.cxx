@@ -0,0 +1,76 @@
+#include "StftProcessor.hxx"
+
+#include <cmath>
+
+StftProcessor::StftProcessor()
+	: hop_(0), position_(0), untilFrame_(0)
+{
+}
+
+void StftProcessor::setup(int windowSize, int overlap)
+{
+	fft_.setSize(windowSize);
+	hop_ = windowSize/overlap;
+
+	// sqrt(Hann) twice is a Hann window, whose periodic copies every hop add up to overlap/2:
+	const double pi = 3.14159265358979323846;
+	analysisWindow_.resize(windowSize);
+	synthesisWindow_.resize(windowSize);
+	for (int n = 0; n < windowSize; ++n)
+	{
+		const double w = std::sqrt(0.5 - 0.5*std::cos(2.0*pi*n/windowSize));
+		analysisWindow_[n] = (float)w;
+		synthesisWindow_[n] = (float)(w*2.0/((double)overlap*windowSize));
+	}
+
+	input_.resize(windowSize);
+	output_.resize(windowSize);
+	frame_.resize(windowSize);
+	re_.resize(fft_.numBins());
+	im_.resize(fft_.numBins());
+	reset();
+}
+
+void StftProcessor::reset()
+{
+	input_.assign(input_.size(), 0.0f);
+	output_.assign(output_.size(), 0.0f);
+	position_ = 0;
+	untilFrame_ = hop_;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// position_ is at the oldest sample of the input ring, so the frame is
+// input_[position_..size) followed by input_[0..position_):
+void StftProcessor::analyse()
+{
+	const int size = windowSize();
+	const int first = size - position_;
+	for (int n = 0; n < first; ++n)
+	{
+		frame_[n] = input_[position_ + n]*analysisWindow_[n];
+	}
+	for (int n = first; n < size; ++n)
+	{
+		frame_[n] = input_[n - first]*analysisWindow_[n];
+	}
+	fft_.forward(&frame_[0], &re_[0], &im_[0]);
+}
+
+// Frame sample n is due at output ring position position_ + n, windowSize samples after the
+// input sample it comes from:
+void StftProcessor::synthesise()
+{
+	fft_.inverse(&re_[0], &im_[0], &frame_[0]);
+	const int size = windowSize();
+	const int first = size - position_;
+	for (int n = 0; n < first; ++n)
+	{
+		output_[position_ + n] += frame_[n]*synthesisWindow_[n];
+	}
+	for (int n = first; n < size; ++n)
+	{
+		output_[n - first] += frame_[n]*synthesisWindow_[n];
+	}
+}
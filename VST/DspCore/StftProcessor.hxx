@@ -0,0 +1,98 @@
+#ifndef INCLUDED_STFTPROCESSOR_HXX
+#define INCLUDED_STFTPROCESSOR_HXX
+
+#include "RealFft.hxx"
+
+#include <vector>
+
+// ---------------------------------------------------------------------------------------
+// Streaming short-time Fourier transform.
+// ---------------------------------------------------------------------------------------
+
+// Overlap-add STFT of one channel, the equivalent of a Pure Data subpatch with
+// "block~ windowSize overlap": every hopSize() = windowSize/overlap input samples, the last
+// windowSize samples are windowed and transformed, the spectrum is handed to the caller to
+// modify in place, and its inverse is windowed again and added to the output.
+//
+// Analysis and synthesis windows are both the square root of a periodic Hann window, so a
+// frame that is not modified comes out unchanged for any overlap >= 2: the output is the
+// input delayed by latency() = windowSize samples.
+//
+// setup() allocates the ring buffers and the FFT tables (call it from resume()); process()
+// does not allocate and takes any number of samples, so the host block size does not have
+// to be related to the window size.
+class StftProcessor
+{
+public:
+	StftProcessor();
+
+	// windowSize: power of two >= 4; overlap: power of two, 2..windowSize. Clears the buffers.
+	void setup(int windowSize, int overlap);
+	void reset(); // silence in the buffers, as after setup()
+
+	int windowSize() const { return fft_.size(); }
+	int hopSize() const { return hop_; }
+	int numBins() const { return fft_.numBins(); }
+	int latency() const { return fft_.size(); }
+
+	// Streams numSamples from in to out (may be the same buffer); calls
+	// processFrame(float *re, float *im, int numBins) for every frame that completes.
+	// Outputs silence before the first setup().
+	template <typename Sample, typename ProcessFrame>
+	void process(const Sample *in, Sample *out, int numSamples, ProcessFrame processFrame)
+	{
+		if (hop_ == 0)
+		{
+			for (int j = 0; j < numSamples; ++j)
+			{
+				out[j] = Sample(0);
+			}
+			return;
+		}
+		while (numSamples > 0)
+		{
+			// Up to the next frame; the hop divides the window, so this never wraps the rings:
+			const int n = numSamples < untilFrame_ ? numSamples : untilFrame_;
+			float *input = &input_[position_];
+			float *output = &output_[position_];
+			for (int j = 0; j < n; ++j)
+			{
+				input[j] = (float)in[j];
+				out[j] = (Sample)output[j];
+				output[j] = 0.0f;
+			}
+			in += n;
+			out += n;
+			numSamples -= n;
+			position_ += n;
+			untilFrame_ -= n;
+
+			if (untilFrame_ == 0)
+			{
+				position_ = position_ == windowSize() ? 0 : position_;
+				untilFrame_ = hop_;
+				analyse();
+				processFrame(&re_[0], &im_[0], numBins());
+				synthesise();
+			}
+		}
+	}
+
+private:
+	void analyse();    // windowed input ring to re_, im_
+	void synthesise(); // re_, im_ to windowed frame added to the output ring
+
+	RealFft fft_;
+	int hop_;
+	int position_;             // of the next sample in both rings
+	int untilFrame_;           // samples until the next frame
+	std::vector<float> analysisWindow_;
+	std::vector<float> synthesisWindow_; // includes 1/windowSize and the overlap-add gain
+	std::vector<float> input_;           // ring of the last windowSize input samples
+	std::vector<float> output_;          // ring of overlap-add sums, read windowSize samples later
+	std::vector<float> frame_;
+	std::vector<float> re_;
+	std::vector<float> im_;
+};
+
+#endif
@@ -0,0 +1,438 @@
+#include "WavFile.hxx"
+
+#include <cmath>
+#include <cstring>
+
+// Little endian fields, independent of the host byte order:
+static unsigned int readLe16(const unsigned char *p)
+{
+	return (unsigned int)p[0] | ((unsigned int)p[1] << 8);
+}
+
+static unsigned int readLe32(const unsigned char *p)
+{
+	return (unsigned int)p[0] | ((unsigned int)p[1] << 8) | ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static unsigned long long readLe64(const unsigned char *p)
+{
+	return readLe32(p) | ((unsigned long long)readLe32(p + 4) << 32);
+}
+
+static void writeLe16(unsigned char *p, unsigned int value)
+{
+	p[0] = (unsigned char)value;
+	p[1] = (unsigned char)(value >> 8);
+}
+
+static void writeLe32(unsigned char *p, unsigned int value)
+{
+	for (int b = 0; b < 4; ++b)
+	{
+		p[b] = (unsigned char)(value >> (8*b));
+	}
+}
+
+static void writeLe64(unsigned char *p, unsigned long long value)
+{
+	writeLe32(p, (unsigned int)value);
+	writeLe32(p + 4, (unsigned int)(value >> 32));
+}
+
+// ---------------------------------------------------------------------------------------
+// WavReader:
+// ---------------------------------------------------------------------------------------
+
+WavReader::WavReader()
+	: file_(NULL), numChannels_(0), sampleRate_(0.0), numFrames_(0), framesLeft_(0), bytesPerSample_(0), isFloat_(false)
+{
+}
+
+WavReader::~WavReader()
+{
+	close();
+}
+
+void WavReader::close()
+{
+	if (file_ != NULL)
+	{
+		std::fclose(file_);
+		file_ = NULL;
+	}
+	numChannels_ = 0;
+	numFrames_ = framesLeft_ = 0;
+}
+
+bool WavReader::fail(const std::string &message)
+{
+	close();
+	error_ = message;
+	return false;
+}
+
+bool WavReader::open(const char *path)
+{
+	close();
+	error_.clear();
+
+	file_ = std::fopen(path, "rb");
+	if (file_ == NULL)
+	{
+		return fail(std::string("cannot open ") + path);
+	}
+
+	unsigned char header[12];
+	if (std::fread(header, 1, 12, file_) != 12 || (std::memcmp(header, "RIFF", 4) != 0 && std::memcmp(header, "RF64", 4) != 0)
+	    || std::memcmp(header + 8, "WAVE", 4) != 0)
+	{
+		return fail(std::string(path) + ": not a RIFF WAVE file");
+	}
+
+	// Chunks until "data", which must come after "fmt " (and, in RF64, "ds64"):
+	bool haveFormat = false;
+	unsigned long long dataSize64 = 0;
+	for (;;)
+	{
+		unsigned char chunk[8];
+		if (std::fread(chunk, 1, 8, file_) != 8)
+		{
+			return fail(std::string(path) + ": no data chunk");
+		}
+		const unsigned long size = readLe32(chunk + 4);
+		if (std::memcmp(chunk, "ds64", 4) == 0)
+		{
+			unsigned char ds64[16];
+			if (size < 16 || std::fread(ds64, 1, 16, file_) != 16)
+			{
+				return fail(std::string(path) + ": bad ds64 chunk");
+			}
+			dataSize64 = readLe64(ds64 + 8); // after the 64 bit RIFF size
+			std::fseek(file_, (long)(size - 16 + (size & 1)), SEEK_CUR);
+		}
+		else if (std::memcmp(chunk, "fmt ", 4) == 0)
+		{
+			unsigned char format[40];
+			std::memset(format, 0, sizeof(format));
+			const size_t toRead = size < sizeof(format) ? size : sizeof(format);
+			if (size < 16 || std::fread(format, 1, toRead, file_) != toRead)
+			{
+				return fail(std::string(path) + ": bad fmt chunk");
+			}
+			unsigned int tag = readLe16(format);
+			if (tag == 0xFFFE && size >= 40)
+			{
+				tag = readLe16(format + 24); // WAVE_FORMAT_EXTENSIBLE: first 2 bytes of the subformat GUID
+			}
+			numChannels_ = (int)readLe16(format + 2);
+			sampleRate_ = (double)readLe32(format + 4);
+			const int bits = (int)readLe16(format + 14);
+			bytesPerSample_ = (bits + 7)/8;
+			isFloat_ = tag == 3;
+			if (!((tag == 1 && bits >= 8 && bits <= 32) || (tag == 3 && (bits == 32 || bits == 64))) || numChannels_ <= 0)
+			{
+				return fail(std::string(path) + ": unsupported sample format");
+			}
+			haveFormat = true;
+			std::fseek(file_, (long)(size - toRead + (size & 1)), SEEK_CUR);
+		}
+		else if (std::memcmp(chunk, "data", 4) == 0)
+		{
+			if (!haveFormat)
+			{
+				return fail(std::string(path) + ": data chunk before fmt chunk");
+			}
+			const unsigned long long dataSize = size == 0xFFFFFFFFul && dataSize64 > 0 ? dataSize64 : size;
+			numFrames_ = framesLeft_ = (long)(dataSize/((unsigned long long)bytesPerSample_*numChannels_));
+			return true;
+		}
+		else
+		{
+			std::fseek(file_, (long)(size + (size & 1)), SEEK_CUR); // chunks are padded to even sizes
+		}
+	}
+}
+
+bool WavReader::openRaw(const char *path, int numChannels, double sampleRate, int bits, bool isFloat)
+{
+	close();
+	error_.clear();
+	if (numChannels <= 0 || !((!isFloat && (bits == 8 || bits == 16 || bits == 24 || bits == 32)) || (isFloat && (bits == 32 || bits == 64))))
+	{
+		return fail("unsupported raw sample format");
+	}
+	file_ = std::fopen(path, "rb");
+	if (file_ == NULL)
+	{
+		return fail(std::string("cannot open ") + path);
+	}
+	std::fseek(file_, 0, SEEK_END);
+	const long size = std::ftell(file_);
+	std::fseek(file_, 0, SEEK_SET);
+	numChannels_ = numChannels;
+	sampleRate_ = sampleRate;
+	bytesPerSample_ = bits/8;
+	isFloat_ = isFloat;
+	numFrames_ = framesLeft_ = size > 0 ? size/((long)bytesPerSample_*numChannels_) : 0;
+	return true;
+}
+
+long WavReader::read(float *interleaved, long numFrames)
+{
+	if (file_ == NULL)
+	{
+		return 0;
+	}
+	numFrames = numFrames < framesLeft_ ? numFrames : framesLeft_;
+	const size_t frameBytes = (size_t)bytesPerSample_*numChannels_;
+	buffer_.resize((size_t)numFrames*frameBytes);
+	const long frames = numFrames > 0 ? (long)(std::fread(&buffer_[0], frameBytes, (size_t)numFrames, file_)) : 0;
+	framesLeft_ = frames == numFrames ? framesLeft_ - frames : 0;
+
+	const long count = frames*numChannels_;
+	const unsigned char *p = buffer_.empty() ? NULL : &buffer_[0];
+	for (long i = 0; i < count; ++i, p += bytesPerSample_)
+	{
+		float value;
+		if (isFloat_ && bytesPerSample_ == 4)
+		{
+			const unsigned int bits = readLe32(p);
+			std::memcpy(&value, &bits, 4);
+		}
+		else if (isFloat_)
+		{
+			const unsigned long long bits = readLe32(p) | ((unsigned long long)readLe32(p + 4) << 32);
+			double d;
+			std::memcpy(&d, &bits, 8);
+			value = (float)d;
+		}
+		else if (bytesPerSample_ == 1)
+		{
+			value = ((int)p[0] - 128)*(1.0f/128.0f); // 8 bit WAV is unsigned
+		}
+		else
+		{
+			// Signed, left aligned into 32 bits:
+			unsigned int bits = 0;
+			for (int b = 0; b < bytesPerSample_; ++b)
+			{
+				bits |= (unsigned int)p[b] << (8*(4 - bytesPerSample_ + b));
+			}
+			value = (float)(int)bits*(1.0f/2147483648.0f);
+		}
+		interleaved[i] = value;
+	}
+	return frames;
+}
+
+// ---------------------------------------------------------------------------------------
+// WavWriter:
+// ---------------------------------------------------------------------------------------
+
+// Header layout: RIFF (12 bytes), JUNK reserved for ds64 (36), fmt (24), data (8):
+enum { kJunkOffset = 12, kFormatOffset = 48, kDataOffset = 72, kHeaderSize = 80 };
+
+WavWriter::WavWriter()
+	: file_(NULL), raw_(false), numChannels_(0), bytesPerSample_(0), isFloat_(false), numFrames_(0)
+{
+}
+
+WavWriter::~WavWriter()
+{
+	close();
+}
+
+bool WavWriter::fail(const std::string &message)
+{
+	if (file_ != NULL)
+	{
+		std::fclose(file_);
+		file_ = NULL;
+	}
+	error_ = message;
+	return false;
+}
+
+bool WavWriter::start(const char *path, int numChannels, int bits, bool isFloat)
+{
+	close();
+	error_.clear();
+	if (numChannels <= 0 || !((!isFloat && (bits == 16 || bits == 24 || bits == 32)) || (isFloat && bits == 32)))
+	{
+		return fail("unsupported output sample format");
+	}
+	file_ = std::fopen(path, "wb");
+	if (file_ == NULL)
+	{
+		return fail(std::string("cannot create ") + path);
+	}
+	numChannels_ = numChannels;
+	bytesPerSample_ = bits/8;
+	isFloat_ = isFloat;
+	numFrames_ = 0;
+	return true;
+}
+
+bool WavWriter::open(const char *path, int numChannels, double sampleRate, int bits, bool isFloat)
+{
+	if (!start(path, numChannels, bits, isFloat))
+	{
+		return false;
+	}
+	raw_ = false;
+
+	// Sizes are filled in by close():
+	unsigned char header[kHeaderSize];
+	std::memset(header, 0, sizeof(header));
+	std::memcpy(header, "RIFF", 4);
+	std::memcpy(header + 8, "WAVE", 4);
+	std::memcpy(header + kJunkOffset, "JUNK", 4);
+	writeLe32(header + kJunkOffset + 4, 28);
+	unsigned char *format = header + kFormatOffset;
+	std::memcpy(format, "fmt ", 4);
+	writeLe32(format + 4, 16);
+	writeLe16(format + 8, isFloat ? 3 : 1);
+	writeLe16(format + 10, (unsigned int)numChannels);
+	writeLe32(format + 12, (unsigned int)sampleRate);
+	writeLe32(format + 16, (unsigned int)sampleRate*(unsigned int)(numChannels*bytesPerSample_));
+	writeLe16(format + 20, (unsigned int)(numChannels*bytesPerSample_));
+	writeLe16(format + 22, (unsigned int)bits);
+	std::memcpy(header + kDataOffset, "data", 4);
+	if (std::fwrite(header, 1, sizeof(header), file_) != sizeof(header))
+	{
+		return fail(std::string("cannot write ") + path);
+	}
+	return true;
+}
+
+bool WavWriter::openRaw(const char *path, int numChannels, int bits, bool isFloat)
+{
+	if (!start(path, numChannels, bits, isFloat))
+	{
+		return false;
+	}
+	raw_ = true;
+	return true;
+}
+
+bool WavWriter::write(const float *interleaved, long numFrames)
+{
+	if (file_ == NULL)
+	{
+		return false;
+	}
+	const long count = numFrames*numChannels_;
+	buffer_.resize((size_t)count*bytesPerSample_);
+	unsigned char *p = buffer_.empty() ? NULL : &buffer_[0];
+	const double scale = std::ldexp(1.0, 8*bytesPerSample_ - 1);
+	for (long i = 0; i < count; ++i, p += bytesPerSample_)
+	{
+		if (isFloat_)
+		{
+			unsigned int bits;
+			std::memcpy(&bits, &interleaved[i], 4);
+			writeLe32(p, bits);
+			continue;
+		}
+		double value = std::floor(interleaved[i]*scale + 0.5);
+		value = value < -scale ? -scale : (value > scale - 1.0 ? scale - 1.0 : value);
+		const unsigned int bits = (unsigned int)(int)value;
+		for (int b = 0; b < bytesPerSample_; ++b)
+		{
+			p[b] = (unsigned char)(bits >> (8*b));
+		}
+	}
+	if (count > 0 && std::fwrite(&buffer_[0], 1, buffer_.size(), file_) != buffer_.size())
+	{
+		return fail("write error (disk full?)");
+	}
+	numFrames_ += numFrames;
+	return true;
+}
+
+bool WavWriter::close()
+{
+	if (file_ == NULL)
+	{
+		return error_.empty();
+	}
+	if (!raw_)
+	{
+		const unsigned long long dataSize = (unsigned long long)numFrames_*numChannels_*bytesPerSample_;
+		const unsigned long long riffSize = kHeaderSize - 8 + dataSize + (dataSize & 1);
+		if ((dataSize & 1) != 0 && std::fputc(0, file_) == EOF) // chunks are padded to even sizes
+		{
+			return fail("write error (disk full?)");
+		}
+		unsigned char size[4];
+		if (riffSize <= 0xFFFFFFFFull)
+		{
+			writeLe32(size, (unsigned int)riffSize);
+			std::fseek(file_, 4, SEEK_SET);
+			std::fwrite(size, 1, 4, file_);
+			writeLe32(size, (unsigned int)dataSize);
+		}
+		else
+		{
+			// RF64: 32 bit sizes of -1, the real ones in the ds64 chunk that replaces JUNK:
+			unsigned char ds64[36];
+			std::memcpy(ds64, "ds64", 4);
+			writeLe32(ds64 + 4, 28);
+			writeLe64(ds64 + 8, riffSize);
+			writeLe64(ds64 + 16, dataSize);
+			writeLe64(ds64 + 24, (unsigned long long)numFrames_);
+			writeLe32(ds64 + 32, 0);
+			unsigned char riff[8];
+			std::memcpy(riff, "RF64", 4);
+			writeLe32(riff + 4, 0xFFFFFFFFu);
+			std::fseek(file_, 0, SEEK_SET);
+			std::fwrite(riff, 1, 8, file_);
+			std::fseek(file_, kJunkOffset, SEEK_SET);
+			std::fwrite(ds64, 1, sizeof(ds64), file_);
+			writeLe32(size, 0xFFFFFFFFu);
+		}
+		std::fseek(file_, kDataOffset + 4, SEEK_SET);
+		std::fwrite(size, 1, 4, file_);
+	}
+	const bool ok = std::ferror(file_) == 0;
+	if (std::fclose(file_) != 0 || !ok)
+	{
+		file_ = NULL;
+		return fail("write error (disk full?)");
+	}
+	file_ = NULL;
+	return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+bool readWavFile(const char *path, std::vector<std::vector<float> > &channels, double &sampleRate, std::string &error)
+{
+	WavReader reader;
+	if (!reader.open(path))
+	{
+		error = reader.errorMessage();
+		return false;
+	}
+	const int numChannels = reader.numChannels();
+	channels.assign(numChannels, std::vector<float>());
+	for (int c = 0; c < numChannels; ++c)
+	{
+		channels[c].reserve(reader.numFrames());
+	}
+	sampleRate = reader.sampleRate();
+
+	std::vector<float> chunk(4096*(size_t)numChannels);
+	long frames;
+	while ((frames = reader.read(&chunk[0], 4096)) > 0)
+	{
+		for (long j = 0; j < frames; ++j)
+		{
+			for (int c = 0; c < numChannels; ++c)
+			{
+				channels[c].push_back(chunk[(size_t)j*numChannels + c]);
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,100 @@
+#ifndef INCLUDED_WAVFILE_HXX
+#define INCLUDED_WAVFILE_HXX
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------------------
+// WAV file reading and writing.
+// ---------------------------------------------------------------------------------------
+
+// Streaming reader of RIFF WAVE files: integer PCM of 8, 16, 24 or 32 bits and IEEE float of
+// 32 or 64 bits (also in WAVE_FORMAT_EXTENSIBLE files), returned as interleaved floats in
+// -1..1. Reads in chunks, so files of any length can be processed with constant memory;
+// RF64 files (EBU Tech 3306, WAV beyond 4 GB) are read too. openRaw() reads headerless
+// little endian samples the same way.
+//
+// For files and tools, not for the audio thread.
+class WavReader
+{
+public:
+	WavReader();
+	~WavReader();
+
+	bool open(const char *path); // returns false and sets errorMessage() on failure
+	bool openRaw(const char *path, int numChannels, double sampleRate, int bits, bool isFloat);
+	void close();
+
+	bool isOpen() const { return file_ != NULL; }
+	const std::string &errorMessage() const { return error_; }
+
+	int numChannels() const { return numChannels_; }
+	double sampleRate() const { return sampleRate_; }
+	long numFrames() const { return numFrames_; }
+
+	// Reads up to numFrames frames (numFrames*numChannels() floats) into interleaved; returns
+	// the number of frames read, 0 at the end of the data or on a read error.
+	long read(float *interleaved, long numFrames);
+
+private:
+	WavReader(const WavReader &);
+	WavReader &operator=(const WavReader &);
+
+	bool fail(const std::string &message);
+
+	FILE *file_;
+	std::string error_;
+	int numChannels_;
+	double sampleRate_;
+	long numFrames_;
+	long framesLeft_;
+	int bytesPerSample_;
+	bool isFloat_;
+	std::vector<unsigned char> buffer_; // raw bytes of one read() chunk
+};
+
+// Streaming writer of WAV files: integer PCM of 16, 24 or 32 bits or 32 bit IEEE float, from
+// interleaved floats in -1..1 (integers are rounded and clipped). close() fills in the sizes;
+// a file that grows beyond 4 GB becomes RF64, through the JUNK chunk reserved for it after
+// the header. openRaw() writes the samples only, no header.
+//
+// For files and tools, not for the audio thread.
+class WavWriter
+{
+public:
+	WavWriter();
+	~WavWriter(); // closes
+
+	bool open(const char *path, int numChannels, double sampleRate, int bits, bool isFloat);
+	bool openRaw(const char *path, int numChannels, int bits, bool isFloat);
+	bool close(); // false and errorMessage() if the file could not be completed
+
+	bool isOpen() const { return file_ != NULL; }
+	const std::string &errorMessage() const { return error_; }
+	long numFrames() const { return numFrames_; }
+
+	bool write(const float *interleaved, long numFrames);
+
+private:
+	WavWriter(const WavWriter &);
+	WavWriter &operator=(const WavWriter &);
+
+	bool start(const char *path, int numChannels, int bits, bool isFloat);
+	bool fail(const std::string &message);
+
+	FILE *file_;
+	std::string error_;
+	bool raw_;
+	int numChannels_;
+	int bytesPerSample_;
+	bool isFloat_;
+	long numFrames_;
+	std::vector<unsigned char> buffer_; // raw bytes of one write() chunk
+};
+
+// Reads a whole file into one buffer per channel (deinterleaved); false and a message in
+// error on failure.
+bool readWavFile(const char *path, std::vector<std::vector<float> > &channels, double &sampleRate, std::string &error);
+
+#endif
@@ -0,0 +1,172 @@
+#include "Wavetable.hxx"
+
+#include <cmath>
+
+// ---------------------------------------------------------------------------------------
+// MipMappedWavetable:
+// ---------------------------------------------------------------------------------------
+
+int MipMappedWavetable::levelOffset(int l)
+{
+	int offset = 0;
+	for (int i = 0; i < l; ++i)
+	{
+		offset += (1 << levelSizeLog2(i)) + 1; // plus guard point
+	}
+	return offset;
+}
+
+void MipMappedWavetable::build(const double *sineAmplitudes, int numHarmonics)
+{
+	samples_.assign(levelOffset(kNumLevels), 0.0f);
+
+	std::vector<double> sine;
+	std::vector<double> sum;
+	for (int l = 0; l < kNumLevels; ++l)
+	{
+		const int size = 1 << levelSizeLog2(l);
+		const int mask = size - 1;
+		sine.resize(size);
+		for (int j = 0; j < size; ++j)
+		{
+			sine[j] = std::sin(2.0*3.14159265358979323846*j/size);
+		}
+
+		// Additive synthesis; sin(n*phase) at point j is sine[(n*j) mod size]:
+		const int harmonics = numHarmonics < (kMaxHarmonics >> l) ? numHarmonics : (kMaxHarmonics >> l);
+		sum.assign(size, 0.0);
+		for (int n = 1; n <= harmonics; ++n)
+		{
+			const double amplitude = sineAmplitudes[n - 1];
+			if (amplitude == 0.0)
+			{
+				continue;
+			}
+			for (int j = 0; j < size; ++j)
+			{
+				sum[j] += amplitude*sine[(n*j) & mask];
+			}
+		}
+
+		float *table = &samples_[levelOffset(l)];
+		for (int j = 0; j < size; ++j)
+		{
+			table[j] = (float)sum[j];
+		}
+		table[size] = table[0]; // guard point
+	}
+}
+
+int MipMappedWavetable::levelFor(double increment)
+{
+	int l = 0;
+	while (l < kNumLevels - 1 && (kMaxHarmonics >> l)*increment > 0.5)
+	{
+		++l;
+	}
+	return l;
+}
+
+// ---------------------------------------------------------------------------------------
+// Clipped sine:
+// ---------------------------------------------------------------------------------------
+
+void clippedSineHarmonics(double drive, double *sineAmplitudes, int numHarmonics)
+{
+	for (int n = 1; n <= numHarmonics; ++n)
+	{
+		sineAmplitudes[n - 1] = 0.0;
+	}
+	if (numHarmonics < 1)
+	{
+		return;
+	}
+	if (drive <= 1.0)
+	{
+		sineAmplitudes[0] = drive; // no clipping
+		return;
+	}
+
+	// Quarter wave symmetric: drive*sin(phase) up to the clip point phaseC, 1 from there to
+	// pi/2. b_n = 4/pi*(integral of the sine part + integral of the flat part).
+	const bool square = std::isinf(drive);
+	const double phaseC = square ? 0.0 : std::asin(1.0/drive);
+	for (int n = 1; n <= numHarmonics; n += 2)
+	{
+		double sinePart = 0.0;
+		if (!square)
+		{
+			sinePart = n == 1 ? 0.5*drive*(phaseC - 0.5*std::sin(2.0*phaseC))
+			                  : 0.5*drive*(std::sin((n - 1)*phaseC)/(n - 1) - std::sin((n + 1)*phaseC)/(n + 1));
+		}
+		const double flatPart = std::cos(n*phaseC)/n;
+		sineAmplitudes[n - 1] = 4.0/3.14159265358979323846*(sinePart + flatPart);
+	}
+}
+
+ClippedSineWavetables::ClippedSineWavetables()
+{
+	std::vector<double> amplitudes(MipMappedWavetable::kMaxHarmonics);
+	for (int i = 0; i < kNumTables; ++i)
+	{
+		const double brightness = (double)i/(kNumTables - 1);
+		const double drive = brightness < 1.0 ? std::pow(1.0 - brightness, -2.0) : HUGE_VAL;
+		clippedSineHarmonics(drive, &amplitudes[0], MipMappedWavetable::kMaxHarmonics);
+		tables_[i].build(&amplitudes[0], MipMappedWavetable::kMaxHarmonics);
+	}
+}
+
+void ClippedSineWavetables::position(float brightness, int &index, float &fraction)
+{
+	brightness = brightness < 0.0f ? 0.0f : (brightness > 1.0f ? 1.0f : brightness);
+	const float position = brightness*(float)(kNumTables - 1);
+	index = position < (float)(kNumTables - 1) ? (int)position : kNumTables - 2;
+	fraction = position - (float)index;
+}
+
+const ClippedSineWavetables &clippedSineWavetables()
+{
+	static const ClippedSineWavetables tables; // thread-safe initialization on first call
+	return tables;
+}
+
+// ---------------------------------------------------------------------------------------
+// WavetableOscillator:
+// ---------------------------------------------------------------------------------------
+
+void WavetableOscillator::process(const MipMappedWavetable &a, const MipMappedWavetable &b, float *out, int numSamples,
+                                  double startIncrement, double endIncrement, float startMix, float endMix)
+{
+	if (numSamples <= 0)
+	{
+		return;
+	}
+
+	const int level = MipMappedWavetable::levelFor(startIncrement > endIncrement ? startIncrement : endIncrement);
+	const float *tableA = a.level(level);
+	const float *tableB = b.level(level);
+	const int shift = 32 - a.levelSizeLog2(level); // index = top sizeLog2 bits of the phase
+	const uint32_t fractionMask = (1u << shift) - 1;
+	const float fractionScale = 1.0f/(float)(1u << shift);
+
+	const double phaseScale = 4294967296.0; // one cycle
+	uint32_t increment = (uint32_t)(startIncrement*phaseScale);
+	const uint32_t incrementStep = (uint32_t)(int32_t)((endIncrement - startIncrement)*phaseScale/numSamples);
+	float mix = startMix;
+	const float mixStep = (endMix - startMix)/(float)numSamples;
+
+	uint32_t phase = phase_;
+	for (int j = 0; j < numSamples; ++j)
+	{
+		const uint32_t index = phase >> shift;
+		const float fraction = (float)(phase & fractionMask)*fractionScale;
+		const float sampleA = tableA[index] + fraction*(tableA[index + 1] - tableA[index]);
+		const float sampleB = tableB[index] + fraction*(tableB[index + 1] - tableB[index]);
+		out[j] = sampleA + mix*(sampleB - sampleA);
+
+		phase += increment;
+		increment += incrementStep; // wraps around for negative steps
+		mix += mixStep;
+	}
+	phase_ = phase;
+}
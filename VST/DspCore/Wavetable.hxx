@@ -0,0 +1,88 @@
+#ifndef INCLUDED_WAVETABLE_HXX
+#define INCLUDED_WAVETABLE_HXX
+
+#include <stdint.h>
+#include <vector>
+
+// ---------------------------------------------------------------------------------------
+// Mip-mapped band-limited wavetables.
+// ---------------------------------------------------------------------------------------
+
+// One single cycle waveform, stored at kNumLevels bandwidths: level l holds the harmonics
+// up to kMaxHarmonics >> l, so a note whose highest harmonic would exceed Nyquist plays from
+// a coarser level instead of aliasing. Each level is sampled with at least 8 points per
+// period of its highest harmonic (and at least 256), plus one guard point for the linear
+// interpolation.
+class MipMappedWavetable
+{
+public:
+	enum { kNumLevels = 10, kMaxHarmonics = 512, kMinSizeLog2 = 8 };
+
+	// sineAmplitudes[n - 1] is the amplitude of sin(n*phase), n = 1..numHarmonics. Allocates.
+	void build(const double *sineAmplitudes, int numHarmonics);
+
+	// Level whose harmonics stay below Nyquist at increment cycles per sample:
+	static int levelFor(double increment);
+
+	const float *level(int l) const { return &samples_[levelOffset(l)]; }
+
+	// All levels in one array, with the same layout in every table:
+	const float *data() const { return &samples_[0]; }
+	static int levelSizeLog2(int l) { return 12 - l > kMinSizeLog2 ? 12 - l : kMinSizeLog2; } // 8 points per period of harmonic 2^(9 - l)
+	static int levelOffset(int l);
+
+private:
+	std::vector<float> samples_;
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Fourier series of the clipped sine min(max(drive*sin(phase), -1), 1), drive >= 1 (infinite
+// for a square wave): odd sine harmonics only. Writes numHarmonics amplitudes.
+void clippedSineHarmonics(double drive, double *sineAmplitudes, int numHarmonics);
+
+// Band-limited versions of the MyVstPlugIn-ex4 timbre: the sine clipped with a drive of
+// (1 - brightness)^-2, at kNumTables brightness values from 0 (pure sine) to 1 (square).
+// Shared by all instances and built on the first call (tens of milliseconds), so call it
+// from resume() rather than from the audio thread the first time.
+class ClippedSineWavetables
+{
+public:
+	enum { kNumTables = 17 };
+
+	ClippedSineWavetables();
+
+	const MipMappedWavetable &table(int i) const { return tables_[i]; }
+
+	// Table index and crossfade fraction for a brightness value (0..1):
+	static void position(float brightness, int &index, float &fraction);
+
+private:
+	MipMappedWavetable tables_[kNumTables];
+};
+
+const ClippedSineWavetables &clippedSineWavetables();
+
+// ---------------------------------------------------------------------------------------
+// Oscillator.
+// ---------------------------------------------------------------------------------------
+
+// 32 bit phase accumulator reading a crossfade of two mip-mapped wavetables. The increment
+// and the crossfade are given per call (per block or sub-block) and ramped linearly inside
+// it; the mip level is chosen once per call from the larger increment.
+class WavetableOscillator
+{
+public:
+	WavetableOscillator() : phase_(0) {}
+
+	void reset() { phase_ = 0; }
+
+	// increment in cycles per sample (0..0.5), mix 0 = a, 1 = b:
+	void process(const MipMappedWavetable &a, const MipMappedWavetable &b, float *out, int numSamples,
+	             double startIncrement, double endIncrement, float startMix, float endMix);
+
+private:
+	uint32_t phase_;
+};
+
+#endif
@@ -0,0 +1,310 @@
+#include "WavetableSynth.hxx"
+
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// ---------------------------------------------------------------------------------------
+// Voice management:
+// ---------------------------------------------------------------------------------------
+
+WavetableSynth::WavetableSynth()
+	: numVoices_(0), sampleRate_(44100.0f), a4Frequency_(440.0f), attackStep_(1.0f), releaseStep_(1.0f), noteCounter_(0)
+{
+	for (int note = 0; note < 128; ++note)
+	{
+		noteRatio_[note] = (float)std::pow(2.0, (note - 69)/12.0);
+	}
+	for (int v = 0; v < kMaxVoices; ++v)
+	{
+		phase_[v] = 0;
+		increment_[v] = 0;
+		positionScale_[v] = 0.0f;
+		levelOffset_[v] = 0;
+		envelope_[v] = 0.0f;
+		envelopeStep_[v] = 0.0f;
+		amplitude_[v] = 0.0f;
+		note_[v] = -1;
+		age_[v] = 0;
+	}
+}
+
+void WavetableSynth::setSampleRate(float sampleRate, float attackMs, float releaseMs)
+{
+	sampleRate_ = sampleRate;
+	const float attackSamples = attackMs*0.001f*sampleRate;
+	const float releaseSamples = releaseMs*0.001f*sampleRate;
+	attackStep_ = attackSamples > 1.0f ? 1.0f/attackSamples : 1.0f;
+	releaseStep_ = releaseSamples > 1.0f ? 1.0f/releaseSamples : 1.0f;
+
+	for (int v = 0; v < numVoices_; ++v)
+	{
+		envelopeStep_[v] = envelopeStep_[v] > 0.0f ? attackStep_ : -releaseStep_;
+		setPitch(v);
+	}
+}
+
+void WavetableSynth::setTuning(float a4Frequency)
+{
+	if (a4Frequency != a4Frequency_)
+	{
+		a4Frequency_ = a4Frequency;
+		for (int v = 0; v < numVoices_; ++v)
+		{
+			setPitch(v);
+		}
+	}
+}
+
+void WavetableSynth::setPitch(int v)
+{
+	const double increment = (double)a4Frequency_*noteRatio_[note_[v]]/sampleRate_;
+	if (increment >= 0.5)
+	{
+		// Above Nyquist: stay at phase 0, where every table (odd waveforms) reads 0:
+		phase_[v] = 0;
+		increment_[v] = 0;
+		positionScale_[v] = 0.0f;
+		return;
+	}
+	const int level = MipMappedWavetable::levelFor(increment);
+	increment_[v] = (uint32_t)(increment*4294967296.0);
+	positionScale_[v] = (float)(1 << MipMappedWavetable::levelSizeLog2(level))/16777216.0f; // phase >> 8 to table position
+	levelOffset_[v] = MipMappedWavetable::levelOffset(level);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int WavetableSynth::allocateVoice()
+{
+	if (numVoices_ < kMaxVoices)
+	{
+		return numVoices_++;
+	}
+
+	// Steal the quietest releasing voice, or else the oldest:
+	int quietest = -1;
+	int oldest = 0;
+	for (int v = 0; v < numVoices_; ++v)
+	{
+		if (envelopeStep_[v] < 0.0f && (quietest < 0 || envelope_[v] < envelope_[quietest]))
+		{
+			quietest = v;
+		}
+		if (noteCounter_ - age_[v] > noteCounter_ - age_[oldest])
+		{
+			oldest = v;
+		}
+	}
+	return quietest >= 0 ? quietest : oldest;
+}
+
+void WavetableSynth::removeVoice(int v)
+{
+	// Move the last active voice into the hole and clear its old slot:
+	const int last = --numVoices_;
+	phase_[v] = phase_[last];
+	increment_[v] = increment_[last];
+	positionScale_[v] = positionScale_[last];
+	levelOffset_[v] = levelOffset_[last];
+	envelope_[v] = envelope_[last];
+	envelopeStep_[v] = envelopeStep_[last];
+	amplitude_[v] = amplitude_[last];
+	note_[v] = note_[last];
+	age_[v] = age_[last];
+
+	phase_[last] = 0;
+	increment_[last] = 0;
+	positionScale_[last] = 0.0f;
+	levelOffset_[last] = 0;
+	envelope_[last] = 0.0f;
+	envelopeStep_[last] = 0.0f;
+	amplitude_[last] = 0.0f;
+	note_[last] = -1;
+}
+
+void WavetableSynth::noteOn(int note, int velocity)
+{
+	if (velocity <= 0)
+	{
+		noteOff(note);
+		return;
+	}
+	const int v = allocateVoice();
+	note_[v] = note & 127;
+	age_[v] = noteCounter_++;
+	phase_[v] = 0;
+	envelope_[v] = 0.0f;
+	envelopeStep_[v] = attackStep_;
+	amplitude_[v] = (float)(velocity & 127)/127.0f;
+	setPitch(v);
+}
+
+void WavetableSynth::noteOff(int note)
+{
+	for (int v = 0; v < numVoices_; ++v)
+	{
+		if (note_[v] == note && envelopeStep_[v] > 0.0f)
+		{
+			envelopeStep_[v] = -releaseStep_;
+		}
+	}
+}
+
+void WavetableSynth::allNotesOff()
+{
+	for (int v = 0; v < numVoices_; ++v)
+	{
+		envelopeStep_[v] = -releaseStep_;
+	}
+}
+
+void WavetableSynth::allSoundOff()
+{
+	while (numVoices_ > 0)
+	{
+		removeVoice(numVoices_ - 1);
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// Rendering:
+// ---------------------------------------------------------------------------------------
+
+template <typename Sample>
+void WavetableSynth::renderBlock(const MipMappedWavetable &a, const MipMappedWavetable &b, Sample *out, int numSamples,
+                                 float startMix, float endMix)
+{
+	if (numSamples <= 0 || numVoices_ == 0)
+	{
+		return;
+	}
+
+	const float mixStep = (endMix - startMix)/(float)numSamples;
+	for (int start = 0; start < numSamples; start += kChunkSize)
+	{
+		const int len = numSamples - start < kChunkSize ? numSamples - start : kChunkSize;
+		renderChunk(a.data(), b.data(), out + start, len, startMix + mixStep*(float)start, mixStep);
+	}
+
+	// Free the voices whose release has finished:
+	for (int v = numVoices_ - 1; v >= 0; --v)
+	{
+		if (envelopeStep_[v] < 0.0f && envelope_[v] <= 0.0f)
+		{
+			removeVoice(v);
+		}
+	}
+}
+
+void WavetableSynth::render(const MipMappedWavetable &a, const MipMappedWavetable &b, float *out, int numSamples,
+                            float startMix, float endMix)
+{
+	renderBlock(a, b, out, numSamples, startMix, endMix);
+}
+
+void WavetableSynth::render(const MipMappedWavetable &a, const MipMappedWavetable &b, double *out, int numSamples,
+                            float startMix, float endMix)
+{
+	renderBlock(a, b, out, numSamples, startMix, endMix);
+}
+
+// The envelope is linear between clamps, so e[j] = clamp(e[-1] + step*(j + 1), 0, 1) equals
+// stepping and clamping sample by sample; computed from j it does not form a dependency chain.
+
+#if defined(__SSE2__)
+
+template <typename Sample>
+void WavetableSynth::renderChunk(const float *tableA, const float *tableB, Sample *out, int numSamples,
+                                 float startMix, float mixStep)
+{
+	// Per sample sums of the 4 lanes of all batches; added across lanes once at the end:
+	__m128 sums[kChunkSize];
+	for (int j = 0; j < numSamples; ++j)
+	{
+		sums[j] = _mm_setzero_ps();
+	}
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	for (int first = 0; first < numVoices_; first += kVoiceBatch)
+	{
+		__m128i phase = _mm_loadu_si128((const __m128i *)&phase_[first]);
+		const __m128i increment = _mm_loadu_si128((const __m128i *)&increment_[first]);
+		const __m128i offset = _mm_loadu_si128((const __m128i *)&levelOffset_[first]);
+		const __m128 scale = _mm_loadu_ps(&positionScale_[first]);
+		const __m128 envelope = _mm_loadu_ps(&envelope_[first]);
+		const __m128 envelopeStep = _mm_loadu_ps(&envelopeStep_[first]);
+		const __m128 amplitude = _mm_loadu_ps(&amplitude_[first]);
+
+		for (int j = 0; j < numSamples; ++j)
+		{
+			// Table position from the top 24 bits of the phase:
+			const __m128 position = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(phase, 8)), scale);
+			const __m128i whole = _mm_cvttps_epi32(position);
+			const __m128 fraction = _mm_sub_ps(position, _mm_cvtepi32_ps(whole));
+			phase = _mm_add_epi32(phase, increment);
+
+			alignas(16) int32_t index[kVoiceBatch];
+			_mm_store_si128((__m128i *)index, _mm_add_epi32(whole, offset));
+			const __m128 a0 = _mm_setr_ps(tableA[index[0]], tableA[index[1]], tableA[index[2]], tableA[index[3]]);
+			const __m128 a1 = _mm_setr_ps(tableA[index[0] + 1], tableA[index[1] + 1], tableA[index[2] + 1], tableA[index[3] + 1]);
+			const __m128 b0 = _mm_setr_ps(tableB[index[0]], tableB[index[1]], tableB[index[2]], tableB[index[3]]);
+			const __m128 b1 = _mm_setr_ps(tableB[index[0] + 1], tableB[index[1] + 1], tableB[index[2] + 1], tableB[index[3] + 1]);
+
+			const __m128 sampleA = _mm_add_ps(a0, _mm_mul_ps(fraction, _mm_sub_ps(a1, a0)));
+			const __m128 sampleB = _mm_add_ps(b0, _mm_mul_ps(fraction, _mm_sub_ps(b1, b0)));
+			const __m128 mix = _mm_set1_ps(startMix + mixStep*(float)j);
+			const __m128 sample = _mm_add_ps(sampleA, _mm_mul_ps(mix, _mm_sub_ps(sampleB, sampleA)));
+
+			__m128 e = _mm_add_ps(envelope, _mm_mul_ps(envelopeStep, _mm_set1_ps((float)(j + 1))));
+			e = _mm_min_ps(_mm_max_ps(e, zero), one);
+			sums[j] = _mm_add_ps(sums[j], _mm_mul_ps(sample, _mm_mul_ps(e, amplitude)));
+		}
+
+		__m128 e = _mm_add_ps(envelope, _mm_mul_ps(envelopeStep, _mm_set1_ps((float)numSamples)));
+		_mm_storeu_si128((__m128i *)&phase_[first], phase);
+		_mm_storeu_ps(&envelope_[first], _mm_min_ps(_mm_max_ps(e, zero), one));
+	}
+
+	for (int j = 0; j < numSamples; ++j)
+	{
+		alignas(16) float lanes[4];
+		_mm_store_ps(lanes, sums[j]);
+		out[j] += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+	}
+}
+
+#else
+
+template <typename Sample>
+void WavetableSynth::renderChunk(const float *tableA, const float *tableB, Sample *out, int numSamples,
+                                 float startMix, float mixStep)
+{
+	for (int v = 0; v < numVoices_; ++v)
+	{
+		uint32_t phase = phase_[v];
+		for (int j = 0; j < numSamples; ++j)
+		{
+			const float position = (float)(int32_t)(phase >> 8)*positionScale_[v];
+			const int whole = (int)position;
+			const float fraction = position - (float)whole;
+			const int index = whole + levelOffset_[v];
+			phase += increment_[v];
+
+			const float sampleA = tableA[index] + fraction*(tableA[index + 1] - tableA[index]);
+			const float sampleB = tableB[index] + fraction*(tableB[index + 1] - tableB[index]);
+			const float mix = startMix + mixStep*(float)j;
+			float e = envelope_[v] + envelopeStep_[v]*(float)(j + 1);
+			e = e < 0.0f ? 0.0f : (e > 1.0f ? 1.0f : e);
+			out[j] += (sampleA + mix*(sampleB - sampleA))*e*amplitude_[v];
+		}
+		const float e = envelope_[v] + envelopeStep_[v]*(float)numSamples;
+		phase_[v] = phase;
+		envelope_[v] = e < 0.0f ? 0.0f : (e > 1.0f ? 1.0f : e);
+	}
+}
+
+#endif
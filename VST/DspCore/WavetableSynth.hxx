@@ -0,0 +1,86 @@
+#ifndef INCLUDED_WAVETABLESYNTH_HXX
+#define INCLUDED_WAVETABLESYNTH_HXX
+
+#include "Wavetable.hxx"
+
+#include <stdint.h>
+
+// ---------------------------------------------------------------------------------------
+// Polyphonic wavetable voices.
+// ---------------------------------------------------------------------------------------
+
+// A preallocated pool of kMaxVoices voices, each a phase accumulator with its own mip level
+// of a shared pair of wavetables (crossfaded as in WavetableOscillator), a linear
+// attack/release envelope and a velocity gain.
+//
+// Voice state is kept in structure-of-arrays layout and the active voices are packed at the
+// start of the pool, so render() works on batches of kVoiceBatch voices (one SSE2 register):
+// per sample, the phase, table position, interpolation and envelope of a batch are vector
+// operations, only the table reads are scalar. Without SSE2 it renders voice by voice.
+//
+// When all voices are busy, a new note steals the quietest releasing voice, or else the
+// oldest one.
+//
+// Nothing allocates; all functions are meant for the audio thread.
+class WavetableSynth
+{
+public:
+	enum { kMaxVoices = 128, kVoiceBatch = 4, kChunkSize = 64 };
+
+	WavetableSynth();
+
+	// Sample rate, attack and release times; call from resume(). Keeps sounding voices.
+	void setSampleRate(float sampleRate, float attackMs, float releaseMs);
+
+	// Frequency of MIDI note 69 (A4), in Hz. Retunes sounding voices.
+	void setTuning(float a4Frequency);
+
+	void noteOn(int note, int velocity);
+	void noteOff(int note);
+	void allNotesOff(); // release every voice
+	void allSoundOff(); // silence every voice at once
+
+	int numActiveVoices() const { return numVoices_; }
+
+	// Adds numSamples of all voices to out. The tables are crossfaded from startMix to
+	// endMix (0 = a, 1 = b) over the block, like WavetableOscillator::process(). The voices
+	// are computed in float either way; only the final sum goes to the double output.
+	void render(const MipMappedWavetable &a, const MipMappedWavetable &b, float *out, int numSamples,
+	            float startMix, float endMix);
+	void render(const MipMappedWavetable &a, const MipMappedWavetable &b, double *out, int numSamples,
+	            float startMix, float endMix);
+
+private:
+	int allocateVoice();
+	void removeVoice(int v);
+	void setPitch(int v);
+
+	// Defined and instantiated in WavetableSynth.cxx, for float and double:
+	template <typename Sample>
+	void renderBlock(const MipMappedWavetable &a, const MipMappedWavetable &b, Sample *out, int numSamples,
+	                 float startMix, float endMix);
+	template <typename Sample>
+	void renderChunk(const float *tableA, const float *tableB, Sample *out, int numSamples, float startMix, float mixStep);
+
+	// Per voice, packed: voices 0..numVoices_-1 are active. Sized up to a whole batch, the
+	// entries past numVoices_ are silent.
+	uint32_t phase_[kMaxVoices];
+	uint32_t increment_[kMaxVoices];
+	float positionScale_[kMaxVoices]; // table size / 2^24 of the voice's mip level
+	int levelOffset_[kMaxVoices];
+	float envelope_[kMaxVoices];
+	float envelopeStep_[kMaxVoices];  // > 0 attack/sustain, < 0 release
+	float amplitude_[kMaxVoices];
+	int note_[kMaxVoices];
+	uint32_t age_[kMaxVoices];        // noteOn() counter value, for stealing the oldest
+	int numVoices_;
+
+	float noteRatio_[128]; // 2^((note - 69)/12)
+	float sampleRate_;
+	float a4Frequency_;
+	float attackStep_;
+	float releaseStep_;
+	uint32_t noteCounter_;
+};
+
+#endif
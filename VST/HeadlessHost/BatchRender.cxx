@@ -0,0 +1,539 @@
+// Offline batch renderer: runs WAV (or raw) files through a MyVstPlugIn-exN effect or a
+// chain of them, as fast as the CPU allows, several files at a time.
+//
+// Every file gets its own plug-in instances (a PluginGraph chain, channel counts adapted) at
+// the file's sample rate. The file is streamed in large blocks: a reader thread decodes the
+// next block while the current one is processed (double buffering), so memory stays constant
+// for files of any size, and the output is written as it comes. The plug-in latency is
+// compensated (the first latency() output samples are dropped, and the input is followed by
+// as many zeros), and --tail seconds more are rendered for reverb tails (or the tails the
+// plug-ins report, with --tail auto). Outputs beyond
+// 4 GB are written as RF64.
+//
+// Usage: BatchRender [options] plugin.so [plugin.so ...] -- file ...
+//   --output rendered         directory of the output files (same names as the inputs)
+//   --jobs 0                  files processed in parallel; 0 = one per core
+//   --block 8192              frames per block
+//   --tail 0                  seconds rendered after the end of the input; auto = the sum of
+//                             the tails the plug-ins report (effGetTailSize)
+//   --channels 0              output channels; 0 = those of the input
+//   --bits float              output samples: 16, 24, 32 (integer) or float (32 bit)
+//   --raw 2:48000:s16         the inputs are headerless little endian samples: channels,
+//                             sample rate and format (s8, s16, s24, s32, f32, f64); the
+//                             outputs are then raw too
+//   --set 0:1=0.5             parameter 1 of plug-in 0 to 0.5 (repeatable)
+//   --csv                     print comma separated values instead of a table
+//
+// Built by the CMake project in VST/ together with the plug-ins when VSTSDK_DIR is set.
+
+#include "PluginGraph.hxx"
+
+#include "DspCore/WavFile.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+
+// ---------------------------------------------------------------------------------------
+// Options:
+// ---------------------------------------------------------------------------------------
+
+struct ParameterSetting
+{
+	int node;
+	int index;
+	float value;
+};
+
+const double kAutoTail = -1.0; // RenderOptions::tail: as reported by the plug-ins
+
+struct RenderOptions
+{
+	std::string output;
+	int jobs;
+	int blockSize;
+	double tail;
+	int channels;
+	int bits;
+	bool isFloat;
+	bool raw;
+	int rawChannels;
+	double rawSampleRate;
+	int rawBits;
+	bool rawIsFloat;
+	std::vector<ParameterSetting> settings;
+	bool csv;
+	std::vector<std::string> plugins;
+	std::vector<std::string> files;
+
+	RenderOptions()
+		: output("rendered"), jobs(0), blockSize(8192), tail(0.0), channels(0), bits(32), isFloat(true), raw(false),
+		  rawChannels(0), rawSampleRate(0.0), rawBits(0), rawIsFloat(false), csv(false)
+	{
+	}
+};
+
+// "channels:rate:format":
+static bool parseRawFormat(const char *text, RenderOptions &options)
+{
+	char format[8];
+	if (std::sscanf(text, "%d:%lf:%7s", &options.rawChannels, &options.rawSampleRate, format) != 3
+	    || options.rawChannels <= 0 || options.rawSampleRate <= 0.0 || (format[0] != 's' && format[0] != 'f'))
+	{
+		return false;
+	}
+	options.rawIsFloat = format[0] == 'f';
+	options.rawBits = std::atoi(format + 1);
+	options.raw = true;
+	return true;
+}
+
+static bool parseOptions(int argc, char **argv, RenderOptions &options)
+{
+	bool files = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		const char *arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (files)
+		{
+			options.files.push_back(arg);
+		}
+		else if (std::strcmp(arg, "--") == 0)
+		{
+			files = true;
+		}
+		else if (std::strcmp(arg, "--output") == 0 && hasValue)
+		{
+			options.output = argv[++i];
+		}
+		else if (std::strcmp(arg, "--jobs") == 0 && hasValue)
+		{
+			options.jobs = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--block") == 0 && hasValue)
+		{
+			options.blockSize = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--tail") == 0 && hasValue)
+		{
+			const char *value = argv[++i];
+			options.tail = std::strcmp(value, "auto") == 0 ? kAutoTail : std::atof(value);
+		}
+		else if (std::strcmp(arg, "--channels") == 0 && hasValue)
+		{
+			options.channels = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--bits") == 0 && hasValue)
+		{
+			const char *value = argv[++i];
+			options.isFloat = std::strcmp(value, "float") == 0;
+			options.bits = options.isFloat ? 32 : std::atoi(value);
+			if (!options.isFloat && options.bits != 16 && options.bits != 24 && options.bits != 32)
+			{
+				std::fprintf(stderr, "unsupported output bits: %s\n", value);
+				return false;
+			}
+		}
+		else if (std::strcmp(arg, "--raw") == 0 && hasValue)
+		{
+			if (!parseRawFormat(argv[++i], options))
+			{
+				std::fprintf(stderr, "bad raw format: %s\n", argv[i]);
+				return false;
+			}
+		}
+		else if (std::strcmp(arg, "--set") == 0 && hasValue)
+		{
+			ParameterSetting setting;
+			if (std::sscanf(argv[++i], "%d:%d=%f", &setting.node, &setting.index, &setting.value) != 3)
+			{
+				std::fprintf(stderr, "bad parameter setting: %s\n", argv[i]);
+				return false;
+			}
+			options.settings.push_back(setting);
+		}
+		else if (std::strcmp(arg, "--csv") == 0)
+		{
+			options.csv = true;
+		}
+		else if (arg[0] == '-')
+		{
+			std::fprintf(stderr, "unknown option: %s\n", arg);
+			return false;
+		}
+		else
+		{
+			options.plugins.push_back(arg);
+		}
+	}
+	return !options.plugins.empty() && !options.files.empty() && options.blockSize >= 1 && (options.tail >= 0.0 || options.tail == kAutoTail)
+	       && options.channels >= 0;
+}
+
+// ---------------------------------------------------------------------------------------
+// Double buffered reading:
+// ---------------------------------------------------------------------------------------
+
+// Decodes the blocks of an open WavReader on a thread of its own, one block ahead of the
+// consumer: next() hands out a block and gives the previous one back for reading.
+class PrefetchReader
+{
+public:
+	PrefetchReader(WavReader &reader, int blockSize)
+		: reader_(reader), blockSize_(blockSize), consumed_(0), stop_(false)
+	{
+		for (int s = 0; s < 2; ++s)
+		{
+			slots_[s].data.resize((size_t)blockSize*reader.numChannels());
+			slots_[s].frames = 0;
+			slots_[s].full = false;
+		}
+		thread_ = std::thread(&PrefetchReader::readerMain, this);
+	}
+
+	~PrefetchReader()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+		changed_.notify_all();
+		thread_.join();
+	}
+
+	// Interleaved frames of the next block; 0 frames at the end:
+	const float *next(long &frames)
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		if (consumed_ > 0)
+		{
+			slots_[(consumed_ - 1) & 1].full = false;
+			changed_.notify_all();
+		}
+		Slot &slot = slots_[consumed_ & 1];
+		changed_.wait(lock, [&slot]() { return slot.full; });
+		++consumed_;
+		frames = slot.frames;
+		return slot.data.empty() ? NULL : &slot.data[0];
+	}
+
+private:
+	struct Slot
+	{
+		std::vector<float> data;
+		long frames;
+		bool full;
+	};
+
+	void readerMain()
+	{
+		for (long produced = 0;; ++produced)
+		{
+			Slot &slot = slots_[produced & 1];
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				changed_.wait(lock, [this, &slot]() { return !slot.full || stop_; });
+				if (stop_)
+				{
+					return;
+				}
+			}
+			const long frames = reader_.read(slot.data.empty() ? NULL : &slot.data[0], blockSize_); // unlocked
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				slot.frames = frames;
+				slot.full = true;
+			}
+			changed_.notify_all();
+			if (frames == 0)
+			{
+				return;
+			}
+		}
+	}
+
+	WavReader &reader_;
+	const int blockSize_;
+	Slot slots_[2];
+	long consumed_;
+	bool stop_;
+	std::mutex mutex_;
+	std::condition_variable changed_;
+	std::thread thread_;
+};
+
+// ---------------------------------------------------------------------------------------
+// Rendering:
+// ---------------------------------------------------------------------------------------
+
+struct FileResult
+{
+	bool ok;
+	std::string error;
+	std::string output;
+	double sampleRate;
+	long inputFrames;
+	long outputFrames;
+	double seconds; // wall clock
+};
+
+static std::string baseName(const std::string &path)
+{
+	const size_t slash = path.find_last_of('/');
+	return path.substr(slash == std::string::npos ? 0 : slash + 1);
+}
+
+static void renderFile(const RenderOptions &options, const std::string &path, FileResult &result)
+{
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	result.ok = false;
+	result.inputFrames = result.outputFrames = 0;
+	result.output = options.output + "/" + baseName(path);
+
+	WavReader reader;
+	const bool opened = options.raw ? reader.openRaw(path.c_str(), options.rawChannels, options.rawSampleRate, options.rawBits,
+	                                                 options.rawIsFloat)
+	                                : reader.open(path.c_str());
+	if (!opened)
+	{
+		result.error = reader.errorMessage();
+		return;
+	}
+	const int numInputs = reader.numChannels();
+	const int numOutputs = options.channels > 0 ? options.channels : numInputs;
+	const int blockSize = options.blockSize;
+	result.sampleRate = reader.sampleRate();
+	result.inputFrames = reader.numFrames();
+
+	PluginGraph graph;
+	for (size_t p = 0; p < options.plugins.size(); ++p)
+	{
+		if (graph.addPlugin(options.plugins[p].c_str()) < 0)
+		{
+			result.error = graph.errorMessage();
+			return;
+		}
+		if (p > 0)
+		{
+			graph.connect((int)p - 1, (int)p);
+		}
+	}
+	// Before prepare(), so that the plug-ins resume at the values set instead of ramping to them:
+	for (size_t s = 0; s < options.settings.size(); ++s)
+	{
+		const ParameterSetting &setting = options.settings[s];
+		if (setting.node < 0 || setting.node >= graph.numNodes() || setting.index < 0
+		    || setting.index >= graph.node(setting.node).numParameters())
+		{
+			char text[64];
+			std::snprintf(text, sizeof(text), "no parameter %d:%d", setting.node, setting.index);
+			result.error = text;
+			return;
+		}
+		graph.node(setting.node).setParameter(setting.index, setting.value);
+	}
+
+	if (!graph.prepare((float)reader.sampleRate(), blockSize, numInputs, numOutputs))
+	{
+		result.error = graph.errorMessage();
+		return;
+	}
+
+	WavWriter writer;
+	const bool created = options.raw ? writer.openRaw(result.output.c_str(), numOutputs, options.bits, options.isFloat)
+	                                 : writer.open(result.output.c_str(), numOutputs, reader.sampleRate(), options.bits, options.isFloat);
+	if (!created)
+	{
+		result.error = writer.errorMessage();
+		return;
+	}
+
+	// Planar buffers for the graph, interleaved ones for the files:
+	std::vector<float> inputs((size_t)numInputs*blockSize), outputs((size_t)numOutputs*blockSize);
+	std::vector<float> interleaved((size_t)numOutputs*blockSize);
+	std::vector<float *> inputPointers(numInputs), outputPointers(numOutputs);
+	for (int c = 0; c < numInputs; ++c)
+	{
+		inputPointers[c] = &inputs[(size_t)c*blockSize];
+	}
+	for (int c = 0; c < numOutputs; ++c)
+	{
+		outputPointers[c] = &outputs[(size_t)c*blockSize];
+	}
+
+	// Input, then latency + tail frames of silence; the first latency output frames dropped:
+	const long latency = graph.latency();
+	long tail = (long)(options.tail*reader.sampleRate() + 0.5);
+	if (options.tail == kAutoTail)
+	{
+		tail = 0;
+		for (int n = 0; n < graph.numNodes(); ++n)
+		{
+			const VstInt32 nodeTail = graph.node(n).tailSize();
+			tail += nodeTail > 1 ? nodeTail : 0; // 0 (not reported) and 1 (none) add nothing
+		}
+	}
+	const long totalFrames = result.inputFrames + latency + tail;
+	long toSkip = latency;
+	PrefetchReader prefetch(reader, blockSize);
+	bool inputLeft = true;
+	for (long done = 0; done < totalFrames;)
+	{
+		long frames = 0;
+		const float *block = inputLeft ? prefetch.next(frames) : NULL;
+		inputLeft = frames > 0;
+		if (!inputLeft)
+		{
+			frames = std::min((long)blockSize, totalFrames - done);
+			std::fill(inputs.begin(), inputs.end(), 0.0f);
+		}
+		for (long j = 0; inputLeft && j < frames; ++j)
+		{
+			for (int c = 0; c < numInputs; ++c)
+			{
+				inputs[(size_t)c*blockSize + j] = block[j*numInputs + c];
+			}
+		}
+
+		graph.process(numInputs > 0 ? &inputPointers[0] : NULL, &outputPointers[0], (int)frames);
+		done += frames;
+
+		const long skip = std::min(toSkip, frames);
+		toSkip -= skip;
+		const long keep = frames - skip;
+		for (long j = 0; j < keep; ++j)
+		{
+			for (int c = 0; c < numOutputs; ++c)
+			{
+				interleaved[j*numOutputs + c] = outputs[(size_t)c*blockSize + skip + j];
+			}
+		}
+		if (keep > 0 && !writer.write(&interleaved[0], keep))
+		{
+			result.error = result.output + ": " + writer.errorMessage();
+			return;
+		}
+	}
+	result.outputFrames = writer.numFrames();
+	if (!writer.close())
+	{
+		result.error = result.output + ": " + writer.errorMessage();
+		return;
+	}
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	result.ok = true;
+}
+
+// ---------------------------------------------------------------------------------------
+// Main:
+// ---------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+	RenderOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		std::fprintf(stderr, "usage: %s [--output dir] [--jobs n] [--block n] [--tail s|auto] [--channels n] [--bits 16|24|32|float] [--raw ch:rate:fmt] [--set node:index=value] [--csv] plugin.so ... -- file ...\n", argv[0]);
+		return 2;
+	}
+	if (mkdir(options.output.c_str(), 0777) != 0 && errno != EEXIST)
+	{
+		std::fprintf(stderr, "cannot create %s\n", options.output.c_str());
+		return 1;
+	}
+
+	// Never overwrite an input, or one output with another:
+	struct stat outputInfo;
+	stat(options.output.c_str(), &outputInfo);
+	for (size_t f = 0; f < options.files.size(); ++f)
+	{
+		for (size_t g = 0; g < f; ++g)
+		{
+			if (baseName(options.files[g]) == baseName(options.files[f]))
+			{
+				std::fprintf(stderr, "%s and %s have the same name\n", options.files[g].c_str(), options.files[f].c_str());
+				return 1;
+			}
+		}
+		struct stat info;
+		const std::string directory = options.files[f].substr(0, options.files[f].find_last_of('/') + 1);
+		if (stat(directory.empty() ? "." : directory.c_str(), &info) == 0 && info.st_dev == outputInfo.st_dev && info.st_ino == outputInfo.st_ino)
+		{
+			std::fprintf(stderr, "%s is in the output directory %s\n", options.files[f].c_str(), options.output.c_str());
+			return 1;
+		}
+	}
+
+	// One file at a time per thread, each taking the next:
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::vector<FileResult> results(options.files.size());
+	int numJobs = options.jobs > 0 ? options.jobs : (int)std::thread::hardware_concurrency();
+	numJobs = std::max(1, std::min(numJobs, (int)options.files.size()));
+	std::atomic<size_t> next(0);
+	std::vector<std::thread> workers;
+	for (int t = 0; t < numJobs; ++t)
+	{
+		workers.push_back(std::thread([&]() {
+			for (size_t i = next++; i < options.files.size(); i = next++)
+			{
+				renderFile(options, options.files[i], results[i]);
+			}
+		}));
+	}
+	for (size_t t = 0; t < workers.size(); ++t)
+	{
+		workers[t].join();
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	if (options.csv)
+	{
+		std::printf("input,output,rate,input_frames,output_frames,audio_s,wall_s,realtime_factor\n");
+	}
+	else
+	{
+		std::printf("%-40s %6s %10s %10s %9s\n", "file", "rate", "audio s", "wall s", "x realtime");
+	}
+	int failures = 0;
+	double audioSeconds = 0.0;
+	for (size_t f = 0; f < results.size(); ++f)
+	{
+		const FileResult &r = results[f];
+		if (!r.ok)
+		{
+			std::fprintf(stderr, "%s: %s\n", options.files[f].c_str(), r.error.c_str());
+			++failures;
+			continue;
+		}
+		const double audio = r.outputFrames/r.sampleRate;
+		audioSeconds += audio;
+		if (options.csv)
+		{
+			std::printf("%s,%s,%g,%ld,%ld,%.3f,%.3f,%.1f\n", options.files[f].c_str(), r.output.c_str(), r.sampleRate, r.inputFrames,
+			            r.outputFrames, audio, r.seconds, audio/r.seconds);
+		}
+		else
+		{
+			std::printf("%-40s %6g %10.1f %10.2f %9.1fx\n", baseName(options.files[f]).c_str(), r.sampleRate, audio, r.seconds,
+			            audio/r.seconds);
+		}
+	}
+	if (!options.csv)
+	{
+		std::printf("%d files, %.1f s of audio in %.2f s with %d jobs: %.1fx real time\n", (int)results.size() - failures, audioSeconds,
+		            seconds, numJobs, audioSeconds/seconds);
+	}
+	return failures == 0 ? 0 : 1;
+}
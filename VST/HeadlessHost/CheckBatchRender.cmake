@@ -0,0 +1,39 @@
+# Render check of BatchRender, run by ctest (cmake -P, see CMakeLists.txt):
+#
+#   cmake -DBATCHRENDER=path -DPLUGIN=MyVstPlugIn-ex1.so -DWORK_DIR=dir -P CheckBatchRender.cmake
+#
+# --set values must be in place before the plug-ins resume, so that a render starts at them
+# instead of ramping from the defaults. The input is 4800 constant samples 0x4040 (16448, raw
+# s16, written as "@@" since file() writes text); ex1 at gain 0.5 (--set 0:0=0.5, 0:1=0.5)
+# must give 8224 (0x2020) from the first sample on.
+
+set(data "@@")
+foreach(i RANGE 11) # 2^12 samples
+	string(APPEND data "${data}")
+endforeach()
+file(MAKE_DIRECTORY "${WORK_DIR}")
+file(WRITE "${WORK_DIR}/constant.raw" "${data}")
+
+execute_process(
+	COMMAND "${BATCHRENDER}" --output "${WORK_DIR}/rendered" --raw 1:48000:s16 --bits 16 --jobs 1
+	        --set 0:0=0.5 --set 0:1=0.5 "${PLUGIN}" -- "${WORK_DIR}/constant.raw"
+	RESULT_VARIABLE result
+	OUTPUT_QUIET
+)
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "BatchRender failed: ${result}")
+endif()
+
+file(READ "${WORK_DIR}/rendered/constant.raw" rendered HEX)
+string(LENGTH "${rendered}" length)
+if(NOT length EQUAL 16384) # 4096 samples of 2 bytes, as hex digits
+	message(FATAL_ERROR "BatchRender wrote ${length} hex digits, expected 16384")
+endif()
+string(SUBSTRING "${rendered}" 0 32 start)
+if(NOT start STREQUAL "20202020202020202020202020202020")
+	message(FATAL_ERROR "the render does not start at the gain set: ${start} (expected 2020 per sample)")
+endif()
+string(REGEX MATCH "^(2020)*$" steady "${rendered}")
+if(steady STREQUAL "")
+	message(FATAL_ERROR "the render is not constant at the gain set")
+endif()
@@ -0,0 +1,353 @@
+// Offline host for a graph of MyVstPlugIn-exN effects, e.g. the ex1 gain -> ex3 filter ->
+// ex2 balance chain, in one process and one set of buffers (see PluginGraph.hxx).
+//
+// Renders noise through the graph twice, with the zero-copy buffer plan and with buffers of
+// its own for every node (a copy per hop, like separate DAW tracks), and reports ns/sample,
+// block time percentiles, the real-time headroom (block period / p99 time), the channel
+// buffers allocated and the channels copied or mixed per block, and whether both renderings
+// are identical.
+//
+// Usage: GraphHost [options] plugin.so [plugin.so ...]
+//   --connect 0-1,1-2         connections between the plug-ins, numbered in the order given,
+//                             "in" for the graph input; default: a chain in that order
+//   --channels 2              graph input and output channels
+//   --set 0:1=0.5             parameter 1 of plug-in 0 to 0.5 (repeatable)
+//   --block 256               block size
+//   --rate 48000              sample rate
+//   --seconds 10              audio seconds rendered per mode
+//   --precision float         float or double (processDoubleReplacing())
+//   --plan                    print the buffer plan of both modes
+//   --csv                     print comma separated values instead of a table
+//
+// Built by the CMake project in VST/ together with the plug-ins when VSTSDK_DIR is set.
+
+#include "PluginGraph.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------------------
+// Options:
+// ---------------------------------------------------------------------------------------
+
+struct ParameterSetting
+{
+	int node;
+	int index;
+	float value;
+};
+
+struct GraphOptions
+{
+	std::vector<std::pair<int, int> > connections;
+	std::vector<ParameterSetting> settings;
+	int channels;
+	int blockSize;
+	int sampleRate;
+	double seconds;
+	bool useDouble;
+	bool plan;
+	bool csv;
+	std::vector<std::string> plugins;
+
+	GraphOptions() : channels(2), blockSize(256), sampleRate(48000), seconds(10.0), useDouble(false), plan(false), csv(false) {}
+};
+
+// "a-b,c-d", a node index or "in" on the left:
+static bool parseConnections(const char *text, std::vector<std::pair<int, int> > &connections)
+{
+	for (const char *p = text; *p != '\0';)
+	{
+		char *end;
+		int from;
+		if (std::strncmp(p, "in", 2) == 0)
+		{
+			from = PluginGraph::kGraphInput;
+			end = (char *)p + 2;
+		}
+		else
+		{
+			from = (int)std::strtol(p, &end, 10);
+			if (end == p)
+			{
+				return false;
+			}
+		}
+		if (*end != '-')
+		{
+			return false;
+		}
+		p = end + 1;
+		const int to = (int)std::strtol(p, &end, 10);
+		if (end == p || (*end != ',' && *end != '\0'))
+		{
+			return false;
+		}
+		connections.push_back(std::make_pair(from, to));
+		p = *end == ',' ? end + 1 : end;
+	}
+	return true;
+}
+
+static bool parseOptions(int argc, char **argv, GraphOptions &options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const char *arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (std::strcmp(arg, "--connect") == 0 && hasValue)
+		{
+			if (!parseConnections(argv[++i], options.connections))
+			{
+				std::fprintf(stderr, "bad connections: %s\n", argv[i]);
+				return false;
+			}
+		}
+		else if (std::strcmp(arg, "--set") == 0 && hasValue)
+		{
+			ParameterSetting setting;
+			if (std::sscanf(argv[++i], "%d:%d=%f", &setting.node, &setting.index, &setting.value) != 3)
+			{
+				std::fprintf(stderr, "bad parameter setting: %s\n", argv[i]);
+				return false;
+			}
+			options.settings.push_back(setting);
+		}
+		else if (std::strcmp(arg, "--channels") == 0 && hasValue)
+		{
+			options.channels = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--block") == 0 && hasValue)
+		{
+			options.blockSize = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--rate") == 0 && hasValue)
+		{
+			options.sampleRate = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--seconds") == 0 && hasValue)
+		{
+			options.seconds = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--precision") == 0 && hasValue)
+		{
+			const char *value = argv[++i];
+			if (std::strcmp(value, "float") != 0 && std::strcmp(value, "double") != 0)
+			{
+				std::fprintf(stderr, "unknown precision: %s\n", value);
+				return false;
+			}
+			options.useDouble = std::strcmp(value, "double") == 0;
+		}
+		else if (std::strcmp(arg, "--plan") == 0)
+		{
+			options.plan = true;
+		}
+		else if (std::strcmp(arg, "--csv") == 0)
+		{
+			options.csv = true;
+		}
+		else if (arg[0] == '-')
+		{
+			std::fprintf(stderr, "unknown option: %s\n", arg);
+			return false;
+		}
+		else
+		{
+			options.plugins.push_back(arg);
+		}
+	}
+	return !options.plugins.empty() && options.channels >= 1 && options.blockSize >= 1 && options.sampleRate > 0;
+}
+
+// ---------------------------------------------------------------------------------------
+// Rendering:
+// ---------------------------------------------------------------------------------------
+
+struct GraphResult
+{
+	int buffers;
+	int copies;
+	long blocks;
+	double nsPerSample; // per channel sample of the graph output
+	double p50, p99, maxTime; // block times in microseconds
+	double headroom;
+	std::vector<double> rendered; // the first channel of the output, for the comparison
+};
+
+static double percentile(const std::vector<double> &sorted, double p)
+{
+	size_t idx = (size_t)(p*(sorted.size() - 1) + 0.5);
+	return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+template <typename Sample>
+static void processGraph(PluginGraph &graph, Sample **inputs, Sample **outputs, int numSamples);
+
+template <>
+void processGraph<float>(PluginGraph &graph, float **inputs, float **outputs, int numSamples)
+{
+	graph.process(inputs, outputs, numSamples);
+}
+
+template <>
+void processGraph<double>(PluginGraph &graph, double **inputs, double **outputs, int numSamples)
+{
+	graph.processDouble(inputs, outputs, numSamples);
+}
+
+// Builds the graph afresh (new plug-in state) and renders the same noise through it:
+template <typename Sample>
+static bool renderGraph(const GraphOptions &options, bool inPlace, GraphResult &result)
+{
+	PluginGraph graph;
+	for (size_t p = 0; p < options.plugins.size(); ++p)
+	{
+		if (graph.addPlugin(options.plugins[p].c_str()) < 0)
+		{
+			std::fprintf(stderr, "%s\n", graph.errorMessage().c_str());
+			return false;
+		}
+	}
+	for (size_t c = 0; c < options.connections.size(); ++c)
+	{
+		if (!graph.connect(options.connections[c].first, options.connections[c].second))
+		{
+			std::fprintf(stderr, "%s\n", graph.errorMessage().c_str());
+			return false;
+		}
+	}
+	if (options.connections.empty())
+	{
+		for (int i = 1; i < graph.numNodes(); ++i)
+		{
+			graph.connect(i - 1, i);
+		}
+	}
+	// Before prepare(), so that the plug-ins resume at the values set instead of ramping to them:
+	for (size_t s = 0; s < options.settings.size(); ++s)
+	{
+		const ParameterSetting &setting = options.settings[s];
+		if (setting.node < 0 || setting.node >= graph.numNodes() || setting.index < 0
+		    || setting.index >= graph.node(setting.node).numParameters())
+		{
+			std::fprintf(stderr, "no parameter %d:%d\n", setting.node, setting.index);
+			return false;
+		}
+		graph.node(setting.node).setParameter(setting.index, setting.value);
+	}
+	if (!graph.prepare((float)options.sampleRate, options.blockSize, options.channels, options.channels, inPlace))
+	{
+		std::fprintf(stderr, "%s\n", graph.errorMessage().c_str());
+		return false;
+	}
+	if (options.plan)
+	{
+		std::printf("%s plan, %d buffers:\n%s", inPlace ? "zero-copy" : "copy", graph.numBuffers(), graph.describePlan().c_str());
+	}
+
+	const int channels = options.channels, blockSize = options.blockSize;
+	std::vector<Sample> input((size_t)channels*blockSize), output((size_t)channels*blockSize);
+	std::vector<Sample *> inputPointers(channels), outputPointers(channels);
+	for (int c = 0; c < channels; ++c)
+	{
+		inputPointers[c] = &input[(size_t)c*blockSize];
+		outputPointers[c] = &output[(size_t)c*blockSize];
+	}
+
+	const long numBlocks = std::max(64L, (long)(options.seconds*options.sampleRate/blockSize));
+	std::vector<double> blockTimes;
+	blockTimes.reserve(numBlocks);
+	result.rendered.assign((size_t)numBlocks*blockSize, 0.0);
+	unsigned int seed = 12345u;
+	double totalNs = 0.0;
+	for (long b = 0; b < numBlocks; ++b)
+	{
+		// New noise every block (the graph may have processed the input in place):
+		for (size_t i = 0; i < input.size(); ++i)
+		{
+			seed = seed*1664525u + 1013904223u; // LCG, good enough for a test signal
+			input[i] = Sample(0.25)*((Sample)(seed >> 8)/Sample(8388608) - Sample(1));
+		}
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		processGraph(graph, &inputPointers[0], &outputPointers[0], blockSize);
+		std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+
+		const double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+		blockTimes.push_back(ns);
+		totalNs += ns;
+		std::copy(outputPointers[0], outputPointers[0] + blockSize, result.rendered.begin() + (size_t)b*blockSize);
+	}
+
+	std::sort(blockTimes.begin(), blockTimes.end());
+	result.buffers = graph.numBuffers();
+	result.copies = graph.numChannelCopies();
+	result.blocks = numBlocks;
+	result.nsPerSample = totalNs/((double)numBlocks*blockSize*channels);
+	result.p50 = percentile(blockTimes, 0.50)*1e-3;
+	result.p99 = percentile(blockTimes, 0.99)*1e-3;
+	result.maxTime = blockTimes.back()*1e-3;
+	result.headroom = 1e9*blockSize/options.sampleRate/std::max(1.0, percentile(blockTimes, 0.99));
+	return true;
+}
+
+// ---------------------------------------------------------------------------------------
+// Main:
+// ---------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+	GraphOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		std::fprintf(stderr, "usage: %s [--connect a-b,...] [--channels n] [--set node:index=value] [--block n] [--rate hz] [--seconds s] [--precision float|double] [--plan] [--csv] plugin.so ...\n", argv[0]);
+		return 2;
+	}
+
+	GraphResult results[2];
+	for (int mode = 0; mode < 2; ++mode)
+	{
+		const bool ok = options.useDouble ? renderGraph<double>(options, mode == 0, results[mode])
+		                                  : renderGraph<float>(options, mode == 0, results[mode]);
+		if (!ok)
+		{
+			return 1;
+		}
+	}
+	const bool identical = results[0].rendered == results[1].rendered;
+
+	if (options.csv)
+	{
+		std::printf("mode,block,rate,channels,buffers,copies,blocks,ns_per_sample,p50_us,p99_us,max_us,headroom,identical\n");
+	}
+	else
+	{
+		std::printf("%-9s %7s %8s %8s %9s %9s %9s %9s\n", "mode", "buffers", "copies", "ns/smp", "p50 us", "p99 us", "max us", "headroom");
+	}
+	for (int mode = 0; mode < 2; ++mode)
+	{
+		const GraphResult &r = results[mode];
+		const char *name = mode == 0 ? "zero-copy" : "copy";
+		if (options.csv)
+		{
+			std::printf("%s,%d,%d,%d,%d,%d,%ld,%.4f,%.3f,%.3f,%.3f,%.2f,%d\n", name, options.blockSize, options.sampleRate,
+			            options.channels, r.buffers, r.copies, r.blocks, r.nsPerSample, r.p50, r.p99, r.maxTime, r.headroom, identical ? 1 : 0);
+		}
+		else
+		{
+			std::printf("%-9s %7d %8d %8.3f %9.2f %9.2f %9.2f %8.1fx\n", name, r.buffers, r.copies, r.nsPerSample, r.p50, r.p99,
+			            r.maxTime, r.headroom);
+		}
+	}
+	if (!options.csv)
+	{
+		std::printf("outputs %s\n", identical ? "identical" : "DIFFER");
+	}
+	return identical ? 0 : 1;
+}
@@ -0,0 +1,601 @@
+// Headless offline host and throughput benchmark for the MyVstPlugIn-exN plug-ins.
+//
+// Loads each plug-in shared object given on the command line, then drives processReplacing()
+// over every combination of block size, sample rate and channel count, and reports ns/sample,
+// blocks/s, block time percentiles and the real-time headroom (block period / p99 time).
+//
+// Usage: HeadlessHost [options] plugin.so [plugin.so ...]
+//   --blocks 16,32,...,8192   block sizes
+//   --rates 44100,48000,96000 sample rates
+//   --channels 0              total channels; 0 = plug-in's own channel count. When larger,
+//                             ceil(channels/numOutputs) instances run side by side, like a
+//                             multichannel track built from mono/stereo inserts.
+//   --seconds 2               audio seconds rendered per configuration (at least 256 blocks)
+//   --automate                call setParameter() with new random values before every block
+//   --automate-cc 0           send that many MIDI control changes per block at random
+//                             deltaFrames, cycling through the parameters (sample accurate
+//                             automation, CC 20 + parameter index; see EventScheduler.hxx)
+//   --notes 0                 for instruments: number of notes held down (MIDI note-ons sent
+//                             before the first block), e.g. 64 to measure 64 voices
+//   --precision float         float:   32 bit buffers through processReplacing()
+//                             double:  64 bit buffers through processDoubleReplacing()
+//                             convert: 64 bit buffers converted to float around
+//                                      processReplacing(), as a 64 bit host does for plug-ins
+//                                      without double support (the cost --precision double saves)
+//   --input noise             noise:   white noise at -12 dBFS in every block
+//                             silence: zeros (an idle track)
+//                             decay:   noise during the warm-up blocks, then zeros: the
+//                                      tails ringing out into subnormal numbers, then idle
+//   --rt-check                real-time safety mode, for debug and CI runs: allocations,
+//                             locks and blocking system calls made inside processReplacing(),
+//                             processDoubleReplacing() or processEvents() are reported with
+//                             a stack trace, and the exit status is 1 if there were any (see
+//                             RealtimeSanitizer.hxx). Best with short runs: --seconds 0.1.
+//   --csv                     print comma separated values instead of a table
+//
+// Built by the CMake project in VST/ together with the plug-ins when VSTSDK_DIR is set.
+
+#include "PluginHost.hxx"
+#include "RealtimeSanitizer.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------------------
+// Options:
+// ---------------------------------------------------------------------------------------
+
+enum Precision
+{
+	kPrecisionFloat,
+	kPrecisionDouble,
+	kPrecisionConvert
+};
+
+enum InputSignal
+{
+	kInputNoise,
+	kInputSilence,
+	kInputDecay
+};
+
+struct BenchOptions
+{
+	std::vector<int> blockSizes;
+	std::vector<int> sampleRates;
+	std::vector<int> channelCounts;
+	double seconds;
+	int notes;
+	int controlChanges;
+	Precision precision;
+	InputSignal input;
+	bool automate;
+	bool rtCheck;
+	bool csv;
+	std::vector<std::string> plugins;
+
+	BenchOptions() : seconds(2.0), notes(0), controlChanges(0), precision(kPrecisionFloat), input(kInputNoise), automate(false), rtCheck(false), csv(false)
+	{
+		for (int n = 16; n <= 8192; n *= 2)
+		{
+			blockSizes.push_back(n);
+		}
+		sampleRates.push_back(44100);
+		sampleRates.push_back(48000);
+		sampleRates.push_back(96000);
+		channelCounts.push_back(0);
+	}
+};
+
+static std::vector<int> parseList(const char *text)
+{
+	std::vector<int> values;
+	const char *p = text;
+	while (*p != '\0')
+	{
+		char *end;
+		long v = std::strtol(p, &end, 10);
+		if (end == p)
+		{
+			break;
+		}
+		values.push_back((int)v);
+		p = (*end == ',') ? end + 1 : end;
+	}
+	return values;
+}
+
+static bool parseOptions(int argc, char **argv, BenchOptions &options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const char *arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (std::strcmp(arg, "--blocks") == 0 && hasValue)
+		{
+			options.blockSizes = parseList(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--rates") == 0 && hasValue)
+		{
+			options.sampleRates = parseList(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--channels") == 0 && hasValue)
+		{
+			options.channelCounts = parseList(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--seconds") == 0 && hasValue)
+		{
+			options.seconds = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--notes") == 0 && hasValue)
+		{
+			options.notes = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--precision") == 0 && hasValue)
+		{
+			const char *value = argv[++i];
+			if (std::strcmp(value, "float") == 0)
+			{
+				options.precision = kPrecisionFloat;
+			}
+			else if (std::strcmp(value, "double") == 0)
+			{
+				options.precision = kPrecisionDouble;
+			}
+			else if (std::strcmp(value, "convert") == 0)
+			{
+				options.precision = kPrecisionConvert;
+			}
+			else
+			{
+				std::fprintf(stderr, "unknown precision: %s\n", value);
+				return false;
+			}
+		}
+		else if (std::strcmp(arg, "--input") == 0 && hasValue)
+		{
+			const char *value = argv[++i];
+			if (std::strcmp(value, "noise") == 0)
+			{
+				options.input = kInputNoise;
+			}
+			else if (std::strcmp(value, "silence") == 0)
+			{
+				options.input = kInputSilence;
+			}
+			else if (std::strcmp(value, "decay") == 0)
+			{
+				options.input = kInputDecay;
+			}
+			else
+			{
+				std::fprintf(stderr, "unknown input: %s\n", value);
+				return false;
+			}
+		}
+		else if (std::strcmp(arg, "--automate") == 0)
+		{
+			options.automate = true;
+		}
+		else if (std::strcmp(arg, "--automate-cc") == 0 && hasValue)
+		{
+			options.controlChanges = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--rt-check") == 0)
+		{
+			options.rtCheck = true;
+		}
+		else if (std::strcmp(arg, "--csv") == 0)
+		{
+			options.csv = true;
+		}
+		else if (arg[0] == '-')
+		{
+			std::fprintf(stderr, "unknown option: %s\n", arg);
+			return false;
+		}
+		else
+		{
+			options.plugins.push_back(arg);
+		}
+	}
+	return !options.plugins.empty() && !options.blockSizes.empty() && !options.sampleRates.empty() && !options.channelCounts.empty();
+}
+
+// ---------------------------------------------------------------------------------------
+// Audio buffers:
+// ---------------------------------------------------------------------------------------
+
+// Non-interleaved channel buffers plus the float** (or double**) arrays processReplacing()
+// (or processDoubleReplacing()) expects.
+template <typename Sample>
+class ChannelBuffers
+{
+public:
+	void allocate(int numChannels, int numSamples)
+	{
+		numSamples_ = numSamples;
+		data_.assign((size_t)numChannels * numSamples, Sample(0));
+		pointers_.resize(numChannels);
+		for (int c = 0; c < numChannels; ++c)
+		{
+			pointers_[c] = &data_[(size_t)c * numSamples];
+		}
+	}
+
+	void fillNoise(unsigned int seed, float amplitude)
+	{
+		for (size_t i = 0; i < data_.size(); ++i)
+		{
+			seed = seed * 1664525u + 1013904223u; // LCG, good enough for a test signal
+			data_[i] = amplitude * ((Sample)(seed >> 8) / Sample(8388608) - Sample(1));
+		}
+	}
+
+	Sample **channels(int first) { return pointers_.empty() ? NULL : &pointers_[first]; }
+
+	// Whole buffer, all channels:
+	Sample *data() { return data_.empty() ? NULL : &data_[0]; }
+	size_t size() const { return data_.size(); }
+
+	void clear() { std::fill(data_.begin(), data_.end(), Sample(0)); }
+
+private:
+	int numSamples_;
+	std::vector<Sample> data_;
+	std::vector<Sample *> pointers_;
+};
+
+template <typename From, typename To>
+static void convertBuffers(ChannelBuffers<From> &from, ChannelBuffers<To> &to)
+{
+	const From *x = from.data();
+	To *y = to.data();
+	for (size_t i = 0; i < from.size(); ++i)
+	{
+		y[i] = (To)x[i];
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// MIDI:
+// ---------------------------------------------------------------------------------------
+
+// A VstEvents list of note-ons, all at the start of the block (VstEvents ends in a variable
+// length array of event pointers, hence the raw storage):
+class NoteOnEvents
+{
+public:
+	explicit NoteOnEvents(int numNotes) : midi_(numNotes)
+	{
+		storage_.resize(sizeof(VstEvents) + numNotes*sizeof(VstEvent *));
+		VstEvents *events = list();
+		events->numEvents = numNotes;
+		events->reserved = 0;
+		for (int i = 0; i < numNotes; ++i)
+		{
+			VstMidiEvent &midi = midi_[i];
+			std::memset(&midi, 0, sizeof(midi));
+			midi.type = kVstMidiType;
+			midi.byteSize = sizeof(VstMidiEvent);
+			midi.deltaFrames = 0;
+			midi.midiData[0] = (char)0x90;         // note on, channel 1
+			midi.midiData[1] = (char)(24 + i % 96); // C1 upwards
+			midi.midiData[2] = 100;
+			events->events[i] = (VstEvent *)&midi;
+		}
+	}
+
+	VstEvents *list() { return (VstEvents *)&storage_[0]; }
+
+private:
+	std::vector<VstMidiEvent> midi_;
+	std::vector<char> storage_;
+};
+
+// A VstEvents list of control changes 20 + parameter at random, sorted deltaFrames; fill()
+// draws new ones for every block:
+class ControlChangeEvents
+{
+public:
+	explicit ControlChangeEvents(int numEvents) : midi_(numEvents), frames_(numEvents)
+	{
+		storage_.resize(sizeof(VstEvents) + numEvents*sizeof(VstEvent *));
+		VstEvents *events = list();
+		events->numEvents = numEvents;
+		events->reserved = 0;
+		for (int i = 0; i < numEvents; ++i)
+		{
+			std::memset(&midi_[i], 0, sizeof(midi_[i]));
+			midi_[i].type = kVstMidiType;
+			midi_[i].byteSize = sizeof(VstMidiEvent);
+			events->events[i] = (VstEvent *)&midi_[i];
+		}
+	}
+
+	void fill(int numParameters, int blockSize, unsigned int &seed)
+	{
+		for (size_t i = 0; i < frames_.size(); ++i)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			frames_[i] = (int)((seed >> 8) % (unsigned int)blockSize);
+		}
+		std::sort(frames_.begin(), frames_.end());
+		for (size_t i = 0; i < midi_.size(); ++i)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			midi_[i].deltaFrames = frames_[i];
+			midi_[i].midiData[0] = (char)0xB0; // control change, channel 1
+			midi_[i].midiData[1] = (char)(20 + (numParameters > 0 ? (int)i % numParameters : 0));
+			midi_[i].midiData[2] = (char)((seed >> 8) & 127);
+		}
+	}
+
+	VstEvents *list() { return (VstEvents *)&storage_[0]; }
+
+private:
+	std::vector<VstMidiEvent> midi_;
+	std::vector<int> frames_;
+	std::vector<char> storage_;
+};
+
+// ---------------------------------------------------------------------------------------
+// Benchmark:
+// ---------------------------------------------------------------------------------------
+
+struct BenchResult
+{
+	int instances;
+	int channels;
+	long blocks;
+	double nsPerSample;   // per channel sample
+	double blocksPerSecond;
+	double p50, p90, p99, maxTime; // block times in microseconds
+	double headroom;      // block period / p99 block time
+};
+
+static double percentile(const std::vector<double> &sorted, double p)
+{
+	size_t idx = (size_t)(p*(sorted.size() - 1) + 0.5);
+	return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+static bool runConfiguration(const std::string &path, int blockSize, int sampleRate, int requestedChannels,
+                             const BenchOptions &options, BenchResult &result)
+{
+	// Probe the plug-in's own channel count:
+	PluginInstance probe;
+	if (!probe.load(path.c_str()))
+	{
+		std::fprintf(stderr, "%s: %s\n", path.c_str(), probe.errorMessage().c_str());
+		return false;
+	}
+	const int pluginOutputs = std::max(1, (int)probe.numOutputs());
+	const int pluginInputs = (int)probe.numInputs();
+	const bool canDouble = probe.canDoubleReplacing();
+	probe.unload();
+
+	if (options.precision == kPrecisionDouble && !canDouble)
+	{
+		std::fprintf(stderr, "%s: no processDoubleReplacing() (try --precision convert)\n", path.c_str());
+		return false;
+	}
+
+	const int channels = requestedChannels > 0 ? requestedChannels : pluginOutputs;
+	const int numInstances = (channels + pluginOutputs - 1) / pluginOutputs;
+
+	std::vector<PluginInstance *> instances;
+	for (int i = 0; i < numInstances; ++i)
+	{
+		PluginInstance *instance = new PluginInstance;
+		if (!instance->load(path.c_str()))
+		{
+			std::fprintf(stderr, "%s: %s\n", path.c_str(), instance->errorMessage().c_str());
+			delete instance;
+			break;
+		}
+		instance->setSampleRate((float)sampleRate);
+		instance->setBlockSize(blockSize);
+		instance->resume();
+		instances.push_back(instance);
+	}
+
+	if ((int)instances.size() != numInstances)
+	{
+		for (size_t i = 0; i < instances.size(); ++i)
+		{
+			delete instances[i];
+		}
+		return false;
+	}
+
+	// The float buffers are used in float and convert mode, the double ones in double and
+	// convert mode:
+	ChannelBuffers<float> inputs, outputs;
+	ChannelBuffers<double> inputsDouble, outputsDouble;
+	inputs.allocate(std::max(1, numInstances * pluginInputs), blockSize);
+	outputs.allocate(numInstances * pluginOutputs, blockSize);
+	inputs.fillNoise(12345u, 0.25f);
+	inputsDouble.allocate(std::max(1, numInstances * pluginInputs), blockSize);
+	outputsDouble.allocate(numInstances * pluginOutputs, blockSize);
+	inputsDouble.fillNoise(12345u, 0.25);
+
+	const long warmupBlocks = 16;
+	const long numBlocks = std::max(256L, (long)(options.seconds * sampleRate / blockSize));
+	std::vector<double> blockTimes;
+	blockTimes.reserve(numBlocks);
+
+	if (options.notes > 0 && instances[0]->isSynth())
+	{
+		NoteOnEvents notes(options.notes);
+		RealtimeScope audioThread("processEvents");
+		for (int i = 0; i < numInstances; ++i)
+		{
+			instances[i]->processEvents(notes.list());
+		}
+	}
+
+	ControlChangeEvents controlChanges(options.controlChanges);
+
+	unsigned int seed = 777u;
+	double totalNs = 0.0;
+	for (long b = -warmupBlocks; b < numBlocks; ++b)
+	{
+		if ((options.input == kInputSilence && b == -warmupBlocks) || (options.input == kInputDecay && b == 0))
+		{
+			inputs.clear();
+			inputsDouble.clear();
+		}
+		if (options.automate)
+		{
+			for (int i = 0; i < numInstances; ++i)
+			{
+				for (VstInt32 p = 0; p < instances[i]->numParameters(); ++p)
+				{
+					seed = seed * 1664525u + 1013904223u;
+					instances[i]->setParameter(p, (float)(seed >> 8) / 16777216.0f);
+				}
+			}
+		}
+		if (options.controlChanges > 0)
+		{
+			controlChanges.fill(instances[0]->numParameters(), blockSize, seed);
+			RealtimeScope audioThread("processEvents");
+			for (int i = 0; i < numInstances; ++i)
+			{
+				instances[i]->processEvents(controlChanges.list());
+			}
+		}
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		if (options.precision == kPrecisionConvert)
+		{
+			convertBuffers(inputsDouble, inputs);
+		}
+		for (int i = 0; i < numInstances; ++i)
+		{
+			RealtimeScope audioThread(options.precision == kPrecisionDouble ? "processDoubleReplacing" : "processReplacing");
+			if (options.precision == kPrecisionDouble)
+			{
+				instances[i]->processDoubleReplacing(inputsDouble.channels(pluginInputs > 0 ? i * pluginInputs : 0),
+				                                     outputsDouble.channels(i * pluginOutputs), blockSize);
+			}
+			else
+			{
+				instances[i]->processReplacing(inputs.channels(pluginInputs > 0 ? i * pluginInputs : 0),
+				                               outputs.channels(i * pluginOutputs), blockSize);
+			}
+		}
+		if (options.precision == kPrecisionConvert)
+		{
+			convertBuffers(outputs, outputsDouble);
+		}
+		std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+
+		if (b >= 0)
+		{
+			double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+			blockTimes.push_back(ns);
+			totalNs += ns;
+		}
+	}
+
+	for (int i = 0; i < numInstances; ++i)
+	{
+		delete instances[i];
+	}
+
+	std::sort(blockTimes.begin(), blockTimes.end());
+	const double blockPeriodNs = 1e9*blockSize/sampleRate;
+
+	result.instances = numInstances;
+	result.channels = channels;
+	result.blocks = numBlocks;
+	result.nsPerSample = totalNs/((double)numBlocks*blockSize*channels);
+	result.blocksPerSecond = 1e9*numBlocks/totalNs;
+	result.p50 = percentile(blockTimes, 0.50)*1e-3;
+	result.p90 = percentile(blockTimes, 0.90)*1e-3;
+	result.p99 = percentile(blockTimes, 0.99)*1e-3;
+	result.maxTime = blockTimes.back()*1e-3;
+	result.headroom = blockPeriodNs/std::max(1.0, percentile(blockTimes, 0.99));
+	return true;
+}
+
+// ---------------------------------------------------------------------------------------
+// Main:
+// ---------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+	BenchOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		std::fprintf(stderr, "usage: %s [--blocks 16,...] [--rates 44100,...] [--channels 0,...] [--seconds s] [--notes n] [--precision float|double|convert] [--input noise|silence|decay] [--automate] [--automate-cc n] [--rt-check] [--csv] plugin.so ...\n", argv[0]);
+		return 2;
+	}
+	if (options.rtCheck && !enableRealtimeChecks())
+	{
+		std::fprintf(stderr, "--rt-check needs Linux with glibc\n");
+		return 2;
+	}
+
+	if (options.csv)
+	{
+		std::printf("plugin,rate,block,channels,instances,blocks,ns_per_sample,blocks_per_s,p50_us,p90_us,p99_us,max_us,headroom\n");
+	}
+
+	int failures = 0;
+	for (size_t p = 0; p < options.plugins.size(); ++p)
+	{
+		const std::string &path = options.plugins[p];
+		resetRealtimeViolations();
+		if (!options.csv)
+		{
+			std::printf("\n%s\n", path.c_str());
+			std::printf("%6s %5s %4s %8s %10s %9s %9s %9s %9s %9s\n",
+			            "rate", "block", "ch", "ns/smp", "blocks/s", "p50 us", "p90 us", "p99 us", "max us", "headroom");
+		}
+
+		for (size_t r = 0; r < options.sampleRates.size(); ++r)
+		{
+			for (size_t c = 0; c < options.channelCounts.size(); ++c)
+			{
+				for (size_t b = 0; b < options.blockSizes.size(); ++b)
+				{
+					BenchResult res;
+					if (!runConfiguration(path, options.blockSizes[b], options.sampleRates[r], options.channelCounts[c], options, res))
+					{
+						++failures;
+						continue;
+					}
+					if (options.csv)
+					{
+						std::printf("%s,%d,%d,%d,%d,%ld,%.4f,%.1f,%.3f,%.3f,%.3f,%.3f,%.2f\n",
+						            path.c_str(), options.sampleRates[r], options.blockSizes[b], res.channels, res.instances,
+						            res.blocks, res.nsPerSample, res.blocksPerSecond, res.p50, res.p90, res.p99, res.maxTime, res.headroom);
+					}
+					else
+					{
+						std::printf("%6d %5d %4d %8.3f %10.0f %9.2f %9.2f %9.2f %9.2f %8.1fx\n",
+						            options.sampleRates[r], options.blockSizes[b], res.channels, res.nsPerSample,
+						            res.blocksPerSecond, res.p50, res.p90, res.p99, res.maxTime, res.headroom);
+					}
+				}
+			}
+		}
+
+		if (options.rtCheck)
+		{
+			const long long violations = realtimeViolations();
+			std::fprintf(stderr, "rt-check: %s: %lld real-time safety violations from %d call stacks\n",
+			             path.c_str(), violations, realtimeViolationSites());
+			failures += violations > 0 ? 1 : 0;
+		}
+	}
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,402 @@
+// Offline host for a mixer of many tracks, each running the same chain of MyVstPlugIn-exN
+// effects (e.g. ex1 gain -> ex3 filter -> ex2 balance), spread over threads with
+// ParallelExecutor.
+//
+// Every block has two phases, each a join: all track chains in parallel (each a PluginGraph
+// with its own noise input), then the buses, each summing its tracks (track t goes to bus
+// t % buses), in parallel; the calling thread sums the buses into the master. Renders the
+// same audio for every thread count and reports blocks/s, the speedup over the first thread
+// count, block time percentiles, the deadline misses (blocks that took longer than their own
+// duration), the steals per block and whether the master output is identical to the first.
+//
+// Usage: MixerHost [options] plugin.so [plugin.so ...]
+//   --tracks 128              number of tracks, each with the chain of plug-ins given
+//   --buses 8                 number of buses
+//   --threads 1,2,4           thread counts to run, the calling thread included;
+//                             default 1, 2, 4, ... up to the number of cores
+//   --block 256               block size
+//   --rate 48000              sample rate
+//   --seconds 5               audio seconds rendered per thread count
+//   --no-pin                  do not pin the worker threads to cores
+//   --csv                     print comma separated values instead of a table
+//
+// Built by the CMake project in VST/ together with the plug-ins when VSTSDK_DIR is set.
+
+#include "ParallelExecutor.hxx"
+#include "PluginGraph.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------------------------------------
+// Options:
+// ---------------------------------------------------------------------------------------
+
+struct MixerOptions
+{
+	int tracks;
+	int buses;
+	std::vector<int> threadCounts;
+	int blockSize;
+	int sampleRate;
+	double seconds;
+	bool pin;
+	bool csv;
+	std::vector<std::string> plugins;
+
+	MixerOptions() : tracks(128), buses(8), blockSize(256), sampleRate(48000), seconds(5.0), pin(true), csv(false)
+	{
+		const int cores = std::max(1, (int)std::thread::hardware_concurrency());
+		for (int n = 1; n < cores; n *= 2)
+		{
+			threadCounts.push_back(n);
+		}
+		threadCounts.push_back(cores);
+	}
+};
+
+static std::vector<int> parseList(const char *text)
+{
+	std::vector<int> values;
+	const char *p = text;
+	while (*p != '\0')
+	{
+		char *end;
+		long v = std::strtol(p, &end, 10);
+		if (end == p)
+		{
+			break;
+		}
+		values.push_back((int)v);
+		p = (*end == ',') ? end + 1 : end;
+	}
+	return values;
+}
+
+static bool parseOptions(int argc, char **argv, MixerOptions &options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const char *arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (std::strcmp(arg, "--tracks") == 0 && hasValue)
+		{
+			options.tracks = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--buses") == 0 && hasValue)
+		{
+			options.buses = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--threads") == 0 && hasValue)
+		{
+			options.threadCounts = parseList(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--block") == 0 && hasValue)
+		{
+			options.blockSize = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--rate") == 0 && hasValue)
+		{
+			options.sampleRate = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--seconds") == 0 && hasValue)
+		{
+			options.seconds = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--no-pin") == 0)
+		{
+			options.pin = false;
+		}
+		else if (std::strcmp(arg, "--csv") == 0)
+		{
+			options.csv = true;
+		}
+		else if (arg[0] == '-')
+		{
+			std::fprintf(stderr, "unknown option: %s\n", arg);
+			return false;
+		}
+		else
+		{
+			options.plugins.push_back(arg);
+		}
+	}
+	for (size_t t = 0; t < options.threadCounts.size(); ++t)
+	{
+		if (options.threadCounts[t] < 1)
+		{
+			return false;
+		}
+	}
+	return !options.plugins.empty() && !options.threadCounts.empty() && options.tracks >= 1 && options.buses >= 1
+	       && options.blockSize >= 1 && options.sampleRate > 0;
+}
+
+// ---------------------------------------------------------------------------------------
+// Mixer:
+// ---------------------------------------------------------------------------------------
+
+enum { kChannels = 2 };
+
+// Stereo buffer with the float** the plug-ins expect:
+struct StereoBuffer
+{
+	std::vector<float> data;
+	float *channels[kChannels];
+
+	void allocate(int numSamples)
+	{
+		data.assign((size_t)kChannels*numSamples, 0.0f);
+		for (int c = 0; c < kChannels; ++c)
+		{
+			channels[c] = &data[(size_t)c*numSamples];
+		}
+	}
+};
+
+class Mixer
+{
+public:
+	~Mixer()
+	{
+		for (size_t t = 0; t < tracks_.size(); ++t)
+		{
+			delete tracks_[t];
+		}
+	}
+
+	bool setup(const MixerOptions &options)
+	{
+		blockSize_ = options.blockSize;
+		numBuses_ = options.buses;
+		inputs_.resize(options.tracks);
+		outputs_.resize(options.tracks);
+		buses_.resize(options.buses);
+		master_.allocate(blockSize_);
+		for (int t = 0; t < options.tracks; ++t)
+		{
+			PluginGraph *graph = new PluginGraph;
+			tracks_.push_back(graph);
+			for (size_t p = 0; p < options.plugins.size(); ++p)
+			{
+				if (graph->addPlugin(options.plugins[p].c_str()) < 0)
+				{
+					std::fprintf(stderr, "%s\n", graph->errorMessage().c_str());
+					return false;
+				}
+				if (p > 0)
+				{
+					graph->connect((int)p - 1, (int)p);
+				}
+			}
+			if (!graph->prepare((float)options.sampleRate, blockSize_, kChannels, kChannels))
+			{
+				std::fprintf(stderr, "%s\n", graph->errorMessage().c_str());
+				return false;
+			}
+
+			// A different noise for every track; the graph does not write its input:
+			inputs_[t].allocate(blockSize_);
+			unsigned int seed = 12345u + 977u*t;
+			for (size_t i = 0; i < inputs_[t].data.size(); ++i)
+			{
+				seed = seed*1664525u + 1013904223u; // LCG, good enough for a test signal
+				inputs_[t].data[i] = 0.25f*((float)(seed >> 8)/8388608.0f - 1.0f);
+			}
+			outputs_[t].allocate(blockSize_);
+		}
+		for (int b = 0; b < numBuses_; ++b)
+		{
+			buses_[b].allocate(blockSize_);
+		}
+		return true;
+	}
+
+	int numTracks() const { return (int)tracks_.size(); }
+
+	// The phases of a block, as tasks for ParallelExecutor::run():
+	void processTrack(int t)
+	{
+		tracks_[t]->process(inputs_[t].channels, outputs_[t].channels, blockSize_);
+	}
+
+	void sumBus(int b)
+	{
+		for (int c = 0; c < kChannels; ++c)
+		{
+			float *y = buses_[b].channels[c];
+			std::fill(y, y + blockSize_, 0.0f);
+			for (int t = b; t < numTracks(); t += numBuses_)
+			{
+				const float *x = outputs_[t].channels[c];
+				for (int j = 0; j < blockSize_; ++j)
+				{
+					y[j] += x[j];
+				}
+			}
+		}
+	}
+
+	const StereoBuffer &sumMaster()
+	{
+		for (int c = 0; c < kChannels; ++c)
+		{
+			float *y = master_.channels[c];
+			std::fill(y, y + blockSize_, 0.0f);
+			for (int b = 0; b < numBuses_; ++b)
+			{
+				const float *x = buses_[b].channels[c];
+				for (int j = 0; j < blockSize_; ++j)
+				{
+					y[j] += x[j];
+				}
+			}
+		}
+		return master_;
+	}
+
+private:
+	int blockSize_;
+	int numBuses_;
+	std::vector<PluginGraph *> tracks_;
+	std::vector<StereoBuffer> inputs_, outputs_, buses_;
+	StereoBuffer master_;
+};
+
+// ---------------------------------------------------------------------------------------
+// Benchmark:
+// ---------------------------------------------------------------------------------------
+
+struct MixerResult
+{
+	long blocks;
+	double blocksPerSecond;
+	double p50, p99, maxTime; // block times in microseconds
+	long misses;              // blocks longer than the block period
+	double stealsPerBlock;
+	std::vector<float> master; // left channel, for the comparison
+};
+
+static double percentile(const std::vector<double> &sorted, double p)
+{
+	size_t idx = (size_t)(p*(sorted.size() - 1) + 0.5);
+	return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+// Fresh plug-in instances every time, so each thread count renders the same audio:
+static bool runMixer(const MixerOptions &options, int numThreads, MixerResult &result)
+{
+	Mixer mixer;
+	if (!mixer.setup(options))
+	{
+		return false;
+	}
+	ParallelExecutor executor;
+	executor.start(numThreads, std::max(options.tracks, options.buses), options.pin);
+
+	struct TrackTask
+	{
+		Mixer *mixer;
+		void operator()(int t) { mixer->processTrack(t); }
+	} trackTask = { &mixer };
+	struct BusTask
+	{
+		Mixer *mixer;
+		void operator()(int b) { mixer->sumBus(b); }
+	} busTask = { &mixer };
+
+	const long numBlocks = std::max(64L, (long)(options.seconds*options.sampleRate/options.blockSize));
+	const double blockPeriodNs = 1e9*options.blockSize/options.sampleRate;
+	std::vector<double> blockTimes;
+	blockTimes.reserve(numBlocks);
+	result.master.assign((size_t)numBlocks*options.blockSize, 0.0f);
+	result.misses = 0;
+	double totalNs = 0.0;
+	for (long b = 0; b < numBlocks; ++b)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		executor.run(mixer.numTracks(), trackTask);
+		executor.run(options.buses, busTask);
+		const StereoBuffer &master = mixer.sumMaster();
+		std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+
+		const double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+		blockTimes.push_back(ns);
+		totalNs += ns;
+		result.misses += ns > blockPeriodNs ? 1 : 0;
+		std::copy(master.channels[0], master.channels[0] + options.blockSize, result.master.begin() + (size_t)b*options.blockSize);
+	}
+	result.stealsPerBlock = (double)executor.steals()/numBlocks;
+	executor.stop();
+
+	std::sort(blockTimes.begin(), blockTimes.end());
+	result.blocks = numBlocks;
+	result.blocksPerSecond = 1e9*numBlocks/totalNs;
+	result.p50 = percentile(blockTimes, 0.50)*1e-3;
+	result.p99 = percentile(blockTimes, 0.99)*1e-3;
+	result.maxTime = blockTimes.back()*1e-3;
+	return true;
+}
+
+// ---------------------------------------------------------------------------------------
+// Main:
+// ---------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+	MixerOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		std::fprintf(stderr, "usage: %s [--tracks n] [--buses n] [--threads 1,2,...] [--block n] [--rate hz] [--seconds s] [--no-pin] [--csv] plugin.so ...\n", argv[0]);
+		return 2;
+	}
+
+	if (options.csv)
+	{
+		std::printf("threads,tracks,buses,block,rate,blocks,blocks_per_s,speedup,p50_us,p99_us,max_us,misses,steals_per_block,identical\n");
+	}
+	else
+	{
+		std::printf("%d tracks, %d buses, %d samples at %d Hz (%.2f ms per block)\n", options.tracks, options.buses,
+		            options.blockSize, options.sampleRate, 1e3*options.blockSize/options.sampleRate);
+		std::printf("%7s %10s %8s %9s %9s %9s %8s %7s %9s\n", "threads", "blocks/s", "speedup", "p50 us", "p99 us", "max us", "misses",
+		            "steals", "identical");
+	}
+
+	MixerResult first = MixerResult();
+	int failures = 0;
+	for (size_t n = 0; n < options.threadCounts.size(); ++n)
+	{
+		MixerResult result;
+		if (!runMixer(options, options.threadCounts[n], result))
+		{
+			return 1;
+		}
+		if (n == 0)
+		{
+			first = result;
+		}
+		const bool identical = result.master == first.master;
+		failures += identical ? 0 : 1;
+		const double speedup = result.blocksPerSecond/first.blocksPerSecond;
+		if (options.csv)
+		{
+			std::printf("%d,%d,%d,%d,%d,%ld,%.1f,%.3f,%.3f,%.3f,%.3f,%ld,%.2f,%d\n", options.threadCounts[n], options.tracks,
+			            options.buses, options.blockSize, options.sampleRate, result.blocks, result.blocksPerSecond, speedup,
+			            result.p50, result.p99, result.maxTime, result.misses, result.stealsPerBlock, identical ? 1 : 0);
+		}
+		else
+		{
+			std::printf("%7d %10.1f %7.2fx %9.1f %9.1f %9.1f %8ld %7.1f %9s\n", options.threadCounts[n], result.blocksPerSecond,
+			            speedup, result.p50, result.p99, result.maxTime, result.misses, result.stealsPerBlock,
+			            identical ? "yes" : "NO");
+		}
+	}
+	return failures == 0 ? 0 : 1;
+}
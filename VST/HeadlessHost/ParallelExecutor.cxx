@@ -0,0 +1,214 @@
+#include "ParallelExecutor.hxx"
+
+#include <pthread.h>
+#include <sched.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Busy-waits for a condition, giving the core away after a while in case the thread being
+// waited for is not running (more threads than cores):
+template <typename Condition>
+static void spinUntil(Condition condition)
+{
+	for (int spins = 0; !condition(); ++spins)
+	{
+		if (spins < 4096)
+		{
+#if defined(__SSE2__)
+			_mm_pause();
+#endif
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// Deque:
+// ---------------------------------------------------------------------------------------
+
+void WorkStealingDeque::setup(int capacity)
+{
+	long long size = 1;
+	while (size < capacity)
+	{
+		size *= 2;
+	}
+	items_.reset(new std::atomic<int>[size]);
+	mask_ = size - 1;
+	top_.store(0);
+	bottom_.store(0);
+}
+
+// ---------------------------------------------------------------------------------------
+// Executor:
+// ---------------------------------------------------------------------------------------
+
+ParallelExecutor::ParallelExecutor()
+	: numThreads_(0), function_(NULL), context_(NULL), numTasks_(0), quit_(false), completed_(0), active_(0)
+{
+}
+
+ParallelExecutor::~ParallelExecutor()
+{
+	stop();
+}
+
+void ParallelExecutor::start(int numThreads, int maxTasks, bool pin)
+{
+	stop();
+	numThreads_ = numThreads < 1 ? 1 : numThreads;
+	deques_.reset(new WorkStealingDeque[numThreads_]);
+	states_.reset(new ThreadState[numThreads_]);
+	for (int t = 0; t < numThreads_; ++t)
+	{
+		deques_[t].setup(maxTasks);
+		sem_init(&states_[t].wake, 0, 0);
+		states_[t].steals.store(0);
+		states_[t].tasksRun.store(0);
+	}
+	quit_ = false;
+	active_.store(0);
+	for (int t = 1; t < numThreads_; ++t)
+	{
+		workers_.push_back(std::thread(&ParallelExecutor::workerMain, this, t, pin));
+	}
+}
+
+void ParallelExecutor::stop()
+{
+	if (numThreads_ == 0)
+	{
+		return;
+	}
+	spinUntil([this]() { return active_.load(std::memory_order_acquire) == 0; });
+	quit_ = true;
+	for (int t = 1; t < numThreads_; ++t)
+	{
+		sem_post(&states_[t].wake);
+	}
+	for (size_t w = 0; w < workers_.size(); ++w)
+	{
+		workers_[w].join();
+	}
+	workers_.clear();
+	for (int t = 0; t < numThreads_; ++t)
+	{
+		sem_destroy(&states_[t].wake);
+	}
+	numThreads_ = 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void ParallelExecutor::runTasks(int numTasks, TaskFunction function, void *context)
+{
+	if (numThreads_ <= 1)
+	{
+		for (int i = 0; i < numTasks; ++i)
+		{
+			function(context, i);
+		}
+		states_[0].tasksRun.fetch_add(numTasks, std::memory_order_relaxed);
+		return;
+	}
+
+	// A worker late for the last phase may still be looking at the deques:
+	spinUntil([this]() { return active_.load(std::memory_order_acquire) == 0; });
+
+	function_ = function;
+	context_ = context;
+	numTasks_ = numTasks;
+	completed_.store(0, std::memory_order_relaxed);
+	// Every worker is parked or past its last look at the deques (active_ is 0), so this thread
+	// may push onto all of them; active_ and the semaphores publish the items:
+	for (int i = 0; i < numTasks; ++i)
+	{
+		deques_[i % numThreads_].push(i);
+	}
+	active_.store(numThreads_ - 1, std::memory_order_release);
+	for (int t = 1; t < numThreads_; ++t)
+	{
+		sem_post(&states_[t].wake); // publishes the phase
+	}
+
+	work(0);
+	spinUntil([this, numTasks]() { return completed_.load(std::memory_order_acquire) == numTasks; });
+}
+
+// Own deque first, then steal, starting with the next thread, until every deque is empty
+// (nothing is pushed during a phase, so empty stays empty):
+void ParallelExecutor::work(int thread)
+{
+	ThreadState &state = states_[thread];
+	int task;
+	long long steals = 0, done = 0;
+	for (;;)
+	{
+		bool found = deques_[thread].pop(task);
+		for (int k = 1; !found && k < numThreads_; ++k)
+		{
+			WorkStealingDeque &victim = deques_[(thread + k) % numThreads_];
+			while (!victim.empty() && !(found = victim.steal(task)))
+			{
+				// lost a race for an item, try again
+			}
+			steals += found ? 1 : 0;
+		}
+		if (!found)
+		{
+			break;
+		}
+		function_(context_, task);
+		++done;
+		completed_.fetch_add(1, std::memory_order_acq_rel);
+	}
+	state.steals.fetch_add(steals, std::memory_order_relaxed);
+	state.tasksRun.fetch_add(done, std::memory_order_relaxed);
+}
+
+void ParallelExecutor::workerMain(int thread, bool pin)
+{
+	if (pin)
+	{
+		const int numCores = (int)std::thread::hardware_concurrency();
+		cpu_set_t cores;
+		CPU_ZERO(&cores);
+		CPU_SET(numCores > 0 ? thread % numCores : 0, &cores);
+		pthread_setaffinity_np(pthread_self(), sizeof(cores), &cores);
+	}
+	for (;;)
+	{
+		while (sem_wait(&states_[thread].wake) != 0)
+		{
+			// EINTR
+		}
+		if (quit_)
+		{
+			return;
+		}
+		work(thread);
+		active_.fetch_sub(1, std::memory_order_acq_rel);
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+long long ParallelExecutor::steals() const
+{
+	long long total = 0;
+	for (int t = 0; t < numThreads_; ++t)
+	{
+		total += states_[t].steals.load(std::memory_order_relaxed);
+	}
+	return total;
+}
+
+long long ParallelExecutor::tasksRun(int thread) const
+{
+	return states_[thread].tasksRun.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,158 @@
+#ifndef INCLUDED_PARALLELEXECUTOR_HXX
+#define INCLUDED_PARALLELEXECUTOR_HXX
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <semaphore.h>
+
+// ---------------------------------------------------------------------------------------
+// Work-stealing execution of independent tasks (e.g. plug-in chains), once per block.
+// ---------------------------------------------------------------------------------------
+
+// Chase-Lev deque of task indices, fixed capacity (a power of two, no growth): the owner
+// pushes and pops at the bottom, the other threads steal from the top. Lock-free; only the
+// last item is contended, through a compare-and-swap on top. (Lê, Pop, Cohen, Zappa Nardelli,
+// "Correct and efficient work-stealing for weak memory models", 2013.)
+class WorkStealingDeque
+{
+public:
+	WorkStealingDeque() : top_(0), bottom_(0), mask_(0) {}
+
+	void setup(int capacity); // allocates; not while in use
+
+	// Owner only, or any single thread while no other thread uses the deque (the executor
+	// seeds every deque from the caller thread between phases, while the workers are parked
+	// or done with it; the release of the phase then publishes the items):
+	void push(int task)
+	{
+		const long long b = bottom_.load(std::memory_order_relaxed);
+		items_[b & mask_].store(task, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom_.store(b + 1, std::memory_order_relaxed);
+	}
+
+	bool pop(int &task)
+	{
+		const long long b = bottom_.load(std::memory_order_relaxed) - 1;
+		bottom_.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		long long t = top_.load(std::memory_order_relaxed);
+		if (t > b)
+		{
+			bottom_.store(b + 1, std::memory_order_relaxed); // empty
+			return false;
+		}
+		task = items_[b & mask_].load(std::memory_order_relaxed);
+		if (t == b)
+		{
+			// The last item: whoever moves top first gets it.
+			const bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			bottom_.store(b + 1, std::memory_order_relaxed);
+			return won;
+		}
+		return true;
+	}
+
+	// Any thread; false when empty or when another thread took the item first:
+	bool steal(int &task)
+	{
+		long long t = top_.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const long long b = bottom_.load(std::memory_order_acquire);
+		if (t >= b)
+		{
+			return false;
+		}
+		task = items_[t & mask_].load(std::memory_order_relaxed);
+		return top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+
+	bool empty() const
+	{
+		return top_.load(std::memory_order_acquire) >= bottom_.load(std::memory_order_acquire);
+	}
+
+private:
+	// On separate cache lines, the owner writes bottom, the thieves top:
+	std::atomic<long long> top_;
+	char padding_[64];
+	std::atomic<long long> bottom_;
+	long long mask_;
+	std::unique_ptr<std::atomic<int>[]> items_;
+};
+
+// Runs task(index) for every index of [0, numTasks) on a pool of worker threads plus the
+// calling thread, and returns when all are done: the join at a summing point. run() can be
+// called once per phase of a block (e.g. the tracks, then the buses that sum them).
+//
+// The tasks are dealt round-robin to one deque per thread before the workers are woken; each
+// thread pops its own and then steals from the others, so an expensive chain does not hold
+// up the ones dealt after it. The workers sleep on a semaphore between phases and can be
+// pinned to one core each (the caller, the host's audio thread, is left alone). run() does
+// not allocate or lock; the calling thread spins for the last tasks of the others.
+class ParallelExecutor
+{
+public:
+	ParallelExecutor();
+	~ParallelExecutor();
+
+	// numThreads includes the caller (1 = everything on the calling thread); maxTasks bounds
+	// numTasks of run(). Starts the workers, pinned to cores 1, 2, ... if pin is set.
+	void start(int numThreads, int maxTasks, bool pin);
+	void stop();
+
+	int numThreads() const { return numThreads_; }
+
+	template <typename Task>
+	void run(int numTasks, Task &task)
+	{
+		runTasks(numTasks, &callTask<Task>, &task);
+	}
+
+	// Statistics since start(): tasks taken from another thread's deque, tasks per thread.
+	long long steals() const;
+	long long tasksRun(int thread) const;
+
+private:
+	ParallelExecutor(const ParallelExecutor &);
+	ParallelExecutor &operator=(const ParallelExecutor &);
+
+	typedef void (*TaskFunction)(void *context, int index);
+
+	template <typename Task>
+	static void callTask(void *context, int index)
+	{
+		(*(Task *)context)(index);
+	}
+
+	void runTasks(int numTasks, TaskFunction function, void *context);
+	void work(int thread); // the calling thread's or a worker's share of a phase
+	void workerMain(int thread, bool pin);
+
+	struct ThreadState
+	{
+		sem_t wake;
+		std::atomic<long long> steals;
+		std::atomic<long long> tasksRun;
+		char padding[64]; // one per cache line, roughly
+	};
+
+	int numThreads_;
+	std::unique_ptr<WorkStealingDeque[]> deques_;
+	std::unique_ptr<ThreadState[]> states_;
+	std::vector<std::thread> workers_;
+
+	// The current phase, published by the semaphore posts:
+	TaskFunction function_;
+	void *context_;
+	int numTasks_;
+	bool quit_;
+	std::atomic<int> completed_; // tasks done in this phase
+	char padding_[64];
+	std::atomic<int> active_;    // workers not yet out of the last phase
+};
+
+#endif
@@ -0,0 +1,522 @@
+#include "PluginGraph.hxx"
+
+#include <algorithm>
+#include <cstdio>
+
+// ---------------------------------------------------------------------------------------
+// Constructor / destructor:
+// ---------------------------------------------------------------------------------------
+
+PluginGraph::PluginGraph()
+	: numInputs_(0), numOutputs_(0), maxBlockSize_(0), numBuffers_(0), numCopies_(0), latency_(0)
+{
+}
+
+PluginGraph::~PluginGraph()
+{
+	for (size_t i = 0; i < nodes_.size(); ++i)
+	{
+		delete nodes_[i].instance;
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// Building:
+// ---------------------------------------------------------------------------------------
+
+int PluginGraph::addPlugin(const char *path)
+{
+	PluginInstance *instance = new PluginInstance;
+	if (!instance->load(path))
+	{
+		error_ = std::string(path) + ": " + instance->errorMessage();
+		delete instance;
+		return -1;
+	}
+	Node node;
+	node.instance = instance;
+	nodes_.push_back(node);
+	return (int)nodes_.size() - 1;
+}
+
+bool PluginGraph::connect(int from, int to)
+{
+	const int n = (int)nodes_.size();
+	if (from < kGraphInput || from >= n || to < 0 || to >= n || from == to)
+	{
+		char text[128];
+		std::snprintf(text, sizeof(text), "bad connection %d -> %d (%d nodes)", from, to, n);
+		error_ = text;
+		return false;
+	}
+	nodes_[to].sources.push_back(from);
+	return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Channels of the source feeding channel `channel` of an input with `numChannels`, and their
+// weight: the source's channels repeated when there are more inputs, averaged when fewer.
+static void adaptChannels(int numSourceChannels, int numChannels, int channel, std::vector<std::pair<int, float> > &terms)
+{
+	terms.clear();
+	if (numSourceChannels == 0)
+	{
+		return;
+	}
+	if (numChannels >= numSourceChannels)
+	{
+		terms.push_back(std::make_pair(channel % numSourceChannels, 1.0f));
+		return;
+	}
+	for (int c = channel; c < numSourceChannels; c += numChannels)
+	{
+		terms.push_back(std::make_pair(c, 0.0f));
+	}
+	for (size_t k = 0; k < terms.size(); ++k)
+	{
+		terms[k].second = 1.0f/terms.size();
+	}
+}
+
+bool PluginGraph::prepare(float sampleRate, int maxBlockSize, int numInputs, int numOutputs, bool inPlace)
+{
+	error_.clear();
+	numInputs_ = numInputs;
+	numOutputs_ = numOutputs;
+	maxBlockSize_ = maxBlockSize;
+	numBuffers_ = 0;
+	numCopies_ = 0;
+	outputMixes_.clear();
+	const int n = (int)nodes_.size();
+
+	// Topological order, lowest index first among the nodes ready:
+	std::vector<std::vector<int> > consumers(n);
+	std::vector<int> pending(n, 0);
+	for (int i = 0; i < n; ++i)
+	{
+		if (nodes_[i].sources.empty())
+		{
+			nodes_[i].sources.push_back(kGraphInput);
+		}
+		for (size_t s = 0; s < nodes_[i].sources.size(); ++s)
+		{
+			const int source = nodes_[i].sources[s];
+			if (source != kGraphInput)
+			{
+				consumers[source].push_back(i);
+				++pending[i];
+			}
+		}
+	}
+	order_.clear();
+	std::vector<bool> done(n, false);
+	while ((int)order_.size() < n)
+	{
+		int next = 0;
+		while (next < n && (done[next] || pending[next] > 0))
+		{
+			++next;
+		}
+		if (next == n)
+		{
+			error_ = "the connections form a cycle";
+			return false;
+		}
+		done[next] = true;
+		order_.push_back(next);
+		for (size_t c = 0; c < consumers[next].size(); ++c)
+		{
+			--pending[consumers[next][c]];
+		}
+	}
+
+	std::vector<int> sinks;
+	for (int i = 0; i < n; ++i)
+	{
+		if (consumers[i].empty())
+		{
+			sinks.push_back(i);
+		}
+	}
+	if (sinks.empty())
+	{
+		sinks.push_back(kGraphInput); // no plug-ins: input to output
+	}
+
+	// How many times each channel of each node (index + 1, 0 = graph input) is read:
+	std::vector<std::vector<int> > reads(n + 1);
+	reads[0].assign(numInputs, 0);
+	for (int i = 0; i < n; ++i)
+	{
+		reads[i + 1].assign(nodes_[i].instance->numOutputs(), 0);
+	}
+	std::vector<std::pair<int, float> > adapted;
+	for (int i = 0; i <= n; ++i)
+	{
+		const std::vector<int> &sources = i < n ? nodes_[i].sources : sinks;
+		const int numChannels = i < n ? nodes_[i].instance->numInputs() : numOutputs;
+		for (size_t s = 0; s < sources.size(); ++s)
+		{
+			std::vector<int> &sourceReads = reads[sources[s] + 1];
+			for (int c = 0; c < numChannels; ++c)
+			{
+				adaptChannels((int)sourceReads.size(), numChannels, c, adapted);
+				for (size_t k = 0; k < adapted.size(); ++k)
+				{
+					++sourceReads[adapted[k].first];
+				}
+			}
+		}
+	}
+
+	// Walk the nodes in order, giving every channel a buffer id. remaining[id] counts the
+	// reads still to come of a pool buffer; at 0 it goes back to the free list.
+	const int firstPoolId = numInputs + numOutputs;
+	std::vector<std::vector<int> > ids(n + 1);
+	for (int c = 0; c < numInputs; ++c)
+	{
+		ids[0].push_back(c);
+	}
+	std::vector<int> remaining, freeIds;
+	auto take = [&]() {
+		if (inPlace && !freeIds.empty())
+		{
+			const int id = freeIds.back();
+			freeIds.pop_back();
+			return id;
+		}
+		remaining.push_back(0);
+		return firstPoolId + numBuffers_++;
+	};
+	const bool direct = inPlace && sinks.size() == 1 && sinks[0] != kGraphInput
+	                    && nodes_[sinks[0]].instance->numOutputs() == numOutputs;
+
+	for (size_t o = 0; o < order_.size(); ++o)
+	{
+		const int i = order_[o];
+		Node &node = nodes_[i];
+		const int numIn = node.instance->numInputs();
+		const int numOut = node.instance->numOutputs();
+		node.mixes.clear();
+		node.inputIds.assign(numIn, -1);
+		node.outputIds.assign(numOut, -1);
+
+		// Inputs: a pointer to the source channel when nothing has to be computed, else a mix,
+		// in place into its first source if nobody reads that afterwards:
+		for (int c = 0; c < numIn; ++c)
+		{
+			Mix mix;
+			for (size_t s = 0; s < node.sources.size(); ++s)
+			{
+				const std::vector<int> &sourceIds = ids[node.sources[s] + 1];
+				adaptChannels((int)sourceIds.size(), numIn, c, adapted);
+				for (size_t k = 0; k < adapted.size(); ++k)
+				{
+					Term term = { sourceIds[adapted[k].first], adapted[k].second };
+					mix.terms.push_back(term);
+				}
+			}
+			if (inPlace && mix.terms.size() == 1 && mix.terms[0].gain == 1.0f)
+			{
+				node.inputIds[c] = mix.terms[0].id;
+				continue;
+			}
+			const int first = mix.terms.empty() ? -1 : mix.terms[0].id;
+			if (inPlace && first >= firstPoolId && remaining[first - firstPoolId] == 1)
+			{
+				mix.dest = first;
+			}
+			else
+			{
+				mix.dest = take();
+				remaining[mix.dest - firstPoolId] = 1;
+			}
+			for (size_t k = 0; k < mix.terms.size(); ++k)
+			{
+				const int id = mix.terms[k].id;
+				if (id >= firstPoolId && id != mix.dest && --remaining[id - firstPoolId] == 0)
+				{
+					freeIds.push_back(id);
+				}
+			}
+			node.inputIds[c] = mix.dest;
+			node.mixes.push_back(mix);
+		}
+
+		// Outputs: the graph output for the last node, or in place over an input channel read
+		// by nobody else, or a free buffer (never one of the inputs, still held):
+		for (int c = 0; c < numOut; ++c)
+		{
+			if (direct && i == sinks[0])
+			{
+				node.outputIds[c] = numInputs + c;
+				continue;
+			}
+			const int in = c < numIn ? node.inputIds[c] : -1;
+			if (inPlace && in >= firstPoolId && remaining[in - firstPoolId] == 1
+			    && std::count(node.inputIds.begin(), node.inputIds.end(), in) == 1)
+			{
+				node.outputIds[c] = in;
+				continue;
+			}
+			node.outputIds[c] = take();
+		}
+
+		// The inputs have been read; the outputs wait for their readers:
+		for (int c = 0; c < numIn; ++c)
+		{
+			const int id = node.inputIds[c];
+			if (id >= firstPoolId && --remaining[id - firstPoolId] == 0
+			    && std::find(node.outputIds.begin(), node.outputIds.end(), id) == node.outputIds.end())
+			{
+				freeIds.push_back(id);
+			}
+		}
+		for (int c = 0; c < numOut; ++c)
+		{
+			const int id = node.outputIds[c];
+			if (id >= firstPoolId)
+			{
+				remaining[id - firstPoolId] = reads[i + 1][c];
+				if (reads[i + 1][c] == 0)
+				{
+					freeIds.push_back(id);
+				}
+			}
+		}
+		ids[i + 1] = node.outputIds;
+		numCopies_ += (int)node.mixes.size();
+	}
+
+	// The sum of the last nodes into the graph output, unless written there directly:
+	if (!direct)
+	{
+		for (int c = 0; c < numOutputs; ++c)
+		{
+			Mix mix;
+			mix.dest = numInputs + c;
+			for (size_t s = 0; s < sinks.size(); ++s)
+			{
+				const std::vector<int> &sourceIds = ids[sinks[s] + 1];
+				adaptChannels((int)sourceIds.size(), numOutputs, c, adapted);
+				for (size_t k = 0; k < adapted.size(); ++k)
+				{
+					Term term = { sourceIds[adapted[k].first], adapted[k].second };
+					mix.terms.push_back(term);
+				}
+			}
+			outputMixes_.push_back(mix);
+		}
+		numCopies_ += numOutputs;
+	}
+
+	// Longest path of plug-in delays:
+	std::vector<int> delays(n, 0);
+	latency_ = 0;
+	for (size_t o = 0; o < order_.size(); ++o)
+	{
+		const int i = order_[o];
+		int longest = 0;
+		for (size_t s = 0; s < nodes_[i].sources.size(); ++s)
+		{
+			longest = std::max(longest, nodes_[i].sources[s] == kGraphInput ? 0 : delays[nodes_[i].sources[s]]);
+		}
+		delays[i] = longest + nodes_[i].instance->initialDelay();
+		if (consumers[i].empty())
+		{
+			latency_ = std::max(latency_, delays[i]);
+		}
+	}
+
+	// Memory, and the pointer tables process() fills in:
+	pool_.assign((size_t)numBuffers_*maxBlockSize, 0.0);
+	floatChannels_.assign(firstPoolId + numBuffers_, NULL);
+	doubleChannels_.assign(firstPoolId + numBuffers_, NULL);
+	for (int b = 0; b < numBuffers_; ++b)
+	{
+		doubleChannels_[firstPoolId + b] = &pool_[(size_t)b*maxBlockSize];
+		floatChannels_[firstPoolId + b] = (float *)&pool_[(size_t)b*maxBlockSize];
+	}
+	for (int i = 0; i < n; ++i)
+	{
+		Node &node = nodes_[i];
+		node.floatInputs.assign(std::max<size_t>(1, node.inputIds.size()), NULL);
+		node.doubleInputs.assign(std::max<size_t>(1, node.inputIds.size()), NULL);
+		node.floatOutputs.assign(std::max<size_t>(1, node.outputIds.size()), NULL);
+		node.doubleOutputs.assign(std::max<size_t>(1, node.outputIds.size()), NULL);
+
+		node.instance->setSampleRate(sampleRate);
+		node.instance->setBlockSize(maxBlockSize);
+		node.instance->resume();
+	}
+	return true;
+}
+
+// ---------------------------------------------------------------------------------------
+// Processing:
+// ---------------------------------------------------------------------------------------
+
+template <typename Sample>
+void PluginGraph::applyMix(const Mix &mix, Sample *const *channels, int numSamples)
+{
+	Sample *y = channels[mix.dest];
+	if (mix.terms.empty())
+	{
+		std::fill(y, y + numSamples, Sample(0));
+		return;
+	}
+	const Sample *x = channels[mix.terms[0].id];
+	const Sample gain = (Sample)mix.terms[0].gain;
+	if (x != y || gain != Sample(1))
+	{
+		for (int j = 0; j < numSamples; ++j)
+		{
+			y[j] = gain*x[j];
+		}
+	}
+	for (size_t k = 1; k < mix.terms.size(); ++k)
+	{
+		x = channels[mix.terms[k].id];
+		const Sample g = (Sample)mix.terms[k].gain;
+		for (int j = 0; j < numSamples; ++j)
+		{
+			y[j] += g*x[j];
+		}
+	}
+}
+
+static void processNode(PluginInstance &instance, float **inputs, float **outputs, int numSamples)
+{
+	instance.processReplacing(inputs, outputs, numSamples);
+}
+
+static void processNode(PluginInstance &instance, double **inputs, double **outputs, int numSamples)
+{
+	instance.processDoubleReplacing(inputs, outputs, numSamples);
+}
+
+template <typename Sample>
+void PluginGraph::run(Sample **inputs, Sample **outputs, int numSamples)
+{
+	std::vector<Sample *> &channels = channelPointers((Sample *)NULL);
+	for (int c = 0; c < numInputs_; ++c)
+	{
+		channels[c] = inputs[c];
+	}
+	for (int c = 0; c < numOutputs_; ++c)
+	{
+		channels[numInputs_ + c] = outputs[c];
+	}
+
+	for (size_t o = 0; o < order_.size(); ++o)
+	{
+		Node &node = nodes_[order_[o]];
+		for (size_t m = 0; m < node.mixes.size(); ++m)
+		{
+			applyMix(node.mixes[m], &channels[0], numSamples);
+		}
+		std::vector<Sample *> &in = inputPointers(node, (Sample *)NULL);
+		std::vector<Sample *> &out = outputPointers(node, (Sample *)NULL);
+		for (size_t c = 0; c < node.inputIds.size(); ++c)
+		{
+			in[c] = channels[node.inputIds[c]];
+		}
+		for (size_t c = 0; c < node.outputIds.size(); ++c)
+		{
+			out[c] = channels[node.outputIds[c]];
+		}
+		processNode(*node.instance, &in[0], &out[0], numSamples);
+	}
+
+	for (size_t m = 0; m < outputMixes_.size(); ++m)
+	{
+		applyMix(outputMixes_[m], &channels[0], numSamples);
+	}
+}
+
+void PluginGraph::process(float **inputs, float **outputs, int numSamples)
+{
+	run(inputs, outputs, numSamples);
+}
+
+void PluginGraph::processDouble(double **inputs, double **outputs, int numSamples)
+{
+	run(inputs, outputs, numSamples);
+}
+
+// ---------------------------------------------------------------------------------------
+// Plan:
+// ---------------------------------------------------------------------------------------
+
+std::string PluginGraph::idName(int id) const
+{
+	char text[32];
+	if (id < numInputs_)
+	{
+		std::snprintf(text, sizeof(text), "in%d", id);
+	}
+	else if (id < numInputs_ + numOutputs_)
+	{
+		std::snprintf(text, sizeof(text), "out%d", id - numInputs_);
+	}
+	else
+	{
+		std::snprintf(text, sizeof(text), "b%d", id - numInputs_ - numOutputs_);
+	}
+	return text;
+}
+
+static void describeMix(std::string &text, const std::string &dest, const std::vector<std::string> &terms)
+{
+	text += "  " + dest + " =";
+	for (size_t k = 0; k < terms.size(); ++k)
+	{
+		text += (k == 0 ? " " : " + ") + terms[k];
+	}
+	text += terms.empty() ? " 0\n" : "\n";
+}
+
+std::string PluginGraph::describePlan() const
+{
+	std::string text;
+	std::vector<Mix> mixes;
+	for (size_t o = 0; o <= order_.size(); ++o)
+	{
+		const Node *node = o < order_.size() ? &nodes_[order_[o]] : NULL;
+		const std::vector<Mix> &nodeMixes = node != NULL ? node->mixes : outputMixes_;
+		for (size_t m = 0; m < nodeMixes.size(); ++m)
+		{
+			std::vector<std::string> terms;
+			for (size_t k = 0; k < nodeMixes[m].terms.size(); ++k)
+			{
+				char gain[32] = "";
+				if (nodeMixes[m].terms[k].gain != 1.0f)
+				{
+					std::snprintf(gain, sizeof(gain), "%g*", nodeMixes[m].terms[k].gain);
+				}
+				terms.push_back(gain + idName(nodeMixes[m].terms[k].id));
+			}
+			describeMix(text, idName(nodeMixes[m].dest), terms);
+		}
+		if (node == NULL)
+		{
+			break;
+		}
+		char line[64];
+		std::snprintf(line, sizeof(line), "  node %d (", order_[o]);
+		const size_t slash = node->instance->path().find_last_of('/');
+		text += line + node->instance->path().substr(slash == std::string::npos ? 0 : slash + 1) + "):";
+		for (size_t c = 0; c < node->inputIds.size(); ++c)
+		{
+			text += (c == 0 ? " " : ",") + idName(node->inputIds[c]);
+		}
+		text += " ->";
+		for (size_t c = 0; c < node->outputIds.size(); ++c)
+		{
+			text += (c == 0 ? " " : ",") + idName(node->outputIds[c]);
+		}
+		text += "\n";
+	}
+	return text;
+}
@@ -0,0 +1,129 @@
+#ifndef INCLUDED_PLUGINGRAPH_HXX
+#define INCLUDED_PLUGINGRAPH_HXX
+
+#include "PluginHost.hxx"
+
+#include <string>
+#include <vector>
+
+// In-process graph of plug-in instances (Linux only, see PluginInstance).
+//
+// Nodes are plug-ins, connections carry all the channels of one node to another. A node
+// takes the sum of everything connected to it; a node without connections takes the graph
+// input, and the nodes nobody is connected to are summed into the graph output. Channel
+// counts are adapted on the way: more channels than the source has repeat its channels
+// (mono to both sides of a stereo input), fewer average them ((L + R)/2 into a mono input).
+//
+// prepare() sorts the nodes topologically and plans the buffers once:
+//   - a channel that only has to be passed on is passed by pointer, including the repeated
+//     channels of an upmix (the same buffer for both inputs),
+//   - a node processes in place when its input buffers are used by nobody after it,
+//   - buffers nobody reads any more are reused by later nodes,
+//   - the last node writes straight into the caller's output buffers when it is the only one
+//     feeding them with the right number of channels,
+//   - the graph input is only read, never overwritten.
+// So a chain of effects with matching channel counts runs without any copy, in one set of
+// buffers. Copies and mixes are left only where the graph needs them: sums, downmixes, and
+// the output of several nodes. With inPlace false every node gets buffers of its own and
+// copies its input, like separate tracks in a DAW, for comparison.
+//
+// process() does not allocate. Latencies of parallel branches are not compensated; latency()
+// is that of the longest path.
+class PluginGraph
+{
+public:
+	enum { kGraphInput = -1 };
+
+	PluginGraph();
+	~PluginGraph();
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Building (not while processing):
+	int addPlugin(const char *path); // node index, or -1 and errorMessage() on failure
+	bool connect(int from, int to);  // from may be kGraphInput; false on bad indices
+
+	// Sorts and plans, allocates the buffers, sets up and resumes all the plug-ins. False
+	// and errorMessage() if the connections form a cycle.
+	bool prepare(float sampleRate, int maxBlockSize, int numInputs, int numOutputs, bool inPlace = true);
+
+	const std::string &errorMessage() const { return error_; }
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Processing, numSamples <= maxBlockSize; float through processReplacing(), double
+	// through processDoubleReplacing():
+	void process(float **inputs, float **outputs, int numSamples);
+	void processDouble(double **inputs, double **outputs, int numSamples);
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Properties:
+	int numNodes() const { return (int)nodes_.size(); }
+	PluginInstance &node(int index) { return *nodes_[index].instance; }
+	int latency() const { return latency_; }
+
+	int numBuffers() const { return numBuffers_; }         // channel buffers allocated
+	int numChannelCopies() const { return numCopies_; }    // channels copied or mixed per block
+	std::string describePlan() const;                      // one line per step
+
+private:
+	PluginGraph(const PluginGraph &);
+	PluginGraph &operator=(const PluginGraph &);
+
+	// A buffer id is a graph input channel (0..numInputs-1), a graph output channel
+	// (numInputs..numInputs+numOutputs-1) or a buffer of the pool (above).
+	struct Term
+	{
+		int id;
+		float gain;
+	};
+
+	// dest = sum of gain*source; dest may be the first source (accumulates in place):
+	struct Mix
+	{
+		int dest;
+		std::vector<Term> terms;
+	};
+
+	struct Node
+	{
+		PluginInstance *instance;
+		std::vector<int> sources; // connected nodes, or kGraphInput
+
+		// Plan: mixes first, then the plug-in from inputIds to outputIds:
+		std::vector<Mix> mixes;
+		std::vector<int> inputIds;
+		std::vector<int> outputIds;
+		std::vector<float *> floatInputs, floatOutputs;
+		std::vector<double *> doubleInputs, doubleOutputs;
+	};
+
+	template <typename Sample>
+	void run(Sample **inputs, Sample **outputs, int numSamples);
+	template <typename Sample>
+	static void applyMix(const Mix &mix, Sample *const *channels, int numSamples);
+
+	static std::vector<float *> &inputPointers(Node &node, float *) { return node.floatInputs; }
+	static std::vector<double *> &inputPointers(Node &node, double *) { return node.doubleInputs; }
+	static std::vector<float *> &outputPointers(Node &node, float *) { return node.floatOutputs; }
+	static std::vector<double *> &outputPointers(Node &node, double *) { return node.doubleOutputs; }
+	std::vector<float *> &channelPointers(float *) { return floatChannels_; }
+	std::vector<double *> &channelPointers(double *) { return doubleChannels_; }
+
+	std::string idName(int id) const;
+
+	std::vector<Node> nodes_;
+	std::vector<int> order_;         // topological
+	std::vector<Mix> outputMixes_;   // into the graph output, after the last node
+	int numInputs_;
+	int numOutputs_;
+	int maxBlockSize_;
+	int numBuffers_;
+	int numCopies_;
+	int latency_;
+
+	std::vector<double> pool_;             // numBuffers_*maxBlockSize_, also seen as floats
+	std::vector<float *> floatChannels_;   // by id
+	std::vector<double *> doubleChannels_;
+	std::string error_;
+};
+
+#endif
@@ -0,0 +1,194 @@
+#include "PluginHost.hxx"
+
+#include <dlfcn.h>
+
+// Signature of the VST 2.4 entry point exported by vstplugmain.cpp:
+typedef AEffect *(*PluginEntryProc)(audioMasterCallback audioMaster);
+
+// ---------------------------------------------------------------------------------------
+// Constructor / destructor:
+// ---------------------------------------------------------------------------------------
+
+PluginInstance::PluginInstance()
+	: library_(NULL), effect_(NULL), resumed_(false), sampleRate_(44100.0f), blockSize_(1024)
+{
+}
+
+PluginInstance::~PluginInstance()
+{
+	unload();
+}
+
+// ---------------------------------------------------------------------------------------
+// Loading:
+// ---------------------------------------------------------------------------------------
+
+bool PluginInstance::load(const char *path)
+{
+	unload();
+	path_ = path;
+
+	// Without a slash dlopen() searches the library path rather than the current directory:
+	std::string file = path;
+	if (file.find('/') == std::string::npos)
+	{
+		file = "./" + file;
+	}
+
+	library_ = dlopen(file.c_str(), RTLD_NOW | RTLD_LOCAL);
+	if (library_ == NULL)
+	{
+		const char *reason = dlerror();
+		error_ = reason != NULL ? reason : "dlopen() failed";
+		return false;
+	}
+
+	PluginEntryProc entry = (PluginEntryProc)dlsym(library_, "VSTPluginMain");
+	if (entry == NULL)
+	{
+		entry = (PluginEntryProc)dlsym(library_, "main"); // very old plug-ins
+	}
+	if (entry == NULL)
+	{
+		error_ = "no VSTPluginMain() entry point in " + path_;
+		unload();
+		return false;
+	}
+
+	// VSTPluginMain() calls createEffectInstance(hostCallback) and returns the AEffect:
+	effect_ = entry(hostCallback);
+	if (effect_ == NULL || effect_->magic != kEffectMagic)
+	{
+		error_ = "createEffectInstance() did not return a valid effect";
+		effect_ = NULL;
+		unload();
+		return false;
+	}
+	effect_->user = this; // AEffect::user is reserved for the host
+
+	dispatch(effOpen);
+	dispatch(effSetSampleRate, 0, 0, NULL, sampleRate_);
+	dispatch(effSetBlockSize, 0, blockSize_);
+	return true;
+}
+
+void PluginInstance::unload()
+{
+	if (effect_ != NULL)
+	{
+		suspend();
+		dispatch(effClose); // deletes the AudioEffect object
+		effect_ = NULL;
+	}
+	if (library_ != NULL)
+	{
+		dlclose(library_);
+		library_ = NULL;
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// Dispatcher wrappers:
+// ---------------------------------------------------------------------------------------
+
+VstIntPtr PluginInstance::dispatch(VstInt32 opcode, VstInt32 index, VstIntPtr value, void *ptr, float opt)
+{
+	return effect_->dispatcher(effect_, opcode, index, value, ptr, opt);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void PluginInstance::setSampleRate(float sampleRate)
+{
+	// Sample rate and block size may only change while suspended:
+	bool wasResumed = resumed_;
+	suspend();
+	sampleRate_ = sampleRate;
+	dispatch(effSetSampleRate, 0, 0, NULL, sampleRate_);
+	if (wasResumed)
+	{
+		resume();
+	}
+}
+
+void PluginInstance::setBlockSize(VstInt32 blockSize)
+{
+	bool wasResumed = resumed_;
+	suspend();
+	blockSize_ = blockSize;
+	dispatch(effSetBlockSize, 0, blockSize_);
+	if (wasResumed)
+	{
+		resume();
+	}
+}
+
+void PluginInstance::resume()
+{
+	if (!resumed_)
+	{
+		dispatch(effMainsChanged, 0, 1);
+		resumed_ = true;
+	}
+}
+
+void PluginInstance::suspend()
+{
+	if (resumed_)
+	{
+		dispatch(effMainsChanged, 0, 0);
+		resumed_ = false;
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void PluginInstance::setParameter(VstInt32 index, float value)
+{
+	effect_->setParameter(effect_, index, value);
+}
+
+float PluginInstance::getParameter(VstInt32 index)
+{
+	return effect_->getParameter(effect_, index);
+}
+
+void PluginInstance::getParameterName(VstInt32 index, char *text)
+{
+	text[0] = '\0';
+	dispatch(effGetParamName, index, 0, text);
+}
+
+VstInt32 PluginInstance::processEvents(VstEvents *events)
+{
+	return (VstInt32)dispatch(effProcessEvents, 0, 0, events);
+}
+
+VstInt32 PluginInstance::tailSize()
+{
+	return (VstInt32)dispatch(effGetTailSize);
+}
+
+// ---------------------------------------------------------------------------------------
+// Host callback:
+// ---------------------------------------------------------------------------------------
+
+VstIntPtr VSTCALLBACK PluginInstance::hostCallback(AEffect *effect, VstInt32 opcode, VstInt32 /*index*/, VstIntPtr /*value*/, void * /*ptr*/, float /*opt*/)
+{
+	// effect is NULL (or user not yet set) while the plug-in is being constructed:
+	PluginInstance *host = effect != NULL ? (PluginInstance *)effect->user : NULL;
+
+	switch (opcode)
+	{
+		case audioMasterVersion:
+			return kVstVersion;
+		case audioMasterGetSampleRate:
+			return host != NULL ? (VstIntPtr)host->sampleRate_ : 0;
+		case audioMasterGetBlockSize:
+			return host != NULL ? (VstIntPtr)host->blockSize_ : 0;
+		case audioMasterIOChanged:
+			return 1; // we query numInputs/numOutputs/initialDelay on demand anyway
+		default:
+			return 0; // not supported (automation, time info, editor, ...)
+	}
+}
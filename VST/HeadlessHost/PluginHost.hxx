@@ -0,0 +1,85 @@
+#ifndef INCLUDED_PLUGINHOST_HXX
+#define INCLUDED_PLUGINHOST_HXX
+
+#include "pluginterfaces/vst2.x/aeffectx.h"
+
+#include <string>
+
+// Minimal in-process VST 2.4 host for one instance of a plug-in shared object (Linux only).
+//
+// The shared object is opened with dlopen() and the effect is created through its exported
+// VSTPluginMain(), which calls the plug-in's createEffectInstance() with our stub
+// audioMasterCallback. Every MyVstPlugIn-exN defines the same class and creator names, so
+// going through dlopen(RTLD_LOCAL) is what lets several of them live in one process.
+class PluginInstance
+{
+public:
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Constructor/destructor:
+	PluginInstance();
+	~PluginInstance();
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Loading:
+	bool load(const char *path); // returns false and sets errorMessage() on failure
+	void unload();
+
+	bool isLoaded() const { return effect_ != NULL; }
+	const std::string &errorMessage() const { return error_; }
+	const std::string &path() const { return path_; }
+	AEffect *effect() const { return effect_; }
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Wrappers around the AEffect dispatcher:
+	void setSampleRate(float sampleRate);
+	void setBlockSize(VstInt32 blockSize);
+	void resume();
+	void suspend();
+
+	void setParameter(VstInt32 index, float value);
+	float getParameter(VstInt32 index);
+	void getParameterName(VstInt32 index, char *text);
+	VstInt32 processEvents(VstEvents *events);
+	VstInt32 tailSize(); // samples the output rings on after the input stops; 0 = not reported, 1 = none
+
+	void processReplacing(float **inputs, float **outputs, VstInt32 numSamples)
+	{
+		effect_->processReplacing(effect_, inputs, outputs, numSamples);
+	}
+
+	void processDoubleReplacing(double **inputs, double **outputs, VstInt32 numSamples)
+	{
+		effect_->processDoubleReplacing(effect_, inputs, outputs, numSamples);
+	}
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Properties:
+	VstInt32 numInputs() const { return effect_->numInputs; }
+	VstInt32 numOutputs() const { return effect_->numOutputs; }
+	VstInt32 numParameters() const { return effect_->numParams; }
+	VstInt32 initialDelay() const { return effect_->initialDelay; }
+	bool isSynth() const { return (effect_->flags & effFlagsIsSynth) != 0; }
+	bool canDoubleReplacing() const { return (effect_->flags & effFlagsCanDoubleReplacing) != 0; }
+
+	float sampleRate() const { return sampleRate_; }
+	VstInt32 blockSize() const { return blockSize_; }
+
+private:
+	PluginInstance(const PluginInstance &);
+	PluginInstance &operator=(const PluginInstance &);
+
+	VstIntPtr dispatch(VstInt32 opcode, VstInt32 index = 0, VstIntPtr value = 0, void *ptr = NULL, float opt = 0.0f);
+
+	// Stub audioMasterCallback handed to the plug-in:
+	static VstIntPtr VSTCALLBACK hostCallback(AEffect *effect, VstInt32 opcode, VstInt32 index, VstIntPtr value, void *ptr, float opt);
+
+	void *library_;
+	AEffect *effect_;
+	bool resumed_;
+	float sampleRate_;
+	VstInt32 blockSize_;
+	std::string path_;
+	std::string error_;
+};
+
+#endif
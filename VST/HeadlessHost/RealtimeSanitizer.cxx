@@ -0,0 +1,445 @@
+#include "RealtimeSanitizer.hxx"
+
+#include <cstddef>
+
+#if defined(__linux__) && defined(__GLIBC__)
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <time.h>
+#include <unistd.h>
+
+// ---------------------------------------------------------------------------------------
+// State:
+// ---------------------------------------------------------------------------------------
+
+static std::atomic<bool> enabled(false);
+
+// Per thread: the innermost RealtimeScope's context, and whether the calls go straight through
+// (while reporting, or looking up glibc's functions):
+static thread_local const char *currentContext = NULL;
+static thread_local bool bypass = false;
+
+enum
+{
+	kMaxFrames = 48,
+	kMaxSites = 256
+};
+
+// Hashes of the call stacks reported so far, behind a spin lock (a mutex would report itself):
+static std::atomic_flag sitesLock = ATOMIC_FLAG_INIT;
+static uint64_t sites[kMaxSites];
+static int numSites = 0;
+static std::atomic<long long> violations(0);
+
+static inline bool isViolation()
+{
+	return currentContext != NULL && !bypass && enabled.load(std::memory_order_relaxed);
+}
+
+// Frame 0 is this function and frame 1 the replacement that called it (both out of line), so
+// the offending call stack starts at frame 2:
+__attribute__((noinline)) static void reportViolation(const char *function, long long argument)
+{
+	bypass = true;
+	void *frames[kMaxFrames];
+	const int numFrames = backtrace(frames, kMaxFrames);
+	const int first = numFrames < 2 ? numFrames : 2;
+
+	uint64_t hash = 14695981039346656037ull; // FNV-1a over the return addresses
+	for (int f = first; f < numFrames; ++f)
+	{
+		hash = (hash ^ (uint64_t)(uintptr_t)frames[f])*1099511628211ull;
+	}
+
+	violations.fetch_add(1, std::memory_order_relaxed);
+	bool isNew = false;
+	while (sitesLock.test_and_set(std::memory_order_acquire))
+	{
+		// another thread is reporting
+	}
+	int s = 0;
+	while (s < numSites && sites[s] != hash)
+	{
+		++s;
+	}
+	if (s == numSites && numSites < kMaxSites)
+	{
+		sites[numSites++] = hash;
+		isNew = true;
+	}
+	sitesLock.clear(std::memory_order_release);
+
+	if (isNew)
+	{
+		char line[256];
+		int length = argument >= 0
+		             ? std::snprintf(line, sizeof(line), "rt-check: %s(%lld) in %s() on the audio thread\n", function, argument, currentContext)
+		             : std::snprintf(line, sizeof(line), "rt-check: %s() in %s() on the audio thread\n", function, currentContext);
+		length = length < (int)sizeof(line) ? length : (int)sizeof(line) - 1;
+		if (write(STDERR_FILENO, line, length) == length)
+		{
+			backtrace_symbols_fd(frames + first, numFrames - first, STDERR_FILENO);
+		}
+	}
+	bypass = false;
+}
+
+#define CHECK_CALL(function, argument) \
+	if (isViolation()) \
+	{ \
+		reportViolation(function, (long long)(argument)); \
+	}
+
+// glibc's definition of a replaced function (the next one after this executable's), looked
+// up on first use:
+template <typename Function>
+static Function realFunction(std::atomic<void *> &cache, const char *name)
+{
+	void *function = cache.load(std::memory_order_relaxed);
+	if (function == NULL)
+	{
+		const bool outer = bypass;
+		bypass = true; // dlsym() may allocate
+		function = dlsym(RTLD_NEXT, name);
+		bypass = outer;
+		cache.store(function, std::memory_order_relaxed);
+	}
+	return (Function)function;
+}
+
+#define REAL_FUNCTION(name) \
+	([]() { static std::atomic<void *> cache(NULL); return realFunction<decltype(&::name)>(cache, #name); }())
+
+// ---------------------------------------------------------------------------------------
+// Public functions:
+// ---------------------------------------------------------------------------------------
+
+bool enableRealtimeChecks()
+{
+	// The first backtrace() loads the unwinder (dlopen, malloc); better here than mid-report:
+	void *frames[4];
+	backtrace(frames, 4);
+	enabled.store(true);
+	return true;
+}
+
+RealtimeScope::RealtimeScope(const char *context)
+	: outer_(currentContext)
+{
+	currentContext = context;
+}
+
+RealtimeScope::~RealtimeScope()
+{
+	currentContext = outer_;
+}
+
+long long realtimeViolations()
+{
+	return violations.load(std::memory_order_relaxed);
+}
+
+int realtimeViolationSites()
+{
+	return numSites;
+}
+
+void resetRealtimeViolations()
+{
+	while (sitesLock.test_and_set(std::memory_order_acquire))
+	{
+	}
+	numSites = 0;
+	violations.store(0, std::memory_order_relaxed);
+	sitesLock.clear(std::memory_order_release);
+}
+
+// ---------------------------------------------------------------------------------------
+// Replacements:
+// ---------------------------------------------------------------------------------------
+
+extern "C"
+{
+
+// The allocator's own entry points, under their internal names (dlsym() would allocate):
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *pointer);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Memory:
+
+void *malloc(size_t size) __THROW
+{
+	CHECK_CALL("malloc", size);
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) __THROW
+{
+	CHECK_CALL("calloc", count*size);
+	return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size) __THROW
+{
+	CHECK_CALL("realloc", size);
+	return __libc_realloc(pointer, size);
+}
+
+void free(void *pointer) __THROW
+{
+	if (pointer != NULL)
+	{
+		CHECK_CALL("free", -1);
+	}
+	__libc_free(pointer);
+}
+
+void *memalign(size_t alignment, size_t size) __THROW
+{
+	CHECK_CALL("memalign", size);
+	return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) __THROW
+{
+	CHECK_CALL("aligned_alloc", size);
+	return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **pointer, size_t alignment, size_t size) __THROW
+{
+	CHECK_CALL("posix_memalign", size);
+	if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0)
+	{
+		return EINVAL;
+	}
+	void *memory = __libc_memalign(alignment, size);
+	if (memory == NULL)
+	{
+		return ENOMEM;
+	}
+	*pointer = memory;
+	return 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Locks:
+
+int pthread_mutex_lock(pthread_mutex_t *mutex) __THROWNL
+{
+	CHECK_CALL("pthread_mutex_lock", -1);
+	return REAL_FUNCTION(pthread_mutex_lock)(mutex);
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t *lock) __THROWNL
+{
+	CHECK_CALL("pthread_rwlock_rdlock", -1);
+	return REAL_FUNCTION(pthread_rwlock_rdlock)(lock);
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t *lock) __THROWNL
+{
+	CHECK_CALL("pthread_rwlock_wrlock", -1);
+	return REAL_FUNCTION(pthread_rwlock_wrlock)(lock);
+}
+
+int pthread_cond_wait(pthread_cond_t *condition, pthread_mutex_t *mutex)
+{
+	CHECK_CALL("pthread_cond_wait", -1);
+	return REAL_FUNCTION(pthread_cond_wait)(condition, mutex);
+}
+
+int pthread_cond_timedwait(pthread_cond_t *condition, pthread_mutex_t *mutex, const struct timespec *time)
+{
+	CHECK_CALL("pthread_cond_timedwait", -1);
+	return REAL_FUNCTION(pthread_cond_timedwait)(condition, mutex, time);
+}
+
+int pthread_join(pthread_t thread, void **result)
+{
+	CHECK_CALL("pthread_join", -1);
+	return REAL_FUNCTION(pthread_join)(thread, result);
+}
+
+int sem_wait(sem_t *semaphore)
+{
+	CHECK_CALL("sem_wait", -1);
+	return REAL_FUNCTION(sem_wait)(semaphore);
+}
+
+int sem_timedwait(sem_t *semaphore, const struct timespec *time)
+{
+	CHECK_CALL("sem_timedwait", -1);
+	return REAL_FUNCTION(sem_timedwait)(semaphore, time);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Sleeping and yielding:
+
+unsigned int sleep(unsigned int seconds)
+{
+	CHECK_CALL("sleep", seconds);
+	return REAL_FUNCTION(sleep)(seconds);
+}
+
+int usleep(useconds_t microseconds)
+{
+	CHECK_CALL("usleep", microseconds);
+	return REAL_FUNCTION(usleep)(microseconds);
+}
+
+int nanosleep(const struct timespec *duration, struct timespec *remaining)
+{
+	CHECK_CALL("nanosleep", -1);
+	return REAL_FUNCTION(nanosleep)(duration, remaining);
+}
+
+int clock_nanosleep(clockid_t clock, int flags, const struct timespec *time, struct timespec *remaining)
+{
+	CHECK_CALL("clock_nanosleep", -1);
+	return REAL_FUNCTION(clock_nanosleep)(clock, flags, time, remaining);
+}
+
+int sched_yield() __THROW
+{
+	CHECK_CALL("sched_yield", -1);
+	return REAL_FUNCTION(sched_yield)();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Files and console:
+
+int open(const char *path, int flags, ...)
+{
+	CHECK_CALL("open", -1);
+	mode_t mode = 0;
+	if ((flags & O_CREAT) != 0 || (flags & O_TMPFILE) == O_TMPFILE)
+	{
+		va_list arguments;
+		va_start(arguments, flags);
+		mode = (mode_t)va_arg(arguments, int);
+		va_end(arguments);
+	}
+	return REAL_FUNCTION(open)(path, flags, mode);
+}
+
+ssize_t read(int file, void *buffer, size_t size)
+{
+	CHECK_CALL("read", size);
+	return REAL_FUNCTION(read)(file, buffer, size);
+}
+
+ssize_t write(int file, const void *buffer, size_t size)
+{
+	CHECK_CALL("write", size);
+	return REAL_FUNCTION(write)(file, buffer, size);
+}
+
+FILE *fopen(const char *path, const char *mode)
+{
+	CHECK_CALL("fopen", -1);
+	return REAL_FUNCTION(fopen)(path, mode);
+}
+
+size_t fread(void *buffer, size_t size, size_t count, FILE *file)
+{
+	CHECK_CALL("fread", size*count);
+	return REAL_FUNCTION(fread)(buffer, size, count, file);
+}
+
+size_t fwrite(const void *buffer, size_t size, size_t count, FILE *file)
+{
+	CHECK_CALL("fwrite", size*count);
+	return REAL_FUNCTION(fwrite)(buffer, size, count, file);
+}
+
+int fflush(FILE *file)
+{
+	CHECK_CALL("fflush", -1);
+	return REAL_FUNCTION(fflush)(file);
+}
+
+int puts(const char *text)
+{
+	CHECK_CALL("puts", -1);
+	return REAL_FUNCTION(puts)(text);
+}
+
+int fputs(const char *text, FILE *file)
+{
+	CHECK_CALL("fputs", -1);
+	return REAL_FUNCTION(fputs)(text, file);
+}
+
+int printf(const char *format, ...)
+{
+	CHECK_CALL("printf", -1);
+	va_list arguments;
+	va_start(arguments, format);
+	const int result = vfprintf(stdout, format, arguments);
+	va_end(arguments);
+	return result;
+}
+
+int fprintf(FILE *file, const char *format, ...)
+{
+	CHECK_CALL("fprintf", -1);
+	va_list arguments;
+	va_start(arguments, format);
+	const int result = vfprintf(file, format, arguments);
+	va_end(arguments);
+	return result;
+}
+
+} // extern "C"
+
+#else
+
+// Without glibc nothing is replaced, and nothing can be checked:
+
+bool enableRealtimeChecks()
+{
+	return false;
+}
+
+RealtimeScope::RealtimeScope(const char *)
+	: outer_(NULL)
+{
+}
+
+RealtimeScope::~RealtimeScope()
+{
+}
+
+long long realtimeViolations()
+{
+	return 0;
+}
+
+int realtimeViolationSites()
+{
+	return 0;
+}
+
+void resetRealtimeViolations()
+{
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef INCLUDED_REALTIMESANITIZER_HXX
+#define INCLUDED_REALTIMESANITIZER_HXX
+
+// ---------------------------------------------------------------------------------------
+// Real-time safety checks of the calls a host makes on its audio thread.
+// ---------------------------------------------------------------------------------------
+
+// A plug-in that allocates, takes a lock or makes a blocking system call in processReplacing()
+// works until the allocator, the lock's other owner or the kernel makes it wait, and then
+// the block is late: a dropout that no benchmark average shows. The host executable linked
+// with RealtimeSanitizer.cxx replaces (interposes) these functions for every library it
+// loads, plug-ins included:
+//
+//   memory:   malloc, calloc, realloc, free, memalign, posix_memalign, aligned_alloc
+//             (operator new and delete end up there)
+//   locks:    pthread_mutex_lock, pthread_rwlock_rdlock/wrlock, pthread_cond_wait/timedwait,
+//             pthread_join, sem_wait, sem_timedwait (std::mutex and friends end up there)
+//   blocking: sleep, usleep, nanosleep, clock_nanosleep, sched_yield, open, read, write,
+//             fopen, fread, fwrite, fflush, puts, fputs, printf, fprintf
+//
+// and each call made inside a RealtimeScope, once the checks are enabled, is a violation. The
+// first one from every distinct call stack is printed to stderr with a stack trace; plug-ins
+// export no symbols, so their frames show as offsets ("MyVstPlugIn-ex3.so(+0x1a2b)"), which
+// addr2line -Cfe MyVstPlugIn-ex3.so 0x1a2b turns into a function name (and a line, in -g
+// builds). Spin locks, atomics and the vDSO clock functions stay allowed.
+//
+// The replacements forward to glibc and cost a thread-local test per call when idle, so the
+// executables that link them (HeadlessHost) behave as before until the checks are enabled.
+// Linux with glibc only; elsewhere enableRealtimeChecks() returns false.
+
+// Arms the checks, for the rest of the process. Call it at startup: it also loads what the
+// stack traces need, which allocates.
+bool enableRealtimeChecks();
+
+// Marks the calling thread as the audio thread while it exists; context names the host call
+// (e.g. "processReplacing") in the reports. Scopes nest.
+class RealtimeScope
+{
+public:
+	explicit RealtimeScope(const char *context);
+	~RealtimeScope();
+
+private:
+	RealtimeScope(const RealtimeScope &);
+	RealtimeScope &operator=(const RealtimeScope &);
+
+	const char *outer_;
+};
+
+// Violations since the last reset: calls, and the distinct call stacks they came from.
+long long realtimeViolations();
+int realtimeViolationSites();
+void resetRealtimeViolations(); // not while a RealtimeScope is open on another thread
+
+#endif
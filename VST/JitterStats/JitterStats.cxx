@@ -0,0 +1,477 @@
+// Timer jitter statistics for the captures of PD/Timing/ex1 (replaces process_data.m).
+//
+// Reads every <experiment>_<method>_<N>ms.txt file given on the command line, or found in the
+// directories given (recursively), e.g. PD/Timing/ex1/data/metro_realtime_10ms.txt: one
+// measured value per line, in ms, as written by save_data.pd. Files with the same experiment,
+// method and period are pooled, so batches of captures from many runs add up.
+//
+// Per group: number of files and values, mean, standard deviation, minimum, percentiles,
+// maximum and the maximum jitter |value - nominal|. The nominal value is the period, except
+// for the "cputime" method, which measures the CPU time spent between ticks and is ideally 0.
+// Optionally a histogram of value - nominal.
+//
+// The files are memory mapped and parsed with a hand written decimal parser, on all cores
+// (one file at a time per thread); each file is read once.
+//
+// Usage: JitterStats [options] file.txt|directory ...
+//   --threads 0          worker threads; 0 = one per core
+//   --histogram          print the histogram of every group
+//   --bin 1              histogram bin width, ms
+//   --csv                print comma separated values instead of a table
+//
+// Built by the CMake project in VST/ (does not need the VST SDK). POSIX (mmap, dirent).
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ---------------------------------------------------------------------------------------
+// Options:
+// ---------------------------------------------------------------------------------------
+
+struct StatsOptions
+{
+	int threads;
+	bool histogram;
+	double binWidth;
+	bool csv;
+	std::vector<std::string> paths;
+
+	StatsOptions() : threads(0), histogram(false), binWidth(1.0), csv(false) {}
+};
+
+static bool parseOptions(int argc, char **argv, StatsOptions &options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const char *arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (std::strcmp(arg, "--threads") == 0 && hasValue)
+		{
+			options.threads = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--histogram") == 0)
+		{
+			options.histogram = true;
+		}
+		else if (std::strcmp(arg, "--bin") == 0 && hasValue)
+		{
+			options.binWidth = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--csv") == 0)
+		{
+			options.csv = true;
+		}
+		else if (arg[0] == '-')
+		{
+			std::fprintf(stderr, "unknown option: %s\n", arg);
+			return false;
+		}
+		else
+		{
+			options.paths.push_back(arg);
+		}
+	}
+	return !options.paths.empty() && options.binWidth > 0.0;
+}
+
+// ---------------------------------------------------------------------------------------
+// Files:
+// ---------------------------------------------------------------------------------------
+
+static bool endsWith(const std::string &text, const char *suffix)
+{
+	const size_t n = std::strlen(suffix);
+	return text.size() >= n && text.compare(text.size() - n, n, suffix) == 0;
+}
+
+// Appends the .txt files under path (a file or a directory), sorted per directory:
+static void collectFiles(const std::string &path, std::vector<std::string> &files)
+{
+	struct stat info;
+	if (stat(path.c_str(), &info) != 0)
+	{
+		std::fprintf(stderr, "cannot stat %s\n", path.c_str());
+		return;
+	}
+	if (!S_ISDIR(info.st_mode))
+	{
+		files.push_back(path);
+		return;
+	}
+	DIR *dir = opendir(path.c_str());
+	if (dir == NULL)
+	{
+		std::fprintf(stderr, "cannot open %s\n", path.c_str());
+		return;
+	}
+	std::vector<std::string> entries;
+	while (struct dirent *entry = readdir(dir))
+	{
+		if (entry->d_name[0] != '.')
+		{
+			entries.push_back(path + "/" + entry->d_name);
+		}
+	}
+	closedir(dir);
+	std::sort(entries.begin(), entries.end());
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		if (stat(entries[i].c_str(), &info) == 0 && (S_ISDIR(info.st_mode) || endsWith(entries[i], ".txt")))
+		{
+			collectFiles(entries[i], files);
+		}
+	}
+}
+
+// Experiment, method and period from "<experiment>_<method>_<N>ms.txt"; false otherwise:
+static bool parseName(const std::string &path, std::string &experiment, std::string &method, double &period)
+{
+	const size_t slash = path.find_last_of('/');
+	std::string name = path.substr(slash == std::string::npos ? 0 : slash + 1);
+	if (!endsWith(name, "ms.txt"))
+	{
+		return false;
+	}
+	name.resize(name.size() - 6);
+	const size_t first = name.find('_'), last = name.find_last_of('_');
+	if (first == std::string::npos || first == last)
+	{
+		return false;
+	}
+	char *end;
+	period = std::strtod(name.c_str() + last + 1, &end);
+	if (*end != '\0' || end == name.c_str() + last + 1)
+	{
+		return false;
+	}
+	experiment = name.substr(0, first);
+	method = name.substr(first + 1, last - first - 1);
+	return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Decimal number at p (sign, digits, fraction, exponent), as written by Pd's textfile; no
+// locale, no allocation. Returns the character after it, or p if there is no number.
+static const char *parseNumber(const char *p, const char *end, double &value)
+{
+	static const double powersOf10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+	                                     1e13, 1e14, 1e15, 1e16, 1e17, 1e18 };
+	const char *start = p;
+	const bool negative = p < end && *p == '-';
+	if (p < end && (*p == '-' || *p == '+'))
+	{
+		++p;
+	}
+	unsigned long long mantissa = 0;
+	int digits = 0, exponent = 0;
+	for (; p < end && *p >= '0' && *p <= '9'; ++p, ++digits)
+	{
+		if (mantissa < 100000000000000000ULL)
+		{
+			mantissa = mantissa*10 + (unsigned)(*p - '0');
+		}
+		else
+		{
+			++exponent; // beyond 17 digits: dropped, the magnitude kept
+		}
+	}
+	if (p < end && *p == '.')
+	{
+		for (++p; p < end && *p >= '0' && *p <= '9'; ++p, ++digits)
+		{
+			if (mantissa < 100000000000000000ULL)
+			{
+				mantissa = mantissa*10 + (unsigned)(*p - '0');
+				--exponent;
+			}
+		}
+	}
+	if (digits == 0)
+	{
+		return start;
+	}
+	if (p < end && (*p == 'e' || *p == 'E'))
+	{
+		const char *q = p + 1;
+		const bool negativeExponent = q < end && *q == '-';
+		if (q < end && (*q == '-' || *q == '+'))
+		{
+			++q;
+		}
+		int e = 0;
+		const char *digitsStart = q;
+		for (; q < end && *q >= '0' && *q <= '9'; ++q)
+		{
+			e = e < 10000 ? e*10 + (*q - '0') : e;
+		}
+		if (q > digitsStart)
+		{
+			exponent += negativeExponent ? -e : e;
+			p = q;
+		}
+	}
+
+	double v = (double)mantissa;
+	if (exponent < 0)
+	{
+		v = -exponent <= 18 ? v/powersOf10[-exponent] : v*std::pow(10.0, exponent);
+	}
+	else if (exponent > 0)
+	{
+		v = exponent <= 18 ? v*powersOf10[exponent] : v*std::pow(10.0, exponent);
+	}
+	value = negative ? -v : v;
+	return p;
+}
+
+struct FileData
+{
+	bool ok;
+	int badTokens;             // text that is not a number
+	std::vector<double> values;
+};
+
+// Maps the file and parses every whitespace separated number (Pd writes one per line, "cr"):
+static void readFile(const std::string &path, FileData &data)
+{
+	data.ok = false;
+	data.badTokens = 0;
+	data.values.clear();
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return;
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0)
+	{
+		close(fd);
+		return;
+	}
+	data.ok = true;
+	if (info.st_size == 0)
+	{
+		close(fd);
+		return;
+	}
+	void *mapping = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED)
+	{
+		data.ok = false;
+		return;
+	}
+	madvise(mapping, (size_t)info.st_size, MADV_SEQUENTIAL);
+
+	const char *p = (const char *)mapping, *end = p + info.st_size;
+	data.values.reserve((size_t)info.st_size/4);
+	while (p < end)
+	{
+		while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t' || *p == ';'))
+		{
+			++p;
+		}
+		if (p == end)
+		{
+			break;
+		}
+		double value;
+		const char *next = parseNumber(p, end, value);
+		if (next == p)
+		{
+			++data.badTokens;
+			while (p < end && *p != ' ' && *p != '\n' && *p != '\r' && *p != '\t')
+			{
+				++p;
+			}
+			continue;
+		}
+		data.values.push_back(value);
+		p = next;
+	}
+	munmap(mapping, (size_t)info.st_size);
+}
+
+// ---------------------------------------------------------------------------------------
+// Statistics:
+// ---------------------------------------------------------------------------------------
+
+struct Group
+{
+	std::string experiment;
+	std::string method;
+	double period;
+	double nominal;
+	int files;
+	std::vector<double> values;
+};
+
+static double percentile(const std::vector<double> &sorted, double p)
+{
+	const double position = p*(sorted.size() - 1);
+	const size_t i = (size_t)position;
+	return i + 1 < sorted.size() ? sorted[i] + (position - i)*(sorted[i + 1] - sorted[i]) : sorted.back();
+}
+
+// ---------------------------------------------------------------------------------------
+// Main:
+// ---------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+	StatsOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		std::fprintf(stderr, "usage: %s [--threads n] [--histogram] [--bin ms] [--csv] file.txt|directory ...\n", argv[0]);
+		return 2;
+	}
+
+	std::vector<std::string> files;
+	for (size_t i = 0; i < options.paths.size(); ++i)
+	{
+		collectFiles(options.paths[i], files);
+	}
+
+	// Parse on all cores, each thread taking the next file:
+	std::vector<FileData> data(files.size());
+	int numThreads = options.threads > 0 ? options.threads : (int)std::thread::hardware_concurrency();
+	numThreads = std::max(1, std::min(numThreads, (int)files.size()));
+	std::atomic<size_t> next(0);
+	std::vector<std::thread> workers;
+	for (int t = 0; t < numThreads; ++t)
+	{
+		workers.push_back(std::thread([&]() {
+			for (size_t i = next++; i < files.size(); i = next++)
+			{
+				readFile(files[i], data[i]);
+			}
+		}));
+	}
+	for (size_t t = 0; t < workers.size(); ++t)
+	{
+		workers[t].join();
+	}
+
+	// Pool by experiment, method and period, in file order:
+	std::map<std::string, Group> groups;
+	int failures = 0;
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		std::string experiment, method;
+		double period;
+		if (!data[i].ok)
+		{
+			std::fprintf(stderr, "cannot read %s\n", files[i].c_str());
+			++failures;
+			continue;
+		}
+		if (!parseName(files[i], experiment, method, period))
+		{
+			std::fprintf(stderr, "skipped %s: not <experiment>_<method>_<N>ms.txt\n", files[i].c_str());
+			continue;
+		}
+		if (data[i].badTokens > 0)
+		{
+			std::fprintf(stderr, "%s: %d entries are not numbers\n", files[i].c_str(), data[i].badTokens);
+		}
+		char key[256];
+		std::snprintf(key, sizeof(key), "%s %s %012.3f", experiment.c_str(), method.c_str(), period);
+		Group &group = groups[key];
+		if (group.files == 0)
+		{
+			group.experiment = experiment;
+			group.method = method;
+			group.period = period;
+			group.nominal = method == "cputime" ? 0.0 : period;
+		}
+		++group.files;
+		group.values.insert(group.values.end(), data[i].values.begin(), data[i].values.end());
+		std::vector<double>().swap(data[i].values);
+	}
+
+	if (options.csv)
+	{
+		std::printf("experiment,method,period_ms,files,count,mean,std,min,p50,p90,p99,p999,max,max_jitter\n");
+	}
+	else
+	{
+		std::printf("%-8s %-14s %7s %5s %8s %10s %9s %9s %9s %9s %9s %9s %9s %10s\n", "exp", "method", "period", "files", "count",
+		            "mean", "std", "min", "p50", "p90", "p99", "p99.9", "max", "max jitter");
+	}
+	for (std::map<std::string, Group>::iterator it = groups.begin(); it != groups.end(); ++it)
+	{
+		Group &group = it->second;
+		std::vector<double> &values = group.values;
+		if (values.empty())
+		{
+			continue;
+		}
+		std::sort(values.begin(), values.end());
+		double mean = 0.0;
+		for (size_t i = 0; i < values.size(); ++i)
+		{
+			mean += values[i];
+		}
+		mean /= values.size();
+		double variance = 0.0;
+		for (size_t i = 0; i < values.size(); ++i)
+		{
+			variance += (values[i] - mean)*(values[i] - mean);
+		}
+		const double deviation = std::sqrt(variance/values.size());
+		const double maxJitter = std::max(std::fabs(values.front() - group.nominal), std::fabs(values.back() - group.nominal));
+
+		if (options.csv)
+		{
+			std::printf("%s,%s,%g,%d,%d,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g\n", group.experiment.c_str(), group.method.c_str(),
+			            group.period, group.files, (int)values.size(), mean, deviation, values.front(), percentile(values, 0.5),
+			            percentile(values, 0.9), percentile(values, 0.99), percentile(values, 0.999), values.back(), maxJitter);
+		}
+		else
+		{
+			std::printf("%-8s %-14s %7g %5d %8d %10.3f %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f %10.3f\n", group.experiment.c_str(),
+			            group.method.c_str(), group.period, group.files, (int)values.size(), mean, deviation, values.front(),
+			            percentile(values, 0.5), percentile(values, 0.9), percentile(values, 0.99), percentile(values, 0.999),
+			            values.back(), maxJitter);
+		}
+
+		// Counts of value - nominal per bin, from the lowest to the highest non-empty bin:
+		if (options.histogram)
+		{
+			const long first = (long)std::floor((values.front() - group.nominal)/options.binWidth);
+			const long last = (long)std::floor((values.back() - group.nominal)/options.binWidth);
+			std::vector<long> counts(last - first + 1, 0);
+			for (size_t i = 0; i < values.size(); ++i)
+			{
+				++counts[(long)std::floor((values[i] - group.nominal)/options.binWidth) - first];
+			}
+			const long largest = *std::max_element(counts.begin(), counts.end());
+			for (size_t b = 0; b < counts.size(); ++b)
+			{
+				if (counts[b] == 0 && b > 0 && b + 1 < counts.size() && counts.size() > 64)
+				{
+					continue; // long sparse tails: empty bins omitted
+				}
+				const double low = (first + (long)b)*options.binWidth;
+				std::printf("    [%9.3f, %9.3f) %8ld %s\n", low, low + options.binWidth, counts[b],
+				            std::string((size_t)(50*counts[b]/largest), '#').c_str());
+			}
+		}
+	}
+	return failures == 0 ? 0 : 1;
+}
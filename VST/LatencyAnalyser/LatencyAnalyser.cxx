@@ -0,0 +1,420 @@
+// Round-trip latency analyser for loopback recordings, such as PD/Timing/ex2/data/*.wav.
+//
+// Streams each WAV file given on the command line in windows of a few seconds and measures,
+// per window, the lag of the cross-correlation peak between a reference channel and the
+// return channel, computed with FFTs (see RealFft.hxx). With a mono file both are the same
+// channel: the recordings of PD/Timing/ex2/ex2.pd hold a noise burst and its echoes through
+// the closed loop, one round trip apart, and the peak of the autocorrelation away from lag 0
+// is the round-trip latency. Memory does not grow with the length of the file, so captures
+// of hours are fine.
+//
+// Each run (file) gets a report line: windows analysed, windows with a clear peak, the
+// median, mean, standard deviation and range of the latency, and its drift (least squares
+// slope over time, in ms per hour and ppm of elapsed time).
+//
+// Usage: LatencyAnalyser [options] file.wav [file.wav ...]
+//   --min-lag 2          shortest latency searched, ms (in mono files it must exceed the
+//                        width of the lag 0 peak, i.e. the correlation time of the burst)
+//   --max-lag 500        longest latency searched, ms
+//   --window 2           analysis window, seconds; one measurement per window
+//   --channels 0,1       reference and return channel (default 0,1; 0,0 for mono files)
+//   --threshold 0.2      minimum normalised correlation for a window to count
+//   --silence -60        windows whose reference RMS is below this (dBFS) are skipped
+//   --windows            also print every window's measurement
+//   --csv                print comma separated values instead of a table
+//
+// Built by the CMake project in VST/ (does not need the VST SDK).
+
+#include "DspCore/RealFft.hxx"
+#include "DspCore/WavFile.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------------------
+// Options:
+// ---------------------------------------------------------------------------------------
+
+struct AnalyserOptions
+{
+	double minLagMs;
+	double maxLagMs;
+	double windowSeconds;
+	int referenceChannel; // -1: default for the file
+	int returnChannel;
+	double threshold;
+	double silenceDb;
+	bool printWindows;
+	bool csv;
+	std::vector<std::string> files;
+
+	AnalyserOptions()
+		: minLagMs(2.0), maxLagMs(500.0), windowSeconds(2.0), referenceChannel(-1), returnChannel(-1),
+		  threshold(0.2), silenceDb(-60.0), printWindows(false), csv(false)
+	{
+	}
+};
+
+static bool parseOptions(int argc, char **argv, AnalyserOptions &options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const char *arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (std::strcmp(arg, "--min-lag") == 0 && hasValue)
+		{
+			options.minLagMs = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--max-lag") == 0 && hasValue)
+		{
+			options.maxLagMs = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--window") == 0 && hasValue)
+		{
+			options.windowSeconds = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--channels") == 0 && hasValue)
+		{
+			if (std::sscanf(argv[++i], "%d,%d", &options.referenceChannel, &options.returnChannel) != 2)
+			{
+				std::fprintf(stderr, "--channels expects reference,return\n");
+				return false;
+			}
+		}
+		else if (std::strcmp(arg, "--threshold") == 0 && hasValue)
+		{
+			options.threshold = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--silence") == 0 && hasValue)
+		{
+			options.silenceDb = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--windows") == 0)
+		{
+			options.printWindows = true;
+		}
+		else if (std::strcmp(arg, "--csv") == 0)
+		{
+			options.csv = true;
+		}
+		else if (arg[0] == '-')
+		{
+			std::fprintf(stderr, "unknown option: %s\n", arg);
+			return false;
+		}
+		else
+		{
+			options.files.push_back(arg);
+		}
+	}
+	return !options.files.empty() && options.minLagMs >= 0.0 && options.maxLagMs > options.minLagMs && options.windowSeconds > 0.0;
+}
+
+// ---------------------------------------------------------------------------------------
+// Cross-correlation:
+// ---------------------------------------------------------------------------------------
+
+// Correlates the reference window x (windowSize samples) with the return y (windowSize +
+// maxLag samples): c[l] = sum of x[n]*y[n + l], through one FFT size large enough that lags up
+// to maxLag do not wrap around.
+class WindowCorrelator
+{
+public:
+	WindowCorrelator(int windowSize, int maxLag)
+		: windowSize_(windowSize), maxLag_(maxLag)
+	{
+		int size = 2;
+		while (size < windowSize + maxLag)
+		{
+			size *= 2;
+		}
+		fft_.setSize(size);
+		frame_.resize(size);
+		xRe_.resize(fft_.numBins());
+		xIm_.resize(fft_.numBins());
+		yRe_.resize(fft_.numBins());
+		yIm_.resize(fft_.numBins());
+	}
+
+	// Fills correlation[0..maxLag]:
+	void correlate(const float *x, const float *y, std::vector<float> &correlation)
+	{
+		const int size = fft_.size();
+		std::fill(frame_.begin(), frame_.end(), 0.0f);
+		std::copy(x, x + windowSize_, frame_.begin());
+		fft_.forward(&frame_[0], &xRe_[0], &xIm_[0]);
+		std::copy(y, y + windowSize_ + maxLag_, frame_.begin());
+		fft_.forward(&frame_[0], &yRe_[0], &yIm_[0]);
+
+		// conj(X)*Y, with the 1/size of the inverse:
+		const float scale = 1.0f/(float)size;
+		for (int k = 0; k < fft_.numBins(); ++k)
+		{
+			const float re = xRe_[k]*yRe_[k] + xIm_[k]*yIm_[k];
+			const float im = xRe_[k]*yIm_[k] - xIm_[k]*yRe_[k];
+			xRe_[k] = re*scale;
+			xIm_[k] = im*scale;
+		}
+		fft_.inverse(&xRe_[0], &xIm_[0], &frame_[0]);
+		correlation.assign(frame_.begin(), frame_.begin() + maxLag_ + 1);
+	}
+
+private:
+	int windowSize_;
+	int maxLag_;
+	RealFft fft_;
+	std::vector<float> frame_;
+	std::vector<float> xRe_, xIm_, yRe_, yIm_;
+};
+
+// ---------------------------------------------------------------------------------------
+// Analysis of one run:
+// ---------------------------------------------------------------------------------------
+
+struct Measurement
+{
+	double time;        // s, start of the window
+	double latencyMs;
+	double correlation; // normalised peak
+};
+
+struct RunReport
+{
+	double seconds;
+	double sampleRate;
+	int windows;
+	std::vector<Measurement> measurements;
+};
+
+static double sumOfSquares(const float *x, int n)
+{
+	double sum = 0.0;
+	for (int j = 0; j < n; ++j)
+	{
+		sum += (double)x[j]*x[j];
+	}
+	return sum;
+}
+
+// Lag of the correlation maximum in minLag..maxLag - 1. In a loop the echoes recur every
+// round trip, so a clipped first echo can leave the maximum at two or three round trips;
+// a peak near a fraction of that lag with at least half its height is taken instead:
+static int findPeak(const std::vector<float> &correlation, int minLag, int maxLag)
+{
+	int peak = minLag;
+	for (int l = minLag + 1; l < maxLag; ++l)
+	{
+		peak = correlation[l] > correlation[peak] ? l : peak;
+	}
+	for (int k = 4; k >= 2; --k) // the shortest first
+	{
+		const int centre = (peak + k/2)/k;
+		int best = -1;
+		for (int l = std::max(minLag, centre - 2); l <= centre + 2; ++l)
+		{
+			best = best < 0 || correlation[l] > correlation[best] ? l : best;
+		}
+		if (best > minLag && correlation[best] >= 0.5f*correlation[peak])
+		{
+			return best;
+		}
+	}
+	return peak;
+}
+
+static bool analyseRun(const std::string &path, const AnalyserOptions &options, RunReport &report, std::string &error)
+{
+	WavReader reader;
+	if (!reader.open(path.c_str()))
+	{
+		error = reader.errorMessage();
+		return false;
+	}
+	const int numChannels = reader.numChannels();
+	const int reference = options.referenceChannel >= 0 ? options.referenceChannel : 0;
+	const int ret = options.returnChannel >= 0 ? options.returnChannel : (numChannels > 1 ? 1 : 0);
+	if (reference >= numChannels || ret >= numChannels)
+	{
+		error = path + ": no such channel";
+		return false;
+	}
+
+	const double rate = reader.sampleRate();
+	const int windowSize = std::max(1, (int)(options.windowSeconds*rate));
+	const int minLag = std::max(1, (int)(options.minLagMs*0.001*rate));
+	const int maxLag = std::max(minLag + 2, (int)(options.maxLagMs*0.001*rate));
+	const double silence = std::pow(10.0, options.silenceDb/10.0)*windowSize; // sum of squares
+
+	WindowCorrelator correlator(windowSize, maxLag);
+	std::vector<float> correlation;
+
+	// x: the window; y: the window and maxLag samples of look-ahead. After each window, the
+	// look-ahead moves to the front and the next windowSize frames are read behind it:
+	const int span = windowSize + maxLag;
+	std::vector<float> x(span, 0.0f), y(span, 0.0f);
+	std::vector<float> frames(4096*(size_t)numChannels);
+	int filled = 0;
+	bool atEnd = false;
+
+	report.sampleRate = rate;
+	report.seconds = (double)reader.numFrames()/rate;
+	report.windows = 0;
+	report.measurements.clear();
+
+	for (long start = 0; ; start += windowSize)
+	{
+		while (filled < span && !atEnd)
+		{
+			const long n = reader.read(&frames[0], std::min(4096L, (long)(span - filled)));
+			if (n == 0)
+			{
+				atEnd = true;
+				break;
+			}
+			for (long j = 0; j < n; ++j)
+			{
+				x[filled + j] = frames[(size_t)j*numChannels + reference];
+				y[filled + j] = frames[(size_t)j*numChannels + ret];
+			}
+			filled += (int)n;
+		}
+		if (filled == 0)
+		{
+			break;
+		}
+		std::fill(x.begin() + filled, x.end(), 0.0f);
+		std::fill(y.begin() + filled, y.end(), 0.0f);
+
+		// Peak in minLag..maxLag, normalised by the energies of x and of y over the same span:
+		const double xEnergy = sumOfSquares(&x[0], windowSize);
+		if (xEnergy > silence)
+		{
+			++report.windows;
+			correlator.correlate(&x[0], &y[0], correlation);
+			const int peak = findPeak(correlation, minLag, maxLag);
+			const double norm = std::sqrt(xEnergy*sumOfSquares(&y[peak], windowSize));
+			const double value = norm > 0.0 ? correlation[peak]/norm : 0.0;
+
+			// Parabola through the peak and its neighbours, for a fraction of a sample:
+			double offset = 0.0;
+			if (peak > minLag)
+			{
+				const double a = correlation[peak - 1], b = correlation[peak], c = correlation[peak + 1];
+				const double curvature = a - 2.0*b + c;
+				offset = curvature < 0.0 ? 0.5*(a - c)/curvature : 0.0;
+			}
+
+			if (value >= options.threshold && peak > minLag && peak < maxLag - 1)
+			{
+				Measurement m;
+				m.time = start/rate;
+				m.latencyMs = 1000.0*(peak + offset)/rate;
+				m.correlation = value;
+				report.measurements.push_back(m);
+			}
+		}
+
+		if (atEnd && filled <= windowSize)
+		{
+			break;
+		}
+		std::copy(x.begin() + windowSize, x.begin() + filled, x.begin());
+		std::copy(y.begin() + windowSize, y.begin() + filled, y.begin());
+		filled = std::max(0, filled - windowSize);
+	}
+	return true;
+}
+
+// ---------------------------------------------------------------------------------------
+// Main:
+// ---------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+	AnalyserOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		std::fprintf(stderr, "usage: %s [--min-lag ms] [--max-lag ms] [--window s] [--channels ref,ret] [--threshold c] [--silence dB] [--windows] [--csv] file.wav ...\n", argv[0]);
+		return 2;
+	}
+
+	if (options.csv)
+	{
+		std::printf("file,seconds,windows,measured,median_ms,mean_ms,std_ms,min_ms,max_ms,drift_ms_per_hour,drift_ppm\n");
+	}
+	else
+	{
+		std::printf("%-40s %8s %7s %8s %10s %10s %8s %10s %10s %10s %9s\n", "file", "seconds", "windows", "measured",
+		            "median ms", "mean ms", "std ms", "min ms", "max ms", "drift ms/h", "drift ppm");
+	}
+
+	int failures = 0;
+	for (size_t f = 0; f < options.files.size(); ++f)
+	{
+		const std::string &path = options.files[f];
+		RunReport report;
+		std::string error;
+		if (!analyseRun(path, options, report, error))
+		{
+			std::fprintf(stderr, "%s\n", error.c_str());
+			++failures;
+			continue;
+		}
+
+		const std::vector<Measurement> &m = report.measurements;
+		const size_t n = m.size();
+		double median = 0.0, mean = 0.0, deviation = 0.0, low = 0.0, high = 0.0, slope = 0.0;
+		if (n > 0)
+		{
+			std::vector<double> latencies(n);
+			double meanTime = 0.0;
+			for (size_t i = 0; i < n; ++i)
+			{
+				latencies[i] = m[i].latencyMs;
+				mean += m[i].latencyMs/n;
+				meanTime += m[i].time/n;
+			}
+			std::sort(latencies.begin(), latencies.end());
+			median = n % 2 ? latencies[n/2] : 0.5*(latencies[n/2 - 1] + latencies[n/2]);
+			low = latencies.front();
+			high = latencies.back();
+
+			// Least squares line through (time, latency):
+			double timeVariance = 0.0, covariance = 0.0;
+			for (size_t i = 0; i < n; ++i)
+			{
+				deviation += (m[i].latencyMs - mean)*(m[i].latencyMs - mean)/n;
+				timeVariance += (m[i].time - meanTime)*(m[i].time - meanTime);
+				covariance += (m[i].time - meanTime)*(m[i].latencyMs - mean);
+			}
+			deviation = std::sqrt(deviation);
+			slope = timeVariance > 0.0 ? covariance/timeVariance : 0.0; // ms per s
+		}
+
+		if (options.printWindows)
+		{
+			for (size_t i = 0; i < n; ++i)
+			{
+				std::printf("  %s  t %9.3f s  latency %9.3f ms  correlation %.3f\n", path.c_str(), m[i].time, m[i].latencyMs, m[i].correlation);
+			}
+		}
+		if (options.csv)
+		{
+			std::printf("%s,%.3f,%d,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.3f\n", path.c_str(), report.seconds, report.windows, (int)n,
+			            median, mean, deviation, low, high, 3600.0*slope, 1000.0*slope);
+		}
+		else
+		{
+			// Long paths keep their end, the part that tells runs apart:
+			const std::string name = path.size() > 40 ? "..." + path.substr(path.size() - 37) : path;
+			std::printf("%-40s %8.1f %7d %8d %10.3f %10.3f %8.3f %10.3f %10.3f %10.3f %9.1f\n", name.c_str(), report.seconds,
+			            report.windows, (int)n, median, mean, deviation, low, high, 3600.0*slope, 1000.0*slope);
+		}
+	}
+	return failures == 0 ? 0 : 1;
+}
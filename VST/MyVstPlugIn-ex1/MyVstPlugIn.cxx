@@ -1,199 +1,309 @@
-#include "MyVstPlugin.hxx"
-
-#include <cmath>
-
-// ---------------------------------------------------------------------------------------
-// Constructor / destructor:
-// ---------------------------------------------------------------------------------------
-
-// Define parameter indexes:
-enum
-{
-	GAIN_PARAM_R,
-	GAIN_PARAM_L,
-	// (.. define other parameters here ..)
-	NUM_PARAMETERS
-};
-
-// Number of programs (presets):
-const int NUM_PROGRAMS = 1; // only current program (NUM_PROGRAMS = 0 causes problems with some hosts)
-
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-MyVstPlugIn::MyVstPlugIn(audioMasterCallback audioMaster) : AudioEffectX(audioMaster, NUM_PROGRAMS, NUM_PARAMETERS)
-{
-	// Set some basic properties of plug-in:
-	setNumInputs(2);			// stereo in
-	setNumOutputs(2);			// stereo out
-	setUniqueID('MVPI');		// unique 4 char identifier for this plug-in (here "My Vst Plug-In")
-	isSynth(false);				// this plug-in is an audio effect, not a synthesizer
-	canProcessReplacing(true);	// supports 'replacing output processing mode' (legacy stuff, always set to true)
-	canDoubleReplacing(false);	// does not support 64 bit floating point I/O
-	programsAreChunks(false);	// programs work through setParameter()/getParameter() rather than binary 'chunks'
-
-	vst_strncpy(programName_, "default", kVstMaxProgNameLen);
-
-	initParameters();
-
-	// (.. do not do much else here, so scanning for plug-ins is fast ..)
-	// (.. do memory allocation/deallocation in resume()/suspend() instead, but normally pointers should be initialized to NULL here ..)
-}
-
-MyVstPlugIn::~MyVstPlugIn()
-{
-	// (.. nothing to do here ..)
-}
-
-// ---------------------------------------------------------------------------------------
-// Parameter functions:
-// ---------------------------------------------------------------------------------------
-
-void MyVstPlugIn::initParameters()
-{
-    gain_L = 0.0f;
-    gain_R = 0.0f;
-	setParameter(GAIN_PARAM_R, 1.0f); // default value of 1.0f corresponds to 0 dB
-	setParameter(GAIN_PARAM_L, 1.0f); // default value of 1.0f corresponds to 0 dB
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-void MyVstPlugIn::setParameter(VstInt32 index, float value)
-{
-	if (index == GAIN_PARAM_R)
-	{
-        lastGainR = gain_R;
-		gain_R = value;
-	}
-	if (index == GAIN_PARAM_L)
-	{
-        lastGainL = gain_L;
-		gain_L = value;
-	}
-	// (.. add more parameters here ..)
-}
-
-float MyVstPlugIn::getParameter(VstInt32 index)
-{
-	if (index == GAIN_PARAM_R)
-	{
-		return gain_R;
-	}
-	else if (index == GAIN_PARAM_L)
-    {
-        return gain_L;
-    }
-	// (.. add more parameters here ..)
-    else
-    {
-        return 0.0f; // invalid index
-    }
-
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-void MyVstPlugIn::getParameterName(VstInt32 index, char *label)
-{
-	if (index == GAIN_PARAM_R)
-	{
-		vst_strncpy(label, "Gain Right", kVstMaxParamStrLen);
-	}
-	else if (index == GAIN_PARAM_L)
-    {
-        vst_strncpy(label, "Gain Left", kVstMaxParamStrLen);
-    }
-    else
-    {
-        vst_strncpy(label, "", kVstMaxParamStrLen); // invalid index
-    }
-}
-
-void MyVstPlugIn::getParameterDisplay(VstInt32 index, char *text)
-{
-	if (index == GAIN_PARAM_R)
-	{
-		dB2string(gain_R, text, kVstMaxParamStrLen); // dB2string() is a VST SDK helper function that converts a linear value to dB scale and then to a string
-	}
-	else if (index == GAIN_PARAM_L)
-    {
-        dB2string(gain_L, text, kVstMaxParamStrLen); // dB2string() is a VST SDK helper function that converts a linear value to dB scale and then to a string
-    }
-    else
-    {
-        vst_strncpy(text, "", kVstMaxParamStrLen); // invalid index
-    }
-}
-
-void MyVstPlugIn::getParameterLabel(VstInt32 index, char *label)
-{
-
-	if ((index == GAIN_PARAM_R ) || (index == GAIN_PARAM_L ))
-	{
-			vst_strncpy(label, "dB", kVstMaxParamStrLen);
-	}
-	else
-	{
-		vst_strncpy(label, "", kVstMaxParamStrLen); // invalid index
-	}
-}
-
-// ---------------------------------------------------------------------------------------
-// Program functions:
-// ---------------------------------------------------------------------------------------
-
-void MyVstPlugIn::setProgramName(char *name)
-{
-	vst_strncpy(programName_, name, kVstMaxProgNameLen);
-}
-
-void MyVstPlugIn::getProgramName(char *name)
-{
-	vst_strncpy(name, programName_, kVstMaxProgNameLen);
-}
-
-// ---------------------------------------------------------------------------------------
-// Processing functions:
-// ---------------------------------------------------------------------------------------
-
-void MyVstPlugIn::resume()
-{
-//	const double sampleRate = getSampleRate();
-//	const int maxBlockSize = getBlockSize();
-
-	// (.. initialization stuff goes here ..)
-	// (.. e.g. allocating memory ..)
-}
-
-void MyVstPlugIn::suspend()
-{
-	// (.. de-initialization stuff goes here ..)
-	// (.. e.g. deallocating memory ..)
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-void MyVstPlugIn::processReplacing(float **inputs, float **outputs, VstInt32 numSamples)
-{
-    for (int j = 0; j < numSamples; ++j)
-    {
-        float gl = lastGainL + (gain_L - lastGainL) * (j/(float)numSamples);
-        outputs[0][j] = inputs[0][j] * gl; // scale each sample in in1 by a factor gain_ and store in out1
-        float gr = lastGainR + (gain_R - lastGainR) * (j/(float)numSamples);
-        outputs[1][j] = inputs[1][j] * gr; // same with right channel
-    }
-    lastGainL = gain_L;
-    lastGainR = gain_R;
-}
-
-// ---------------------------------------------------------------------------------------
-// Instance creator:
-// ---------------------------------------------------------------------------------------
-
-// Method that creates an instance of the VST plug-in:
-AudioEffect *createEffectInstance(audioMasterCallback audioMaster)
-{
-	return new MyVstPlugIn(audioMaster);
-}
-
+#include "MyVstPlugIn.hxx"
+
+#include "DspCore/GainRamp.hxx"
+
+#include <cmath>
+#include <cstring>
+
+// ---------------------------------------------------------------------------------------
+// Constructor / destructor:
+// ---------------------------------------------------------------------------------------
+
+// Define parameter indexes:
+enum
+{
+	GAIN_PARAM_R,
+	GAIN_PARAM_L,
+	// (.. define other parameters here ..)
+	NUM_PARAMETERS
+};
+
+// Name of the instances in the profiles (see BlockProfiler.hxx):
+const char *const PROFILE_NAME = "MyVstPlugIn-ex1";
+
+// Number of programs (presets):
+const int NUM_PROGRAMS = 1; // only current program (NUM_PROGRAMS = 0 causes problems with some hosts)
+
+// Time a gain change takes to ramp to its new value:
+const float GAIN_RAMP_MS = 20.0f;
+
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+MyVstPlugIn::MyVstPlugIn(audioMasterCallback audioMaster)
+	: AudioEffectX(audioMaster, NUM_PROGRAMS, NUM_PARAMETERS), events_(NUM_PARAMETERS)
+{
+	// Set some basic properties of plug-in:
+	setNumInputs(2);			// stereo in
+	setNumOutputs(2);			// stereo out
+	setUniqueID('MVPI');		// unique 4 char identifier for this plug-in (here "My Vst Plug-In")
+	isSynth(false);				// this plug-in is an audio effect, not a synthesizer
+	canProcessReplacing(true);	// supports 'replacing output processing mode' (legacy stuff, always set to true)
+	canDoubleReplacing(true);	// supports 64 bit floating point I/O (processDoubleReplacing())
+	programsAreChunks(false);	// programs work through setParameter()/getParameter() rather than binary 'chunks'
+	noTail(true);				// silence in, silence out: hosts may stop calling processReplacing() on idle tracks
+
+	vst_strncpy(programName_, "default", kVstMaxProgNameLen);
+
+	initParameters();
+
+	// (.. do not do much else here, so scanning for plug-ins is fast ..)
+	// (.. do memory allocation/deallocation in resume()/suspend() instead, but normally pointers should be initialized to NULL here ..)
+}
+
+MyVstPlugIn::~MyVstPlugIn()
+{
+	// (.. nothing to do here ..)
+}
+
+// ---------------------------------------------------------------------------------------
+// Parameter functions:
+// ---------------------------------------------------------------------------------------
+
+void MyVstPlugIn::initParameters()
+{
+	setParameter(GAIN_PARAM_R, 1.0f); // default value of 1.0f corresponds to 0 dB
+	setParameter(GAIN_PARAM_L, 1.0f); // default value of 1.0f corresponds to 0 dB
+
+	// Start at the defaults rather than ramping to them:
+	parameters_.takeChanges();
+	gainR_.reset(parameters_.get(GAIN_PARAM_R));
+	gainL_.reset(parameters_.get(GAIN_PARAM_L));
+}
+
+// Called on the audio thread at the start of every block:
+void MyVstPlugIn::updateParameters()
+{
+	const uint32_t changes = parameters_.takeChanges();
+	for (int i = 0; i < NUM_PARAMETERS; ++i)
+	{
+		if (ParameterState::hasChanged(changes, i))
+		{
+			applyParameter(i, parameters_.get(i));
+		}
+	}
+}
+
+// Sets the smoother of a parameter, at the start of a block or at a scheduled event:
+void MyVstPlugIn::applyParameter(int index, float value)
+{
+	if (index == GAIN_PARAM_R)
+	{
+		gainR_.setTarget(value);
+	}
+	else if (index == GAIN_PARAM_L)
+	{
+		gainL_.setTarget(value);
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void MyVstPlugIn::setParameter(VstInt32 index, float value)
+{
+	// May be called from any thread; the audio thread picks the value up in updateParameters():
+	if (index >= 0 && index < NUM_PARAMETERS)
+	{
+		parameters_.set(index, value);
+	}
+}
+
+float MyVstPlugIn::getParameter(VstInt32 index)
+{
+	if (index == GAIN_PARAM_R)
+	{
+		return parameters_.get(GAIN_PARAM_R);
+	}
+	else if (index == GAIN_PARAM_L)
+    {
+        return parameters_.get(GAIN_PARAM_L);
+    }
+	// (.. add more parameters here ..)
+    else
+    {
+        return 0.0f; // invalid index
+    }
+
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void MyVstPlugIn::getParameterName(VstInt32 index, char *label)
+{
+	if (index == GAIN_PARAM_R)
+	{
+		vst_strncpy(label, "Gain Right", kVstMaxParamStrLen);
+	}
+	else if (index == GAIN_PARAM_L)
+    {
+        vst_strncpy(label, "Gain Left", kVstMaxParamStrLen);
+    }
+    else
+    {
+        vst_strncpy(label, "", kVstMaxParamStrLen); // invalid index
+    }
+}
+
+void MyVstPlugIn::getParameterDisplay(VstInt32 index, char *text)
+{
+	if (index == GAIN_PARAM_R)
+	{
+		dB2string(parameters_.get(GAIN_PARAM_R), text, kVstMaxParamStrLen); // dB2string() is a VST SDK helper function that converts a linear value to dB scale and then to a string
+	}
+	else if (index == GAIN_PARAM_L)
+    {
+        dB2string(parameters_.get(GAIN_PARAM_L), text, kVstMaxParamStrLen); // dB2string() is a VST SDK helper function that converts a linear value to dB scale and then to a string
+    }
+    else
+    {
+        vst_strncpy(text, "", kVstMaxParamStrLen); // invalid index
+    }
+}
+
+void MyVstPlugIn::getParameterLabel(VstInt32 index, char *label)
+{
+
+	if ((index == GAIN_PARAM_R ) || (index == GAIN_PARAM_L ))
+	{
+			vst_strncpy(label, "dB", kVstMaxParamStrLen);
+	}
+	else
+	{
+		vst_strncpy(label, "", kVstMaxParamStrLen); // invalid index
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// Program functions:
+// ---------------------------------------------------------------------------------------
+
+void MyVstPlugIn::setProgramName(char *name)
+{
+	vst_strncpy(programName_, name, kVstMaxProgNameLen);
+}
+
+void MyVstPlugIn::getProgramName(char *name)
+{
+	vst_strncpy(name, programName_, kVstMaxProgNameLen);
+}
+
+// ---------------------------------------------------------------------------------------
+// Processing functions:
+// ---------------------------------------------------------------------------------------
+
+void MyVstPlugIn::resume()
+{
+	const float sampleRate = getSampleRate();
+//	const int maxBlockSize = getBlockSize();
+
+	profiler_.setup(PROFILE_NAME, sampleRate);
+
+	gainR_.setRampTime(GAIN_RAMP_MS, sampleRate);
+	gainL_.setRampTime(GAIN_RAMP_MS, sampleRate);
+
+	// Nothing to ramp from after a suspend:
+	updateParameters();
+	gainR_.reset(gainR_.target());
+	gainL_.reset(gainL_.target());
+}
+
+void MyVstPlugIn::suspend()
+{
+	// (.. de-initialization stuff goes here ..)
+	// (.. e.g. deallocating memory ..)
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+template <typename Sample>
+void MyVstPlugIn::processBlock(Sample **inputs, Sample **outputs, VstInt32 numSamples)
+{
+	updateParameters();
+	if (gainL_.isSmoothing() || gainR_.isSmoothing())
+	{
+		profiler_.mark(BlockProfiler::kRamping);
+	}
+
+	// Scale each channel by its smoothed gain (vectorised, see GainRamp.hxx), in sub-blocks
+	// split at the scheduled parameter changes:
+	events_.process(numSamples,
+		[this](const ScheduledEvent &event) { handleEvent(event); },
+		[&](int start, int length) {
+			applySmoothedGain(gainL_, inputs[0] + start, outputs[0] + start, length);
+			applySmoothedGain(gainR_, inputs[1] + start, outputs[1] + start, length);
+		});
+}
+
+// Subnormal input (the tail of an upstream filter) would slow the gain multiplies down:
+void MyVstPlugIn::processReplacing(float **inputs, float **outputs, VstInt32 numSamples)
+{
+	BlockProfiler::Scope profile(profiler_, numSamples);
+	ScopedFlushDenormals flushDenormals;
+	processBlock(inputs, outputs, numSamples);
+}
+
+// Hosts with a 64 bit mix bus call this; same code, no conversion to float and back:
+void MyVstPlugIn::processDoubleReplacing(double **inputs, double **outputs, VstInt32 numSamples)
+{
+	BlockProfiler::Scope profile(profiler_, numSamples, BlockProfiler::kDouble);
+	ScopedFlushDenormals flushDenormals;
+	processBlock(inputs, outputs, numSamples);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Called by the host before processReplacing(), with the events of the next block. Control
+// changes 20 and 21 set the right and left gain at their deltaFrames (see EventScheduler.hxx):
+VstInt32 MyVstPlugIn::processEvents(VstEvents *events)
+{
+	for (VstInt32 i = 0; i < events->numEvents; ++i)
+	{
+		if (events->events[i]->type != kVstMidiType)
+		{
+			continue;
+		}
+		const VstMidiEvent *midi = (const VstMidiEvent *)events->events[i];
+		events_.pushMidi(midi->deltaFrames, (unsigned char)midi->midiData[0],
+		                 (unsigned char)midi->midiData[1], (unsigned char)midi->midiData[2]);
+	}
+	return 1;
+}
+
+void MyVstPlugIn::handleEvent(const ScheduledEvent &event)
+{
+	// Other MIDI messages are ignored:
+	if (event.isParameter())
+	{
+		parameters_.set(event.parameter, event.value); // for getParameter(); re-applying it next block is a no-op
+		applyParameter(event.parameter, event.value);
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// Capabilities:
+// ---------------------------------------------------------------------------------------
+
+VstInt32 MyVstPlugIn::getGetTailSize()
+{
+	return 1; // no tail (0 would mean "not reported")
+}
+
+VstInt32 MyVstPlugIn::canDo(char *text)
+{
+	if (std::strcmp(text, "receiveVstEvents") == 0 || std::strcmp(text, "receiveVstMidiEvent") == 0)
+	{
+		return 1;
+	}
+	return -1; // explicitly can't do; 0 => don't know
+}
+
+// ---------------------------------------------------------------------------------------
+// Instance creator:
+// ---------------------------------------------------------------------------------------
+
+// Method that creates an instance of the VST plug-in:
+AudioEffect *createEffectInstance(audioMasterCallback audioMaster)
+{
+	return new MyVstPlugIn(audioMaster);
+}
+
@@ -1,208 +1,331 @@
-#include "MyVstPlugin.hxx"
-
-#include <cmath>
-
-// ---------------------------------------------------------------------------------------
-// Constructor / destructor:
-// ---------------------------------------------------------------------------------------
-
-// Define parameter indexes:
-enum
-{
-	BALANCE,
-    GAIN,
-	// (.. define other parameters here ..)
-	NUM_PARAMETERS
-};
-
-// Number of programs (presets):
-const int NUM_PROGRAMS = 1; // only current program (NUM_PROGRAMS = 0 causes problems with some hosts)
-
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-MyVstPlugIn::MyVstPlugIn(audioMasterCallback audioMaster) : AudioEffectX(audioMaster, NUM_PROGRAMS, NUM_PARAMETERS)
-{
-	// Set some basic properties of plug-in:
-	setNumInputs(2);			// stereo in
-	setNumOutputs(2);			// stereo out
-	setUniqueID('MVPI');		// unique 4 char identifier for this plug-in (here "My Vst Plug-In")
-	isSynth(false);				// this plug-in is an audio effect, not a synthesizer
-	canProcessReplacing(true);	// supports 'replacing output processing mode' (legacy stuff, always set to true)
-	canDoubleReplacing(false);	// does not support 64 bit floating point I/O
-	programsAreChunks(false);	// programs work through setParameter()/getParameter() rather than binary 'chunks'
-
-	vst_strncpy(programName_, "default", kVstMaxProgNameLen);
-
-	initParameters();
-
-	// (.. do not do much else here, so scanning for plug-ins is fast ..)
-	// (.. do memory allocation/deallocation in resume()/suspend() instead, but normally pointers should be initialized to NULL here ..)
-}
-
-MyVstPlugIn::~MyVstPlugIn()
-{
-	// (.. nothing to do here ..)
-}
-
-// ---------------------------------------------------------------------------------------
-// Parameter functions:
-// ---------------------------------------------------------------------------------------
-
-void MyVstPlugIn::initParameters()
-{
-    gain = 0.0f;
-    balance = 0.5f;
-	setParameter(BALANCE, 0.5f); 
-    setParameter(GAIN, 1.0f);
-	// (.. add more parameters here ..)
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-void MyVstPlugIn::setParameter(VstInt32 index, float value)
-{
-	if (index == BALANCE)
-	{
-        last_balance = balance;
-		balance = value;
-	} 
-    else if (index == GAIN)
-    {
-        last_gain = gain;
-        gain = value;
-    }
-    
-}
-
-float MyVstPlugIn::getParameter(VstInt32 index)
-{
-	if (index == BALANCE)
-	{
-		return balance;
-	}
-    else if (index == GAIN)
-    {
-        return gain;
-    }
-    else
-    {
-        return 0.0f; // invalid index
-    }
-
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-void MyVstPlugIn::getParameterName(VstInt32 index, char *label)
-{
-	if (index == BALANCE)
-	{
-		vst_strncpy(label, "Balance", kVstMaxParamStrLen);
-	}
-    else if (index == GAIN)
-    {
-        vst_strncpy(label, "Gain", kVstMaxParamStrLen);
-    }
-    else
-    {
-        vst_strncpy(label, "", kVstMaxParamStrLen); // invalid index
-    }
-}
-
-void MyVstPlugIn::getParameterDisplay(VstInt32 index, char *text)
-{
-	if (index == BALANCE)
-	{
-		float2string(balance, text, kVstMaxParamStrLen); // dB2string() is a VST SDK helper function that converts a linear value to dB scale and then to a string
-	}
-    else if (index == GAIN)
-    {
-        dB2string(gain, text, kVstMaxParamStrLen);
-    }
-    else
-    {
-        vst_strncpy(text, "", kVstMaxParamStrLen); // invalid index
-    }
-}
-
-void MyVstPlugIn::getParameterLabel(VstInt32 index, char *label)
-{
-	if (index == BALANCE )
-	{
-		vst_strncpy(label, "", kVstMaxParamStrLen);
-	}
-    else if (index == GAIN)
-    {
-        vst_strncpy(label, "", kVstMaxParamStrLen);
-    }
-	else
-	{
-		vst_strncpy(label, "", kVstMaxParamStrLen); // invalid index
-	}
-}
-
-// ---------------------------------------------------------------------------------------
-// Program functions:
-// ---------------------------------------------------------------------------------------
-
-void MyVstPlugIn::setProgramName(char *name)
-{
-	vst_strncpy(programName_, name, kVstMaxProgNameLen);
-}
-
-void MyVstPlugIn::getProgramName(char *name)
-{
-	vst_strncpy(name, programName_, kVstMaxProgNameLen);
-}
-
-// ---------------------------------------------------------------------------------------
-// Processing functions:
-// ---------------------------------------------------------------------------------------
-
-void MyVstPlugIn::resume()
-{
-//	const double sampleRate = getSampleRate();
-//	const int maxBlockSize = getBlockSize();
-
-	// (.. initialization stuff goes here ..)
-	// (.. e.g. allocating memory ..)
-}
-
-void MyVstPlugIn::suspend()
-{
-	// (.. de-initialization stuff goes here ..)
-	// (.. e.g. deallocating memory ..)
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-void MyVstPlugIn::processReplacing(float **inputs, float **outputs, VstInt32 numSamples)
-{
-    // -3 dB 
-	// float gain_L = cos(balance*PI/2.0f);
-	// float gain_R = sin(balance*PI/2.0f);
-    
-    // -4.5 dB
-    for (int j = 0; j < numSamples; ++j)
-    {
-        float g = last_gain + (gain - last_gain) * (j/(float)numSamples);
-        float b = last_balance + (balance - last_balance) * (j/(float)numSamples);
-        outputs[0][j] = inputs[0][j] * g * sqrt(1-b); // scale each sample in in1 by a factor gain_ and store in out1
-        outputs[1][j] = inputs[1][j] * g * sqrt(b); // same with right channel
-    }
-    last_gain = gain;
-    last_balance = balance;
-}
-
-// ---------------------------------------------------------------------------------------
-// Instance creator:
-// ---------------------------------------------------------------------------------------
-
-// Method that creates an instance of the VST plug-in:
-AudioEffect *createEffectInstance(audioMasterCallback audioMaster)
-{
-	return new MyVstPlugIn(audioMaster);
-}
-
+#include "MyVstPlugIn.hxx"
+
+#include <cmath>
+#include <cstring>
+
+// ---------------------------------------------------------------------------------------
+// Constructor / destructor:
+// ---------------------------------------------------------------------------------------
+
+// Define parameter indexes:
+enum
+{
+	BALANCE,
+    GAIN,
+	PAN_LAW,
+	// (.. define other parameters here ..)
+	NUM_PARAMETERS
+};
+
+// Name of the instances in the profiles (see BlockProfiler.hxx):
+const char *const PROFILE_NAME = "MyVstPlugIn-ex2";
+
+// Number of programs (presets):
+const int NUM_PROGRAMS = 1; // only current program (NUM_PROGRAMS = 0 causes problems with some hosts)
+
+// Time a gain or balance change takes to ramp to its new value:
+const float RAMP_MS = 20.0f;
+
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+MyVstPlugIn::MyVstPlugIn(audioMasterCallback audioMaster)
+	: AudioEffectX(audioMaster, NUM_PROGRAMS, NUM_PARAMETERS), events_(NUM_PARAMETERS)
+{
+	// Set some basic properties of plug-in:
+	setNumInputs(2);			// stereo in
+	setNumOutputs(2);			// stereo out
+	setUniqueID('MVPI');		// unique 4 char identifier for this plug-in (here "My Vst Plug-In")
+	isSynth(false);				// this plug-in is an audio effect, not a synthesizer
+	canProcessReplacing(true);	// supports 'replacing output processing mode' (legacy stuff, always set to true)
+	canDoubleReplacing(true);	// supports 64 bit floating point I/O (processDoubleReplacing())
+	programsAreChunks(false);	// programs work through setParameter()/getParameter() rather than binary 'chunks'
+	noTail(true);				// silence in, silence out: hosts may stop calling processReplacing() on idle tracks
+
+	vst_strncpy(programName_, "default", kVstMaxProgNameLen);
+
+	initParameters();
+
+	// (.. do not do much else here, so scanning for plug-ins is fast ..)
+	// (.. do memory allocation/deallocation in resume()/suspend() instead, but normally pointers should be initialized to NULL here ..)
+}
+
+MyVstPlugIn::~MyVstPlugIn()
+{
+	// (.. nothing to do here ..)
+}
+
+// ---------------------------------------------------------------------------------------
+// Parameter functions:
+// ---------------------------------------------------------------------------------------
+
+void MyVstPlugIn::initParameters()
+{
+	setParameter(BALANCE, 0.5f); 
+    setParameter(GAIN, 1.0f);
+	setParameter(PAN_LAW, switch2norm(kPanLaw3dB, kNumPanLaws));
+	// (.. add more parameters here ..)
+
+	// Start at the defaults rather than ramping to them:
+	parameters_.takeChanges();
+	balance_.reset(parameters_.get(BALANCE));
+	gain_.reset(parameters_.get(GAIN));
+	panLaw_ = (PanLaw)norm2switch(parameters_.get(PAN_LAW), kNumPanLaws);
+}
+
+// Called on the audio thread at the start of every block:
+void MyVstPlugIn::updateParameters()
+{
+	const uint32_t changes = parameters_.takeChanges();
+	for (int i = 0; i < NUM_PARAMETERS; ++i)
+	{
+		if (ParameterState::hasChanged(changes, i))
+		{
+			applyParameter(i, parameters_.get(i));
+		}
+	}
+}
+
+// Sets the smoother or switch of a parameter, at the start of a block or at a scheduled event:
+void MyVstPlugIn::applyParameter(int index, float value)
+{
+	if (index == BALANCE)
+	{
+		balance_.setTarget(value);
+	}
+	else if (index == GAIN)
+	{
+		gain_.setTarget(value);
+	}
+	else if (index == PAN_LAW)
+	{
+		panLaw_ = (PanLaw)norm2switch(value, kNumPanLaws);
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void MyVstPlugIn::setParameter(VstInt32 index, float value)
+{
+	// May be called from any thread; the audio thread picks the value up in updateParameters():
+	if (index >= 0 && index < NUM_PARAMETERS)
+	{
+		parameters_.set(index, value);
+	}
+}
+
+float MyVstPlugIn::getParameter(VstInt32 index)
+{
+	if (index == BALANCE)
+	{
+		return parameters_.get(BALANCE);
+	}
+    else if (index == GAIN)
+    {
+        return parameters_.get(GAIN);
+    }
+    else if (index == PAN_LAW)
+    {
+        return parameters_.get(PAN_LAW);
+    }
+    else
+    {
+        return 0.0f; // invalid index
+    }
+
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void MyVstPlugIn::getParameterName(VstInt32 index, char *label)
+{
+	if (index == BALANCE)
+	{
+		vst_strncpy(label, "Balance", kVstMaxParamStrLen);
+	}
+    else if (index == GAIN)
+    {
+        vst_strncpy(label, "Gain", kVstMaxParamStrLen);
+    }
+    else if (index == PAN_LAW)
+    {
+        vst_strncpy(label, "Pan Law", kVstMaxParamStrLen);
+    }
+    else
+    {
+        vst_strncpy(label, "", kVstMaxParamStrLen); // invalid index
+    }
+}
+
+void MyVstPlugIn::getParameterDisplay(VstInt32 index, char *text)
+{
+	if (index == BALANCE)
+	{
+		float2string(parameters_.get(BALANCE), text, kVstMaxParamStrLen); // dB2string() is a VST SDK helper function that converts a linear value to dB scale and then to a string
+	}
+    else if (index == GAIN)
+    {
+        dB2string(parameters_.get(GAIN), text, kVstMaxParamStrLen);
+    }
+    else if (index == PAN_LAW)
+    {
+        vst_strncpy(text, panLawName((PanLaw)norm2switch(parameters_.get(PAN_LAW), kNumPanLaws)), kVstMaxParamStrLen);
+    }
+    else
+    {
+        vst_strncpy(text, "", kVstMaxParamStrLen); // invalid index
+    }
+}
+
+void MyVstPlugIn::getParameterLabel(VstInt32 index, char *label)
+{
+	if (index == BALANCE )
+	{
+		vst_strncpy(label, "", kVstMaxParamStrLen);
+	}
+    else if (index == GAIN)
+    {
+        vst_strncpy(label, "", kVstMaxParamStrLen);
+    }
+	else
+	{
+		vst_strncpy(label, "", kVstMaxParamStrLen); // invalid index
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// Program functions:
+// ---------------------------------------------------------------------------------------
+
+void MyVstPlugIn::setProgramName(char *name)
+{
+	vst_strncpy(programName_, name, kVstMaxProgNameLen);
+}
+
+void MyVstPlugIn::getProgramName(char *name)
+{
+	vst_strncpy(name, programName_, kVstMaxProgNameLen);
+}
+
+// ---------------------------------------------------------------------------------------
+// Processing functions:
+// ---------------------------------------------------------------------------------------
+
+void MyVstPlugIn::resume()
+{
+	const float sampleRate = getSampleRate();
+//	const int maxBlockSize = getBlockSize();
+
+	profiler_.setup(PROFILE_NAME, sampleRate);
+
+	balance_.setRampTime(RAMP_MS, sampleRate);
+	gain_.setRampTime(RAMP_MS, sampleRate);
+
+	// Nothing to ramp from after a suspend:
+	updateParameters();
+	balance_.reset(balance_.target());
+	gain_.reset(gain_.target());
+}
+
+void MyVstPlugIn::suspend()
+{
+	// (.. de-initialization stuff goes here ..)
+	// (.. e.g. deallocating memory ..)
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+template <typename Sample>
+void MyVstPlugIn::processBlock(Sample **inputs, Sample **outputs, VstInt32 numSamples)
+{
+	updateParameters();
+	if (gain_.isSmoothing() || balance_.isSmoothing())
+	{
+		profiler_.mark(BlockProfiler::kRamping);
+	}
+
+	// Gain times the selected pan law (table lookup, no sqrt/cos per sample), vectorised per channel,
+	// in sub-blocks split at the scheduled parameter changes:
+	events_.process(numSamples,
+		[this](const ScheduledEvent &event) { handleEvent(event); },
+		[&](int start, int length) {
+			const Sample *in[2] = { inputs[0] + start, inputs[1] + start };
+			Sample *out[2] = { outputs[0] + start, outputs[1] + start };
+			applySmoothedPan(panLaw_, gain_, balance_, in, out, length);
+		});
+}
+
+// Subnormal input (the tail of an upstream filter) would slow the gain multiplies down:
+void MyVstPlugIn::processReplacing(float **inputs, float **outputs, VstInt32 numSamples)
+{
+	BlockProfiler::Scope profile(profiler_, numSamples);
+	ScopedFlushDenormals flushDenormals;
+	processBlock(inputs, outputs, numSamples);
+}
+
+// Hosts with a 64 bit mix bus call this; the double buffers go straight through the pan kernels:
+void MyVstPlugIn::processDoubleReplacing(double **inputs, double **outputs, VstInt32 numSamples)
+{
+	BlockProfiler::Scope profile(profiler_, numSamples, BlockProfiler::kDouble);
+	ScopedFlushDenormals flushDenormals;
+	processBlock(inputs, outputs, numSamples);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Called by the host before processReplacing(), with the events of the next block. Control
+// changes 20, 21 and 22 set balance, gain and pan law at their deltaFrames (see EventScheduler.hxx):
+VstInt32 MyVstPlugIn::processEvents(VstEvents *events)
+{
+	for (VstInt32 i = 0; i < events->numEvents; ++i)
+	{
+		if (events->events[i]->type != kVstMidiType)
+		{
+			continue;
+		}
+		const VstMidiEvent *midi = (const VstMidiEvent *)events->events[i];
+		events_.pushMidi(midi->deltaFrames, (unsigned char)midi->midiData[0],
+		                 (unsigned char)midi->midiData[1], (unsigned char)midi->midiData[2]);
+	}
+	return 1;
+}
+
+void MyVstPlugIn::handleEvent(const ScheduledEvent &event)
+{
+	// Other MIDI messages are ignored:
+	if (event.isParameter())
+	{
+		parameters_.set(event.parameter, event.value); // for getParameter(); re-applying it next block changes nothing
+		applyParameter(event.parameter, event.value);
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// Capabilities:
+// ---------------------------------------------------------------------------------------
+
+VstInt32 MyVstPlugIn::getGetTailSize()
+{
+	return 1; // no tail (0 would mean "not reported")
+}
+
+VstInt32 MyVstPlugIn::canDo(char *text)
+{
+	if (std::strcmp(text, "receiveVstEvents") == 0 || std::strcmp(text, "receiveVstMidiEvent") == 0)
+	{
+		return 1;
+	}
+	return -1; // explicitly can't do; 0 => don't know
+}
+
+// ---------------------------------------------------------------------------------------
+// Instance creator:
+// ---------------------------------------------------------------------------------------
+
+// Method that creates an instance of the VST plug-in:
+AudioEffect *createEffectInstance(audioMasterCallback audioMaster)
+{
+	return new MyVstPlugIn(audioMaster);
+}
+
 // getsamplerate i mirar freq / periode ... mostres cicle i calcular el pas per cada mostra
\ No newline at end of file
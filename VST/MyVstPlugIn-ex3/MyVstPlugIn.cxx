@@ -1,248 +1,460 @@
-#include "MyVstPlugin.hxx"
-
-#include <cmath>
-
-// ---------------------------------------------------------------------------------------
-// Constructor / destructor:
-// ---------------------------------------------------------------------------------------
-
-// Define parameter indexes:
-enum
-{
-	GAIN_PARAM,
-	FC_PARAM,
-	Q_PARAM,
-	NUM_PARAMETERS
-};
-
-// Number of programs (presets):
-const int NUM_PROGRAMS = 1; // only current program (NUM_PROGRAMS = 0 causes problems with some hosts)
-
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-MyVstPlugIn::MyVstPlugIn(audioMasterCallback audioMaster) : AudioEffectX(audioMaster, NUM_PROGRAMS, NUM_PARAMETERS)
-{
-	// Set some basic properties of plug-in:
-	setNumInputs(1);			// stereo in
-	setNumOutputs(1);			// stereo out
-	setUniqueID('MVPI');		// unique 4 char identifier for this plug-in (here "My Vst Plug-In")
-	isSynth(false);				// this plug-in is an audio effect, not a synthesizer
-	canProcessReplacing(true);	// supports 'replacing output processing mode' (legacy stuff, always set to true)
-	canDoubleReplacing(false);	// does not support 64 bit floating point I/O
-	programsAreChunks(false);	// programs work through setParameter()/getParameter() rather than binary 'chunks'
-
-	vst_strncpy(programName_, "default", kVstMaxProgNameLen);
-
-	initParameters();
-
-	// (.. do not do much else here, so scanning for plug-ins is fast ..)
-	// (.. do memory allocation/deallocation in resume()/suspend() instead, but normally pointers should be initialized to NULL here ..)
-}
-
-MyVstPlugIn::~MyVstPlugIn()
-{
-	// (.. nothing to do here ..)
-}
-
-// ---------------------------------------------------------------------------------------
-// Parameter functions:
-// ---------------------------------------------------------------------------------------
-
-void MyVstPlugIn::initParameters()
-{
-    gain = 0.0f;
-	setParameter(GAIN_PARAM, 0.7f); 
-	setParameter(FC_PARAM, 0.6f); 
-	setParameter(Q_PARAM, 0.2f); 
-    for (int i = 0; i < 3; i++) {
-        xN_[i] = 0.0f;
-        yN_[i] = 0.0f;
-    }
-    updateCoeffs();
-
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-void MyVstPlugIn::setParameter(VstInt32 index, float value)
-{
-	switch (index) {
-        case GAIN_PARAM:
-            last_gain = gain;
-            gain = value;
-            break;
-        case FC_PARAM:
-            freq = norm2exp(value, MIN_FREQ, MAX_FREQ);
-            updateCoeffs();
-            break;
-        case Q_PARAM:
-            q = norm2lin(value, MIN_Q, MAX_Q);
-            updateCoeffs();
-            break;
-    }
-	
-}
-
-float MyVstPlugIn::getParameter(VstInt32 index)
-{
-    switch (index) {
-        case GAIN_PARAM:
-            return gain;
-            break;
-        case FC_PARAM:
-            return exp2norm(freq, MIN_FREQ, MAX_FREQ);
-            break;
-        case Q_PARAM:
-            return lin2norm(q, MIN_Q, MAX_Q);
-            break;
-        default:
-            return 0.0f; // default
-            break;
-    }
-
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-void MyVstPlugIn::getParameterName(VstInt32 index, char *label)
-{    
-    switch (index) {
-        case GAIN_PARAM:
-            vst_strncpy(label, "Gain", kVstMaxParamStrLen);
-            break;
-        case FC_PARAM:
-            vst_strncpy(label, "Cutoff F", kVstMaxParamStrLen);
-            break;
-        case Q_PARAM:
-            vst_strncpy(label, "Q", kVstMaxParamStrLen);
-            break;
-        default:
-            vst_strncpy(label, "", kVstMaxParamStrLen); // default
-            break;
-    }
-    
-}
-
-void MyVstPlugIn::getParameterDisplay(VstInt32 index, char *text)
-{
-    switch (index) {
-        case GAIN_PARAM:
-            dB2string(gain, text, kVstMaxParamStrLen);
-            break;
-        case FC_PARAM:
-            float2string(freq, text, kVstMaxParamStrLen);
-            break;
-        case Q_PARAM:
-            float2string(q, text, kVstMaxParamStrLen);
-            break;
-        default:
-            vst_strncpy(text, "", kVstMaxParamStrLen); // invalid index
-            break;
-    }    
-
-}
-
-void MyVstPlugIn::getParameterLabel(VstInt32 index, char *label)
-{
-    switch (index) {
-        case GAIN_PARAM:
-            vst_strncpy(label, "", kVstMaxParamStrLen);
-            break;
-        case FC_PARAM:
-            vst_strncpy(label, "", kVstMaxParamStrLen);
-            break;
-        case Q_PARAM:
-            vst_strncpy(label, "", kVstMaxParamStrLen);
-            break;
-        default:
-            vst_strncpy(label, "", kVstMaxParamStrLen); // invalid index
-            break;
-    }    
-}
-
-// ---------------------------------------------------------------------------------------
-// Program functions:
-// ---------------------------------------------------------------------------------------
-
-void MyVstPlugIn::setProgramName(char *name)
-{
-	vst_strncpy(programName_, name, kVstMaxProgNameLen);
-}
-
-void MyVstPlugIn::getProgramName(char *name)
-{
-	vst_strncpy(name, programName_, kVstMaxProgNameLen);
-}
-
-// ---------------------------------------------------------------------------------------
-// Private functions:
-// ---------------------------------------------------------------------------------------
-
-void MyVstPlugIn::updateCoeffs()
-{
-    float w0 = 2 * PI * freq / (float)getSampleRate();
-    float alpha = sin(w0) / (2.0f * q);
-    
-    b_[0] = (1.0f - cos(w0)) / 2.0f;
-    b_[1] = 1.0f - cos(w0);
-    b_[2] = b_[0];
-    a_[0] = 1.0f + alpha;
-    a_[1] = -2.0f * cos(w0);
-    a_[2] = 1.0f - alpha;
-}
-
-// ---------------------------------------------------------------------------------------
-// Processing functions:
-// ---------------------------------------------------------------------------------------
-
-void MyVstPlugIn::resume()
-{
-//	const double sampleRate = getSampleRate();
-//	const int maxBlockSize = getBlockSize();
-
-	// (.. initialization stuff goes here ..)
-	// (.. e.g. allocating memory ..)
-}
-
-void MyVstPlugIn::suspend()
-{
-	// (.. de-initialization stuff goes here ..)
-	// (.. e.g. deallocating memory ..)
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-void MyVstPlugIn::processReplacing(float **inputs, float **outputs, VstInt32 numSamples)
-{
-
-	float *out = outputs[0];
-    float *in = inputs[0];
-
-    for (int j = 0; j < numSamples; ++j) {
-        
-        xN_[2] = xN_[1];
-        xN_[1] = xN_[0];
-        xN_[0] = in[j];
-        yN_[2] = yN_[1];
-        yN_[1] = yN_[0];
-        
-        yN_[0] = (b_[0]/a_[0]) * xN_[0] + (b_[1]/a_[0]) * xN_[1] + (b_[2]/a_[0]) * xN_[2] -
-                 (a_[1]/a_[0]) * yN_[1] - (a_[2]/a_[0]) * yN_[2];
-        
-        out[j] = (last_gain + (gain-last_gain) * (j/(float)numSamples)) * yN_[0];
-    }
-    last_gain = gain;
-}
-
-// ---------------------------------------------------------------------------------------
-// Instance creator:
-// ---------------------------------------------------------------------------------------
-
-// Method that creates an instance of the VST plug-in:
-AudioEffect *createEffectInstance(audioMasterCallback audioMaster)
-{
-	return new MyVstPlugIn(audioMaster);
-}
-
+#include "MyVstPlugIn.hxx"
+
+#include "DspCore/GainRamp.hxx"
+
+#include <cstring>
+
+// ---------------------------------------------------------------------------------------
+// Constructor / destructor:
+// ---------------------------------------------------------------------------------------
+
+// Define parameter indexes:
+enum
+{
+	GAIN_PARAM,
+	FC_PARAM,
+	Q_PARAM,
+	NUM_PARAMETERS
+};
+
+// Name of the instances in the profiles (see BlockProfiler.hxx):
+const char *const PROFILE_NAME = "MyVstPlugIn-ex3";
+
+// Number of programs (presets):
+const int NUM_PROGRAMS = 1; // only current program (NUM_PROGRAMS = 0 causes problems with some hosts)
+
+// Parameter smoothing times:
+const float GAIN_RAMP_MS = 20.0f;
+const float FILTER_SMOOTHING_MS = 15.0f; // time constant of the cutoff/Q glide
+
+// While cutoff or Q glide, coefficients are looked up every COEFF_UPDATE_SAMPLES samples and
+// interpolated per sample in between:
+const int COEFF_UPDATE_SAMPLES = 32;
+
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+MyVstPlugIn::MyVstPlugIn(audioMasterCallback audioMaster)
+	: AudioEffectX(audioMaster, NUM_PROGRAMS, NUM_PARAMETERS), events_(NUM_PARAMETERS)
+{
+	// Set some basic properties of plug-in:
+	setNumInputs(NUM_CHANNELS);	// mono in by default
+	setNumOutputs(NUM_CHANNELS);	// mono out by default
+	setUniqueID('MVPI');		// unique 4 char identifier for this plug-in (here "My Vst Plug-In")
+	isSynth(false);				// this plug-in is an audio effect, not a synthesizer
+	canProcessReplacing(true);	// supports 'replacing output processing mode' (legacy stuff, always set to true)
+	canDoubleReplacing(true);	// supports 64 bit floating point I/O (processDoubleReplacing())
+	programsAreChunks(false);	// programs work through setParameter()/getParameter() rather than binary 'chunks'
+
+	vst_strncpy(programName_, "default", kVstMaxProgNameLen);
+
+	initParameters();
+
+	// (.. do not do much else here, so scanning for plug-ins is fast ..)
+	// (.. do memory allocation/deallocation in resume()/suspend() instead, but normally pointers should be initialized to NULL here ..)
+}
+
+MyVstPlugIn::~MyVstPlugIn()
+{
+	// (.. nothing to do here ..)
+}
+
+// ---------------------------------------------------------------------------------------
+// Parameter functions:
+// ---------------------------------------------------------------------------------------
+
+void MyVstPlugIn::initParameters()
+{
+	setParameter(GAIN_PARAM, 0.7f); 
+	setParameter(FC_PARAM, 0.6f); 
+	setParameter(Q_PARAM, 0.2f); 
+	for (int f = 0; f < NUM_FILTERS; ++f)
+	{
+		filters_[f].reset();
+	}
+
+	// Start at the defaults rather than gliding to them:
+	parameters_.takeChanges();
+	gain_.reset(parameters_.get(GAIN_PARAM));
+	cutoff_.reset(parameters_.get(FC_PARAM));
+	resonance_.reset(parameters_.get(Q_PARAM));
+
+}
+
+// Called on the audio thread at the start of every block:
+void MyVstPlugIn::updateParameters()
+{
+	const uint32_t changes = parameters_.takeChanges();
+	for (int i = 0; i < NUM_PARAMETERS; ++i)
+	{
+		if (ParameterState::hasChanged(changes, i))
+		{
+			applyParameter(i, parameters_.get(i));
+		}
+	}
+}
+
+// Sets the smoother of a parameter, at the start of a block or at a scheduled event:
+void MyVstPlugIn::applyParameter(int index, float value)
+{
+	switch (index)
+	{
+		case GAIN_PARAM:
+			gain_.setTarget(value);
+			break;
+		case FC_PARAM:
+			cutoff_.setTarget(value);
+			break;
+		case Q_PARAM:
+			resonance_.setTarget(value);
+			break;
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void MyVstPlugIn::setParameter(VstInt32 index, float value)
+{
+	// May be called from any thread; the audio thread picks the value up in updateParameters()
+	// and recomputes the coefficients there:
+	switch (index) {
+        case GAIN_PARAM:
+        case FC_PARAM:
+        case Q_PARAM:
+            parameters_.set(index, value);
+            break;
+    }
+	
+}
+
+float MyVstPlugIn::getParameter(VstInt32 index)
+{
+    switch (index) {
+        case GAIN_PARAM:
+        case FC_PARAM:
+        case Q_PARAM:
+            return parameters_.get(index);
+            break;
+        default:
+            return 0.0f; // default
+            break;
+    }
+
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void MyVstPlugIn::getParameterName(VstInt32 index, char *label)
+{    
+    switch (index) {
+        case GAIN_PARAM:
+            vst_strncpy(label, "Gain", kVstMaxParamStrLen);
+            break;
+        case FC_PARAM:
+            vst_strncpy(label, "Cutoff F", kVstMaxParamStrLen);
+            break;
+        case Q_PARAM:
+            vst_strncpy(label, "Q", kVstMaxParamStrLen);
+            break;
+        default:
+            vst_strncpy(label, "", kVstMaxParamStrLen); // default
+            break;
+    }
+    
+}
+
+void MyVstPlugIn::getParameterDisplay(VstInt32 index, char *text)
+{
+    switch (index) {
+        case GAIN_PARAM:
+            dB2string(parameters_.get(GAIN_PARAM), text, kVstMaxParamStrLen);
+            break;
+        case FC_PARAM:
+            float2string(norm2exp(parameters_.get(FC_PARAM), MIN_FREQ, MAX_FREQ), text, kVstMaxParamStrLen);
+            break;
+        case Q_PARAM:
+            float2string(norm2lin(parameters_.get(Q_PARAM), MIN_Q, MAX_Q), text, kVstMaxParamStrLen);
+            break;
+        default:
+            vst_strncpy(text, "", kVstMaxParamStrLen); // invalid index
+            break;
+    }    
+
+}
+
+void MyVstPlugIn::getParameterLabel(VstInt32 index, char *label)
+{
+    switch (index) {
+        case GAIN_PARAM:
+            vst_strncpy(label, "", kVstMaxParamStrLen);
+            break;
+        case FC_PARAM:
+            vst_strncpy(label, "", kVstMaxParamStrLen);
+            break;
+        case Q_PARAM:
+            vst_strncpy(label, "", kVstMaxParamStrLen);
+            break;
+        default:
+            vst_strncpy(label, "", kVstMaxParamStrLen); // invalid index
+            break;
+    }    
+}
+
+// ---------------------------------------------------------------------------------------
+// Program functions:
+// ---------------------------------------------------------------------------------------
+
+void MyVstPlugIn::setProgramName(char *name)
+{
+	vst_strncpy(programName_, name, kVstMaxProgNameLen);
+}
+
+void MyVstPlugIn::getProgramName(char *name)
+{
+	vst_strncpy(name, programName_, kVstMaxProgNameLen);
+}
+
+// ---------------------------------------------------------------------------------------
+// Private functions:
+// ---------------------------------------------------------------------------------------
+
+// Audio thread: coefficients for the current smoothed cutoff and Q, from the table. The
+// filters move to them linearly over the next rampSamples samples (at once if 0).
+void MyVstPlugIn::updateCoeffs(int rampSamples)
+{
+	const BiquadCoeffs<float> coeffs = lowPassTable_.lookup(cutoff_.current(), resonance_.current());
+	for (int f = 0; f < NUM_FILTERS; ++f)
+	{
+		filters_[f].setTarget(coeffs);
+		filters_[f].rampToTarget(rampSamples);
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// Processing functions:
+// ---------------------------------------------------------------------------------------
+
+void MyVstPlugIn::resume()
+{
+	const float sampleRate = getSampleRate();
+//	const int maxBlockSize = getBlockSize();
+
+	profiler_.setup(PROFILE_NAME, sampleRate);
+
+	gain_.setRampTime(GAIN_RAMP_MS, sampleRate);
+	cutoff_.setTimeConstant(FILTER_SMOOTHING_MS, sampleRate);
+	resonance_.setTimeConstant(FILTER_SMOOTHING_MS, sampleRate);
+	lowPassTable_.build(sampleRate, MIN_FREQ, MAX_FREQ, MIN_Q, MAX_Q);
+
+	// Nothing to glide from after a suspend, but the sample rate may have changed:
+	updateParameters();
+	gain_.reset(gain_.target());
+	cutoff_.reset(cutoff_.target());
+	resonance_.reset(resonance_.target());
+	updateCoeffs(0);
+}
+
+void MyVstPlugIn::suspend()
+{
+	// (.. de-initialization stuff goes here ..)
+	// (.. e.g. deallocating memory ..)
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+template <typename Sample>
+void MyVstPlugIn::processBlock(Sample **inputs, Sample **outputs, VstInt32 numSamples)
+{
+	updateParameters();
+	if (gain_.isSmoothing() || cutoff_.isSmoothing() || resonance_.isSmoothing())
+	{
+		profiler_.mark(BlockProfiler::kRamping);
+	}
+
+	// An idle track: the output would be silence, so skip the filters until input returns:
+	if (isSilent(inputs, NUM_CHANNELS, numSamples) && filtersQuiet())
+	{
+		profiler_.mark(BlockProfiler::kSkipped);
+		skipBlock(numSamples);
+		clearChannels(outputs, NUM_CHANNELS, numSamples);
+		return;
+	}
+
+	// Sub-blocks from one scheduled parameter change to the next:
+	events_.process(numSamples,
+		[this](const ScheduledEvent &event) { handleEvent(event); },
+		[&](int start, int length) { processSubBlock(inputs, outputs, start, length); });
+}
+
+template <typename Sample>
+void MyVstPlugIn::processSubBlock(Sample **inputs, Sample **outputs, int start, int numSamples)
+{
+	// While cutoff/Q glide, filter in steps and move the coefficients along every few samples:
+	const Sample *in[NUM_CHANNELS];
+	Sample *out[NUM_CHANNELS];
+	const int end = start + numSamples;
+	for (int j = start; j < end; )
+	{
+		int len = end - j;
+		if (cutoff_.isSmoothing() || resonance_.isSmoothing())
+		{
+			len = len < COEFF_UPDATE_SAMPLES ? len : COEFF_UPDATE_SAMPLES;
+			cutoff_.skip(len);
+			resonance_.skip(len);
+			updateCoeffs(len);
+		}
+		for (int c = 0; c < NUM_CHANNELS; ++c)
+		{
+			in[c] = inputs[c] + j;
+			out[c] = outputs[c] + j;
+		}
+		filterChannels(filters_, in, out, len);
+		j += len;
+	}
+
+	// Every channel follows the same gain ramp:
+	LinearSmoother gain = gain_;
+	for (int c = 0; c < NUM_CHANNELS; ++c)
+	{
+		gain = gain_;
+		applySmoothedGain(gain, outputs[c] + start, outputs[c] + start, numSamples);
+	}
+	gain_ = gain;
+}
+
+template <typename Sample>
+void MyVstPlugIn::filterChannels(BiquadBank<float, FILTER_LANES> *filters, const Sample *const *in, Sample *const *out, int len)
+{
+	for (int b = 0; b < NUM_FILTERS; ++b)
+	{
+		const int first = b*FILTER_LANES;
+		const int channels = NUM_CHANNELS - first < FILTER_LANES ? NUM_CHANNELS - first : FILTER_LANES;
+		filters[b].process(in + first, out + first, channels, len);
+	}
+}
+
+template <typename Sample>
+void MyVstPlugIn::filterChannels(Biquad<float, double> *filters, const Sample *const *in, Sample *const *out, int len)
+{
+	for (int c = 0; c < NUM_CHANNELS; ++c)
+	{
+		filters[c].process(in[c], out[c], len);
+	}
+}
+
+bool MyVstPlugIn::filtersQuiet() const
+{
+	for (int f = 0; f < NUM_FILTERS; ++f)
+	{
+		if (!filters_[f].isQuiet(kSilenceThreshold))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void MyVstPlugIn::skipBlock(int numSamples)
+{
+	// Exact zeros, rather than a residue below the threshold that would decay on later:
+	for (int f = 0; f < NUM_FILTERS; ++f)
+	{
+		filters_[f].reset();
+	}
+
+	// Events and smoothers keep their timing, the coefficients catch up with cutoff and Q:
+	const bool gliding = cutoff_.isSmoothing() || resonance_.isSmoothing();
+	events_.process(numSamples,
+		[this](const ScheduledEvent &event) { handleEvent(event); },
+		[this](int, int length) {
+			gain_.skip(length);
+			cutoff_.skip(length);
+			resonance_.skip(length);
+		});
+	if (gliding || cutoff_.isSmoothing() || resonance_.isSmoothing())
+	{
+		updateCoeffs(0);
+	}
+}
+
+// The filter state decays into subnormal numbers once the input goes silent; flushing them
+// keeps the last blocks before skipBlock() takes over (and loud resonances) at normal cost:
+void MyVstPlugIn::processReplacing(float **inputs, float **outputs, VstInt32 numSamples)
+{
+	BlockProfiler::Scope profile(profiler_, numSamples);
+	ScopedFlushDenormals flushDenormals;
+	processBlock(inputs, outputs, numSamples);
+}
+
+// Hosts with a 64 bit mix bus call this; the filter bank converts while it transposes anyway:
+void MyVstPlugIn::processDoubleReplacing(double **inputs, double **outputs, VstInt32 numSamples)
+{
+	BlockProfiler::Scope profile(profiler_, numSamples, BlockProfiler::kDouble);
+	ScopedFlushDenormals flushDenormals;
+	processBlock(inputs, outputs, numSamples);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Called by the host before processReplacing(), with the events of the next block. Control
+// changes 20, 21 and 22 set gain, cutoff and Q at their deltaFrames (see EventScheduler.hxx):
+VstInt32 MyVstPlugIn::processEvents(VstEvents *events)
+{
+	for (VstInt32 i = 0; i < events->numEvents; ++i)
+	{
+		if (events->events[i]->type != kVstMidiType)
+		{
+			continue;
+		}
+		const VstMidiEvent *midi = (const VstMidiEvent *)events->events[i];
+		events_.pushMidi(midi->deltaFrames, (unsigned char)midi->midiData[0],
+		                 (unsigned char)midi->midiData[1], (unsigned char)midi->midiData[2]);
+	}
+	return 1;
+}
+
+void MyVstPlugIn::handleEvent(const ScheduledEvent &event)
+{
+	// Other MIDI messages are ignored:
+	if (event.isParameter())
+	{
+		parameters_.set(event.parameter, event.value); // for getParameter(); already applied when picked up next block
+		applyParameter(event.parameter, event.value);
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// Capabilities:
+// ---------------------------------------------------------------------------------------
+
+// Samples the output rings on after the input stops, at the current cutoff and Q: the decay
+// of the filter's impulse response to the silence threshold: about 500 samples with the
+// default settings, seconds for a low cutoff at high Q.
+VstInt32 MyVstPlugIn::getGetTailSize()
+{
+	const double freq = norm2exp((double)parameters_.get(FC_PARAM), MIN_FREQ, MAX_FREQ);
+	const double q = norm2lin((double)parameters_.get(Q_PARAM), MIN_Q, MAX_Q);
+	const long tail = BiquadCoeffs<double>::lowPass(freq, q, getSampleRate()).decaySamples(kSilenceThreshold);
+	return tail < 2 ? 2 : (VstInt32)tail; // 1 would mean no tail at all
+}
+
+VstInt32 MyVstPlugIn::canDo(char *text)
+{
+	if (std::strcmp(text, "receiveVstEvents") == 0 || std::strcmp(text, "receiveVstMidiEvent") == 0)
+	{
+		return 1;
+	}
+	return -1; // explicitly can't do; 0 => don't know
+}
+
+// ---------------------------------------------------------------------------------------
+// Instance creator:
+// ---------------------------------------------------------------------------------------
+
+// Method that creates an instance of the VST plug-in:
+AudioEffect *createEffectInstance(audioMasterCallback audioMaster)
+{
+	return new MyVstPlugIn(audioMaster);
+}
+
 // getsamplerate i mirar freq / periode ... mostres cicle i calcular el pas per cada mostra
\ No newline at end of file
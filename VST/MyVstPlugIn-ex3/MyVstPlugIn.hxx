@@ -1,134 +1,132 @@
-#ifndef INCLUDED_MYVSTPLUGIN_HXX
-#define INCLUDED_MYVSTPLUGIN_HXX
-
-#define _CRT_SECURE_NO_WARNINGS
-#include "public.sdk/source/vst2.x/audioeffectx.h"
-#undef _CRT_SECURE_NO_WARNINGS
-
-#define PI 3.14159265358979323f
-
-#define MIN_FREQ 20
-#define MAX_FREQ 10000
-
-#define MIN_Q 0.01
-#define MAX_Q 10
-
-// Class that implements the VST plug-in.
-//
-// Most functions implemented are virtual functions of the AudioEffect(X) baseclass.
-// This is a very minimal example, there are many more functions that can be implemented.
-class MyVstPlugIn : public AudioEffectX
-{
-public:
-	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-	// Constructor/destructor:
-	MyVstPlugIn(audioMasterCallback audioMaster);
-	~MyVstPlugIn();
-
-    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-	// Parameters functions:
-	void initParameters(); // not from AudioEffect(X)
-
-	void setParameter(VstInt32 index, float value);
-	float getParameter(VstInt32 index);
-
-	void getParameterLabel(VstInt32 index, char *label);
-	void getParameterDisplay(VstInt32 index, char *text);
-	void getParameterName(VstInt32 index, char *text);
-
-	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-	// Program functions:
-	void setProgramName(char *name);
-	void getProgramName(char *name);
-
-	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-	// Processing functions:
-	void resume();
-	void suspend();
-	void processReplacing(float **inputs, float **outputs, VstInt32 numSamples);
-    
-    // Private utils
-    void updateCoeffs();
-
-private:
-	// Parameters values:
-	float gain; // 0..1
-    float last_gain;
-	float freq; // 0..1
-	float q; // 0..1
-
-	// Filter coeff
-	double b_[3];
-	double a_[3];
-
-	// Filter states
-	double xN_[3];
-	double yN_[3];
-
-	// Program data:
-	char programName_[kVstMaxProgNameLen + 1];
-};
-
-// ---------------------------------------------------------------------------------------
-// Some helper functions for parameters:
-
-#include <cmath>
-
-// Convert normalized float (0.0f..1.0f) to linear scale (min..max):
-inline float norm2lin(float normalized, float min, float max)
-{
-	return min + (max - min)*normalized;
-}
-
-// Convert linear scale (min..max) to normalized float (0.0f..1.0f):
-inline float lin2norm(float v, float min, float max)
-{
-	return (v - min)/(max - min);
-}
-
-// Convert normalized float (0.0f..1.0f) to exponential scale (min..max):
-inline float norm2exp(float normalized, float min, float max)
-{
-	return min*std::exp(normalized*std::log(max/min));
-}
-
-// Convert exponential scale (min..max) to normalized float (0.0f..1.0f):
-inline float exp2norm(float v, float min, float max)
-{
-	return std::log(v/min)/std::log(max/min);
-}
-
-// Convert normalized float (0.0f..1.0f) to gain factor.
-// Gain is linear on a dB scale, but below some threshold tapers off linearly (on a linear scale) to 0.0f (-inf dB).
-// with minDecibels = -36, maxDecibels = 12, norm = 0.75 -> 0 dB
-float norm2gainFactor(float normalized, float minDecibels = -36.0f, float maxDecibels = +12.0f, float th = 0.2f)
-{
-	float gainFactor;
-	if (normalized >= th)
-	{
-		float gainDecibels = norm2lin(normalized, minDecibels, maxDecibels); // linear on dB scale
-		gainFactor = std::pow(10.0f, gainDecibels/20.0f);
-	}
-	else
-	{
-		float dbAtTh = norm2lin(th, minDecibels, maxDecibels);
-		float linAtTh = pow(10.0f, dbAtTh/20.0f); // less than 0.05 (with default parameters), so already quite small
-		gainFactor = linAtTh*normalized/th; // scale so gainFactor is continuous
-	}
-	return gainFactor;
-}
-
-// Convert normalized float (0.0f..1.0f) to index (0..n-1):
-inline int norm2switch(float normalized, int numCases)
-{
-	return (int)std::floor(normalized*(numCases-1) + 0.5f); // round (for positive values only!)
-}
-
-// Convert index (0..n-1) to normalized float (0.0f..1.0f):
-inline float switch2norm(int idx, int numCases)
-{
-	return (float)(idx)/(float)(numCases-1);
-}
-
-
-#endif
+#ifndef INCLUDED_MYVSTPLUGIN_HXX
+#define INCLUDED_MYVSTPLUGIN_HXX
+
+#define _CRT_SECURE_NO_WARNINGS
+#include "public.sdk/source/vst2.x/audioeffectx.h"
+#undef _CRT_SECURE_NO_WARNINGS
+
+#include "DspCore/Biquad.hxx"
+#include "DspCore/BiquadBank.hxx"
+#include "DspCore/BlockProfiler.hxx"
+#include "DspCore/Denormals.hxx"
+#include "DspCore/EventScheduler.hxx"
+#include "DspCore/LowPassTable.hxx"
+#include "DspCore/ParameterMapping.hxx"
+#include "DspCore/ParameterState.hxx"
+#include "DspCore/Silence.hxx"
+#include "DspCore/Smoother.hxx"
+
+#include <type_traits>
+
+// Number of channels, all filtered by the same low-pass. 1 by default; build with e.g.
+// -DMYVSTPLUGIN_EX3_CHANNELS=32 (CMake option of the same name) for multichannel stems.
+#ifndef MYVSTPLUGIN_EX3_CHANNELS
+#define MYVSTPLUGIN_EX3_CHANNELS 1
+#endif
+
+#define MIN_FREQ 20
+#define MAX_FREQ 10000
+
+#define MIN_Q 0.01
+#define MAX_Q 10
+
+// Class that implements the VST plug-in.
+//
+// Most functions implemented are virtual functions of the AudioEffect(X) baseclass.
+// This is a very minimal example, there are many more functions that can be implemented.
+class MyVstPlugIn : public AudioEffectX
+{
+public:
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Constructor/destructor:
+	MyVstPlugIn(audioMasterCallback audioMaster);
+	~MyVstPlugIn();
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Parameters functions:
+	void initParameters(); // not from AudioEffect(X)
+
+	void setParameter(VstInt32 index, float value);
+	float getParameter(VstInt32 index);
+
+	void getParameterLabel(VstInt32 index, char *label);
+	void getParameterDisplay(VstInt32 index, char *text);
+	void getParameterName(VstInt32 index, char *text);
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Program functions:
+	void setProgramName(char *name);
+	void getProgramName(char *name);
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Processing functions:
+	void resume();
+	void suspend();
+	void processReplacing(float **inputs, float **outputs, VstInt32 numSamples);
+	void processDoubleReplacing(double **inputs, double **outputs, VstInt32 numSamples);
+	VstInt32 processEvents(VstEvents *events);
+	VstInt32 getGetTailSize();
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Capabilities:
+	VstInt32 canDo(char *text);
+    
+    // Private utils
+    void updateCoeffs(int rampSamples);
+
+private:
+	void updateParameters(); // audio thread
+	void applyParameter(int index, float value); // audio thread
+	void handleEvent(const ScheduledEvent &event); // audio thread
+
+	// Body of processReplacing() and processDoubleReplacing(), Sample = float or double:
+	template <typename Sample>
+	void processBlock(Sample **inputs, Sample **outputs, VstInt32 numSamples);
+	// Samples start..start + numSamples - 1 of the block, up to the next scheduled event:
+	template <typename Sample>
+	void processSubBlock(Sample **inputs, Sample **outputs, int start, int numSamples);
+	// Silent input into filters that have rung out: only the parameters move on:
+	bool filtersQuiet() const;
+	void skipBlock(int numSamples);
+
+	enum
+	{
+		NUM_CHANNELS = MYVSTPLUGIN_EX3_CHANNELS,
+		// 4 channels or more: banks of FILTER_LANES channels, one SSE, AVX or AVX-512 register
+		// of floats. Mono and stereo would not fill a register, so they keep one scalar biquad
+		// per channel with a double recursion (stable at low cutoffs at 96 kHz):
+		USE_FILTER_BANKS = NUM_CHANNELS >= 4,
+		FILTER_LANES = NUM_CHANNELS >= 16 ? 16 : (NUM_CHANNELS >= 8 ? 8 : 4),
+		NUM_FILTERS = USE_FILTER_BANKS ? (NUM_CHANNELS + FILTER_LANES - 1)/FILTER_LANES : NUM_CHANNELS
+	};
+	typedef std::conditional<USE_FILTER_BANKS, BiquadBank<float, FILTER_LANES>, Biquad<float, double> >::type Filter;
+
+	// Filters channel c of in into out (c = 0..NUM_CHANNELS-1), len samples:
+	template <typename Sample>
+	static void filterChannels(BiquadBank<float, FILTER_LANES> *filters, const Sample *const *in, Sample *const *out, int len);
+	template <typename Sample>
+	static void filterChannels(Biquad<float, double> *filters, const Sample *const *in, Sample *const *out, int len);
+
+	// Parameters values (normalized, 0..1), shared between host and audio thread:
+	ParameterState parameters_;
+
+	// Smoothed parameters, audio thread only:
+	LinearSmoother gain_;
+	OnePoleSmoother cutoff_;    // normalized
+	OnePoleSmoother resonance_; // normalized
+	LowPassTable lowPassTable_; // built in resume() for the current sample rate
+
+	// Low-pass filters, FILTER_LANES channels per bank or one per channel:
+	Filter filters_[NUM_FILTERS];
+
+	// Parameter changes (MIDI control changes) of the next block, preallocated:
+	EventScheduler<512> events_;
+
+	// Cost of every process call (see BlockProfiler.hxx):
+	BlockProfiler profiler_;
+
+	// Program data:
+	char programName_[kVstMaxProgNameLen + 1];
+};
+
+#endif
@@ -1,221 +1,461 @@
-#include "MyVstPlugin.hxx"
-
-#include <cmath>
-
-// ---------------------------------------------------------------------------------------
-// Constructor / destructor:
-// ---------------------------------------------------------------------------------------
-
-// Define parameter indexes:
-enum
-{
-	GAIN,
-    FREQUENCY,
-    BRIGHTNESS,
-	// (.. define other parameters here ..)
-	NUM_PARAMETERS
-};
-
-// Number of programs (presets):
-const int NUM_PROGRAMS = 1; // only current program (NUM_PROGRAMS = 0 causes problems with some hosts)
-
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-MyVstPlugIn::MyVstPlugIn(audioMasterCallback audioMaster) : AudioEffectX(audioMaster, NUM_PROGRAMS, NUM_PARAMETERS)
-{
-	// Set some basic properties of plug-in:
-	setNumInputs(1);			// mono in
-	setNumOutputs(1);			// mono out
-	setUniqueID('MVPI');		// unique 4 char identifier for this plug-in (here "My Vst Plug-In")
-	isSynth(false);				// this plug-in is an audio effect, not a synthesizer
-	canProcessReplacing(true);	// supports 'replacing output processing mode' (legacy stuff, always set to true)
-	canDoubleReplacing(false);	// does not support 64 bit floating point I/O
-	programsAreChunks(false);	// programs work through setParameter()/getParameter() rather than binary 'chunks'
-
-	vst_strncpy(programName_, "default", kVstMaxProgNameLen);
-
-	initParameters();
-
-	// (.. do not do much else here, so scanning for plug-ins is fast ..)
-	// (.. do memory allocation/deallocation in resume()/suspend() instead, but normally pointers should be initialized to NULL here ..)
-}
-
-MyVstPlugIn::~MyVstPlugIn()
-{
-	// (.. nothing to do here ..)
-}
-
-// ---------------------------------------------------------------------------------------
-// Parameter functions:
-// ---------------------------------------------------------------------------------------
-
-void MyVstPlugIn::initParameters()
-{
-    gain = 0.0f;
-    frequency = 0.0f;
-    brightness = 0.0f;
-	setParameter(GAIN, 0.7f); 
-	setParameter(FREQUENCY, 0.1f); 
-    setParameter(BRIGHTNESS, 0.0f);
-    phase = 0.0f;
-	// (.. add more parameters here ..)
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-void MyVstPlugIn::setParameter(VstInt32 index, float value)
-{
-	switch (index) {
-        case GAIN:
-            last_gain = gain;
-            gain = value;
-            break;
-        case FREQUENCY:
-            last_freq = frequency;
-            frequency = norm2exp(value,MIN_FREQ,MAX_FREQ);
-            break;
-        case BRIGHTNESS:
-            last_bright = brightness;
-            brightness = value;
-            break;
-    }
-}
-
-float MyVstPlugIn::getParameter(VstInt32 index)
-{
-    switch (index) {
-        case GAIN:
-            return gain;
-            break;
-        case FREQUENCY:
-            return exp2norm(frequency, MIN_FREQ, MAX_FREQ);
-            break;
-        case BRIGHTNESS:
-            return brightness;
-            break;
-        default:
-            return 0.0f; // invalid index
-            break;
-    }
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-void MyVstPlugIn::getParameterName(VstInt32 index, char *label)
-{
-    switch (index) {
-        case GAIN:
-            vst_strncpy(label, "Gain", kVstMaxParamStrLen);
-            break;
-        case FREQUENCY:
-            vst_strncpy(label, "Freq", kVstMaxParamStrLen);
-            break;
-        case BRIGHTNESS:
-            vst_strncpy(label, "Timbre", kVstMaxParamStrLen);
-            break;
-        default:
-            vst_strncpy(label, "", kVstMaxParamStrLen); // invalid index
-            break;
-    }
-}
-
-void MyVstPlugIn::getParameterDisplay(VstInt32 index, char *text)
-{
-    switch (index) {
-        case GAIN:
-            dB2string(gain, text, kVstMaxParamStrLen);
-            break;
-        case FREQUENCY:
-            float2string(frequency, text, kVstMaxParamStrLen);
-            break;
-        case BRIGHTNESS:
-            float2string(brightness, text, kVstMaxParamStrLen);
-            break;
-        default:
-            vst_strncpy(text, "", kVstMaxParamStrLen); // invalid index
-            break;
-    }
-}
-
-void MyVstPlugIn::getParameterLabel(VstInt32 index, char *label)
-{
-    switch (index) {
-        case GAIN:
-            vst_strncpy(label, "", kVstMaxParamStrLen);
-            break;
-        case FREQUENCY:
-            vst_strncpy(label, "", kVstMaxParamStrLen);
-            break;
-        case BRIGHTNESS:
-            vst_strncpy(label, "", kVstMaxParamStrLen);
-            break;
-        default:
-            vst_strncpy(label, "", kVstMaxParamStrLen); // invalid index
-            break;
-    }
-}
-
-// ---------------------------------------------------------------------------------------
-// Program functions:
-// ---------------------------------------------------------------------------------------
-
-void MyVstPlugIn::setProgramName(char *name)
-{
-	vst_strncpy(programName_, name, kVstMaxProgNameLen);
-}
-
-void MyVstPlugIn::getProgramName(char *name)
-{
-	vst_strncpy(name, programName_, kVstMaxProgNameLen);
-}
-
-// ---------------------------------------------------------------------------------------
-// Processing functions:
-// ---------------------------------------------------------------------------------------
-
-void MyVstPlugIn::resume()
-{
-//	const double sampleRate = getSampleRate();
-//	const int maxBlockSize = getBlockSize();
-
-	// (.. initialization stuff goes here ..)
-	// (.. e.g. allocating memory ..)
-}
-
-void MyVstPlugIn::suspend()
-{
-	// (.. de-initialization stuff goes here ..)
-	// (.. e.g. deallocating memory ..)
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-void MyVstPlugIn::processReplacing(float **inputs, float **outputs, VstInt32 numSamples)
-{
-    float *out = outputs[0];
-    for (int j = 0; j < numSamples; ++j)
-    {
-        float g = last_gain + (gain - last_gain) * (j/(float)numSamples);
-        float f = last_freq + (frequency - last_freq) * (j/(float)numSamples);
-        float b = last_bright + (brightness - last_bright) * (j/(float)numSamples);
-        phase += (2.0f * PI * f / (float)getSampleRate());
-        if (phase > 2.0f*PI) phase -= 2.0f*PI;
-        out[j] = g * MIN(MAX(sin(phase) * pow((1-b),-2),-1),1);
-    }
-    last_gain = gain;
-    last_freq = frequency;
-    last_bright = brightness;
-}
-
-// ---------------------------------------------------------------------------------------
-// Instance creator:
-// ---------------------------------------------------------------------------------------
-
-// Method that creates an instance of the VST plug-in:
-AudioEffect *createEffectInstance(audioMasterCallback audioMaster)
-{
-	return new MyVstPlugIn(audioMaster);
-}
-
+#include "MyVstPlugIn.hxx"
+
+#include "DspCore/GainRamp.hxx"
+
+#include <cstring>
+
+// ---------------------------------------------------------------------------------------
+// Constructor / destructor:
+// ---------------------------------------------------------------------------------------
+
+// Define parameter indexes:
+enum
+{
+	GAIN,
+    FREQUENCY,
+    BRIGHTNESS,
+	DRIVE,
+	// (.. define other parameters here ..)
+	NUM_PARAMETERS
+};
+
+// Name of the instances in the profiles (see BlockProfiler.hxx):
+const char *const PROFILE_NAME = "MyVstPlugIn-ex4";
+
+// Number of programs (presets):
+const int NUM_PROGRAMS = 1; // only current program (NUM_PROGRAMS = 0 causes problems with some hosts)
+
+// Parameter smoothing times:
+const float RAMP_MS = 20.0f;            // gain, brightness and drive
+const float GLIDE_MS = 10.0f;           // time constant of the frequency glide
+
+// Voice envelope:
+const float ATTACK_MS = 5.0f;
+const float RELEASE_MS = 60.0f;
+
+// While tuning or brightness move, the voices read them every OSC_UPDATE_SAMPLES samples
+// (the table crossfade is ramped linearly in between):
+const int OSC_UPDATE_SAMPLES = 32;
+
+// The summed voices go through the clipper of the original single voice,
+// MIN(MAX(x*(1 - d)^-2, -1), 1), d = DRIVE_RANGE*drive: 0..40 dB of drive, and at 0 a
+// limiter at full scale. Oversampled, so the harmonics and intermodulation of chords do not
+// fold back (see Oversampler.hxx):
+const float DRIVE_RANGE = 0.9f;
+const int OVERSAMPLING = MYVSTPLUGIN_EX4_OVERSAMPLING;
+
+static float driveGain(float drive)
+{
+	const float d = 1.0f - DRIVE_RANGE*drive;
+	return 1.0f/(d*d);
+}
+
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+MyVstPlugIn::MyVstPlugIn(audioMasterCallback audioMaster)
+	: AudioEffectX(audioMaster, NUM_PROGRAMS, NUM_PARAMETERS), wavetables_(NULL), events_(NUM_PARAMETERS)
+{
+	// Set some basic properties of plug-in:
+	setNumInputs(0);			// no audio in
+	setNumOutputs(1);			// mono out
+	setUniqueID('MVPI');		// unique 4 char identifier for this plug-in (here "My Vst Plug-In")
+	isSynth(true);				// this plug-in is a synthesizer, played through MIDI
+	canProcessReplacing(true);	// supports 'replacing output processing mode' (legacy stuff, always set to true)
+	canDoubleReplacing(true);	// supports 64 bit floating point I/O (processDoubleReplacing())
+	programsAreChunks(false);	// programs work through setParameter()/getParameter() rather than binary 'chunks'
+
+	// A few hundred floats of filter state; the delay is known once the factor is:
+	oversampler_.setup(OVERSAMPLING);
+	setInitialDelay((VstInt32)(oversampler_.latency() + 0.5));
+
+	vst_strncpy(programName_, "default", kVstMaxProgNameLen);
+
+	initParameters();
+
+	// (.. do not do much else here, so scanning for plug-ins is fast ..)
+	// (.. do memory allocation/deallocation in resume()/suspend() instead, but normally pointers should be initialized to NULL here ..)
+}
+
+MyVstPlugIn::~MyVstPlugIn()
+{
+	// (.. nothing to do here ..)
+}
+
+// ---------------------------------------------------------------------------------------
+// Parameter functions:
+// ---------------------------------------------------------------------------------------
+
+void MyVstPlugIn::initParameters()
+{
+	setParameter(GAIN, 0.7f); 
+	setParameter(FREQUENCY, exp2norm(440.0f, MIN_FREQ, MAX_FREQ)); // A4 = 440 Hz
+    setParameter(BRIGHTNESS, 0.0f);
+	setParameter(DRIVE, 0.0f);
+	// (.. add more parameters here ..)
+
+	// Start at the defaults rather than ramping to them:
+	parameters_.takeChanges();
+	gain_.reset(parameters_.get(GAIN));
+	frequency_.reset(norm2exp(parameters_.get(FREQUENCY), MIN_FREQ, MAX_FREQ));
+	brightness_.reset(parameters_.get(BRIGHTNESS));
+	drive_.reset(driveGain(parameters_.get(DRIVE)));
+}
+
+// Called on the audio thread at the start of every block:
+void MyVstPlugIn::updateParameters()
+{
+	const uint32_t changes = parameters_.takeChanges();
+	for (int i = 0; i < NUM_PARAMETERS; ++i)
+	{
+		if (ParameterState::hasChanged(changes, i))
+		{
+			applyParameter(i, parameters_.get(i));
+		}
+	}
+}
+
+// Sets the smoother of a parameter, at the start of a block or at a scheduled event:
+void MyVstPlugIn::applyParameter(int index, float value)
+{
+	switch (index)
+	{
+		case GAIN:
+			gain_.setTarget(value);
+			break;
+		case FREQUENCY:
+			frequency_.setTarget(norm2exp(value, MIN_FREQ, MAX_FREQ));
+			break;
+		case BRIGHTNESS:
+			brightness_.setTarget(value);
+			break;
+		case DRIVE:
+			drive_.setTarget(driveGain(value));
+			break;
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void MyVstPlugIn::setParameter(VstInt32 index, float value)
+{
+	// May be called from any thread; the audio thread picks the value up in updateParameters():
+	switch (index) {
+        case GAIN:
+        case FREQUENCY:
+        case BRIGHTNESS:
+        case DRIVE:
+            parameters_.set(index, value);
+            break;
+    }
+}
+
+float MyVstPlugIn::getParameter(VstInt32 index)
+{
+    switch (index) {
+        case GAIN:
+        case FREQUENCY:
+        case BRIGHTNESS:
+        case DRIVE:
+            return parameters_.get(index);
+            break;
+        default:
+            return 0.0f; // invalid index
+            break;
+    }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void MyVstPlugIn::getParameterName(VstInt32 index, char *label)
+{
+    switch (index) {
+        case GAIN:
+            vst_strncpy(label, "Gain", kVstMaxParamStrLen);
+            break;
+        case FREQUENCY:
+            vst_strncpy(label, "A4 Freq", kVstMaxParamStrLen);
+            break;
+        case BRIGHTNESS:
+            vst_strncpy(label, "Timbre", kVstMaxParamStrLen);
+            break;
+        case DRIVE:
+            vst_strncpy(label, "Drive", kVstMaxParamStrLen);
+            break;
+        default:
+            vst_strncpy(label, "", kVstMaxParamStrLen); // invalid index
+            break;
+    }
+}
+
+void MyVstPlugIn::getParameterDisplay(VstInt32 index, char *text)
+{
+    switch (index) {
+        case GAIN:
+            dB2string(parameters_.get(GAIN), text, kVstMaxParamStrLen);
+            break;
+        case FREQUENCY:
+            float2string(norm2exp(parameters_.get(FREQUENCY), MIN_FREQ, MAX_FREQ), text, kVstMaxParamStrLen);
+            break;
+        case BRIGHTNESS:
+            float2string(parameters_.get(BRIGHTNESS), text, kVstMaxParamStrLen);
+            break;
+        case DRIVE:
+            dB2string(driveGain(parameters_.get(DRIVE)), text, kVstMaxParamStrLen);
+            break;
+        default:
+            vst_strncpy(text, "", kVstMaxParamStrLen); // invalid index
+            break;
+    }
+}
+
+void MyVstPlugIn::getParameterLabel(VstInt32 index, char *label)
+{
+    switch (index) {
+        case GAIN:
+            vst_strncpy(label, "", kVstMaxParamStrLen);
+            break;
+        case FREQUENCY:
+            vst_strncpy(label, "", kVstMaxParamStrLen);
+            break;
+        case BRIGHTNESS:
+            vst_strncpy(label, "", kVstMaxParamStrLen);
+            break;
+        case DRIVE:
+            vst_strncpy(label, "dB", kVstMaxParamStrLen);
+            break;
+        default:
+            vst_strncpy(label, "", kVstMaxParamStrLen); // invalid index
+            break;
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// Program functions:
+// ---------------------------------------------------------------------------------------
+
+void MyVstPlugIn::setProgramName(char *name)
+{
+	vst_strncpy(programName_, name, kVstMaxProgNameLen);
+}
+
+void MyVstPlugIn::getProgramName(char *name)
+{
+	vst_strncpy(name, programName_, kVstMaxProgNameLen);
+}
+
+// ---------------------------------------------------------------------------------------
+// Processing functions:
+// ---------------------------------------------------------------------------------------
+
+void MyVstPlugIn::resume()
+{
+	const float sampleRate = getSampleRate();
+//	const int maxBlockSize = getBlockSize();
+
+	profiler_.setup(PROFILE_NAME, sampleRate);
+
+	gain_.setRampTime(RAMP_MS, sampleRate);
+	frequency_.setTimeConstant(GLIDE_MS, sampleRate);
+	frequency_.setThreshold(0.01f); // Hz
+	brightness_.setRampTime(RAMP_MS, sampleRate);
+	drive_.setRampTime(RAMP_MS, sampleRate*oversampler_.factor());
+	oversampler_.reset();
+	silenceGate_.setTail((int)(2.0*oversampler_.latency()) + 2); // impulse response of up + down
+	silenceGate_.reset();
+	synth_.setSampleRate(sampleRate, ATTACK_MS, RELEASE_MS);
+
+	// Built by the first instance to get here, not on the audio thread:
+	wavetables_ = &clippedSineWavetables();
+
+	// Nothing to ramp from after a suspend:
+	updateParameters();
+	gain_.reset(gain_.target());
+	frequency_.reset(frequency_.target());
+	brightness_.reset(brightness_.target());
+	drive_.reset(drive_.target());
+	synth_.setTuning(frequency_.current());
+}
+
+void MyVstPlugIn::suspend()
+{
+	synth_.allSoundOff();
+	events_.clear();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+template <typename Sample>
+void MyVstPlugIn::processBlock(Sample **inputs, Sample **outputs, VstInt32 numSamples)
+{
+	Sample *out = outputs[0];
+	updateParameters();
+	if (gain_.isSmoothing() || frequency_.isSmoothing() || brightness_.isSmoothing() || drive_.isSmoothing())
+	{
+		profiler_.mark(BlockProfiler::kRamping);
+	}
+
+	for (int j = 0; j < numSamples; ++j)
+	{
+		out[j] = Sample(0);
+	}
+
+	// No voice sounding and no MIDI that could start one: once the oversampler has rung out,
+	// the block is silence:
+	if (!silenceGate_.next(synth_.numActiveVoices() == 0 && events_.empty(), numSamples))
+	{
+		profiler_.mark(BlockProfiler::kSkipped);
+		skipBlock(numSamples);
+		return;
+	}
+
+	// Render from event to event, so every MIDI message and parameter change takes effect at
+	// its deltaFrames:
+	events_.process(numSamples,
+		[this](const ScheduledEvent &event) { handleEvent(event); },
+		[&](int start, int length) { renderSubBlock(out + start, length); });
+}
+
+template <typename Sample>
+void MyVstPlugIn::renderSubBlock(Sample *out, int numSamples)
+{
+	for (int j = 0; j < numSamples; )
+	{
+		int end = numSamples;
+		if (frequency_.isSmoothing() || brightness_.isSmoothing())
+		{
+			end = end < j + OSC_UPDATE_SAMPLES ? end : j + OSC_UPDATE_SAMPLES;
+		}
+		const int len = end - j;
+
+		int table;
+		float startMix;
+		ClippedSineWavetables::position(brightness_.current(), table, startMix);
+
+		frequency_.skip(len);
+		brightness_.skip(len);
+		synth_.setTuning(frequency_.current());
+
+		// The crossfade stays between the two tables of the sub-block start; a faster sweep
+		// catches up in the next sub-block:
+		int endTable;
+		float endMix;
+		ClippedSineWavetables::position(brightness_.current(), endTable, endMix);
+		endMix = endTable > table ? 1.0f : (endTable < table ? 0.0f : endMix);
+
+		synth_.render(wavetables_->table(table), wavetables_->table(table + 1), out + j, len, startMix, endMix);
+		j = end;
+	}
+
+	oversampler_.process(out, numSamples, [this](float *x, int n) { clipOversampled(x, n); });
+	applySmoothedGain(gain_, out, out, numSamples);
+}
+
+void MyVstPlugIn::clipOversampled(float *x, int numSamples)
+{
+	for (int j = 0; j < numSamples; ++j)
+	{
+		const float y = x[j]*drive_.next();
+		x[j] = y < -1.0f ? -1.0f : (y > 1.0f ? 1.0f : y);
+	}
+}
+
+void MyVstPlugIn::skipBlock(int numSamples)
+{
+	gain_.skip(numSamples);
+	frequency_.skip(numSamples);
+	brightness_.skip(numSamples);
+	drive_.skip(numSamples*oversampler_.factor());
+	synth_.setTuning(frequency_.current());
+}
+
+// Nothing here is recursive, but like the effects the synth runs with subnormals flushed, in
+// case the host hands it a thread with a different setting (see Denormals.hxx):
+void MyVstPlugIn::processReplacing(float **inputs, float **outputs, VstInt32 numSamples)
+{
+	BlockProfiler::Scope profile(profiler_, numSamples);
+	ScopedFlushDenormals flushDenormals;
+	processBlock(inputs, outputs, numSamples);
+}
+
+// Hosts with a 64 bit mix bus call this; the voices are summed into the double output, the
+// oversampled clipper converts to float and back:
+void MyVstPlugIn::processDoubleReplacing(double **inputs, double **outputs, VstInt32 numSamples)
+{
+	BlockProfiler::Scope profile(profiler_, numSamples, BlockProfiler::kDouble);
+	ScopedFlushDenormals flushDenormals;
+	processBlock(inputs, outputs, numSamples);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Called by the host before processReplacing(), with the events of the next block. Control
+// changes 20 to 23 set gain, tuning, timbre and drive at their deltaFrames (see EventScheduler.hxx):
+VstInt32 MyVstPlugIn::processEvents(VstEvents *events)
+{
+	for (VstInt32 i = 0; i < events->numEvents; ++i)
+	{
+		if (events->events[i]->type != kVstMidiType)
+		{
+			continue;
+		}
+		const VstMidiEvent *midi = (const VstMidiEvent *)events->events[i];
+		events_.pushMidi(midi->deltaFrames, (unsigned char)midi->midiData[0],
+		                 (unsigned char)midi->midiData[1], (unsigned char)midi->midiData[2]);
+	}
+	return 1;
+}
+
+void MyVstPlugIn::handleEvent(const ScheduledEvent &event)
+{
+	if (event.isParameter())
+	{
+		parameters_.set(event.parameter, event.value); // for getParameter(); re-applying it next block changes nothing
+		applyParameter(event.parameter, event.value);
+		return;
+	}
+	switch (event.status & 0xF0)
+	{
+		case 0x90: // note on (velocity 0 means note off)
+			synth_.noteOn(event.data1, event.data2);
+			break;
+		case 0x80: // note off
+			synth_.noteOff(event.data1);
+			break;
+		case 0xB0: // control change
+			if (event.data1 == 120)
+			{
+				synth_.allSoundOff();
+			}
+			else if (event.data1 == 123)
+			{
+				synth_.allNotesOff();
+			}
+			break;
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// Capabilities:
+// ---------------------------------------------------------------------------------------
+
+VstInt32 MyVstPlugIn::canDo(char *text)
+{
+	if (std::strcmp(text, "receiveVstEvents") == 0 || std::strcmp(text, "receiveVstMidiEvent") == 0)
+	{
+		return 1;
+	}
+	return -1; // explicitly can't do; 0 => don't know
+}
+
+// ---------------------------------------------------------------------------------------
+// Instance creator:
+// ---------------------------------------------------------------------------------------
+
+// Method that creates an instance of the VST plug-in:
+AudioEffect *createEffectInstance(audioMasterCallback audioMaster)
+{
+	return new MyVstPlugIn(audioMaster);
+}
+
 // getsamplerate i mirar freq / periode ... mostres cicle i calcular el pas per cada mostra
\ No newline at end of file
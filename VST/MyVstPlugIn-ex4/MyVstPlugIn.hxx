@@ -1,126 +1,104 @@
-#ifndef INCLUDED_MYVSTPLUGIN_HXX
-#define INCLUDED_MYVSTPLUGIN_HXX
-
-#define _CRT_SECURE_NO_WARNINGS
-#include "public.sdk/source/vst2.x/audioeffectx.h"
-#undef _CRT_SECURE_NO_WARNINGS
-
-#define PI 3.14159265359f
-#define MAX_FREQ 5000.0f
-#define MIN_FREQ 50.0f
-
-#define MAX(a,b) ((a)>(b)?(a):(b))
-#define MIN(a,b) ((a)<(b)?(a):(b))
-
-// Class that implements the VST plug-in.
-//
-// Most functions implemented are virtual functions of the AudioEffect(X) baseclass.
-// This is a very minimal example, there are many more functions that can be implemented.
-class MyVstPlugIn : public AudioEffectX
-{
-public:
-	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-	// Constructor/destructor:
-	MyVstPlugIn(audioMasterCallback audioMaster);
-	~MyVstPlugIn();
-
-    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-	// Parameters functions:
-	void initParameters(); // not from AudioEffect(X)
-
-	void setParameter(VstInt32 index, float value);
-	float getParameter(VstInt32 index);
-
-	void getParameterLabel(VstInt32 index, char *label);
-	void getParameterDisplay(VstInt32 index, char *text);
-	void getParameterName(VstInt32 index, char *text);
-
-	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-	// Program functions:
-	void setProgramName(char *name);
-	void getProgramName(char *name);
-
-	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-	// Processing functions:
-	void resume();
-	void suspend();
-	void processReplacing(float **inputs, float **outputs, VstInt32 numSamples);
-
-private:
-	// Parameters values:
-	float gain;
-    float last_gain;
-    float frequency;
-    float last_freq;
-    float brightness;
-    float last_bright;
-    float phase; // it's a buffer, not a parameter!
-
-
-	// Program data:
-	char programName_[kVstMaxProgNameLen + 1];
-};
-
-// ---------------------------------------------------------------------------------------
-// Some helper functions for parameters:
-
-#include <cmath>
-
-// Convert normalized float (0.0f..1.0f) to linear scale (min..max):
-inline float norm2lin(float normalized, float min, float max)
-{
-	return min + (max - min)*normalized;
-}
-
-// Convert linear scale (min..max) to normalized float (0.0f..1.0f):
-inline float lin2norm(float v, float min, float max)
-{
-	return (v - min)/(max - min);
-}
-
-// Convert normalized float (0.0f..1.0f) to exponential scale (min..max):
-inline float norm2exp(float normalized, float min, float max)
-{
-	return min*std::exp(normalized*std::log(max/min));
-}
-
-// Convert exponential scale (min..max) to normalized float (0.0f..1.0f):
-inline float exp2norm(float v, float min, float max)
-{
-	return std::log(v/min)/std::log(max/min);
-}
-
-// Convert normalized float (0.0f..1.0f) to gain factor.
-// Gain is linear on a dB scale, but below some threshold tapers off linearly (on a linear scale) to 0.0f (-inf dB).
-// with minDecibels = -36, maxDecibels = 12, norm = 0.75 -> 0 dB
-float norm2gainFactor(float normalized, float minDecibels = -36.0f, float maxDecibels = +12.0f, float th = 0.2f)
-{
-	float gainFactor;
-	if (normalized >= th)
-	{
-		float gainDecibels = norm2lin(normalized, minDecibels, maxDecibels); // linear on dB scale
-		gainFactor = std::pow(10.0f, gainDecibels/20.0f);
-	}
-	else
-	{
-		float dbAtTh = norm2lin(th, minDecibels, maxDecibels);
-		float linAtTh = pow(10.0f, dbAtTh/20.0f); // less than 0.05 (with default parameters), so already quite small
-		gainFactor = linAtTh*normalized/th; // scale so gainFactor is continuous
-	}
-	return gainFactor;
-}
-
-// Convert normalized float (0.0f..1.0f) to index (0..n-1):
-inline int norm2switch(float normalized, int numCases)
-{
-	return (int)std::floor(normalized*(numCases-1) + 0.5f); // round (for positive values only!)
-}
-
-// Convert index (0..n-1) to normalized float (0.0f..1.0f):
-inline float switch2norm(int idx, int numCases)
-{
-	return (float)(idx)/(float)(numCases-1);
-}
-
-
-#endif
+#ifndef INCLUDED_MYVSTPLUGIN_HXX
+#define INCLUDED_MYVSTPLUGIN_HXX
+
+#define _CRT_SECURE_NO_WARNINGS
+#include "public.sdk/source/vst2.x/audioeffectx.h"
+#undef _CRT_SECURE_NO_WARNINGS
+
+#include "DspCore/BlockProfiler.hxx"
+#include "DspCore/Denormals.hxx"
+#include "DspCore/EventScheduler.hxx"
+#include "DspCore/Oversampler.hxx"
+#include "DspCore/ParameterMapping.hxx"
+#include "DspCore/ParameterState.hxx"
+#include "DspCore/Silence.hxx"
+#include "DspCore/Smoother.hxx"
+#include "DspCore/WavetableSynth.hxx"
+
+#define MAX_FREQ 5000.0f
+#define MIN_FREQ 50.0f
+
+// Oversampling factor of the drive clipper (1, 2, 4 or 8), CMake option of the same name:
+#ifndef MYVSTPLUGIN_EX4_OVERSAMPLING
+#define MYVSTPLUGIN_EX4_OVERSAMPLING 4
+#endif
+
+// Class that implements the VST plug-in.
+//
+// Most functions implemented are virtual functions of the AudioEffect(X) baseclass.
+// This is a very minimal example, there are many more functions that can be implemented.
+class MyVstPlugIn : public AudioEffectX
+{
+public:
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Constructor/destructor:
+	MyVstPlugIn(audioMasterCallback audioMaster);
+	~MyVstPlugIn();
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Parameters functions:
+	void initParameters(); // not from AudioEffect(X)
+
+	void setParameter(VstInt32 index, float value);
+	float getParameter(VstInt32 index);
+
+	void getParameterLabel(VstInt32 index, char *label);
+	void getParameterDisplay(VstInt32 index, char *text);
+	void getParameterName(VstInt32 index, char *text);
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Program functions:
+	void setProgramName(char *name);
+	void getProgramName(char *name);
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Processing functions:
+	void resume();
+	void suspend();
+	void processReplacing(float **inputs, float **outputs, VstInt32 numSamples);
+	void processDoubleReplacing(double **inputs, double **outputs, VstInt32 numSamples);
+	VstInt32 processEvents(VstEvents *events);
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Capabilities:
+	VstInt32 canDo(char *text);
+
+private:
+	void updateParameters(); // audio thread
+	void applyParameter(int index, float value); // audio thread
+
+	// Body of processReplacing() and processDoubleReplacing(), Sample = float or double:
+	template <typename Sample>
+	void processBlock(Sample **inputs, Sample **outputs, VstInt32 numSamples);
+	template <typename Sample>
+	void renderSubBlock(Sample *out, int numSamples);
+	void clipOversampled(float *x, int numSamples); // the drive clipper, at the oversampled rate
+	void skipBlock(int numSamples); // no voice and the oversampler rung out: only the smoothers move on
+	void handleEvent(const ScheduledEvent &event); // audio thread
+
+	// Parameters values (normalized, 0..1), shared between host and audio thread:
+	ParameterState parameters_;
+
+	// Smoothed parameters, audio thread only:
+	LinearSmoother gain_;
+	OnePoleSmoother frequency_; // Hz, tuning (frequency of A4)
+	LinearSmoother brightness_;
+	LinearSmoother drive_; // clipper input gain, ramped at the oversampled rate
+
+	// Band-limited clipped sine (see ClippedSineWavetables), shared by all instances:
+	const ClippedSineWavetables *wavetables_;
+
+	// Voices, and the MIDI messages and parameter changes of the next block, preallocated:
+	WavetableSynth synth_;
+	Oversampler oversampler_;
+	EventScheduler<512> events_;
+	SilenceGate silenceGate_; // tail: the oversampler's filters
+
+	// Cost of every process call (see BlockProfiler.hxx):
+	BlockProfiler profiler_;
+
+	// Program data:
+	char programName_[kVstMaxProgNameLen + 1];
+};
+
+#endif
@@ -0,0 +1,321 @@
+#include "MyVstPlugIn.hxx"
+
+#include <cmath>
+#include <cstring>
+
+// ---------------------------------------------------------------------------------------
+// Constructor / destructor:
+// ---------------------------------------------------------------------------------------
+
+// Define parameter indexes:
+enum
+{
+	THRESHOLD,
+	REDUCTION,
+	// (.. define other parameters here ..)
+	NUM_PARAMETERS
+};
+
+// Name of the instances in the profiles (see BlockProfiler.hxx):
+const char *const PROFILE_NAME = "MyVstPlugIn-ex5";
+
+// Number of programs (presets):
+const int NUM_PROGRAMS = 1; // only current program (NUM_PROGRAMS = 0 causes problems with some hosts)
+
+// Peak bin magnitude of a full scale sine: sum of the sqrt(Hann) window/2 = WINDOW_SIZE/pi,
+// the 0 dB reference of the threshold:
+const float FULL_SCALE_BIN = (float)MYVSTPLUGIN_EX5_WINDOW_SIZE/3.14159265f;
+
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+MyVstPlugIn::MyVstPlugIn(audioMasterCallback audioMaster)
+	: AudioEffectX(audioMaster, NUM_PROGRAMS, NUM_PARAMETERS), thresholdPower_(0.0f), reduction_(1.0f),
+	  events_(NUM_PARAMETERS)
+{
+	// Set some basic properties of plug-in:
+	setNumInputs(NUM_CHANNELS);	// stereo in
+	setNumOutputs(NUM_CHANNELS);	// stereo out
+	setUniqueID('MVPI');		// unique 4 char identifier for this plug-in (here "My Vst Plug-In")
+	isSynth(false);				// this plug-in is an audio effect, not a synthesizer
+	canProcessReplacing(true);	// supports 'replacing output processing mode' (legacy stuff, always set to true)
+	canDoubleReplacing(true);	// supports 64 bit floating point I/O (processDoubleReplacing())
+	programsAreChunks(false);	// programs work through setParameter()/getParameter() rather than binary 'chunks'
+	setInitialDelay(WINDOW_SIZE);	// the STFT latency, so the host can compensate it
+
+	vst_strncpy(programName_, "default", kVstMaxProgNameLen);
+
+	initParameters();
+
+	// (.. do not do much else here, so scanning for plug-ins is fast ..)
+	// (.. do memory allocation/deallocation in resume()/suspend() instead, but normally pointers should be initialized to NULL here ..)
+}
+
+MyVstPlugIn::~MyVstPlugIn()
+{
+	// (.. nothing to do here ..)
+}
+
+// ---------------------------------------------------------------------------------------
+// Parameter functions:
+// ---------------------------------------------------------------------------------------
+
+void MyVstPlugIn::initParameters()
+{
+	setParameter(THRESHOLD, lin2norm(-60.0f, MIN_THRESHOLD_DB, MAX_THRESHOLD_DB));
+	setParameter(REDUCTION, 0.5f); // 30 dB
+	// (.. add more parameters here ..)
+
+	updateParameters();
+}
+
+// Called on the audio thread at the start of every block:
+void MyVstPlugIn::updateParameters()
+{
+	const uint32_t changes = parameters_.takeChanges();
+	for (int i = 0; i < NUM_PARAMETERS; ++i)
+	{
+		if (ParameterState::hasChanged(changes, i))
+		{
+			applyParameter(i, parameters_.get(i));
+		}
+	}
+}
+
+// Sets the gate from a parameter, at the start of a block or at a scheduled event:
+void MyVstPlugIn::applyParameter(int index, float value)
+{
+	if (index == THRESHOLD)
+	{
+		const float threshold = FULL_SCALE_BIN*fastDecibelsToGain(norm2lin(value, MIN_THRESHOLD_DB, MAX_THRESHOLD_DB));
+		thresholdPower_ = threshold*threshold;
+	}
+	else if (index == REDUCTION)
+	{
+		reduction_ = fastDecibelsToGain(-value*MAX_REDUCTION_DB);
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void MyVstPlugIn::setParameter(VstInt32 index, float value)
+{
+	// May be called from any thread; the audio thread picks the value up in updateParameters():
+	if (index >= 0 && index < NUM_PARAMETERS)
+	{
+		parameters_.set(index, value);
+	}
+}
+
+float MyVstPlugIn::getParameter(VstInt32 index)
+{
+	if (index >= 0 && index < NUM_PARAMETERS)
+	{
+		return parameters_.get(index);
+	}
+	else
+	{
+		return 0.0f; // invalid index
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void MyVstPlugIn::getParameterName(VstInt32 index, char *label)
+{
+	if (index == THRESHOLD)
+	{
+		vst_strncpy(label, "Thresh", kVstMaxParamStrLen);
+	}
+	else if (index == REDUCTION)
+	{
+		vst_strncpy(label, "Reduce", kVstMaxParamStrLen);
+	}
+	else
+	{
+		vst_strncpy(label, "", kVstMaxParamStrLen); // invalid index
+	}
+}
+
+void MyVstPlugIn::getParameterDisplay(VstInt32 index, char *text)
+{
+	if (index == THRESHOLD)
+	{
+		float2string(norm2lin(parameters_.get(THRESHOLD), MIN_THRESHOLD_DB, MAX_THRESHOLD_DB), text, kVstMaxParamStrLen);
+	}
+	else if (index == REDUCTION)
+	{
+		float2string(-parameters_.get(REDUCTION)*MAX_REDUCTION_DB, text, kVstMaxParamStrLen);
+	}
+	else
+	{
+		vst_strncpy(text, "", kVstMaxParamStrLen); // invalid index
+	}
+}
+
+void MyVstPlugIn::getParameterLabel(VstInt32 index, char *label)
+{
+	if (index == THRESHOLD || index == REDUCTION)
+	{
+		vst_strncpy(label, "dB", kVstMaxParamStrLen);
+	}
+	else
+	{
+		vst_strncpy(label, "", kVstMaxParamStrLen); // invalid index
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// Program functions:
+// ---------------------------------------------------------------------------------------
+
+void MyVstPlugIn::setProgramName(char *name)
+{
+	vst_strncpy(programName_, name, kVstMaxProgNameLen);
+}
+
+void MyVstPlugIn::getProgramName(char *name)
+{
+	vst_strncpy(name, programName_, kVstMaxProgNameLen);
+}
+
+// ---------------------------------------------------------------------------------------
+// Processing functions:
+// ---------------------------------------------------------------------------------------
+
+void MyVstPlugIn::resume()
+{
+	profiler_.setup(PROFILE_NAME, getSampleRate());
+
+	// Ring buffers and FFT tables; starts from silence, as after a suspend:
+	for (int c = 0; c < NUM_CHANNELS; ++c)
+	{
+		stft_[c].setup(WINDOW_SIZE, OVERLAP);
+	}
+	setInitialDelay(stft_[0].latency());
+	silenceGate_.setTail(TAIL_SIZE);
+	silenceGate_.reset();
+
+	updateParameters();
+}
+
+void MyVstPlugIn::suspend()
+{
+	// (.. de-initialization stuff goes here ..)
+	// (.. e.g. deallocating memory ..)
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Spectral gate: the bins whose magnitude is below the threshold are attenuated.
+void MyVstPlugIn::gateFrame(float *re, float *im, int numBins) const
+{
+	for (int k = 0; k < numBins; ++k)
+	{
+		const float gain = re[k]*re[k] + im[k]*im[k] < thresholdPower_ ? reduction_ : 1.0f;
+		re[k] *= gain;
+		im[k] *= gain;
+	}
+}
+
+template <typename Sample>
+void MyVstPlugIn::processBlock(Sample **inputs, Sample **outputs, VstInt32 numSamples)
+{
+	updateParameters();
+
+	// An idle track: once the last frames holding input are out, skip the FFTs until input
+	// returns (the rings then hold silence, as if the blocks had gone through):
+	if (!silenceGate_.next(isSilent(inputs, NUM_CHANNELS, numSamples), numSamples))
+	{
+		profiler_.mark(BlockProfiler::kSkipped);
+		events_.process(numSamples, [this](const ScheduledEvent &event) { handleEvent(event); }, [](int, int) {});
+		clearChannels(outputs, NUM_CHANNELS, numSamples);
+		return;
+	}
+
+	// Each channel streams through its STFT, any host block size; gateFrame() runs every
+	// WINDOW_SIZE/OVERLAP samples. Parameter changes split the block, so they reach the first
+	// frame after their sample:
+	events_.process(numSamples,
+		[this](const ScheduledEvent &event) { handleEvent(event); },
+		[&](int start, int length) {
+			for (int c = 0; c < NUM_CHANNELS; ++c)
+			{
+				stft_[c].process(inputs[c] + start, outputs[c] + start, length,
+				                 [this](float *re, float *im, int numBins) { gateFrame(re, im, numBins); });
+			}
+		});
+}
+
+// The overlap-add of a decaying input leaves subnormal numbers in the rings:
+void MyVstPlugIn::processReplacing(float **inputs, float **outputs, VstInt32 numSamples)
+{
+	BlockProfiler::Scope profile(profiler_, numSamples);
+	ScopedFlushDenormals flushDenormals;
+	processBlock(inputs, outputs, numSamples);
+}
+
+// Hosts with a 64 bit mix bus call this; the STFT rings are float, converted on the way in and out:
+void MyVstPlugIn::processDoubleReplacing(double **inputs, double **outputs, VstInt32 numSamples)
+{
+	BlockProfiler::Scope profile(profiler_, numSamples, BlockProfiler::kDouble);
+	ScopedFlushDenormals flushDenormals;
+	processBlock(inputs, outputs, numSamples);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Called by the host before processReplacing(), with the events of the next block. Control
+// changes 20 and 21 set threshold and reduction at their deltaFrames (see EventScheduler.hxx):
+VstInt32 MyVstPlugIn::processEvents(VstEvents *events)
+{
+	for (VstInt32 i = 0; i < events->numEvents; ++i)
+	{
+		if (events->events[i]->type != kVstMidiType)
+		{
+			continue;
+		}
+		const VstMidiEvent *midi = (const VstMidiEvent *)events->events[i];
+		events_.pushMidi(midi->deltaFrames, (unsigned char)midi->midiData[0],
+		                 (unsigned char)midi->midiData[1], (unsigned char)midi->midiData[2]);
+	}
+	return 1;
+}
+
+void MyVstPlugIn::handleEvent(const ScheduledEvent &event)
+{
+	// Other MIDI messages are ignored:
+	if (event.isParameter())
+	{
+		parameters_.set(event.parameter, event.value); // for getParameter(); re-applying it next block changes nothing
+		applyParameter(event.parameter, event.value);
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// Capabilities:
+// ---------------------------------------------------------------------------------------
+
+VstInt32 MyVstPlugIn::getGetTailSize()
+{
+	return TAIL_SIZE;
+}
+
+VstInt32 MyVstPlugIn::canDo(char *text)
+{
+	if (std::strcmp(text, "receiveVstEvents") == 0 || std::strcmp(text, "receiveVstMidiEvent") == 0)
+	{
+		return 1;
+	}
+	return -1; // explicitly can't do; 0 => don't know
+}
+
+// ---------------------------------------------------------------------------------------
+// Instance creator:
+// ---------------------------------------------------------------------------------------
+
+// Method that creates an instance of the VST plug-in:
+AudioEffect *createEffectInstance(audioMasterCallback audioMaster)
+{
+	return new MyVstPlugIn(audioMaster);
+}
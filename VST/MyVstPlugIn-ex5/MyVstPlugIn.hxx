@@ -0,0 +1,116 @@
+#ifndef INCLUDED_MYVSTPLUGIN_HXX
+#define INCLUDED_MYVSTPLUGIN_HXX
+
+#define _CRT_SECURE_NO_WARNINGS
+#include "public.sdk/source/vst2.x/audioeffectx.h"
+#undef _CRT_SECURE_NO_WARNINGS
+
+#include "DspCore/BlockProfiler.hxx"
+#include "DspCore/Denormals.hxx"
+#include "DspCore/EventScheduler.hxx"
+#include "DspCore/FastMath.hxx"
+#include "DspCore/ParameterMapping.hxx"
+#include "DspCore/ParameterState.hxx"
+#include "DspCore/Silence.hxx"
+#include "DspCore/StftProcessor.hxx"
+
+// STFT window size and overlap, "block~ 1024 4" in "PD/spectral processing.pd" by default;
+// build with e.g. -DMYVSTPLUGIN_EX5_WINDOW_SIZE=2048 (CMake options of the same names).
+// Powers of two; the latency reported to the host is the window size.
+#ifndef MYVSTPLUGIN_EX5_WINDOW_SIZE
+#define MYVSTPLUGIN_EX5_WINDOW_SIZE 1024
+#endif
+#ifndef MYVSTPLUGIN_EX5_OVERLAP
+#define MYVSTPLUGIN_EX5_OVERLAP 4
+#endif
+
+#define MIN_THRESHOLD_DB -90.0f
+#define MAX_THRESHOLD_DB 0.0f
+#define MAX_REDUCTION_DB 60.0f
+
+// Class that implements the VST plug-in.
+//
+// Most functions implemented are virtual functions of the AudioEffect(X) baseclass.
+// This is a very minimal example, there are many more functions that can be implemented.
+class MyVstPlugIn : public AudioEffectX
+{
+public:
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Constructor/destructor:
+	MyVstPlugIn(audioMasterCallback audioMaster);
+	~MyVstPlugIn();
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Parameters functions:
+	void initParameters(); // not from AudioEffect(X)
+
+	void setParameter(VstInt32 index, float value);
+	float getParameter(VstInt32 index);
+
+	void getParameterLabel(VstInt32 index, char *label);
+	void getParameterDisplay(VstInt32 index, char *text);
+	void getParameterName(VstInt32 index, char *text);
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Program functions:
+	void setProgramName(char *name);
+	void getProgramName(char *name);
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Processing functions:
+	void resume();
+	void suspend();
+	void processReplacing(float **inputs, float **outputs, VstInt32 numSamples);
+	void processDoubleReplacing(double **inputs, double **outputs, VstInt32 numSamples);
+	VstInt32 processEvents(VstEvents *events);
+	VstInt32 getGetTailSize();
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Capabilities:
+	VstInt32 canDo(char *text);
+
+private:
+	void updateParameters(); // audio thread
+	void applyParameter(int index, float value); // audio thread
+	void handleEvent(const ScheduledEvent &event); // audio thread
+
+	// Body of processReplacing() and processDoubleReplacing(), Sample = float or double:
+	template <typename Sample>
+	void processBlock(Sample **inputs, Sample **outputs, VstInt32 numSamples);
+
+	// The spectral effect, on every STFT frame of each channel:
+	void gateFrame(float *re, float *im, int numBins) const;
+
+	enum
+	{
+		NUM_CHANNELS = 2,
+		WINDOW_SIZE = MYVSTPLUGIN_EX5_WINDOW_SIZE,
+		OVERLAP = MYVSTPLUGIN_EX5_OVERLAP,
+		// The last input sample comes out after the latency, spread over the window of the
+		// frames that contain it:
+		TAIL_SIZE = 2*WINDOW_SIZE
+	};
+
+	// Parameters values (normalized, 0..1), shared between host and audio thread:
+	ParameterState parameters_;
+
+	// Gate settings, audio thread only; they change at frame boundaries, which the overlap-add
+	// crossfades anyway:
+	float thresholdPower_; // squared bin magnitude
+	float reduction_;      // gain of the bins below the threshold
+
+	// One STFT per channel, buffers allocated in resume():
+	StftProcessor stft_[NUM_CHANNELS];
+
+	// Parameter changes (MIDI control changes) of the next block, preallocated:
+	EventScheduler<512> events_;
+	SilenceGate silenceGate_;
+
+	// Cost of every process call (see BlockProfiler.hxx):
+	BlockProfiler profiler_;
+
+	// Program data:
+	char programName_[kVstMaxProgNameLen + 1];
+};
+
+#endif
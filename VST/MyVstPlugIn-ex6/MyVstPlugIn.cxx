@@ -0,0 +1,431 @@
+#include "MyVstPlugIn.hxx"
+
+#include "DspCore/GainRamp.hxx"
+#include "DspCore/WavFile.hxx"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// ---------------------------------------------------------------------------------------
+// Constructor / destructor:
+// ---------------------------------------------------------------------------------------
+
+// Define parameter indexes:
+enum
+{
+	DRY,
+	WET,
+	// (.. define other parameters here ..)
+	NUM_PARAMETERS
+};
+
+// Name of the instances in the profiles (see BlockProfiler.hxx):
+const char *const PROFILE_NAME = "MyVstPlugIn-ex6";
+
+// Number of programs (presets):
+const int NUM_PROGRAMS = 1; // only current program (NUM_PROGRAMS = 0 causes problems with some hosts)
+
+// Time a gain change takes to ramp to its new value:
+const float GAIN_RAMP_MS = 20.0f;
+
+// Synthetic impulse response: exponentially decaying noise, 60 dB down after DECAY_SECONDS:
+const float TAIL_SECONDS = 2.5f;
+const float DECAY_SECONDS = 2.0f;
+
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+MyVstPlugIn::MyVstPlugIn(audioMasterCallback audioMaster)
+	: AudioEffectX(audioMaster, NUM_PROGRAMS, NUM_PARAMETERS), dryDelayPosition_(0), events_(NUM_PARAMETERS)
+{
+	// Set some basic properties of plug-in:
+	setNumInputs(NUM_CHANNELS);	// stereo in
+	setNumOutputs(NUM_CHANNELS);	// stereo out
+	setUniqueID('MVPI');		// unique 4 char identifier for this plug-in (here "My Vst Plug-In")
+	isSynth(false);				// this plug-in is an audio effect, not a synthesizer
+	canProcessReplacing(true);	// supports 'replacing output processing mode' (legacy stuff, always set to true)
+	canDoubleReplacing(true);	// supports 64 bit floating point I/O (processDoubleReplacing())
+	programsAreChunks(false);	// programs work through setParameter()/getParameter() rather than binary 'chunks'
+	setInitialDelay(BLOCK_SIZE);	// the convolver latency, so the host can compensate it
+
+	std::memset(dryDelay_, 0, sizeof(dryDelay_));
+	vst_strncpy(programName_, "default", kVstMaxProgNameLen);
+
+	initParameters();
+
+	// (.. do not do much else here, so scanning for plug-ins is fast ..)
+	// (.. do memory allocation/deallocation in resume()/suspend() instead, but normally pointers should be initialized to NULL here ..)
+}
+
+MyVstPlugIn::~MyVstPlugIn()
+{
+	// (.. nothing to do here ..)
+}
+
+// ---------------------------------------------------------------------------------------
+// Parameter functions:
+// ---------------------------------------------------------------------------------------
+
+void MyVstPlugIn::initParameters()
+{
+	setParameter(DRY, 1.0f);  // 0 dB
+	setParameter(WET, 0.25f); // -12 dB
+	// (.. add more parameters here ..)
+
+	// Start at the defaults rather than ramping to them:
+	parameters_.takeChanges();
+	for (int c = 0; c < NUM_CHANNELS; ++c)
+	{
+		dryGain_[c].reset(parameters_.get(DRY));
+		wetGain_[c].reset(parameters_.get(WET));
+	}
+}
+
+// Called on the audio thread at the start of every block:
+void MyVstPlugIn::updateParameters()
+{
+	const uint32_t changes = parameters_.takeChanges();
+	for (int i = 0; i < NUM_PARAMETERS; ++i)
+	{
+		if (ParameterState::hasChanged(changes, i))
+		{
+			applyParameter(i, parameters_.get(i));
+		}
+	}
+}
+
+// Sets the smoothers of a parameter, at the start of a block or at a scheduled event:
+void MyVstPlugIn::applyParameter(int index, float value)
+{
+	for (int c = 0; c < NUM_CHANNELS; ++c)
+	{
+		if (index == DRY)
+		{
+			dryGain_[c].setTarget(value);
+		}
+		else if (index == WET)
+		{
+			wetGain_[c].setTarget(value);
+		}
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void MyVstPlugIn::setParameter(VstInt32 index, float value)
+{
+	// May be called from any thread; the audio thread picks the value up in updateParameters():
+	if (index >= 0 && index < NUM_PARAMETERS)
+	{
+		parameters_.set(index, value);
+	}
+}
+
+float MyVstPlugIn::getParameter(VstInt32 index)
+{
+	if (index >= 0 && index < NUM_PARAMETERS)
+	{
+		return parameters_.get(index);
+	}
+	else
+	{
+		return 0.0f; // invalid index
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void MyVstPlugIn::getParameterName(VstInt32 index, char *label)
+{
+	if (index == DRY)
+	{
+		vst_strncpy(label, "Dry", kVstMaxParamStrLen);
+	}
+	else if (index == WET)
+	{
+		vst_strncpy(label, "Wet", kVstMaxParamStrLen);
+	}
+	else
+	{
+		vst_strncpy(label, "", kVstMaxParamStrLen); // invalid index
+	}
+}
+
+void MyVstPlugIn::getParameterDisplay(VstInt32 index, char *text)
+{
+	if (index == DRY || index == WET)
+	{
+		dB2string(parameters_.get(index), text, kVstMaxParamStrLen); // linear gain, shown in dB
+	}
+	else
+	{
+		vst_strncpy(text, "", kVstMaxParamStrLen); // invalid index
+	}
+}
+
+void MyVstPlugIn::getParameterLabel(VstInt32 index, char *label)
+{
+	if (index == DRY || index == WET)
+	{
+		vst_strncpy(label, "dB", kVstMaxParamStrLen);
+	}
+	else
+	{
+		vst_strncpy(label, "", kVstMaxParamStrLen); // invalid index
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// Program functions:
+// ---------------------------------------------------------------------------------------
+
+void MyVstPlugIn::setProgramName(char *name)
+{
+	vst_strncpy(programName_, name, kVstMaxProgNameLen);
+}
+
+void MyVstPlugIn::getProgramName(char *name)
+{
+	vst_strncpy(name, programName_, kVstMaxProgNameLen);
+}
+
+// ---------------------------------------------------------------------------------------
+// Processing functions:
+// ---------------------------------------------------------------------------------------
+
+// The file named by MYVSTPLUGIN_EX6_IR if it can be read (used at its own sample rate, not
+// resampled), otherwise decorrelated decaying noise per channel. Both are normalised to unit
+// energy, so white noise keeps its level through the wet path.
+void MyVstPlugIn::loadImpulseResponses(float sampleRate)
+{
+	const char *path = std::getenv(MYVSTPLUGIN_EX6_IR_VARIABLE);
+	std::vector<std::vector<float> > channels;
+	double fileSampleRate = 0.0;
+	std::string error;
+	if (path != NULL && readWavFile(path, channels, fileSampleRate, error) && !channels.empty() && !channels[0].empty())
+	{
+		for (int c = 0; c < NUM_CHANNELS; ++c)
+		{
+			impulseResponses_[c] = channels[c < (int)channels.size() ? c : 0];
+		}
+	}
+	else
+	{
+		const int length = (int)(TAIL_SECONDS*sampleRate);
+		const float decay = std::log(1000.0f)/(DECAY_SECONDS*sampleRate);
+		unsigned int seed = 12345u;
+		for (int c = 0; c < NUM_CHANNELS; ++c)
+		{
+			impulseResponses_[c].resize(length);
+			for (int j = 0; j < length; ++j)
+			{
+				seed = seed*1664525u + 1013904223u;
+				const float noise = (float)(seed >> 9)*(2.0f/8388608.0f) - 1.0f;
+				impulseResponses_[c][j] = noise*std::exp(-decay*j);
+			}
+		}
+	}
+
+	for (int c = 0; c < NUM_CHANNELS; ++c)
+	{
+		double energy = 0.0;
+		for (size_t j = 0; j < impulseResponses_[c].size(); ++j)
+		{
+			energy += (double)impulseResponses_[c][j]*impulseResponses_[c][j];
+		}
+		const float scale = energy > 0.0 ? (float)(1.0/std::sqrt(energy)) : 0.0f;
+		for (size_t j = 0; j < impulseResponses_[c].size(); ++j)
+		{
+			impulseResponses_[c][j] *= scale;
+		}
+	}
+}
+
+void MyVstPlugIn::resume()
+{
+	const float sampleRate = getSampleRate();
+
+	profiler_.setup(PROFILE_NAME, sampleRate);
+
+	// Impulse response spectra and delay lines; starts from silence, as after a suspend:
+	loadImpulseResponses(sampleRate);
+	for (int c = 0; c < NUM_CHANNELS; ++c)
+	{
+		convolvers_[c].setup(&impulseResponses_[c][0], (int)impulseResponses_[c].size(), BLOCK_SIZE, MAX_PARTITION_SIZE);
+		dryGain_[c].setRampTime(GAIN_RAMP_MS, sampleRate);
+		wetGain_[c].setRampTime(GAIN_RAMP_MS, sampleRate);
+	}
+	std::memset(dryDelay_, 0, sizeof(dryDelay_));
+	dryDelayPosition_ = 0;
+	setInitialDelay(convolvers_[0].latency());
+	size_t longest = 0;
+	for (int c = 0; c < NUM_CHANNELS; ++c)
+	{
+		longest = impulseResponses_[c].size() > longest ? impulseResponses_[c].size() : longest;
+	}
+	silenceGate_.setTail(convolvers_[0].latency() + (int)longest);
+	silenceGate_.reset();
+
+	// Nothing to ramp from after a suspend:
+	updateParameters();
+	for (int c = 0; c < NUM_CHANNELS; ++c)
+	{
+		dryGain_[c].reset(dryGain_[c].target());
+		wetGain_[c].reset(wetGain_[c].target());
+	}
+}
+
+void MyVstPlugIn::suspend()
+{
+	// (.. de-initialization stuff goes here ..)
+	// (.. e.g. deallocating memory ..)
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+template <typename Sample>
+void MyVstPlugIn::processChunk(Sample **inputs, Sample **outputs, int start, int numSamples)
+{
+	int position = dryDelayPosition_;
+	for (int c = 0; c < NUM_CHANNELS; ++c)
+	{
+		const Sample *input = inputs[c] + start;
+		Sample *output = outputs[c] + start;
+
+		// Both paths read the input before the output (possibly the same buffer) is written:
+		position = dryDelayPosition_;
+		for (int j = 0; j < numSamples; ++j)
+		{
+			dry_[j] = dryDelay_[c][position];
+			dryDelay_[c][position] = (float)input[j];
+			position = position + 1 == BLOCK_SIZE ? 0 : position + 1;
+		}
+		convolvers_[c].process(input, wet_, numSamples);
+
+		applySmoothedGain(dryGain_[c], dry_, dry_, numSamples);
+		applySmoothedGain(wetGain_[c], wet_, wet_, numSamples);
+		for (int j = 0; j < numSamples; ++j)
+		{
+			output[j] = (Sample)(dry_[j] + wet_[j]);
+		}
+	}
+	dryDelayPosition_ = position;
+}
+
+template <typename Sample>
+void MyVstPlugIn::processBlock(Sample **inputs, Sample **outputs, VstInt32 numSamples)
+{
+	updateParameters();
+	for (int c = 0; c < NUM_CHANNELS; ++c)
+	{
+		if (dryGain_[c].isSmoothing() || wetGain_[c].isSmoothing())
+		{
+			profiler_.mark(BlockProfiler::kRamping);
+		}
+	}
+
+	// An idle track: once the reverb has died away, skip the convolutions until input returns
+	// (the convolvers and the dry delay then hold silence, as if the blocks had gone through):
+	if (!silenceGate_.next(isSilent(inputs, NUM_CHANNELS, numSamples), numSamples))
+	{
+		profiler_.mark(BlockProfiler::kSkipped);
+		events_.process(numSamples,
+			[this](const ScheduledEvent &event) { handleEvent(event); },
+			[this](int, int length) {
+				for (int c = 0; c < NUM_CHANNELS; ++c)
+				{
+					dryGain_[c].skip(length);
+					wetGain_[c].skip(length);
+				}
+			});
+		clearChannels(outputs, NUM_CHANNELS, numSamples);
+		return;
+	}
+
+	// Sub-blocks split at the scheduled parameter changes, in pieces that fit the scratch
+	// buffers; the convolvers stream across any of these boundaries:
+	events_.process(numSamples,
+		[this](const ScheduledEvent &event) { handleEvent(event); },
+		[&](int start, int length) {
+			for (int offset = 0; offset < length; offset += CHUNK_SIZE)
+			{
+				processChunk(inputs, outputs, start + offset, length - offset < CHUNK_SIZE ? length - offset : (int)CHUNK_SIZE);
+			}
+		});
+}
+
+// A decaying tail convolved with a decaying impulse response ends up in subnormal numbers:
+void MyVstPlugIn::processReplacing(float **inputs, float **outputs, VstInt32 numSamples)
+{
+	BlockProfiler::Scope profile(profiler_, numSamples);
+	ScopedFlushDenormals flushDenormals;
+	processBlock(inputs, outputs, numSamples);
+}
+
+// Hosts with a 64 bit mix bus call this; the convolvers are float, converted on the way in and out:
+void MyVstPlugIn::processDoubleReplacing(double **inputs, double **outputs, VstInt32 numSamples)
+{
+	BlockProfiler::Scope profile(profiler_, numSamples, BlockProfiler::kDouble);
+	ScopedFlushDenormals flushDenormals;
+	processBlock(inputs, outputs, numSamples);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Called by the host before processReplacing(), with the events of the next block. Control
+// changes 20 and 21 set the dry and wet gain at their deltaFrames (see EventScheduler.hxx):
+VstInt32 MyVstPlugIn::processEvents(VstEvents *events)
+{
+	for (VstInt32 i = 0; i < events->numEvents; ++i)
+	{
+		if (events->events[i]->type != kVstMidiType)
+		{
+			continue;
+		}
+		const VstMidiEvent *midi = (const VstMidiEvent *)events->events[i];
+		events_.pushMidi(midi->deltaFrames, (unsigned char)midi->midiData[0],
+		                 (unsigned char)midi->midiData[1], (unsigned char)midi->midiData[2]);
+	}
+	return 1;
+}
+
+void MyVstPlugIn::handleEvent(const ScheduledEvent &event)
+{
+	// Other MIDI messages are ignored:
+	if (event.isParameter())
+	{
+		parameters_.set(event.parameter, event.value); // for getParameter(); re-applying it next block changes nothing
+		applyParameter(event.parameter, event.value);
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// Capabilities:
+// ---------------------------------------------------------------------------------------
+
+// Known once resume() has loaded the impulse responses (0 before: not reported):
+VstInt32 MyVstPlugIn::getGetTailSize()
+{
+	return silenceGate_.tail();
+}
+
+VstInt32 MyVstPlugIn::canDo(char *text)
+{
+	if (std::strcmp(text, "receiveVstEvents") == 0 || std::strcmp(text, "receiveVstMidiEvent") == 0)
+	{
+		return 1;
+	}
+	return -1; // explicitly can't do; 0 => don't know
+}
+
+// ---------------------------------------------------------------------------------------
+// Instance creator:
+// ---------------------------------------------------------------------------------------
+
+// Method that creates an instance of the VST plug-in:
+AudioEffect *createEffectInstance(audioMasterCallback audioMaster)
+{
+	return new MyVstPlugIn(audioMaster);
+}
@@ -0,0 +1,129 @@
+#ifndef INCLUDED_MYVSTPLUGIN_HXX
+#define INCLUDED_MYVSTPLUGIN_HXX
+
+#define _CRT_SECURE_NO_WARNINGS
+#include "public.sdk/source/vst2.x/audioeffectx.h"
+#undef _CRT_SECURE_NO_WARNINGS
+
+#include "DspCore/BlockProfiler.hxx"
+#include "DspCore/Denormals.hxx"
+#include "DspCore/EventScheduler.hxx"
+#include "DspCore/ParameterMapping.hxx"
+#include "DspCore/ParameterState.hxx"
+#include "DspCore/PartitionedConvolver.hxx"
+#include "DspCore/Silence.hxx"
+#include "DspCore/Smoother.hxx"
+
+#include <vector>
+
+// Partitioning of the impulse response: the first partitions (and the latency reported to
+// the host) are MYVSTPLUGIN_EX6_BLOCK_SIZE samples, the later ones grow up to
+// MYVSTPLUGIN_EX6_MAX_PARTITION_SIZE; equal sizes give uniform partitioning. Powers of two,
+// CMake options of the same names.
+#ifndef MYVSTPLUGIN_EX6_BLOCK_SIZE
+#define MYVSTPLUGIN_EX6_BLOCK_SIZE 64
+#endif
+#ifndef MYVSTPLUGIN_EX6_MAX_PARTITION_SIZE
+#define MYVSTPLUGIN_EX6_MAX_PARTITION_SIZE 4096
+#endif
+
+// Environment variable with the path of a WAV impulse response (mono, or one channel per
+// output channel), read in resume(). Without it the plug-in makes a synthetic reverb tail.
+#define MYVSTPLUGIN_EX6_IR_VARIABLE "MYVSTPLUGIN_EX6_IR"
+
+// Class that implements the VST plug-in.
+//
+// Most functions implemented are virtual functions of the AudioEffect(X) baseclass.
+// This is a very minimal example, there are many more functions that can be implemented.
+class MyVstPlugIn : public AudioEffectX
+{
+public:
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Constructor/destructor:
+	MyVstPlugIn(audioMasterCallback audioMaster);
+	~MyVstPlugIn();
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Parameters functions:
+	void initParameters(); // not from AudioEffect(X)
+
+	void setParameter(VstInt32 index, float value);
+	float getParameter(VstInt32 index);
+
+	void getParameterLabel(VstInt32 index, char *label);
+	void getParameterDisplay(VstInt32 index, char *text);
+	void getParameterName(VstInt32 index, char *text);
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Program functions:
+	void setProgramName(char *name);
+	void getProgramName(char *name);
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Processing functions:
+	void resume();
+	void suspend();
+	void processReplacing(float **inputs, float **outputs, VstInt32 numSamples);
+	void processDoubleReplacing(double **inputs, double **outputs, VstInt32 numSamples);
+	VstInt32 processEvents(VstEvents *events);
+	VstInt32 getGetTailSize();
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Capabilities:
+	VstInt32 canDo(char *text);
+
+private:
+	void updateParameters(); // audio thread
+	void applyParameter(int index, float value); // audio thread
+	void handleEvent(const ScheduledEvent &event); // audio thread
+
+	// Loads the impulse response of each channel into impulseResponses_ (resume() only):
+	void loadImpulseResponses(float sampleRate);
+
+	// Body of processReplacing() and processDoubleReplacing(), Sample = float or double:
+	template <typename Sample>
+	void processBlock(Sample **inputs, Sample **outputs, VstInt32 numSamples);
+
+	// Dry and wet mix of samples start..start + numSamples, numSamples <= CHUNK_SIZE:
+	template <typename Sample>
+	void processChunk(Sample **inputs, Sample **outputs, int start, int numSamples);
+
+	enum
+	{
+		NUM_CHANNELS = 2,
+		BLOCK_SIZE = MYVSTPLUGIN_EX6_BLOCK_SIZE,
+		MAX_PARTITION_SIZE = MYVSTPLUGIN_EX6_MAX_PARTITION_SIZE,
+		CHUNK_SIZE = 256 // scratch buffers, any host block size is processed in pieces of this
+	};
+
+	// Parameters values (normalized, 0..1), shared between host and audio thread:
+	ParameterState parameters_;
+
+	// Smoothed gains per channel, audio thread only:
+	LinearSmoother dryGain_[NUM_CHANNELS];
+	LinearSmoother wetGain_[NUM_CHANNELS];
+
+	// Impulse responses and their convolvers, set up in resume():
+	std::vector<float> impulseResponses_[NUM_CHANNELS];
+	PartitionedConvolver convolvers_[NUM_CHANNELS];
+
+	// The dry signal, delayed by the convolver latency so dry and wet stay aligned:
+	float dryDelay_[NUM_CHANNELS][BLOCK_SIZE];
+	int dryDelayPosition_;
+
+	// Scratch buffers of processChunk():
+	float dry_[CHUNK_SIZE];
+	float wet_[CHUNK_SIZE];
+
+	// Parameter changes (MIDI control changes) of the next block, preallocated:
+	EventScheduler<512> events_;
+	SilenceGate silenceGate_; // tail: latency plus the longest impulse response
+
+	// Cost of every process call (see BlockProfiler.hxx):
+	BlockProfiler profiler_;
+
+	// Program data:
+	char programName_[kVstMaxProgNameLen + 1];
+};
+
+#endif
@@ -0,0 +1,357 @@
+// Deadline report of the plug-in instances profiled with DSPCORE_PROFILE (see BlockProfiler.hxx).
+//
+// Reads the <module>-<pid>.prof snapshots given on the command line, or found in the
+// directories given: the drain thread of every plug-in module keeps one up to date while its
+// instances exist, in shared memory under /dev/shm or in a file elsewhere. E.g.
+//
+//   DSPCORE_PROFILE=/dev/shm HeadlessHost MyVstPlugIn-ex3.so ... &
+//   ProfileReport --watch 1 /dev/shm
+//
+// Per instance, worst first: blocks, deadline misses (blocks that took longer than
+// numSamples/sampleRate), the mean load (time in the process call / audio time), the load
+// percentiles and maximum, the longest block, the share of blocks with a parameter ramp and
+// of blocks skipped as silent, and the records lost to a full ring. The percentiles come
+// from the histogram (4 bins per octave), so they are upper bounds within 19% (and never
+// above the maximum). Exits with 1 if a path or snapshot cannot be read.
+//
+// Usage: ProfileReport [options] file.prof|directory ...
+//   --watch 0            reprint every so many seconds (0 = once)
+//   --histogram          print the load histogram of every instance
+//   --csv                print comma separated values instead of a table
+//
+// Built by the CMake project in VST/ (does not need the VST SDK). POSIX (mmap, dirent).
+
+#include "DspCore/BlockProfiler.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ---------------------------------------------------------------------------------------
+// Options:
+// ---------------------------------------------------------------------------------------
+
+struct ReportOptions
+{
+	double watch;
+	bool histogram;
+	bool csv;
+	std::vector<std::string> paths;
+
+	ReportOptions() : watch(0.0), histogram(false), csv(false) {}
+};
+
+static bool parseOptions(int argc, char **argv, ReportOptions &options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const char *arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (std::strcmp(arg, "--watch") == 0 && hasValue)
+		{
+			options.watch = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--histogram") == 0)
+		{
+			options.histogram = true;
+		}
+		else if (std::strcmp(arg, "--csv") == 0)
+		{
+			options.csv = true;
+		}
+		else if (arg[0] == '-')
+		{
+			std::fprintf(stderr, "unknown option: %s\n", arg);
+			return false;
+		}
+		else
+		{
+			options.paths.push_back(arg);
+		}
+	}
+	return !options.paths.empty() && options.watch >= 0.0;
+}
+
+// ---------------------------------------------------------------------------------------
+// Snapshots:
+// ---------------------------------------------------------------------------------------
+
+static bool endsWith(const std::string &text, const char *suffix)
+{
+	const size_t n = std::strlen(suffix);
+	return text.size() >= n && text.compare(text.size() - n, n, suffix) == 0;
+}
+
+// Appends path if it is a file, or the .prof files in it if it is a directory (sorted);
+// false if path cannot be read:
+static bool collectFiles(const std::string &path, std::vector<std::string> &files)
+{
+	struct stat info;
+	if (stat(path.c_str(), &info) != 0)
+	{
+		std::fprintf(stderr, "cannot stat %s\n", path.c_str());
+		return false;
+	}
+	if (!S_ISDIR(info.st_mode))
+	{
+		files.push_back(path);
+		return true;
+	}
+	DIR *dir = opendir(path.c_str());
+	if (dir == NULL)
+	{
+		std::fprintf(stderr, "cannot open %s\n", path.c_str());
+		return false;
+	}
+	std::vector<std::string> entries;
+	while (struct dirent *entry = readdir(dir))
+	{
+		if (entry->d_name[0] != '.' && endsWith(entry->d_name, ".prof"))
+		{
+			entries.push_back(path + "/" + entry->d_name);
+		}
+	}
+	closedir(dir);
+	std::sort(entries.begin(), entries.end());
+	files.insert(files.end(), entries.begin(), entries.end());
+	return true;
+}
+
+// Consistent copy of the instances of a snapshot, retrying while the drain thread writes it:
+static bool readSnapshot(const std::string &path, std::vector<ProfileInstanceStats> &instances, int &pid)
+{
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(ProfileSnapshot))
+	{
+		close(fd);
+		return false;
+	}
+	void *mapping = mmap(NULL, sizeof(ProfileSnapshot), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED)
+	{
+		return false;
+	}
+	const ProfileSnapshot *snapshot = (const ProfileSnapshot *)mapping;
+
+	bool ok = false;
+	for (int attempt = 0; attempt < 1000 && !ok; ++attempt)
+	{
+		const uint32_t before = snapshot->sequence.load(std::memory_order_acquire);
+		if (before & 1)
+		{
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+			continue;
+		}
+		if (snapshot->magic != kProfileMagic || snapshot->version != kProfileVersion)
+		{
+			break;
+		}
+		const int count = std::min(std::max(snapshot->numInstances, 0), (int)kProfileMaxInstances);
+		instances.assign(snapshot->instances, snapshot->instances + count);
+		pid = snapshot->pid;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		ok = snapshot->sequence.load(std::memory_order_relaxed) == before;
+	}
+	munmap(mapping, sizeof(ProfileSnapshot));
+	return ok;
+}
+
+// ---------------------------------------------------------------------------------------
+// Statistics:
+// ---------------------------------------------------------------------------------------
+
+struct Row
+{
+	std::string file;
+	int pid;
+	ProfileInstanceStats stats;
+	uint64_t drained; // blocks in the histogram
+};
+
+// Upper edge (as a load) of the bin holding the p quantile of the drained blocks, but no more
+// than the worst block (which may sit low in the last bin used):
+static double loadPercentile(const Row &row, double p)
+{
+	if (row.drained == 0)
+	{
+		return 0.0;
+	}
+	const uint64_t rank = (uint64_t)(p*(row.drained - 1));
+	uint64_t count = 0;
+	for (int bin = 0; bin < kProfileHistogramBins; ++bin)
+	{
+		count += row.stats.histogram[bin];
+		if (count > rank)
+		{
+			return bin + 1 < kProfileHistogramBins ? std::min(profileHistogramLoad(bin + 1), row.stats.maxLoad) : row.stats.maxLoad;
+		}
+	}
+	return row.stats.maxLoad;
+}
+
+// Most deadline misses first, then the highest peak load:
+static bool worseThan(const Row &a, const Row &b)
+{
+	if (a.stats.misses != b.stats.misses)
+	{
+		return a.stats.misses > b.stats.misses;
+	}
+	return a.stats.maxLoad > b.stats.maxLoad;
+}
+
+static double percent(uint64_t part, uint64_t whole)
+{
+	return whole > 0 ? 100.0*part/whole : 0.0;
+}
+
+static void printHistogram(const Row &row)
+{
+	uint64_t peak = 1;
+	for (int bin = 0; bin < kProfileHistogramBins; ++bin)
+	{
+		peak = std::max(peak, row.stats.histogram[bin]);
+	}
+	for (int bin = 0; bin < kProfileHistogramBins; ++bin)
+	{
+		const uint64_t count = row.stats.histogram[bin];
+		if (count == 0)
+		{
+			continue;
+		}
+		const double upper = bin + 1 < kProfileHistogramBins ? 100.0*profileHistogramLoad(bin + 1) : 0.0;
+		char range[32];
+		if (upper > 0.0)
+		{
+			std::snprintf(range, sizeof(range), "%8.2f..%.2f%%", 100.0*profileHistogramLoad(bin), upper);
+		}
+		else
+		{
+			std::snprintf(range, sizeof(range), "%8.2f%%..", 100.0*profileHistogramLoad(bin));
+		}
+		std::printf("    %-20s %10llu %s%s\n", range, (unsigned long long)count,
+		            std::string((size_t)(50*count/peak), '#').c_str(), bin >= kProfileDeadlineBin ? " late" : "");
+	}
+}
+
+static int report(const ReportOptions &options)
+{
+	std::vector<std::string> files;
+	int failures = 0;
+	for (size_t i = 0; i < options.paths.size(); ++i)
+	{
+		failures += collectFiles(options.paths[i], files) ? 0 : 1;
+	}
+
+	std::vector<Row> rows;
+	int snapshots = 0;
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		std::vector<ProfileInstanceStats> instances;
+		int pid = 0;
+		if (!readSnapshot(files[i], instances, pid))
+		{
+			std::fprintf(stderr, "cannot read %s (not a profile snapshot?)\n", files[i].c_str());
+			++failures;
+			continue;
+		}
+		++snapshots;
+		for (size_t k = 0; k < instances.size(); ++k)
+		{
+			Row row;
+			row.file = files[i];
+			row.pid = pid;
+			row.stats = instances[k];
+			row.stats.name[kProfileNameSize - 1] = '\0';
+			row.drained = 0;
+			for (int bin = 0; bin < kProfileHistogramBins; ++bin)
+			{
+				row.drained += row.stats.histogram[bin];
+			}
+			rows.push_back(row);
+		}
+	}
+	if (snapshots == 0)
+	{
+		std::fprintf(stderr, "no profile snapshot read\n");
+		return 1;
+	}
+	std::stable_sort(rows.begin(), rows.end(), worseThan);
+
+	if (options.csv)
+	{
+		std::printf("instance,pid,active,sample_rate,blocks,samples,misses,mean_load,p50_load,p99_load,p999_load,max_load,max_us,ramp_blocks,skipped_blocks,dropped\n");
+	}
+	else
+	{
+		std::printf("%-24s %7s %6s %10s %8s %7s %7s %7s %7s %8s %9s %6s %6s %8s\n", "instance", "pid", "rate", "blocks", "misses",
+		            "mean", "p50", "p99", "p99.9", "max", "max us", "ramp", "skip", "dropped");
+	}
+	for (size_t i = 0; i < rows.size(); ++i)
+	{
+		const Row &row = rows[i];
+		const ProfileInstanceStats &stats = row.stats;
+		const double mean = stats.audioSeconds > 0.0 ? stats.processSeconds/stats.audioSeconds : 0.0;
+		if (options.csv)
+		{
+			std::printf("%s,%d,%u,%.0f,%llu,%llu,%llu,%.6f,%.6f,%.6f,%.6f,%.6f,%.3f,%llu,%llu,%llu\n", stats.name, row.pid, stats.active,
+			            stats.sampleRate, (unsigned long long)stats.blocks, (unsigned long long)stats.samples,
+			            (unsigned long long)stats.misses, mean, loadPercentile(row, 0.5), loadPercentile(row, 0.99),
+			            loadPercentile(row, 0.999), stats.maxLoad, 1e6*stats.maxSeconds, (unsigned long long)stats.rampBlocks,
+			            (unsigned long long)stats.skippedBlocks, (unsigned long long)stats.dropped);
+			continue;
+		}
+		std::printf("%-24s %7d %6.0f %10llu %8llu %6.2f%% %6.2f%% %6.2f%% %6.2f%% %7.2f%% %9.1f %5.1f%% %5.1f%% %8llu%s\n", stats.name,
+		            row.pid, stats.sampleRate, (unsigned long long)stats.blocks, (unsigned long long)stats.misses, 100.0*mean,
+		            100.0*loadPercentile(row, 0.5), 100.0*loadPercentile(row, 0.99), 100.0*loadPercentile(row, 0.999),
+		            100.0*stats.maxLoad, 1e6*stats.maxSeconds, percent(stats.rampBlocks, stats.blocks),
+		            percent(stats.skippedBlocks, stats.blocks), (unsigned long long)stats.dropped, stats.active ? "" : " (deleted)");
+		if (options.histogram)
+		{
+			printHistogram(row);
+		}
+	}
+	return failures > 0 ? 1 : 0;
+}
+
+// ---------------------------------------------------------------------------------------
+// Main:
+// ---------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+	ReportOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		std::fprintf(stderr, "usage: %s [--watch seconds] [--histogram] [--csv] file.prof|directory ...\n", argv[0]);
+		return 2;
+	}
+
+	if (options.watch <= 0.0)
+	{
+		return report(options);
+	}
+	for (;;)
+	{
+		std::printf("\n");
+		report(options);
+		std::fflush(stdout);
+		std::this_thread::sleep_for(std::chrono::duration<double>(options.watch));
+	}
+}
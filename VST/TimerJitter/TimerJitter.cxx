@@ -0,0 +1,429 @@
+// Native timer jitter benchmark: the PD/Timing/ex1 metro and delay experiments, run against
+// the Linux clocks instead of the Pd scheduler, to compare timer strategies for a thread that
+// has to wake up on time (e.g. an audio callback thread).
+//
+// Experiments (as in ex1.pd and ex1delay.pd):
+//   metro   periodic deadlines, start + k*period; a late wake-up does not move the next one
+//   delay   the next deadline is period after the actual wake-up, so lateness accumulates
+//
+// Methods (how the thread waits for a deadline on CLOCK_MONOTONIC):
+//   sleep      std::this_thread::sleep_until() on steady_clock
+//   nanosleep  clock_nanosleep() with an absolute deadline (TIMER_ABSTIME)
+//   hybrid     clock_nanosleep() until --spin us before the deadline, then busy-wait
+//
+// With --fifo the thread runs with SCHED_FIFO at the given priority and all memory locked
+// (mlockall); the method names get a "-fifo" suffix. This needs CAP_SYS_NICE or an rtprio
+// limit (/etc/security/limits.conf).
+//
+// Every run writes <output>/<experiment>_<method>_<N>ms.txt: the measured interval between
+// successive wake-ups, in ms, one value per line, like the realtime files of save_data.pd, so
+// JitterStats reads them along with the Pd captures. A summary line per run is printed:
+// interval statistics, lateness (wake-up time - deadline) and the CPU load of the thread.
+//
+// A run lasts --duration seconds, but has at least --min-ticks ticks; all runs take about
+// 12 minutes with the defaults.
+//
+// Usage: TimerJitter [options]
+//   --experiments metro,delay
+//   --methods sleep,nanosleep,hybrid
+//   --periods 5000,1000,200,100,50,10,5,3    ms
+//   --duration 10                            seconds per run
+//   --min-ticks 10
+//   --spin 200                               busy-wait margin of hybrid, us
+//   --fifo 0                                 SCHED_FIFO priority (1..99), 0 = normal
+//   --output data                            directory of the result files
+//   --csv                                    print comma separated values instead of a table
+//
+// Built by the CMake project in VST/ (does not need the VST SDK). Linux (clock_nanosleep,
+// sched_setscheduler, mlockall).
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// ---------------------------------------------------------------------------------------
+// Options:
+// ---------------------------------------------------------------------------------------
+
+enum Experiment { kMetro, kDelay };
+enum Method { kSleep, kNanosleep, kHybrid };
+
+static const char *const experimentNames[] = { "metro", "delay" };
+static const char *const methodNames[] = { "sleep", "nanosleep", "hybrid" };
+
+struct JitterOptions
+{
+	std::vector<int> experiments;
+	std::vector<int> methods;
+	std::vector<double> periods; // ms
+	double duration;             // s
+	int minTicks;
+	double spin;                 // us
+	int fifoPriority;
+	std::string output;
+	bool csv;
+
+	JitterOptions() : duration(10.0), minTicks(10), spin(200.0), fifoPriority(0), output("data"), csv(false) {}
+};
+
+// Indices in names[0..count) of the comma separated list; false if a name is unknown:
+static bool parseNames(const char *list, const char *const *names, int count, std::vector<int> &indices)
+{
+	indices.clear();
+	std::string text(list);
+	for (size_t start = 0; start <= text.size();)
+	{
+		size_t comma = text.find(',', start);
+		if (comma == std::string::npos)
+		{
+			comma = text.size();
+		}
+		const std::string name = text.substr(start, comma - start);
+		int i = 0;
+		while (i < count && name != names[i])
+		{
+			++i;
+		}
+		if (i == count)
+		{
+			std::fprintf(stderr, "unknown name: %s\n", name.c_str());
+			return false;
+		}
+		indices.push_back(i);
+		start = comma + 1;
+	}
+	return true;
+}
+
+static bool parsePeriods(const char *list, std::vector<double> &periods)
+{
+	periods.clear();
+	for (const char *p = list; *p != '\0';)
+	{
+		char *end;
+		const double period = std::strtod(p, &end);
+		if (end == p || period <= 0.0 || (*end != ',' && *end != '\0'))
+		{
+			return false;
+		}
+		periods.push_back(period);
+		p = *end == ',' ? end + 1 : end;
+	}
+	return !periods.empty();
+}
+
+static bool parseOptions(int argc, char **argv, JitterOptions &options)
+{
+	static const int defaultExperiments[] = { kMetro, kDelay };
+	static const int defaultMethods[] = { kSleep, kNanosleep, kHybrid };
+	static const double defaultPeriods[] = { 5000, 1000, 200, 100, 50, 10, 5, 3 }; // ex1.pd
+	options.experiments.assign(defaultExperiments, defaultExperiments + 2);
+	options.methods.assign(defaultMethods, defaultMethods + 3);
+	options.periods.assign(defaultPeriods, defaultPeriods + 8);
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const char *arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (std::strcmp(arg, "--experiments") == 0 && hasValue)
+		{
+			if (!parseNames(argv[++i], experimentNames, 2, options.experiments))
+			{
+				return false;
+			}
+		}
+		else if (std::strcmp(arg, "--methods") == 0 && hasValue)
+		{
+			if (!parseNames(argv[++i], methodNames, 3, options.methods))
+			{
+				return false;
+			}
+		}
+		else if (std::strcmp(arg, "--periods") == 0 && hasValue)
+		{
+			if (!parsePeriods(argv[++i], options.periods))
+			{
+				std::fprintf(stderr, "bad periods: %s\n", argv[i]);
+				return false;
+			}
+		}
+		else if (std::strcmp(arg, "--duration") == 0 && hasValue)
+		{
+			options.duration = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--min-ticks") == 0 && hasValue)
+		{
+			options.minTicks = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--spin") == 0 && hasValue)
+		{
+			options.spin = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--fifo") == 0 && hasValue)
+		{
+			options.fifoPriority = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(arg, "--output") == 0 && hasValue)
+		{
+			options.output = argv[++i];
+		}
+		else if (std::strcmp(arg, "--csv") == 0)
+		{
+			options.csv = true;
+		}
+		else
+		{
+			std::fprintf(stderr, "unknown option: %s\n", arg);
+			return false;
+		}
+	}
+	return options.duration >= 0.0 && options.minTicks >= 1 && options.spin >= 0.0 && options.fifoPriority >= 0
+	       && options.fifoPriority <= 99;
+}
+
+// ---------------------------------------------------------------------------------------
+// Waiting:
+// ---------------------------------------------------------------------------------------
+
+typedef long long Nanoseconds; // on CLOCK_MONOTONIC
+
+static Nanoseconds monotonicNow()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (Nanoseconds)ts.tv_sec*1000000000LL + ts.tv_nsec;
+}
+
+static Nanoseconds threadCpuTime()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (Nanoseconds)ts.tv_sec*1000000000LL + ts.tv_nsec;
+}
+
+static void sleepUntil(Nanoseconds deadline)
+{
+	struct timespec ts;
+	ts.tv_sec = (time_t)(deadline/1000000000LL);
+	ts.tv_nsec = (long)(deadline%1000000000LL);
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+	{
+	}
+}
+
+// Returns when the deadline has passed. steady_clock is CLOCK_MONOTONIC with libstdc++ and
+// libc++ on Linux, so the deadlines are the same time points for all methods.
+static void waitUntil(Method method, Nanoseconds deadline, Nanoseconds spin)
+{
+	switch (method)
+	{
+	case kSleep:
+		std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(deadline)));
+		break;
+	case kNanosleep:
+		sleepUntil(deadline);
+		break;
+	case kHybrid:
+		if (deadline - spin > monotonicNow())
+		{
+			sleepUntil(deadline - spin);
+		}
+		while (monotonicNow() < deadline)
+		{
+#if defined(__SSE2__)
+			_mm_pause();
+#endif
+		}
+		break;
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// Runs:
+// ---------------------------------------------------------------------------------------
+
+struct RunResult
+{
+	std::vector<double> intervals; // ms between successive wake-ups (the first from the start)
+	double lateMean;               // ms, wake-up time - deadline
+	double lateMax;
+	double cpuLoad;                // thread CPU time / elapsed time
+};
+
+// Allocates before the clock starts; the loop itself only reads clocks and waits:
+static void run(Experiment experiment, Method method, double period, int ticks, double spin, RunResult &result)
+{
+	result.intervals.assign(ticks, 0.0);
+	std::vector<Nanoseconds> late(ticks, 0);
+	const Nanoseconds periodNs = (Nanoseconds)std::llround(period*1e6);
+	const Nanoseconds spinNs = (Nanoseconds)std::llround(spin*1e3);
+
+	const Nanoseconds cpuStart = threadCpuTime();
+	const Nanoseconds start = monotonicNow();
+	Nanoseconds previous = start, deadline = start;
+	for (int k = 0; k < ticks; ++k)
+	{
+		deadline = experiment == kMetro ? start + (k + 1)*periodNs : previous + periodNs;
+		waitUntil(method, deadline, spinNs);
+		const Nanoseconds now = monotonicNow();
+		result.intervals[k] = (now - previous)*1e-6;
+		late[k] = now - deadline;
+		previous = now;
+	}
+	const Nanoseconds cpu = threadCpuTime() - cpuStart;
+
+	double lateSum = 0.0;
+	Nanoseconds lateMax = 0;
+	for (int k = 0; k < ticks; ++k)
+	{
+		lateSum += late[k];
+		lateMax = std::max(lateMax, late[k]);
+	}
+	result.lateMean = lateSum/ticks*1e-6;
+	result.lateMax = lateMax*1e-6;
+	result.cpuLoad = previous > start ? (double)cpu/(previous - start) : 0.0;
+}
+
+static bool writeValues(const std::string &path, const std::vector<double> &values)
+{
+	FILE *file = std::fopen(path.c_str(), "w");
+	if (file == NULL)
+	{
+		return false;
+	}
+	for (size_t i = 0; i < values.size(); ++i)
+	{
+		std::fprintf(file, "%.4f\n", values[i]);
+	}
+	return std::fclose(file) == 0;
+}
+
+// ---------------------------------------------------------------------------------------
+// Main:
+// ---------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+	JitterOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		std::fprintf(stderr,
+		             "usage: %s [--experiments metro,delay] [--methods sleep,nanosleep,hybrid] [--periods ms,...]\n"
+		             "       [--duration s] [--min-ticks n] [--spin us] [--fifo priority] [--output dir] [--csv]\n",
+		             argv[0]);
+		return 2;
+	}
+
+	if (mkdir(options.output.c_str(), 0777) != 0 && errno != EEXIST)
+	{
+		std::fprintf(stderr, "cannot create %s: %s\n", options.output.c_str(), std::strerror(errno));
+		return 1;
+	}
+
+	// Real-time scheduling for the whole process, before anything is timed:
+	const char *suffix = "";
+	if (options.fifoPriority > 0)
+	{
+		if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+		{
+			std::fprintf(stderr, "mlockall: %s\n", std::strerror(errno));
+			return 1;
+		}
+		struct sched_param param;
+		std::memset(&param, 0, sizeof(param));
+		param.sched_priority = options.fifoPriority;
+		const int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+		if (error != 0)
+		{
+			std::fprintf(stderr, "SCHED_FIFO priority %d: %s (needs CAP_SYS_NICE or an rtprio limit)\n", options.fifoPriority,
+			             std::strerror(error));
+			return 1;
+		}
+		suffix = "-fifo";
+	}
+
+	if (options.csv)
+	{
+		std::printf("experiment,method,period_ms,ticks,mean,std,min,max,max_jitter,late_mean,late_max,cpu_load\n");
+	}
+	else
+	{
+		std::printf("%-8s %-14s %7s %6s %10s %8s %10s %10s %10s %9s %9s %6s\n", "exp", "method", "period", "ticks", "mean", "std",
+		            "min", "max", "max jitter", "late mean", "late max", "cpu %");
+	}
+	std::fflush(stdout);
+
+	int failures = 0;
+	RunResult result;
+	for (size_t e = 0; e < options.experiments.size(); ++e)
+	{
+		for (size_t m = 0; m < options.methods.size(); ++m)
+		{
+			for (size_t p = 0; p < options.periods.size(); ++p)
+			{
+				const Experiment experiment = (Experiment)options.experiments[e];
+				const Method method = (Method)options.methods[m];
+				const double period = options.periods[p];
+				const int ticks = std::max(options.minTicks, (int)(options.duration*1000.0/period));
+				run(experiment, method, period, ticks, options.spin, result);
+
+				const std::string methodName = std::string(methodNames[method]) + suffix;
+				char name[256];
+				std::snprintf(name, sizeof(name), "%s/%s_%s_%gms.txt", options.output.c_str(), experimentNames[experiment],
+				              methodName.c_str(), period);
+				if (!writeValues(name, result.intervals))
+				{
+					std::fprintf(stderr, "cannot write %s\n", name);
+					++failures;
+				}
+
+				const std::vector<double> &x = result.intervals;
+				double mean = 0.0, variance = 0.0, maxJitter = 0.0;
+				for (size_t i = 0; i < x.size(); ++i)
+				{
+					mean += x[i];
+					maxJitter = std::max(maxJitter, std::fabs(x[i] - period));
+				}
+				mean /= x.size();
+				for (size_t i = 0; i < x.size(); ++i)
+				{
+					variance += (x[i] - mean)*(x[i] - mean);
+				}
+				const double deviation = std::sqrt(variance/x.size());
+				const double low = *std::min_element(x.begin(), x.end()), high = *std::max_element(x.begin(), x.end());
+
+				if (options.csv)
+				{
+					std::printf("%s,%s,%g,%d,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.4f\n", experimentNames[experiment],
+					            methodName.c_str(), period, ticks, mean, deviation, low, high, maxJitter, result.lateMean,
+					            result.lateMax, result.cpuLoad);
+				}
+				else
+				{
+					std::printf("%-8s %-14s %7g %6d %10.4f %8.4f %10.4f %10.4f %10.4f %9.4f %9.4f %6.2f\n", experimentNames[experiment],
+					            methodName.c_str(), period, ticks, mean, deviation, low, high, maxJitter, result.lateMean,
+					            result.lateMax, 100.0*result.cpuLoad);
+				}
+				std::fflush(stdout);
+			}
+		}
+	}
+	return failures == 0 ? 0 : 1;
+}